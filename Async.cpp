@@ -0,0 +1,197 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Async.hpp"
+#include "LU.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::min
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+using namespace matrix;
+using async::Job;
+
+namespace {
+
+thread_local Job* running = nullptr;
+
+/** @brief Marks the driver thread as running @p job for the scope. */
+struct Bind {
+    explicit Bind(Job* job) { running = job; }
+    ~Bind() { running = nullptr; }
+};
+
+/** @brief Single background thread that runs queued jobs in order. */
+class Driver {
+private:
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> queue;
+    bool stopping = false;
+    std::thread thread;                // אחרון – מתחיל לרוץ רק אחרי שהשאר נבנו
+
+    void loop()
+    {
+        for (;;) {
+            std::function<void()> next;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                wake.wait(lock, [&] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                next = std::move(queue.front());
+                queue.pop_front();
+            }
+            next();
+        }
+    }
+
+public:
+    Driver() : thread(&Driver::loop, this) {}
+    Driver(const Driver&) = delete;
+    Driver& operator=(const Driver&) = delete;
+
+    /** Drains the queue and joins – outstanding jobs still complete. */
+    ~Driver()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    void submit(std::function<void()> fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            queue.push_back(std::move(fn));
+        }
+        wake.notify_one();
+    }
+
+    static Driver& instance()
+    {
+        ThreadPool::instance();        // נבנה קודם → נהרס אחרי ה-driver
+        static Driver driver;
+        return driver;
+    }
+};
+
+/** @brief Queue @p body as a job expecting @p flops of work.  Operands
+ *  are captured by shared_ptr, so each is copied once, at submission. */
+template <class T, class Body>
+Task<T> launch(std::uint64_t flops, async::ProgressFn onProgress, Body body)
+{
+    auto job = std::make_shared<Job>(flops, std::move(onProgress));
+    auto work = std::make_shared<std::packaged_task<T()>>([job, body = std::move(body)]() mutable {
+        Bind bind(job.get());
+        job->step(0);                  // בוטל עוד בתור
+        T r = body();
+        job->finish();
+        return r;
+    });
+    Task<T> task(job, work->get_future());
+    Driver::instance().submit([work] { (*work)(); });
+    return task;
+}
+
+std::uint64_t cube(int n) { return static_cast<std::uint64_t>(n) * n * n; }
+
+} // namespace
+
+/* ====================================================================
+   Job state
+   ================================================================= */
+
+Job::Job(std::uint64_t expectedFlops, ProgressFn fn)
+    : stopRequested(false), done(0), total(expectedFlops ? expectedFlops : 1),
+      onProgress(std::move(fn)), reported(-1) {}
+
+/** @brief Ask the job to stop at its next checkpoint. */
+void Job::cancel() { stopRequested.store(true, std::memory_order_relaxed); }
+
+bool Job::cancelled() const { return stopRequested.load(std::memory_order_relaxed); }
+
+/** @brief Fraction of the expected FLOPs done, held below 1 until the
+ *  job has actually finished (the FLOP model is an estimate).          */
+double Job::progress() const
+{
+    const std::uint64_t d = done.load(std::memory_order_relaxed);
+    if (d == UINT64_MAX) return 1.0;
+    return std::min(0.99, static_cast<double>(d) / static_cast<double>(total));
+}
+
+/** @brief Record @p flops of finished work; throws if cancelled.
+ *  @throw OperationCancelled after cancel()                           */
+void Job::step(std::uint64_t flops)
+{
+    if (cancelled()) throw OperationCancelled();
+    if (!flops) return;
+    done.fetch_add(flops, std::memory_order_relaxed);
+    if (onProgress) report(static_cast<int>(progress() * 100));
+}
+
+/** @brief Mark the job complete (progress 1, final callback). */
+void Job::finish()
+{
+    done.store(UINT64_MAX, std::memory_order_relaxed);
+    if (onProgress) report(100);
+}
+
+void Job::report(int percent)
+{
+    std::lock_guard<std::mutex> lock(reportMtx);
+    if (percent <= reported) return;
+    reported = percent;
+    onProgress(percent / 100.0);
+}
+
+/** @brief Job driving the calling thread (set on the driver thread only;
+ *  kernels read it once on entry and hand it to their pool tiles).    */
+Job* async::current() { return running; }
+
+/* ====================================================================
+   Operations
+   ================================================================= */
+
+/** @brief A·B in the background.
+ *  @throw std::invalid_argument (immediately) on dimension mismatch    */
+Task<SquareMat> matrix::multiplyAsync(const SquareMat& A, const SquareMat& B, async::ProgressFn onProgress)
+{
+    if (A.getN() != B.getN()) throw std::invalid_argument("dimension mismatch");
+    auto a = std::make_shared<const SquareMat>(A), b = std::make_shared<const SquareMat>(B);
+    return launch<SquareMat>(2 * cube(A.getN()), std::move(onProgress),
+                             [a, b] { return *a * *b; });
+}
+
+/** @brief A^e in the background (same square-and-multiply as operator^).
+ *  @throw std::invalid_argument (immediately) if @p e < 0              */
+Task<SquareMat> matrix::powAsync(const SquareMat& A, int e, async::ProgressFn onProgress)
+{
+    if (e < 0) throw std::invalid_argument("negative exponent");
+    std::uint64_t products = 0;
+    for (int k = e; k > 0; k >>= 1) products += 1 + (k & 1);
+    auto a = std::make_shared<const SquareMat>(A);
+    return launch<SquareMat>(products * 2 * cube(A.getN()), std::move(onProgress),
+                             [a, e] { return *a ^ e; });
+}
+
+/** @brief det(A) in the background.  Uses the O(n³) LU factorization –
+ *  the same value operator! defines, without its O(n!) expansion.     */
+Task<double> matrix::detAsync(const SquareMat& A, async::ProgressFn onProgress)
+{
+    auto a = std::make_shared<const SquareMat>(A);
+    return launch<double>(2 * cube(A.getN()) / 3, std::move(onProgress),
+                          [a] { return LU(*a).determinant(); });
+}
+
+/** @brief X with A·X = B in the background; a singular @p A surfaces
+ *  as std::domain_error from get().
+ *  @throw std::invalid_argument (immediately) on dimension mismatch    */
+Task<SquareMat> matrix::solveAsync(const SquareMat& A, const SquareMat& B, async::ProgressFn onProgress)
+{
+    if (A.getN() != B.getN()) throw std::invalid_argument("dimension mismatch");
+    auto a = std::make_shared<const SquareMat>(A), b = std::make_shared<const SquareMat>(B);
+    return launch<SquareMat>(2 * cube(A.getN()) / 3 + 2 * cube(A.getN()), std::move(onProgress),
+                             [a, b] { return LU(*a).solve(*b); });
+}
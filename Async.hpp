@@ -0,0 +1,112 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include "SquareMat.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace matrix {
+
+/*
+ * Non-blocking variants of the long-running operations.  Each call copies
+ * its operands, queues the job and returns a Task at once; a background
+ * driver thread runs queued jobs one after another, each spreading its
+ * GEMM tiles over the shared ThreadPool (which serves one parallel loop
+ * at a time, so running jobs side by side would not be faster).
+ *
+ * Cancellation is cooperative: cancel() is noticed at the next GEMM
+ * tile, triangular-solve chunk or LU panel, and get() then throws
+ * OperationCancelled.  Progress is the fraction of the expected FLOPs
+ * done so far; the callback runs on whichever pool thread finished the
+ * work, once per whole percent, and must not block.
+ */
+
+/** Thrown by Task::get() when the job was cancelled before finishing. */
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("operation cancelled") {}
+};
+
+namespace async {
+
+using ProgressFn = std::function<void(double)>;
+
+/** Shared state of one asynchronous job. */
+class Job {
+private:
+    std::atomic<bool> stopRequested;
+    std::atomic<std::uint64_t> done;     // FLOPs שדווחו
+    std::uint64_t total;                 // FLOPs צפויים
+    ProgressFn onProgress;
+    std::mutex reportMtx;
+    int reported;                        // האחוז האחרון שדווח (תחת reportMtx)
+
+    void report(int percent);
+
+public:
+    Job(std::uint64_t expectedFlops, ProgressFn fn);
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
+
+    void cancel();
+    bool cancelled() const;
+    double progress() const;             // 0..1; 1 רק אחרי finish()
+
+    void step(std::uint64_t flops);      // זורק OperationCancelled אם בוטל
+    void finish();
+};
+
+// ---------- נקודות ביקורת בקרנלים ----------
+Job* current();                          // העבודה שהחוט הזה מריץ, או nullptr
+
+inline void checkpoint(Job* job, std::uint64_t flops = 0)
+{
+    if (job) job->step(flops);
+}
+
+} // namespace async
+
+/** Handle to a queued or running job; move-only, like std::future. */
+template <class T>
+class Task {
+private:
+    std::shared_ptr<async::Job> job;
+    std::future<T> result;
+
+public:
+    Task(std::shared_ptr<async::Job> job_, std::future<T> result_)
+        : job(std::move(job_)), result(std::move(result_)) {}
+
+    T get() { return result.get(); }     // ממתין; זורק את שגיאת העבודה
+    void wait() const { result.wait(); }
+    bool ready() const
+    {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+    template <class Rep, class Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& d) const
+    {
+        return result.wait_for(d) == std::future_status::ready;
+    }
+
+    void cancel() { job->cancel(); }
+    double progress() const { return job->progress(); }
+};
+
+// ---------- פעולות אסינכרוניות ----------
+Task<SquareMat> multiplyAsync(const SquareMat& A, const SquareMat& B, async::ProgressFn onProgress = {});
+Task<SquareMat> powAsync(const SquareMat& A, int e, async::ProgressFn onProgress = {});
+Task<double> detAsync(const SquareMat& A, async::ProgressFn onProgress = {});      // דרך LU, O(n³)
+Task<SquareMat> solveAsync(const SquareMat& A, const SquareMat& B, async::ProgressFn onProgress = {});
+
+} // namespace matrix
+
+#endif // ASYNC_HPP
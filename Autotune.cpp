@@ -0,0 +1,229 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Autotune.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::min, std::max
+#include <chrono>
+#include <cmath>       // std::sin
+#include <cstdio>      // std::rename, std::remove
+#include <cstdlib>     // std::getenv
+#include <fstream>     // std::ifstream, std::ofstream
+#include <memory>      // std::unique_ptr
+#include <sstream>     // std::istringstream
+#include <stdexcept>   // std::runtime_error
+#include <vector>
+#include <sys/stat.h>  // mkdir
+
+using namespace matrix;
+using namespace matrix::autotune;
+using kernels::GemmConfig;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** @brief mkdir -p for the directories above @p path. */
+void makeParents(const std::string& path)
+{
+    for (std::size_t p = path.find('/', 1); p != std::string::npos; p = path.find('/', p + 1))
+        ::mkdir(path.substr(0, p).c_str(), 0755);             // EEXIST זה בסדר
+}
+
+/** @brief Candidate values for one dimension of the search. */
+std::vector<int> candidates(int dim, int poolSize)
+{
+    switch (dim) {
+    case 0: return {32, 48, 64, 96, 128, 192, 256};            // MC
+    case 1: return {64, 128, 192, 256, 384, 512};              // KC
+    case 2: return {512, 1024, 2048, 4096, 8192};              // NC
+    default: {                                                 // חוטים; 0 = כל ה-pool
+        std::vector<int> t{0};
+        for (int k = 1; k < poolSize; k *= 2) t.push_back(k);
+        return t;
+    }
+    }
+}
+
+int& field(GemmConfig& c, int dim)
+{
+    switch (dim) {
+    case 0: return c.mc;
+    case 1: return c.kc;
+    case 2: return c.nc;
+    default: return c.threads;
+    }
+}
+
+} // namespace
+
+/* ====================================================================
+   Host identification and cache
+   ================================================================= */
+
+/** @brief "model name" from /proc/cpuinfo ("unknown" if absent). */
+std::string autotune::cpuModel()
+{
+    std::ifstream f("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(f, line))
+        if (line.rfind("model name", 0) == 0) {
+            const std::size_t c = line.find(':');
+            return c == std::string::npos ? "" : line.substr(line.find_first_not_of(' ', c + 1));
+        }
+    return "unknown";
+}
+
+/** @brief $SQUAREMAT_TUNE_CACHE, else $XDG_CACHE_HOME/squaremat/gemm.tune,
+ *  else ~/.cache/squaremat/gemm.tune; empty when caching is off.      */
+std::string autotune::defaultCachePath()
+{
+    if (const char* env = std::getenv("SQUAREMAT_TUNE_CACHE"))
+        return std::string(env) == "off" ? "" : env;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/squaremat/gemm.tune";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/squaremat/gemm.tune";
+    return "";
+}
+
+/** @brief Apply the cached configuration for this CPU model, if any.
+ *  Lines are "model<TAB>mr nr mc kc nc threads gflops"; malformed lines
+ *  and entries for another micro-kernel shape are skipped.
+ *  @return true if gemmConfig() was updated                           */
+bool autotune::loadCache(const std::string& path)
+{
+    if (path.empty()) return false;
+    std::ifstream f(path);
+    const std::string model = cpuModel();
+    std::string line;
+    while (std::getline(f, line)) {
+        const std::size_t tab = line.find('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos || line.substr(0, tab) != model)
+            continue;
+        std::istringstream in(line.substr(tab + 1));
+        int mr, nr;
+        GemmConfig c;
+        if (!(in >> mr >> nr >> c.mc >> c.kc >> c.nc >> c.threads)) continue;
+        if (mr != kernels::MR || nr != kernels::NR || c.mc <= 0 || c.kc <= 0 || c.nc <= 0 || c.threads < 0)
+            continue;
+        kernels::setGemmConfig(c);
+        return true;
+    }
+    return false;
+}
+
+/** @brief Record @p cfg for this CPU model, replacing its old entry and
+ *  keeping other models' lines (a shared home directory may serve a
+ *  mixed fleet).  Written via a temporary file and rename().
+ *  @throw std::runtime_error if the file cannot be written            */
+void autotune::saveCache(const GemmConfig& cfg, double gflops, const std::string& path)
+{
+    if (path.empty()) throw std::runtime_error("no tuning cache path");
+    const std::string model = cpuModel();
+    std::vector<std::string> keep;
+    {
+        std::ifstream old(path);
+        std::string line;
+        while (std::getline(old, line))
+            if (!line.empty() && line[0] != '#' && line.substr(0, line.find('\t')) != model) keep.push_back(line);
+    }
+    makeParents(path);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::trunc);
+        f << "# SquareMat GEMM tuning cache: model<TAB>mr nr mc kc nc threads gflops\n";
+        for (const std::string& l : keep) f << l << '\n';
+        f << model << '\t' << kernels::MR << ' ' << kernels::NR << ' ' << cfg.mc << ' ' << cfg.kc << ' '
+          << cfg.nc << ' ' << cfg.threads << ' ' << gflops << '\n';
+        if (!f) throw std::runtime_error("cannot write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot rename " + tmp + " to " + path);
+    }
+}
+
+/* ====================================================================
+   Search
+   ================================================================= */
+
+/** @brief GFLOP/s of an n×n×n gemm under @p cfg – best of at least two
+ *  runs (the first also warms the caches and pack buffers) and 0.1 s.
+ *  @p cfg is passed to gemm directly; the active configuration, which
+ *  other threads may be using, is left alone.                         */
+double autotune::measure(const GemmConfig& cfg, int n)
+{
+    const long nn = static_cast<long>(n) * n;
+    std::unique_ptr<double[]> A(new double[nn]), B(new double[nn]), C(new double[nn]);
+    for (long k = 0; k < nn; ++k) {
+        A[k] = std::sin(0.37 * (k + 1));
+        B[k] = std::sin(0.91 * (k + 1));
+    }
+
+    double best = 1e30, total = 0;
+    for (int run = 0; run < 2 || (total < 0.1 && run < 20); ++run) {
+        const auto t0 = Clock::now();
+        kernels::gemm(n, n, n, 1.0, A.get(), n, false, B.get(), n, false, 0.0, C.get(), n, cfg);
+        const double s = std::chrono::duration<double>(Clock::now() - t0).count();
+        best = std::min(best, s);
+        total += s;
+    }
+    return 2.0 * n * n * static_cast<double>(n) / best * 1e-9;
+}
+
+/** @brief Coordinate search over MC, KC, NC and the thread count,
+ *  starting from the active configuration.  A change is kept only if it
+ *  is more than 1% faster, so timing noise does not wander the result;
+ *  the search stops early once the budget is spent.  The winner is
+ *  installed in gemmConfig() and, if requested, saved to the cache.  */
+TuneResult autotune::tune(const TuneOptions& opt)
+{
+    if (opt.n < 64) throw std::invalid_argument("tuning size must be at least 64");
+    const auto deadline = Clock::now() + std::chrono::duration<double>(opt.budgetSeconds);
+    const int poolSize = ThreadPool::instance().size();
+
+    TuneResult r{kernels::gemmConfig(), 0, 0, 1};
+    r.gflops = r.baselineGflops = measure(r.config, opt.n);
+
+    for (int pass = 0; pass < opt.passes && Clock::now() < deadline; ++pass) {
+        bool improved = false;
+        for (int dim = 0; dim < 4 && Clock::now() < deadline; ++dim)
+            for (int v : candidates(dim, poolSize)) {
+                if (Clock::now() >= deadline) break;
+                GemmConfig c = r.config;
+                if (field(c, dim) == v) continue;
+                field(c, dim) = v;
+                const double g = measure(c, opt.n);
+                ++r.tried;
+                if (g > r.gflops * 1.01) {
+                    r.config = c;
+                    r.gflops = g;
+                    improved = true;
+                }
+            }
+        if (!improved) break;
+    }
+
+    kernels::setGemmConfig(r.config);
+    if (opt.save) saveCache(r.config, r.gflops, opt.cachePath.empty() ? defaultCachePath() : opt.cachePath);
+    return r;
+}
+
+namespace {
+
+/** @brief Apply this host's cached tuning before main() runs, but only
+ *  when SQUAREMAT_TUNE_LOAD=1 asks for it – a tuning cache must not
+ *  silently change the blocking of every program linking the library. */
+struct LoadAtStartup {
+    LoadAtStartup()
+    {
+        const char* env = std::getenv("SQUAREMAT_TUNE_LOAD");
+        if (!env || std::string(env) != "1") return;
+        try {
+            loadCache();
+        } catch (...) {
+            // מטמון פגום או לא נגיש – נשארים עם ברירת המחדל
+        }
+    }
+} loadAtStartup;
+
+} // namespace
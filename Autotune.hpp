@@ -0,0 +1,53 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef AUTOTUNE_HPP
+#define AUTOTUNE_HPP
+
+#include "Kernels.hpp"
+#include <string>
+
+namespace matrix {
+namespace autotune {
+
+/*
+ * Per-host tuning of the GEMM blocking (MC, KC, NC) and thread count.
+ * tune() times kernels::gemm on the current machine, installs the fastest
+ * configuration with kernels::setGemmConfig() and records it in a cache
+ * file keyed by the CPU model.  The cache is applied only on request:
+ * call loadCache(), or set SQUAREMAT_TUNE_LOAD=1 to apply this CPU's
+ * entry at program start.
+ *
+ * The micro-kernel shape MR×NR is fixed at compile time; it is stored
+ * with each entry, and entries written for another shape are ignored.
+ */
+
+struct TuneOptions {
+    int n = 1024;                   // גודל המכפלה הנמדדת
+    double budgetSeconds = 20;      // הפסקה מוקדמת – שומר את הטוב עד כה
+    int passes = 2;                 // סבבי חיפוש קואורדינטות
+    bool save = true;
+    std::string cachePath;          // ריק = defaultCachePath()
+};
+
+struct TuneResult {
+    kernels::GemmConfig config;
+    double gflops;                  // של התצורה שנבחרה
+    double baselineGflops;          // של התצורה שהייתה פעילה לפני
+    int tried;                      // תצורות שנמדדו
+};
+
+// ---------- זיהוי ומטמון ----------
+std::string cpuModel();
+std::string defaultCachePath();     // $SQUAREMAT_TUNE_CACHE, אחרת ~/.cache/squaremat/gemm.tune
+bool loadCache(const std::string& path = defaultCachePath());   // true אם נמצאה רשומה למעבד הזה
+void saveCache(const kernels::GemmConfig& cfg, double gflops,
+               const std::string& path = defaultCachePath());
+
+// ---------- חיפוש ----------
+double measure(const kernels::GemmConfig& cfg, int n);          // GFLOP/s, הטוב מבין כמה הרצות
+TuneResult tune(const TuneOptions& opt = TuneOptions());
+
+} // namespace autotune
+} // namespace matrix
+
+#endif // AUTOTUNE_HPP
@@ -0,0 +1,379 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "BandMat.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min, std::max, std::swap
+#include <cmath>       // std::fabs
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::invalid_argument, std::out_of_range, std::domain_error
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Rows handled by one task in the row-parallel products. */
+constexpr int ROWS = 256;
+
+/**
+ * Banded LU with partial pivoting (gbtrf-style).  Pivoting can push
+ * fill up to kl extra super-diagonals, so each row keeps columns
+ * i-kl … i+kl+ku, i.e. 2kl+ku+1 doubles.
+ */
+struct BandLU {
+    std::unique_ptr<double[]> a;
+    std::unique_ptr<int[]> piv;
+    int n, kl, ku, w;
+    int sign = 1;
+    bool singular = false;
+
+    double& at(int i, int j) { return a[static_cast<long>(i) * w + (j - i + kl)]; }
+};
+
+} // namespace
+
+/* ====================================================================
+   Rule-of-Three
+   ================================================================= */
+
+/** @brief Construct an @c n×n band with @p kl_ sub- and @p ku_
+ *  super-diagonals filled with @p initVal.  Bandwidths ≥ n are clipped.
+ *  @throw std::invalid_argument if @p n_ ≤ 0 or a bandwidth is negative */
+BandMat::BandMat(int n_, int kl_, int ku_, double initVal)
+    : data(nullptr), n(n_), kl(kl_), ku(ku_)
+{
+    if (n <= 0) throw std::invalid_argument("n must be positive");
+    if (kl < 0 || ku < 0) throw std::invalid_argument("bandwidth must be non-negative");
+    kl = std::min(kl, n - 1);
+    ku = std::min(ku, n - 1);
+    data = new double[static_cast<long>(n) * width()];
+    std::fill(data, data + static_cast<long>(n) * width(), 0.0);
+    for (int i = 0; i < n; ++i)
+        for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j)
+            data[static_cast<long>(i) * width() + (j - i + kl)] = initVal;
+}
+
+/** @brief Keep the band of @p A; everything outside it is dropped. */
+BandMat::BandMat(const SquareMat& A, int kl_, int ku_) : BandMat(A.getN(), kl_, ku_)
+{
+    const double* a = A.raw();
+    for (int i = 0; i < n; ++i)
+        for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j)
+            data[static_cast<long>(i) * width() + (j - i + kl)] = a[static_cast<long>(i) * n + j];
+}
+
+/** @brief Deep-copy constructor (O(n·bandwidth)). */
+BandMat::BandMat(const BandMat& other)
+    : data(nullptr), n(other.n), kl(other.kl), ku(other.ku)
+{
+    data = new double[static_cast<long>(n) * width()];
+    std::copy(other.data, other.data + static_cast<long>(n) * width(), data);
+}
+
+/** @brief Copy-assignment operator. */
+BandMat& BandMat::operator=(const BandMat& other)
+{
+    if (this == &other) return *this;
+
+    if (static_cast<long>(n) * width() != static_cast<long>(other.n) * other.width()) {
+        delete[] data;
+        data = new double[static_cast<long>(other.n) * other.width()];
+    }
+    n = other.n;
+    kl = other.kl;
+    ku = other.ku;
+    std::copy(other.data, other.data + static_cast<long>(n) * width(), data);
+    return *this;
+}
+
+/** @brief Destructor – frees the band buffer. */
+BandMat::~BandMat() { delete[] data; }
+
+/* ====================================================================
+   Element access
+   ================================================================= */
+
+/** @brief Stored doubles per row. */
+int BandMat::width() const { return kl + ku + 1; }
+
+/** @brief True if (i,j) lies inside the band. */
+bool BandMat::inBand(int i, int j) const { return j >= i - kl && j <= i + ku; }
+
+/** @brief Mutable access to an element inside the band.
+ *  @throw std::out_of_range outside [0,n-1] or outside the band        */
+double& BandMat::operator()(int i, int j)
+{
+    if (i < 0 || i >= n || j < 0 || j >= n)
+        throw std::out_of_range("index out of range");
+    if (!inBand(i, j)) throw std::out_of_range("element is not stored");
+    return data[static_cast<long>(i) * width() + (j - i + kl)];
+}
+
+/** @brief Value of element (i,j) – 0 outside the band. */
+double BandMat::operator()(int i, int j) const
+{
+    if (i < 0 || i >= n || j < 0 || j >= n)
+        throw std::out_of_range("index out of range");
+    if (!inBand(i, j)) return 0.0;
+    return data[static_cast<long>(i) * width() + (j - i + kl)];
+}
+
+int BandMat::getN() const { return n; }
+int BandMat::lower() const { return kl; }
+int BandMat::upper() const { return ku; }
+
+/** @brief Expand to a dense SquareMat. */
+SquareMat BandMat::toSquareMat() const
+{
+    SquareMat res(n, 0.0);
+    for (int i = 0; i < n; ++i)
+        for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j)
+            res[i][j] = data[static_cast<long>(i) * width() + (j - i + kl)];
+    return res;
+}
+
+/* ====================================================================
+   Arithmetic
+   ================================================================= */
+
+/** @brief Sum of two bands – the result has the wider of each bandwidth. */
+BandMat BandMat::operator+(const BandMat& rhs) const
+{
+    if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    BandMat res(n, std::max(kl, rhs.kl), std::max(ku, rhs.ku));
+    for (int i = 0; i < n; ++i) {
+        double* r = res.data + static_cast<long>(i) * res.width();
+        for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j)
+            r[j - i + res.kl] += data[static_cast<long>(i) * width() + (j - i + kl)];
+        for (int j = std::max(0, i - rhs.kl); j <= std::min(n - 1, i + rhs.ku); ++j)
+            r[j - i + res.kl] += rhs.data[static_cast<long>(i) * rhs.width() + (j - i + rhs.kl)];
+    }
+    return res;
+}
+
+/** @brief Multiply every stored element by scalar @p s. */
+BandMat BandMat::operator*(double s) const
+{
+    BandMat res(*this);
+    for (long k = 0; k < static_cast<long>(n) * width(); ++k) res.data[k] *= s;
+    return res;
+}
+
+/** @brief y = A·x in O(n·bandwidth). */
+void BandMat::multiply(const double* x, double* y) const
+{
+    ThreadPool::instance().parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        const int r1 = std::min(n, (blk + 1) * ROWS);
+        for (int i = blk * ROWS; i < r1; ++i) {
+            const double* row = data + static_cast<long>(i) * width();
+            double s = 0.0;
+            for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j)
+                s += row[j - i + kl] * x[j];
+            y[i] = s;
+        }
+    });
+}
+
+/** @brief Band × dense: each result row is a short sum of rows of
+ *  @p rhs – O(n²·bandwidth) instead of O(n³).                         */
+SquareMat BandMat::operator*(const SquareMat& rhs) const
+{
+    if (n != rhs.getN()) throw std::invalid_argument("dimension mismatch");
+    SquareMat res(n, 0.0);
+    const double* b = rhs.raw();
+    double* c = res.raw();
+    ThreadPool::instance().parallelFor(0, (n + 63) / 64, [&](int blk) {
+        const int r1 = std::min(n, (blk + 1) * 64);
+        for (int i = blk * 64; i < r1; ++i) {
+            double* ci = c + static_cast<long>(i) * n;
+            for (int k = std::max(0, i - kl); k <= std::min(n - 1, i + ku); ++k) {
+                const double a = data[static_cast<long>(i) * width() + (k - i + kl)];
+                if (a == 0.0) continue;
+                const double* bk = b + static_cast<long>(k) * n;
+                for (int j = 0; j < n; ++j) ci[j] += a * bk[j];
+            }
+        }
+    });
+    return res;
+}
+
+/** @brief Band × band → band with kl₁+kl₂ / ku₁+ku₂ diagonals,
+ *  in O(n · bandwidth₁ · bandwidth₂).                                   */
+BandMat BandMat::operator*(const BandMat& rhs) const
+{
+    if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    BandMat res(n, kl + rhs.kl, ku + rhs.ku);
+    ThreadPool::instance().parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        const int r1 = std::min(n, (blk + 1) * ROWS);
+        for (int i = blk * ROWS; i < r1; ++i) {
+            double* ci = res.data + static_cast<long>(i) * res.width();
+            for (int k = std::max(0, i - kl); k <= std::min(n - 1, i + ku); ++k) {
+                const double a = data[static_cast<long>(i) * width() + (k - i + kl)];
+                if (a == 0.0) continue;
+                const double* bk = rhs.data + static_cast<long>(k) * rhs.width();
+                for (int j = std::max(0, k - rhs.kl); j <= std::min(n - 1, k + rhs.ku); ++j)
+                    ci[j - i + res.kl] += a * bk[j - k + rhs.kl];
+            }
+        }
+    });
+    return res;
+}
+
+/** @brief Binary exponentiation; the band widens with each product
+ *  (capped at a full matrix).                                         */
+BandMat BandMat::operator^(int e) const
+{
+    if (e < 0) throw std::invalid_argument("negative exponent");
+    BandMat base(*this);
+    BandMat res(n, 0, 0, 1.0);                        // identity
+    while (e) {
+        if (e & 1) res = res * base;
+        e >>= 1;
+        if (e) base = base * base;
+    }
+    return res;
+}
+
+/* ====================================================================
+   Transpose / determinant / solve
+   ================================================================= */
+
+/** @brief Transpose – swaps the sub- and super-diagonal counts. */
+BandMat BandMat::operator~() const
+{
+    BandMat res(n, ku, kl);
+    for (int i = 0; i < n; ++i)
+        for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j)
+            res.data[static_cast<long>(j) * res.width() + (i - j + res.kl)] =
+                data[static_cast<long>(i) * width() + (j - i + kl)];
+    return res;
+}
+
+namespace {
+
+/** @brief Factor @p A with row pivoting inside the band –
+ *  O(n·kl·(kl+ku)) instead of O(n³).                                  */
+BandLU factorBand(const BandMat& A)
+{
+    BandLU f;
+    f.n = A.getN();
+    f.kl = A.lower();
+    f.ku = A.upper();
+    f.w = 2 * f.kl + f.ku + 1;
+    f.a.reset(new double[static_cast<long>(f.n) * f.w]);
+    f.piv.reset(new int[f.n]);
+    std::fill(f.a.get(), f.a.get() + static_cast<long>(f.n) * f.w, 0.0);
+
+    const int n = f.n;
+    for (int i = 0; i < n; ++i)
+        for (int j = std::max(0, i - f.kl); j <= std::min(n - 1, i + f.ku); ++j)
+            f.at(i, j) = A(i, j);
+
+    for (int k = 0; k < n; ++k) {
+        const int iEnd = std::min(n - 1, k + f.kl);
+        const int jEnd = std::min(n - 1, k + f.kl + f.ku);
+
+        int p = k;
+        for (int i = k + 1; i <= iEnd; ++i)
+            if (std::fabs(f.at(i, k)) > std::fabs(f.at(p, k))) p = i;
+        f.piv[k] = p;
+        if (p != k) {
+            for (int j = k; j <= jEnd; ++j) std::swap(f.at(k, j), f.at(p, j));
+            f.sign = -f.sign;
+        }
+        const double d = f.at(k, k);
+        if (d == 0.0) { f.singular = true; continue; }
+
+        for (int i = k + 1; i <= iEnd; ++i) {
+            const double l = (f.at(i, k) /= d);
+            if (l == 0.0) continue;
+            for (int j = k + 1; j <= jEnd; ++j) f.at(i, j) -= l * f.at(k, j);
+        }
+    }
+    return f;
+}
+
+/** @brief Apply the factored band to @p m right-hand sides stored as
+ *  rows of @p x (row-major, leading dimension @p m).                  */
+void bandSubstitute(BandLU& f, double* x, int m)
+{
+    const int n = f.n;
+    for (int k = 0; k < n; ++k) {
+        double* xk = x + static_cast<long>(k) * m;
+        if (f.piv[k] != k)
+            std::swap_ranges(xk, xk + m, x + static_cast<long>(f.piv[k]) * m);
+        for (int i = k + 1; i <= std::min(n - 1, k + f.kl); ++i) {
+            const double l = f.at(i, k);
+            if (l == 0.0) continue;
+            double* xi = x + static_cast<long>(i) * m;
+            for (int j = 0; j < m; ++j) xi[j] -= l * xk[j];
+        }
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        double* xi = x + static_cast<long>(i) * m;
+        for (int p = i + 1; p <= std::min(n - 1, i + f.kl + f.ku); ++p) {
+            const double u = f.at(i, p);
+            if (u == 0.0) continue;
+            const double* xp = x + static_cast<long>(p) * m;
+            for (int j = 0; j < m; ++j) xi[j] -= u * xp[j];
+        }
+        const double d = f.at(i, i);
+        for (int j = 0; j < m; ++j) xi[j] /= d;
+    }
+}
+
+} // namespace
+
+/** @brief Determinant through banded LU – O(n) for a fixed bandwidth. */
+double BandMat::determinant() const
+{
+    if (kl == 0 || ku == 0) {                     // משולשית – מכפלת האלכסון
+        double det = 1.0;
+        for (int i = 0; i < n; ++i) det *= data[static_cast<long>(i) * width() + kl];
+        return det;
+    }
+    BandLU f = factorBand(*this);
+    if (f.singular) return 0.0;
+    double det = f.sign;
+    for (int i = 0; i < n; ++i) det *= f.at(i, i);
+    return det;
+}
+
+/** @brief Same as determinant(). */
+double BandMat::operator!() const { return determinant(); }
+
+/** @brief Solve A·x = b with banded LU, overwriting @p b.
+ *  @throw std::domain_error if the matrix is singular                 */
+void BandMat::solveInPlace(double* b) const
+{
+    BandLU f = factorBand(*this);
+    if (f.singular) throw std::domain_error("matrix is singular");
+    bandSubstitute(f, b, 1);
+}
+
+/** @brief Solve A·X = B for every column of @p B (one factorization). */
+SquareMat BandMat::solve(const SquareMat& B) const
+{
+    if (n != B.getN()) throw std::invalid_argument("dimension mismatch");
+    BandLU f = factorBand(*this);
+    if (f.singular) throw std::domain_error("matrix is singular");
+    SquareMat X(B);
+    bandSubstitute(f, X.raw(), n);
+    return X;
+}
+
+namespace matrix {
+
+/** @brief Pretty-print the full matrix row-by-row (zeros included). */
+std::ostream& operator<<(std::ostream& os, const BandMat& m)
+{
+    for (int i = 0; i < m.getN(); ++i) {
+        os << "[ ";
+        for (int j = 0; j < m.getN(); ++j) {
+            os << m(i, j);
+            if (j + 1 < m.getN()) os << ' ';
+        }
+        os << " ]\n";
+    }
+    return os;
+}
+
+} // namespace matrix
@@ -0,0 +1,67 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef BANDMAT_HPP
+#define BANDMAT_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+
+namespace matrix {
+
+/**
+ * Banded n×n matrix with kl sub-diagonals and ku super-diagonals.
+ * Row i keeps columns i-kl … i+ku contiguously (kl+ku+1 doubles per row),
+ * so storage and every product are O(n · bandwidth).  The const accessor
+ * reads 0 outside the band; the mutable one throws std::out_of_range there.
+ */
+class BandMat {
+private:
+    double* data;   // n שורות × (kl+ku+1) איברים
+    int n;
+    int kl;         // מספר תת-אלכסונים
+    int ku;         // מספר על-אלכסונים
+
+    int width() const;
+    bool inBand(int i, int j) const;
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    BandMat(int n, int kl, int ku, double initVal = 0.0);
+    BandMat(const SquareMat& A, int kl, int ku);       // שומר רק את הרצועה
+    BandMat(const BandMat& other);
+    BandMat& operator=(const BandMat& other);
+    ~BandMat();
+
+    // ---------- גישה לאיברים ----------
+    double& operator()(int i, int j);
+    double operator()(int i, int j) const;
+
+    int getN() const;
+    int lower() const;
+    int upper() const;
+
+    SquareMat toSquareMat() const;
+
+    // ---------- פעולות אריתמטיות ----------
+    BandMat operator+(const BandMat& rhs) const;
+    BandMat operator*(double s) const;
+
+    void multiply(const double* x, double* y) const;   // y = A·x
+    SquareMat operator*(const SquareMat& rhs) const;
+    BandMat operator*(const BandMat& rhs) const;
+    BandMat operator^(int e) const;
+
+    // ---------- טרנספוז / דטרמיננטה / פתרון ----------
+    BandMat operator~() const;
+    double operator!() const;
+    double determinant() const;
+
+    void solveInPlace(double* b) const;
+    SquareMat solve(const SquareMat& B) const;
+};
+
+std::ostream& operator<<(std::ostream& out, const BandMat& m);
+
+} // namespace matrix
+
+#endif // BANDMAT_HPP
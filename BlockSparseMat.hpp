@@ -0,0 +1,321 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef BLOCKSPARSEMAT_HPP
+#define BLOCKSPARSEMAT_HPP
+
+#include "Kernels.hpp"
+#include "SquareMat.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::copy, std::fill, std::sort, std::lower_bound, std::min
+#include <cmath>       // std::fabs
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::invalid_argument, std::out_of_range
+
+namespace matrix {
+
+/**
+ * Block-sparse row (BSR) matrix with dense B×B blocks.
+ *
+ * Block row I owns blocks rowPtr[I] … rowPtr[I+1]-1, whose block columns
+ * are colIdx[...] (sorted).  Each block is stored in the MR-strip layout
+ * that kernels::packA produces, so products feed the blocks straight
+ * into kernels::microKernel – the same register kernel behind
+ * SquareMat::operator*.  n need not be a multiple of B; the last block
+ * row/column is zero-padded.
+ */
+template <int B>
+class BlockSparseMat {
+    static_assert(B > 0 && B % kernels::MR == 0 && B % kernels::NR == 0,
+                  "block size must be a multiple of the micro-kernel tile");
+
+private:
+    long* rowPtr;     // nb+1 היסטים של שורות-בלוק
+    int* colIdx;      // עמודת-בלוק של כל בלוק
+    double* blocks;   // B×B לכל בלוק, בפריסת packA
+    int n;
+    int nb;           // מספר שורות-בלוק = ceil(n/B)
+
+    static constexpr long BB = static_cast<long>(B) * B;
+
+    /** @brief Offset of (r,c) inside one block (MR-strip layout). */
+    static long slot(int r, int c)
+    {
+        return static_cast<long>(r / kernels::MR) * B * kernels::MR
+             + static_cast<long>(c) * kernels::MR + r % kernels::MR;
+    }
+
+    /** @brief Allocate for @p nnzb blocks (outer[0]=0, outer[nb]=nnzb). */
+    BlockSparseMat(int n_, long nnzb, bool)
+        : rowPtr(nullptr), colIdx(nullptr), blocks(nullptr), n(n_), nb(0)
+    {
+        if (n <= 0) throw std::invalid_argument("n must be positive");
+        nb = (n + B - 1) / B;
+        std::unique_ptr<long[]> rows(new long[nb + 1]);
+        std::unique_ptr<int[]> cols(new int[nnzb]);
+        std::unique_ptr<double[]> vals(new double[nnzb * BB]);
+        std::fill(rows.get(), rows.get() + nb + 1, 0L);
+        rows[nb] = nnzb;
+        rowPtr = rows.release();
+        colIdx = cols.release();
+        blocks = vals.release();
+    }
+
+public:
+    static constexpr int blockSize = B;
+
+    // ---------- בנאים ו־Rule of 3 ----------
+
+    /** @brief The n×n zero matrix. */
+    explicit BlockSparseMat(int n_) : BlockSparseMat(n_, 0L, true) {}
+
+    /** @brief Keep every B×B block of @p A that has an entry with
+     *  |aᵢⱼ| > @p dropTol; all other blocks are dropped.               */
+    explicit BlockSparseMat(const SquareMat& A, double dropTol = 0.0)
+        : BlockSparseMat(A.getN(), 0L, true)
+    {
+        const double* a = A.raw();
+        auto nonEmpty = [&](int I, int J) {
+            for (int i = I * B; i < std::min(n, (I + 1) * B); ++i)
+                for (int j = J * B; j < std::min(n, (J + 1) * B); ++j)
+                    if (std::fabs(a[static_cast<long>(i) * n + j]) > dropTol) return true;
+            return false;
+        };
+
+        for (int I = 0; I < nb; ++I) {
+            long c = 0;
+            for (int J = 0; J < nb; ++J) c += nonEmpty(I, J);
+            rowPtr[I + 1] = rowPtr[I] + c;
+        }
+        std::unique_ptr<int[]> cols(new int[rowPtr[nb]]);          // הקצאה לפני שחרור – חריגה משאירה מצב תקין
+        std::unique_ptr<double[]> vals(new double[rowPtr[nb] * BB]);
+        delete[] colIdx;
+        delete[] blocks;
+        colIdx = cols.release();
+        blocks = vals.release();
+
+        ThreadPool::instance().parallelFor(0, nb, [&](int I) {
+            long q = rowPtr[I];
+            for (int J = 0; J < nb; ++J) {
+                if (!nonEmpty(I, J)) continue;
+                colIdx[q] = J;
+                double* blk = blocks + q * BB;
+                for (int r = 0; r < B; ++r)
+                    for (int c = 0; c < B; ++c) {
+                        const int i = I * B + r, j = J * B + c;
+                        blk[slot(r, c)] = (i < n && j < n) ? a[static_cast<long>(i) * n + j] : 0.0;
+                    }
+                ++q;
+            }
+        });
+    }
+
+    /** @brief Deep-copy constructor. */
+    BlockSparseMat(const BlockSparseMat& other)
+        : BlockSparseMat(other.n, other.nonZeroBlocks(), true)
+    {
+        std::copy(other.rowPtr, other.rowPtr + nb + 1, rowPtr);
+        std::copy(other.colIdx, other.colIdx + other.nonZeroBlocks(), colIdx);
+        std::copy(other.blocks, other.blocks + other.nonZeroBlocks() * BB, blocks);
+    }
+
+    /** @brief Copy-assignment operator. */
+    BlockSparseMat& operator=(const BlockSparseMat& other)
+    {
+        if (this == &other) return *this;
+        BlockSparseMat tmp(other);
+        std::swap(rowPtr, tmp.rowPtr);
+        std::swap(colIdx, tmp.colIdx);
+        std::swap(blocks, tmp.blocks);
+        n = other.n;
+        nb = other.nb;
+        return *this;
+    }
+
+    /** @brief Destructor – frees the index and block arrays. */
+    ~BlockSparseMat()
+    {
+        delete[] rowPtr;
+        delete[] colIdx;
+        delete[] blocks;
+    }
+
+    // ---------- גישה ----------
+
+    int getN() const { return n; }
+    int blockRows() const { return nb; }
+    long nonZeroBlocks() const { return rowPtr[nb]; }
+
+    /** @brief Value of element (i,j) – 0 outside the stored blocks.
+     *  @throw std::out_of_range if indices are outside [0,n-1]       */
+    double operator()(int i, int j) const
+    {
+        if (i < 0 || i >= n || j < 0 || j >= n)
+            throw std::out_of_range("index out of range");
+        const int I = i / B, J = j / B;
+        const int* b = colIdx + rowPtr[I];
+        const int* e = colIdx + rowPtr[I + 1];
+        const int* p = std::lower_bound(b, e, J);
+        if (p == e || *p != J) return 0.0;
+        return blocks[(p - colIdx) * BB + slot(i % B, j % B)];
+    }
+
+    /** @brief Expand to a dense SquareMat. */
+    SquareMat toSquareMat() const
+    {
+        SquareMat res(n, 0.0);
+        double* d = res.raw();
+        for (int I = 0; I < nb; ++I)
+            for (long q = rowPtr[I]; q < rowPtr[I + 1]; ++q)
+                for (int r = 0; r < B && I * B + r < n; ++r)
+                    for (int c = 0; c < B && colIdx[q] * B + c < n; ++c)
+                        d[static_cast<long>(I * B + r) * n + colIdx[q] * B + c] =
+                            blocks[q * BB + slot(r, c)];
+        return res;
+    }
+
+    // ---------- מכפלות ----------
+
+    /** @brief y = A·x, one B×B block-vector product per stored block. */
+    void multiply(const double* x, double* y) const
+    {
+        ThreadPool::instance().parallelFor(0, nb, [&](int I) {
+            double acc[B] = {};
+            for (long q = rowPtr[I]; q < rowPtr[I + 1]; ++q) {
+                const double* blk = blocks + q * BB;
+                const int j0 = colIdx[q] * B;
+                for (int c = 0; c < B && j0 + c < n; ++c) {
+                    const double xc = x[j0 + c];
+                    for (int r = 0; r < B; ++r) acc[r] += blk[slot(r, c)] * xc;
+                }
+            }
+            for (int r = 0; r < B && I * B + r < n; ++r) y[I * B + r] = acc[r];
+        });
+    }
+
+    /** @brief BSR × dense.  Every B-row slice of @p rhs is packed once
+     *  into NR strips; each stored block then drives the micro-kernel
+     *  directly across the full width of the result.                 */
+    SquareMat operator*(const SquareMat& rhs) const
+    {
+        if (n != rhs.getN()) throw std::invalid_argument("dimension mismatch");
+        using kernels::MR;
+        using kernels::NR;
+        const long nPad = (n + NR - 1) / NR * NR;
+        std::unique_ptr<double[]> xPack(new double[nb * B * nPad]);
+        const double* x = rhs.raw();
+
+        ThreadPool& pool = ThreadPool::instance();
+        pool.parallelFor(0, nb, [&](int K) {
+            const int kc = std::min(B, n - K * B);
+            kernels::packB(kc, n, x + static_cast<long>(K) * B * n, n, false,
+                           xPack.get() + K * B * nPad);
+        });
+
+        SquareMat res(n, 0.0);
+        double* c = res.raw();
+        pool.parallelFor(0, nb, [&](int I) {
+            for (long q = rowPtr[I]; q < rowPtr[I + 1]; ++q) {
+                const int K = colIdx[q];
+                const int kc = std::min(B, n - K * B);
+                const double* panel = xPack.get() + K * B * nPad;
+                for (int jr = 0; jr < n; jr += NR)
+                    for (int s = 0; s < B / MR; ++s) {
+                        const int row = I * B + s * MR;
+                        if (row >= n) break;
+                        kernels::microKernel(kc, blocks + q * BB + static_cast<long>(s) * B * MR,
+                                             panel + static_cast<long>(jr) * kc,
+                                             c + static_cast<long>(row) * n + jr, n,
+                                             std::min(MR, n - row), std::min(NR, n - jr), 1.0);
+                    }
+            }
+        });
+        return res;
+    }
+
+    /** @brief BSR × BSR: Gustavson over block indices.  The rhs blocks
+     *  are packed into NR strips once; each task accumulates a block row
+     *  of the result in a private dense B×B-per-block-column workspace. */
+    BlockSparseMat operator*(const BlockSparseMat& rhs) const
+    {
+        if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+        using kernels::MR;
+        using kernels::NR;
+        ThreadPool& pool = ThreadPool::instance();
+
+        // --- rhs blocks → NR-strip layout ---
+        const long rq = rhs.nonZeroBlocks();
+        std::unique_ptr<double[]> rPack(new double[rq * BB]);
+        pool.parallelFor(0, rhs.nb, [&](int K) {
+            double rowMajor[BB];
+            for (long q = rhs.rowPtr[K]; q < rhs.rowPtr[K + 1]; ++q) {
+                for (int r = 0; r < B; ++r)
+                    for (int c = 0; c < B; ++c)
+                        rowMajor[r * B + c] = rhs.blocks[q * BB + slot(r, c)];
+                kernels::packB(B, B, rowMajor, B, false, rPack.get() + q * BB);
+            }
+        });
+
+        // --- symbolic: blocks per block row ---
+        const int tasks = std::min(nb, 4 * pool.size());
+        std::unique_ptr<long[]> counts(new long[nb + 1]);
+        pool.parallelFor(0, tasks, [&](int t) {
+            std::unique_ptr<int[]> marker(new int[nb]);
+            std::fill(marker.get(), marker.get() + nb, -1);
+            for (int I = nb * t / tasks; I < nb * (t + 1) / tasks; ++I) {
+                long cnt = 0;
+                for (long p = rowPtr[I]; p < rowPtr[I + 1]; ++p) {
+                    const int K = colIdx[p];
+                    for (long q = rhs.rowPtr[K]; q < rhs.rowPtr[K + 1]; ++q)
+                        if (marker[rhs.colIdx[q]] != I) { marker[rhs.colIdx[q]] = I; ++cnt; }
+                }
+                counts[I + 1] = cnt;
+            }
+        });
+        counts[0] = 0;
+        for (int I = 0; I < nb; ++I) counts[I + 1] += counts[I];
+
+        // --- numeric ---
+        BlockSparseMat res(n, counts[nb], true);
+        std::copy(counts.get(), counts.get() + nb + 1, res.rowPtr);
+        pool.parallelFor(0, tasks, [&](int t) {
+            std::unique_ptr<int[]> marker(new int[nb]);
+            std::unique_ptr<double[]> acc(new double[nb * BB]);
+            std::fill(marker.get(), marker.get() + nb, -1);
+            for (int I = nb * t / tasks; I < nb * (t + 1) / tasks; ++I) {
+                int* cols = res.colIdx + res.rowPtr[I];
+                int len = 0;
+                for (long p = rowPtr[I]; p < rowPtr[I + 1]; ++p) {
+                    const int K = colIdx[p];
+                    const double* a = blocks + p * BB;
+                    for (long q = rhs.rowPtr[K]; q < rhs.rowPtr[K + 1]; ++q) {
+                        const int J = rhs.colIdx[q];
+                        double* cj = acc.get() + J * BB;
+                        if (marker[J] != I) {
+                            marker[J] = I;
+                            cols[len++] = J;
+                            std::fill(cj, cj + BB, 0.0);
+                        }
+                        for (int s = 0; s < B / MR; ++s)
+                            for (int jr = 0; jr < B; jr += NR)
+                                kernels::microKernel(B, a + static_cast<long>(s) * B * MR,
+                                                     rPack.get() + q * BB + static_cast<long>(jr) * B,
+                                                     cj + static_cast<long>(s) * MR * B + jr, B,
+                                                     MR, NR, 1.0);
+                    }
+                }
+                std::sort(cols, cols + len);
+                for (int k = 0; k < len; ++k) {
+                    const double* cj = acc.get() + cols[k] * BB;
+                    double* dst = res.blocks + (res.rowPtr[I] + k) * BB;
+                    for (int r = 0; r < B; ++r)
+                        for (int c = 0; c < B; ++c) dst[slot(r, c)] = cj[r * B + c];
+                }
+            }
+        });
+        return res;
+    }
+};
+
+} // namespace matrix
+
+#endif // BLOCKSPARSEMAT_HPP
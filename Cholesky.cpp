@@ -0,0 +1,219 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Cholesky.hpp"
+#include "Kernels.hpp"
+#include "LU.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>   // std::min, std::fill
+#include <cmath>       // std::sqrt, std::log, std::fabs
+#include <stdexcept>   // std::domain_error, std::invalid_argument
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Block size of the factorization (diagonal block / panel width). */
+constexpr int NB = 64;
+
+/** @brief O(n²) screening before the O(n³) factorization:
+ *  a positive diagonal and (numerical) symmetry are necessary for SPD. */
+bool looksSPD(const SquareMat& A)
+{
+    const int n = A.getN();
+    const double* a = A.raw();
+    for (int i = 0; i < n; ++i) {
+        if (!(a[i * n + i] > 0.0)) return false;
+        for (int j = 0; j < i; ++j) {
+            const double x = a[i * n + j], y = a[j * n + i];
+            if (std::fabs(x - y) > 1e-12 * (std::fabs(x) + std::fabs(y)) + 1e-300)
+                return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Unblocked Cholesky of the kb×kb diagonal block at (k0,k0).
+ *  Columns left of k0 were already folded in by the trailing updates.
+ *  @return false on a non-positive pivot                              */
+bool factorDiagonal(double* a, int n, int k0, int kb)
+{
+    for (int j = k0; j < k0 + kb; ++j) {
+        double* lj = a + j * n;
+        double d = lj[j];
+        for (int p = k0; p < j; ++p) d -= lj[p] * lj[p];
+        if (!(d > 0.0)) return false;
+        lj[j] = std::sqrt(d);
+        for (int i = j + 1; i < k0 + kb; ++i) {
+            double* li = a + i * n;
+            double s = li[j];
+            for (int p = k0; p < j; ++p) s -= li[p] * lj[p];
+            li[j] = s / lj[j];
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+/* ====================================================================
+   Factorization
+   ================================================================= */
+
+/** @brief Factor @p A = L·Lᵀ (right-looking, blocked, multithreaded).
+ *
+ *  Per NB-wide block column: the diagonal block is factored serially,
+ *  the panel below it is solved against L11ᵀ row-block by row-block in
+ *  parallel, and the lower triangle of the trailing matrix receives
+ *  A22 -= L21·L21ᵀ through kernels::gemm, one block row per task.
+ *  Only the lower triangle of @p A is read; the cheap symmetry check
+ *  rejects inputs whose upper triangle disagrees.                       */
+Cholesky::Cholesky(const SquareMat& A) : L(A), spd(false)
+{
+    if (!looksSPD(A)) return;
+
+    const int n = L.getN();
+    double* a = L.raw();
+    ThreadPool& pool = ThreadPool::instance();
+
+    for (int k0 = 0; k0 < n; k0 += NB) {
+        const int kb = std::min(NB, n - k0);
+        const int kEnd = k0 + kb;
+        trace::Span panel("cholesky panel", "panel", "col", k0);
+        if (!factorDiagonal(a, n, k0, kb)) return;
+        if (kEnd == n) break;
+
+        // --- L21 = A21 · L11⁻ᵀ ---
+        const int rowBlocks = (n - kEnd + NB - 1) / NB;
+        pool.parallelFor(0, rowBlocks, [&](int rb) {
+            const int r0 = kEnd + rb * NB;
+            const int r1 = std::min(n, r0 + NB);
+            for (int i = r0; i < r1; ++i) {
+                double* li = a + i * n;
+                for (int j = k0; j < kEnd; ++j) {
+                    const double* lj = a + j * n;
+                    double s = li[j];
+                    for (int p = k0; p < j; ++p) s -= li[p] * lj[p];
+                    li[j] = s / lj[j];
+                }
+            }
+        });
+        panel.end();
+
+        // --- tril(A22) -= L21 · L21ᵀ, biggest block rows first ---
+        pool.parallelFor(0, rowBlocks, [&](int t) {
+            const int rb = rowBlocks - 1 - t;
+            const int r0 = kEnd + rb * NB;
+            const int rows = std::min(NB, n - r0);
+            kernels::gemm(rows, r0 + rows - kEnd, kb, -1.0,
+                          a + r0 * n + k0, n, false,
+                          a + kEnd * n + k0, n, true,
+                          1.0, a + r0 * n + kEnd, n);
+        });
+    }
+
+    for (int i = 0; i < n; ++i)
+        std::fill(a + i * n + i + 1, a + (i + 1) * n, 0.0);
+    spd = true;
+}
+
+/* ====================================================================
+   Queries
+   ================================================================= */
+
+/** @brief True if the factorization succeeded (A is SPD). */
+bool Cholesky::isSPD() const { return spd; }
+
+/** @brief The lower-triangular factor L.
+ *  @throw std::domain_error if A is not SPD                           */
+const SquareMat& Cholesky::factor() const
+{
+    if (!spd) throw std::domain_error("matrix is not positive definite");
+    return L;
+}
+
+/** @brief det(A) = Π lᵢᵢ²  – O(n) after factorization. */
+double Cholesky::determinant() const
+{
+    const SquareMat& f = factor();
+    const int n = f.getN();
+    double det = 1.0;
+    for (int i = 0; i < n; ++i) det *= f.raw()[i * n + i] * f.raw()[i * n + i];
+    return det;
+}
+
+/** @brief log det(A) = 2·Σ log lᵢᵢ – does not overflow for large n. */
+double Cholesky::logDeterminant() const
+{
+    const SquareMat& f = factor();
+    const int n = f.getN();
+    double s = 0.0;
+    for (int i = 0; i < n; ++i) s += std::log(f.raw()[i * n + i]);
+    return 2.0 * s;
+}
+
+/* ====================================================================
+   Solves
+   ================================================================= */
+
+/** @brief Solve A·x = b (L·y = b, then Lᵀ·x = y), overwriting @p b. */
+void Cholesky::solveInPlace(double* b) const
+{
+    const SquareMat& f = factor();
+    const int n = f.getN();
+    kernels::trsm(true, false, false, n, 1, f.raw(), n, b, 1);
+    kernels::trsm(true, true, false, n, 1, f.raw(), n, b, 1);
+}
+
+/** @brief Solve A·X = B for all columns of @p B.
+ *  @throw std::invalid_argument on dimension mismatch                 */
+SquareMat Cholesky::solve(const SquareMat& B) const
+{
+    const SquareMat& f = factor();
+    const int n = f.getN();
+    if (B.getN() != n) throw std::invalid_argument("dimension mismatch");
+    SquareMat X(B);
+    kernels::trsm(true, false, false, n, n, f.raw(), n, X.raw(), n);
+    kernels::trsm(true, true, false, n, n, f.raw(), n, X.raw(), n);
+    return X;
+}
+
+/** @brief A⁻¹ = L⁻ᵀ·L⁻¹. */
+SquareMat Cholesky::inverse() const
+{
+    const int n = factor().getN();
+    SquareMat I(n, 0.0);
+    for (int i = 0; i < n; ++i) I[i][i] = 1.0;
+    return solve(I);
+}
+
+/* ====================================================================
+   SPD helpers with LU fallback
+   ================================================================= */
+
+namespace matrix {
+
+/** @brief Determinant via Cholesky; LU if @p A is not SPD. */
+double spdDeterminant(const SquareMat& A)
+{
+    Cholesky c(A);
+    if (c.isSPD()) return c.determinant();
+    return LU(A).determinant();
+}
+
+/** @brief Solve A·X = B via Cholesky; LU if @p A is not SPD. */
+SquareMat spdSolve(const SquareMat& A, const SquareMat& B)
+{
+    Cholesky c(A);
+    if (c.isSPD()) return c.solve(B);
+    return LU(A).solve(B);
+}
+
+/** @brief A⁻¹ via Cholesky; LU if @p A is not SPD. */
+SquareMat spdInverse(const SquareMat& A)
+{
+    Cholesky c(A);
+    if (c.isSPD()) return c.inverse();
+    return LU(A).inverse();
+}
+
+} // namespace matrix
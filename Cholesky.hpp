@@ -0,0 +1,42 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef CHOLESKY_HPP
+#define CHOLESKY_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * Cholesky factorization A = L·Lᵀ of a symmetric positive-definite matrix.
+ * Constructing from a matrix that is not SPD does not throw; check
+ * isSPD() or use the spd* helpers, which fall back to LU.
+ */
+class Cholesky {
+private:
+    SquareMat L;     // גורם משולש תחתון (מעל האלכסון אפסים)
+    bool spd;
+
+public:
+    // ---------- בנאי ----------
+    explicit Cholesky(const SquareMat& A);
+
+    // ---------- תוצאות ----------
+    bool isSPD() const;
+    const SquareMat& factor() const;
+    double determinant() const;
+    double logDeterminant() const;
+
+    void solveInPlace(double* b) const;
+    SquareMat solve(const SquareMat& B) const;
+    SquareMat inverse() const;
+};
+
+// ---------- Cholesky עם נפילה ל-LU ----------
+double spdDeterminant(const SquareMat& A);
+SquareMat spdSolve(const SquareMat& A, const SquareMat& B);
+SquareMat spdInverse(const SquareMat& A);
+
+} // namespace matrix
+
+#endif // CHOLESKY_HPP
@@ -0,0 +1,156 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Expm.hpp"
+#include "Kernels.hpp"
+#include "LU.hpp"
+#include <algorithm>   // std::max, std::swap
+#include <cmath>       // std::fabs, std::ceil, std::log2, std::ldexp
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Largest ‖A‖₁ for which the [m/m] Padé approximant reaches
+ *  double precision without scaling (Higham 2005, Table 2.3).          */
+constexpr double THETA3  = 1.495585217958292e-2;
+constexpr double THETA5  = 2.539398330063230e-1;
+constexpr double THETA7  = 9.504178996162932e-1;
+constexpr double THETA9  = 2.097847961257068e0;
+constexpr double THETA13 = 5.371920351148152e0;
+
+constexpr double B3[]  = {120, 60, 12, 1};
+constexpr double B5[]  = {30240, 15120, 3360, 420, 30, 1};
+constexpr double B7[]  = {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+constexpr double B9[]  = {17643225600., 8821612800., 2075673600., 302702400., 30270240.,
+                          2162160., 110880., 3960., 90., 1.};
+constexpr double B13[] = {64764752532480000., 32382376266240000., 7771770303897600.,
+                          1187353796428800., 129060195264000., 10559470521600.,
+                          670442572800., 33522128640., 1323241920., 40840800.,
+                          960960., 16380., 182., 1.};
+
+/** @brief Maximum absolute column sum. */
+double norm1(const double* a, int n)
+{
+    double best = 0.0;
+    for (int j = 0; j < n; ++j) {
+        double s = 0.0;
+        for (int i = 0; i < n; ++i) s += std::fabs(a[static_cast<long>(i) * n + j]);
+        best = std::max(best, s);
+    }
+    return best;
+}
+
+/** @brief dst = Σ c[k]·src[k] (+ c0·I) over @p count matrices. */
+void combine(double* dst, int n, double c0, int count, const double* const* src, const double* c)
+{
+    const long nn = static_cast<long>(n) * n;
+    for (long e = 0; e < nn; ++e) {
+        double v = 0.0;
+        for (int k = 0; k < count; ++k) v += c[k] * src[k][e];
+        dst[e] = v;
+    }
+    for (int i = 0; i < n; ++i) dst[static_cast<long>(i) * n + i] += c0;
+}
+
+/** @brief C = A·B into a preallocated buffer. */
+void mul(const double* A, const double* B, double* C, int n)
+{
+    kernels::gemm(n, n, n, 1.0, A, n, false, B, n, false, 0.0, C, n);
+}
+
+} // namespace
+
+namespace matrix {
+
+/** @brief Matrix exponential by scaling and squaring with a diagonal
+ *  Padé approximant (Higham, SIAM J. Matrix Anal. Appl. 26, 2005).
+ *
+ *  The lowest degree m ∈ {3,5,7,9,13} whose error bound holds for ‖A‖₁
+ *  is used; beyond θ₁₃ the matrix is scaled by 2⁻ˢ and the [13/13]
+ *  result is squared s times.  All products go through kernels::gemm
+ *  into a fixed set of n×n work buffers allocated up front, and
+ *  (V−U)·X = V+U is solved with one blocked LU – the number of
+ *  allocations does not depend on the degree or on s.                  */
+SquareMat expm(const SquareMat& A)
+{
+    const int n = A.getN();
+    const double nrm = norm1(A.raw(), n);
+
+    int s = 0;
+    const double* b = B13;
+    int m = 13;
+    if      (nrm <= THETA3) { b = B3; m = 3; }
+    else if (nrm <= THETA5) { b = B5; m = 5; }
+    else if (nrm <= THETA7) { b = B7; m = 7; }
+    else if (nrm <= THETA9) { b = B9; m = 9; }
+    else s = std::max(0, static_cast<int>(std::ceil(std::log2(nrm / THETA13))));
+
+    // ---- work buffers ----
+    SquareMat As(A);
+    SquareMat A2(n), A4(n), A6(n), U(n), V(n), T(n);
+    if (s > 0) As *= std::ldexp(1.0, -s);
+
+    const double* a = As.raw();
+    mul(a, a, A2.raw(), n);
+    const double* a2 = A2.raw();
+    const double* a4 = A4.raw();
+    const double* a6 = A6.raw();
+
+    if (m == 13) {
+        mul(a2, a2, A4.raw(), n);
+        mul(a4, a2, A6.raw(), n);
+
+        const double* p3[] = {a6, a4, a2};
+        const double cu[] = {b[13], b[11], b[9]};
+        combine(T.raw(), n, 0.0, 3, p3, cu);
+        mul(a6, T.raw(), U.raw(), n);                          // A6·(b13A6+b11A4+b9A2)
+        const double* p4[] = {U.raw(), a6, a4, a2};
+        const double cu2[] = {1.0, b[7], b[5], b[3]};
+        combine(T.raw(), n, b[1], 4, p4, cu2);
+        mul(a, T.raw(), U.raw(), n);                           // U = A·[…]
+
+        const double cv[] = {b[12], b[10], b[8]};
+        combine(T.raw(), n, 0.0, 3, p3, cv);
+        mul(a6, T.raw(), V.raw(), n);
+        const double* p4v[] = {V.raw(), a6, a4, a2};
+        const double cv2[] = {1.0, b[6], b[4], b[2]};
+        combine(V.raw(), n, b[0], 4, p4v, cv2);                // עדכון במקום – איבר-איבר
+    } else {
+        const double* pw[4] = {a2, a4, a6, T.raw()};
+        if (m >= 5) mul(a2, a2, A4.raw(), n);
+        if (m >= 7) mul(a4, a2, A6.raw(), n);
+        if (m >= 9) mul(a6, a2, T.raw(), n);                   // A8
+        const int terms = (m - 1) / 2;                          // A2 … A^(m-1)
+
+        double cu[4], cv[4];
+        for (int k = 0; k < terms; ++k) {
+            cu[k] = b[2 * k + 3];
+            cv[k] = b[2 * k + 2];
+        }
+        combine(V.raw(), n, b[1], terms, pw, cu);              // Σ b_odd A^(k-1)
+        mul(a, V.raw(), U.raw(), n);
+        combine(V.raw(), n, b[0], terms, pw, cv);
+    }
+
+    // ---- (V − U)·X = V + U ----
+    const long nn = static_cast<long>(n) * n;
+    double* u = U.raw();
+    double* v = V.raw();
+    for (long e = 0; e < nn; ++e) {
+        const double p = v[e] + u[e];
+        const double q = v[e] - u[e];
+        u[e] = p;
+        v[e] = q;
+    }
+    SquareMat X = LU(V).solve(U);
+
+    // ---- squaring phase, ping-pong between X and T ----
+    SquareMat* cur = &X;
+    SquareMat* nxt = &T;
+    for (int k = 0; k < s; ++k) {
+        mul(cur->raw(), cur->raw(), nxt->raw(), n);
+        std::swap(cur, nxt);
+    }
+    return *cur;
+}
+
+} // namespace matrix
@@ -0,0 +1,15 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef EXPM_HPP
+#define EXPM_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+// ---------- אקספוננט מטריצה: e^A ----------
+SquareMat expm(const SquareMat& A);
+
+} // namespace matrix
+
+#endif // EXPM_HPP
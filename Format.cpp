@@ -0,0 +1,106 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Format.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::max, std::min
+#include <cstring>     // std::memcpy, std::memmove
+#include <memory>      // std::unique_ptr
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Output produced per buffer flush; anything smaller than this
+ *  goes out in a single write.                                         */
+constexpr long BATCH_BYTES = 8L << 20;
+
+/** @brief Rows below this count are formatted on the calling thread. */
+constexpr int PARALLEL_ROWS = 16;
+
+/** @brief Upper bound on the characters to_chars can emit for one value. */
+long elementBound(const FormatOptions& opt)
+{
+    if (opt.precision < 0) return 32;                    // "-1.2345678901234567e-308"
+    if (opt.style == std::chars_format::fixed) return 330L + opt.precision;
+    return 16L + opt.precision;
+}
+
+char* put(char* p, const std::string& s)
+{
+    std::memcpy(p, s.data(), s.size());
+    return p + s.size();
+}
+
+/** @brief Format one row at @p p; returns one past the last character. */
+char* formatRow(char* p, const double* row, int n, long elemMax, const FormatOptions& opt)
+{
+    p = put(p, opt.open);
+    for (int j = 0; j < n; ++j) {
+        if (j > 0) p = put(p, opt.separator);
+        const std::to_chars_result r = (opt.precision < 0)
+            ? std::to_chars(p, p + elemMax, row[j])
+            : std::to_chars(p, p + elemMax, row[j], opt.style, opt.precision);
+        p = r.ptr;
+    }
+    return put(p, opt.close);
+}
+
+/**
+ * Format @p m batch by batch and hand each finished batch to @p sink.
+ * A batch is as many rows as fit in BATCH_BYTES at their worst-case
+ * width.  In parallel mode each row is formatted by a pool task into
+ * its own fixed slot, then the slots are compacted in row order, so the
+ * output is byte-for-byte the serial one.
+ */
+template <class Sink>
+void formatBatches(const SquareMat& m, const FormatOptions& opt, Sink sink)
+{
+    const int n = m.getN();
+    const double* a = m.raw();
+    const long elemMax = elementBound(opt);
+    const long rowMax = static_cast<long>(opt.open.size() + opt.close.size()) +
+                        n * (elemMax + static_cast<long>(opt.separator.size()));
+    const int rowsPerBatch = static_cast<int>(std::max(1L, std::min<long>(n, BATCH_BYTES / rowMax)));
+    std::unique_ptr<char[]> buf(new char[rowsPerBatch * rowMax]);
+    std::unique_ptr<long[]> len(new long[rowsPerBatch]);
+    const bool parallel = opt.parallel && ThreadPool::instance().size() > 1 && n >= PARALLEL_ROWS;
+
+    for (int r0 = 0; r0 < n; r0 += rowsPerBatch) {
+        const int rows = std::min(rowsPerBatch, n - r0);
+        char* end = buf.get();
+        if (!parallel) {
+            for (int r = 0; r < rows; ++r)
+                end = formatRow(end, a + static_cast<long>(r0 + r) * n, n, elemMax, opt);
+        } else {
+            ThreadPool::instance().parallelFor(0, rows, [&](int r) {
+                char* slot = buf.get() + r * rowMax;
+                len[r] = formatRow(slot, a + static_cast<long>(r0 + r) * n, n, elemMax, opt) - slot;
+            });
+            for (int r = 0; r < rows; ++r) {             // דחיסה לפי סדר השורות
+                std::memmove(end, buf.get() + r * rowMax, len[r]);
+                end += len[r];
+            }
+        }
+        sink(buf.get(), end - buf.get());
+    }
+}
+
+} // namespace
+
+namespace matrix {
+
+/** @brief The whole matrix as one string (see FormatOptions). */
+std::string formatMatrix(const SquareMat& m, const FormatOptions& opt)
+{
+    std::string out;
+    formatBatches(m, opt, [&](const char* p, long len) { out.append(p, len); });
+    return out;
+}
+
+/** @brief Stream @p m with one os.write per 8 MiB of text (so one write
+ *  for any ordinary matrix) instead of one insertion per element.      */
+void writeMatrix(std::ostream& os, const SquareMat& m, const FormatOptions& opt)
+{
+    formatBatches(m, opt, [&](const char* p, long len) { os.write(p, len); });
+}
+
+} // namespace matrix
@@ -0,0 +1,33 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef FORMAT_HPP
+#define FORMAT_HPP
+
+#include "SquareMat.hpp"
+#include <charconv>
+#include <iostream>
+#include <string>
+
+namespace matrix {
+
+/**
+ * Text layout of a dumped matrix.  The defaults reproduce operator<<:
+ * "[ a b c ]" per line, every value printed with the shortest
+ * representation that reads back to the same double.
+ */
+struct FormatOptions {
+    int precision = -1;                                   // <0: הייצוג הקצר ביותר שמשוחזר במדויק
+    std::chars_format style = std::chars_format::general; // בשימוש רק כש-precision ≥ 0
+    std::string open = "[ ";
+    std::string separator = " ";
+    std::string close = " ]\n";
+    bool parallel = true;                                 // עיצוב שורות במקביל
+};
+
+// ---------- עיצוב מהיר (std::to_chars לבאפר אחד) ----------
+std::string formatMatrix(const SquareMat& m, const FormatOptions& opt = FormatOptions());
+void writeMatrix(std::ostream& os, const SquareMat& m, const FormatOptions& opt = FormatOptions());
+
+} // namespace matrix
+
+#endif // FORMAT_HPP
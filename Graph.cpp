@@ -0,0 +1,342 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Graph.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>   // std::max
+#include <coroutine>
+#include <exception>   // std::exception_ptr, std::terminate
+#include <memory>      // std::shared_ptr, std::unique_ptr
+#include <mutex>
+#include <stdexcept>   // std::invalid_argument, std::logic_error
+
+using namespace matrix;
+using namespace matrix::graph;
+
+namespace {
+
+/** @brief Coroutine type of one node: starts suspended, stays suspended
+ *  at the end so the run can destroy every frame in one place.        */
+struct NodeTask {
+    struct promise_type {
+        NodeTask get_return_object()
+        {
+            return NodeTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }      // הגוף תופס הכל
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    explicit NodeTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    NodeTask(NodeTask&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    NodeTask(const NodeTask&) = delete;
+    NodeTask& operator=(const NodeTask&) = delete;
+    NodeTask& operator=(NodeTask&&) = delete;
+    ~NodeTask()
+    {
+        if (handle) handle.destroy();
+    }
+};
+
+/** @brief Per-node state of one run. */
+struct Slot {
+    std::shared_ptr<const SquareMat> value;
+    std::exception_ptr error;
+    bool done = false;
+    bool keep = false;                          // יעד – לא משוחרר
+    bool owned = false;                         // תוצאה שההרצה הקצתה ונספרה ב-liveBytes
+    int consumers = 0;                          // צרכנים שעוד לא סיימו
+    std::vector<std::coroutine_handle<>> waiters;
+};
+
+/** @brief Shared state of one run() call. */
+struct Run {
+    std::mutex mtx;
+    std::vector<Slot> slots;
+    std::vector<std::coroutine_handle<>> ready;
+    std::size_t liveBytes = 0;
+    Stats stats;
+
+    /** Awaiter for one input: suspends the node until the input is done. */
+    struct Input {
+        Run& run;
+        int id;
+
+        bool await_ready()
+        {
+            std::lock_guard<std::mutex> lock(run.mtx);
+            return run.slots[id].done;
+        }
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            std::lock_guard<std::mutex> lock(run.mtx);
+            if (run.slots[id].done) return false;              // הסתיים בינתיים
+            run.slots[id].waiters.push_back(h);
+            return true;
+        }
+        void await_resume() {}
+    };
+
+    /** Publish node @p id's result, queue its waiters and drop inputs
+     *  whose last consumer this was (freed outside the lock).  The new
+     *  result is counted before its inputs are released, since both
+     *  exist at that moment.                                           */
+    void finish(int id, const std::vector<int>& inputs, std::shared_ptr<const SquareMat> value,
+                std::exception_ptr error)
+    {
+        std::vector<std::shared_ptr<const SquareMat>> dropped;
+        std::lock_guard<std::mutex> lock(mtx);
+        Slot& s = slots[id];
+        if (value) {
+            liveBytes += 8ULL * value->getN() * value->getN();
+            stats.peakBytes = std::max(stats.peakBytes, liveBytes);
+            s.owned = true;
+        }
+        s.value = std::move(value);
+        s.error = error;
+        s.done = true;
+        ++stats.computed;
+        ready.insert(ready.end(), s.waiters.begin(), s.waiters.end());
+        s.waiters.clear();
+        for (int in : inputs) {
+            Slot& src = slots[in];
+            if (--src.consumers > 0 || src.keep || !src.owned) continue;   // קלטים מושאלים – לא נספרו
+            liveBytes -= 8ULL * src.value->getN() * src.value->getN();
+            dropped.push_back(std::move(src.value));
+            src.owned = false;
+        }
+    }
+};
+
+/** @brief Body of every computed node: wait for the inputs, then run
+ *  the node's function (an input's error is passed on unchanged).     */
+NodeTask evaluateNode(Run& run, int id, const char* name, std::vector<int> inputs, Graph::Fn fn)
+{
+    for (int in : inputs) co_await Run::Input{run, in};
+
+    std::shared_ptr<const SquareMat> value;
+    std::exception_ptr error;
+    std::vector<const SquareMat*> args;
+    for (int in : inputs) {
+        if (run.slots[in].error && !error) error = run.slots[in].error;
+        args.push_back(run.slots[in].value.get());
+    }
+    if (!error) {
+        try {
+            trace::Span span(name, "graph");
+            value.reset(new SquareMat(fn(args)));          // בלי עותק נוסף של התוצאה
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    run.finish(id, inputs, std::move(value), error);
+}
+
+/** @throw std::invalid_argument unless @p v is a node of @p g */
+void requireOwn(const Graph* g, Value v)
+{
+    if (!v.graph() || v.graph() != g) throw std::invalid_argument("value belongs to another graph");
+}
+
+} // namespace
+
+/* ====================================================================
+   Building
+   ================================================================= */
+
+int Graph::add(Node node)
+{
+    nodes.push_back(std::move(node));
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+/** @brief Leaf node for @p m (borrowed – it must outlive run()). */
+Value Graph::input(const SquareMat& m)
+{
+    return Value(this, add(Node{"input", {}, Fn(), &m}));
+}
+
+/** @brief Node computing @p fn on the results of @p args (in order).
+ *  @param name trace span name; must be a string literal
+ *  @throw std::invalid_argument if an argument belongs to another graph
+ *         or @p fn is empty                                            */
+Value Graph::apply(Fn fn, const std::vector<Value>& args, const char* name)
+{
+    if (!fn) throw std::invalid_argument("empty node function");
+    std::vector<int> inputs;
+    for (Value v : args) {
+        requireOwn(this, v);
+        inputs.push_back(v.index());
+    }
+    return Value(this, add(Node{name, std::move(inputs), std::move(fn), nullptr}));
+}
+
+/** @brief Number of nodes, inputs included. */
+int Graph::size() const { return static_cast<int>(nodes.size()); }
+
+/* ====================================================================
+   Running
+   ================================================================= */
+
+/** @brief Evaluate @p target and return its value. */
+SquareMat Graph::run(Value target)
+{
+    std::vector<SquareMat> out = evaluate({target});
+    return out.front();
+}
+
+/** @brief Evaluate several targets in one run (shared work is done once). */
+std::vector<SquareMat> Graph::run(const std::vector<Value>& targets) { return evaluate(targets); }
+
+const Stats& Graph::stats() const { return last; }
+
+/** @brief One run: mark what the targets need, start a coroutine per
+ *  needed node and resume ready ones batch by batch until all are done.
+ *  A lone ready node runs on the caller with the whole ThreadPool; a
+ *  wider batch runs concurrently, the pool's threads split into one
+ *  team per running node so each node's kernels still go parallel.
+ *  @throw the first error of a target's computation                    */
+std::vector<SquareMat> Graph::evaluate(const std::vector<Value>& targets)
+{
+    if (targets.empty()) throw std::invalid_argument("no targets");
+    Run run;
+    run.slots.resize(nodes.size());
+
+    // --- nodes the targets depend on, and their consumer counts ---
+    std::vector<char> needed(nodes.size(), 0);
+    std::vector<int> stack;
+    for (Value t : targets) {
+        requireOwn(this, t);
+        run.slots[t.index()].keep = true;
+        stack.push_back(t.index());
+    }
+    while (!stack.empty()) {
+        const int id = stack.back();
+        stack.pop_back();
+        if (needed[id]) continue;
+        needed[id] = 1;
+        for (int in : nodes[id].inputs) {
+            ++run.slots[in].consumers;
+            stack.push_back(in);
+        }
+    }
+
+    // --- inputs are ready at once; every other node is a coroutine ---
+    std::vector<NodeTask> tasks;
+    std::vector<int> taskIds;
+    for (std::size_t id = 0; id < nodes.size(); ++id) {
+        if (!needed[id]) continue;
+        const Node& node = nodes[id];
+        if (!node.fn) {
+            run.slots[id].value = std::shared_ptr<const SquareMat>(node.source, [](const SquareMat*) {});
+            run.slots[id].done = true;
+            continue;
+        }
+        tasks.push_back(evaluateNode(run, static_cast<int>(id), node.name, node.inputs, node.fn));
+        taskIds.push_back(static_cast<int>(id));
+    }
+    // a node whose inputs are all ready goes straight to the first batch;
+    // the rest are started here and suspend on their first pending input
+    for (std::size_t k = 0; k < tasks.size(); ++k) {
+        bool inputsReady = true;
+        for (int in : nodes[taskIds[k]].inputs) inputsReady = inputsReady && run.slots[in].done;
+        if (inputsReady) run.ready.push_back(tasks[k].handle);
+        else tasks[k].handle.resume();
+    }
+
+    ThreadPool& pool = ThreadPool::instance();
+    std::vector<std::unique_ptr<ThreadPool>> teams;
+    int teamSize = 0;
+    while (!run.ready.empty()) {
+        std::vector<std::coroutine_handle<>> batch;
+        batch.swap(run.ready);
+        const int width = std::min(static_cast<int>(batch.size()), pool.size());
+        run.stats.widest = std::max(run.stats.widest, width);
+        if (width == 1) {                                    // כל ה-pool לצומת הבודד
+            for (std::coroutine_handle<> h : batch) h.resume();
+            continue;
+        }
+
+        // pool.size()/width threads per running node: slot t of the pool
+        // resumes nodes t, t+width, ... with kernels on its own team
+        const int share = pool.size() / width;
+        if (share != teamSize) teams.clear();
+        teamSize = share;
+        while (static_cast<int>(teams.size()) < width)
+            teams.emplace_back(share > 1 ? new ThreadPool(share) : nullptr);
+        pool.parallelForStatic(0, width, [&](int t) {
+            ThreadPool* outer = ThreadPool::use(teams[t].get());
+            for (std::size_t i = t; i < batch.size(); i += width) batch[i].resume();
+            ThreadPool::use(outer);
+        });
+    }
+
+    last = run.stats;
+    std::vector<SquareMat> out;
+    for (Value t : targets) {
+        const Slot& s = run.slots[t.index()];
+        if (s.error) std::rethrow_exception(s.error);
+        if (!s.done) throw std::logic_error("graph node was not evaluated");
+        out.push_back(*s.value);
+    }
+    return out;
+}
+
+/* ====================================================================
+   Operators
+   ================================================================= */
+
+namespace matrix {
+namespace graph {
+
+Value operator+(Value a, Value b)
+{
+    requireOwn(a.graph(), b);
+    return a.graph()->apply([](const std::vector<const SquareMat*>& x) { return *x[0] + *x[1]; },
+                            {a, b}, "graph +");
+}
+
+Value operator-(Value a, Value b)
+{
+    requireOwn(a.graph(), b);
+    return a.graph()->apply([](const std::vector<const SquareMat*>& x) { return *x[0] - *x[1]; },
+                            {a, b}, "graph -");
+}
+
+Value operator*(Value a, Value b)
+{
+    requireOwn(a.graph(), b);
+    return a.graph()->apply([](const std::vector<const SquareMat*>& x) { return *x[0] * *x[1]; },
+                            {a, b}, "graph *");
+}
+
+Value operator*(Value a, double s)
+{
+    requireOwn(a.graph(), a);
+    return a.graph()->apply([s](const std::vector<const SquareMat*>& x) { return *x[0] * s; },
+                            {a}, "graph scale");
+}
+
+Value operator*(double s, Value a) { return a * s; }
+
+/** @throw std::invalid_argument (when built) if @p e < 0 */
+Value operator^(Value a, int e)
+{
+    requireOwn(a.graph(), a);
+    if (e < 0) throw std::invalid_argument("negative exponent");
+    return a.graph()->apply([e](const std::vector<const SquareMat*>& x) { return *x[0] ^ e; },
+                            {a}, "graph ^");
+}
+
+Value operator~(Value a)
+{
+    requireOwn(a.graph(), a);
+    return a.graph()->apply([](const std::vector<const SquareMat*>& x) { return ~*x[0]; },
+                            {a}, "graph ~");
+}
+
+} // namespace graph
+} // namespace matrix
@@ -0,0 +1,103 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef GRAPH_HPP
+#define GRAPH_HPP
+
+#include "SquareMat.hpp"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace matrix {
+namespace graph {
+
+/*
+ * Task graph for dependent matrix computations:
+ *
+ *     Graph g;
+ *     Value X = g.input(A) * g.input(B), Y = g.input(C) * g.input(D);
+ *     SquareMat W = g.run((X + Y) ^ 8);
+ *
+ * Building a graph only records nodes.  run() evaluates what the targets
+ * need: every node is a C++20 coroutine that co_awaits its inputs and is
+ * suspended until they are ready.  Ready nodes are resumed in batches –
+ * a lone ready node runs on the caller with the whole ThreadPool; k
+ * ready nodes run concurrently, each with a team of size()/k threads
+ * for its own kernels.  An intermediate result is
+ * freed as soon as its last consumer has finished; targets are kept and
+ * returned.
+ *
+ * Inputs are borrowed and must outlive run().  A graph may be run again;
+ * each run recomputes from the inputs.
+ */
+
+class Graph;
+
+/** Handle to one node's result. */
+class Value {
+private:
+    Graph* g;
+    int id;
+
+    Value(Graph* g_, int id_) : g(g_), id(id_) {}
+    friend class Graph;
+
+public:
+    Value() : g(nullptr), id(-1) {}
+    Graph* graph() const { return g; }
+    int index() const { return id; }
+};
+
+struct Stats {
+    int computed = 0;               // צמתים שחושבו בהרצה האחרונה
+    int widest = 0;                 // הכי הרבה צמתים שרצו בו-זמנית
+    std::size_t peakBytes = 0;      // שיא התוצאות החיות בין צמתים (ללא קלטים)
+};
+
+class Graph {
+public:
+    using Fn = std::function<SquareMat(const std::vector<const SquareMat*>&)>;
+
+private:
+    struct Node {
+        const char* name;           // לשם ה-span ב-trace (מחרוזת ליטרלית)
+        std::vector<int> inputs;
+        Fn fn;                      // ריק בצומת קלט
+        const SquareMat* source;    // צומת קלט – מושאל
+    };
+    std::vector<Node> nodes;
+    Stats last;
+
+    int add(Node node);
+    std::vector<SquareMat> evaluate(const std::vector<Value>& targets);
+
+public:
+    // ---------- בנאים ----------
+    Graph() = default;
+    Graph(const Graph&) = delete;               // Value מצביע על הגרף
+    Graph& operator=(const Graph&) = delete;
+
+    // ---------- בניית צמתים ----------
+    Value input(const SquareMat& m);
+    Value apply(Fn fn, const std::vector<Value>& args, const char* name = "apply");
+    int size() const;
+
+    // ---------- הרצה ----------
+    SquareMat run(Value target);
+    std::vector<SquareMat> run(const std::vector<Value>& targets);
+    const Stats& stats() const;                 // של ההרצה האחרונה
+};
+
+// ---------- אופרטורים שבונים צמתים ----------
+Value operator+(Value a, Value b);
+Value operator-(Value a, Value b);
+Value operator*(Value a, Value b);
+Value operator*(Value a, double s);
+Value operator*(double s, Value a);
+Value operator^(Value a, int e);
+Value operator~(Value a);
+
+} // namespace graph
+} // namespace matrix
+
+#endif // GRAPH_HPP
@@ -0,0 +1,173 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Householder.hpp"
+#include "Kernels.hpp"
+#include "Trace.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min
+#include <cmath>       // std::hypot, std::copysign
+#include <memory>      // std::unique_ptr
+
+namespace matrix {
+namespace householder {
+
+namespace {
+
+/** @brief Reflectors per panel / per block application. */
+constexpr int NB = 64;
+
+} // namespace
+
+/** @brief Generate H with H·x = (beta, 0, …, 0)ᵀ (LAPACK dlarfg).
+ *  On exit x[1..m) holds v[1..m) (v₀ = 1 is implicit) and x[0] is left
+ *  untouched; τ = 0 means H = I.
+ *  @param inc stride between consecutive elements of @p x             */
+void generate(int m, double* x, int inc, double& beta, double& tau)
+{
+    const double alpha = x[0];
+    double xnorm = 0.0;
+    for (int i = 1; i < m; ++i) xnorm = std::hypot(xnorm, x[static_cast<long>(i) * inc]);
+
+    if (xnorm == 0.0) {
+        beta = alpha;
+        tau = 0.0;
+        return;
+    }
+    beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+    tau = (beta - alpha) / beta;
+    const double scale = 1.0 / (alpha - beta);
+    for (int i = 1; i < m; ++i) x[static_cast<long>(i) * inc] *= scale;
+}
+
+/** @brief T of the compact WY form (LAPACK dlarft, forward/rowwise V):
+ *  T(j,j) = τ_j,  T(0:j, j) = −τ_j · T(0:j,0:j) · V(0:j,:)·v_jᵀ.        */
+void formT(int m, int k, const double* V, int ldv, const double* tau, double* T)
+{
+    for (int j = 0; j < k; ++j) {
+        for (int i = 0; i < k; ++i) T[static_cast<long>(i) * k + j] = 0.0;
+        T[static_cast<long>(j) * k + j] = tau[j];
+        if (tau[j] == 0.0) continue;
+
+        const double* vj = V + static_cast<long>(j) * ldv;
+        for (int i = 0; i < j; ++i) {
+            const double* vi = V + static_cast<long>(i) * ldv;
+            double s = 0.0;
+            for (int r = j; r < m; ++r) s += vi[r] * vj[r];
+            T[static_cast<long>(i) * k + j] = -tau[j] * s;
+        }
+        for (int i = 0; i < j; ++i) {                     // T(0:j,j) = T(0:j,0:j)·w
+            double s = 0.0;
+            for (int p = i; p < j; ++p)
+                s += T[static_cast<long>(i) * k + p] * T[static_cast<long>(p) * k + j];
+            T[static_cast<long>(i) * k + j] = s;
+        }
+    }
+}
+
+/** @brief Apply the block reflector from the left at GEMM speed:
+ *  C ← (I − Vᵀ·T·V)·C, or with Tᵀ when @p transpose is set.
+ *  Three gemm calls: Y = V·C, Y ← T·Y, C −= Vᵀ·Y.                       */
+void applyLeft(bool transpose, int m, int ncols, int k,
+               const double* V, int ldv, const double* T, double* C, int ldc)
+{
+    if (m <= 0 || ncols <= 0 || k <= 0) return;
+    std::unique_ptr<double[]> Y(new double[static_cast<long>(k) * ncols]);
+    std::unique_ptr<double[]> Z(new double[static_cast<long>(k) * ncols]);
+    kernels::gemm(k, ncols, m, 1.0, V, ldv, false, C, ldc, false, 0.0, Y.get(), ncols);
+    kernels::gemm(k, ncols, k, 1.0, T, k, transpose, Y.get(), ncols, false, 0.0, Z.get(), ncols);
+    kernels::gemm(m, ncols, k, -1.0, V, ldv, true, Z.get(), ncols, false, 1.0, C, ldc);
+}
+
+/** @brief Right-hand counterpart of applyLeft():
+ *  C ← C·(I − Vᵀ·T·V), or with Tᵀ when @p transpose is set.
+ *  Y = C·Vᵀ, Y ← Y·T, C −= Y·V.                                        */
+void applyRight(bool transpose, int nrows, int m, int k,
+                const double* V, int ldv, const double* T, double* C, int ldc)
+{
+    if (m <= 0 || nrows <= 0 || k <= 0) return;
+    std::unique_ptr<double[]> Y(new double[static_cast<long>(nrows) * k]);
+    std::unique_ptr<double[]> Z(new double[static_cast<long>(nrows) * k]);
+    kernels::gemm(nrows, k, m, 1.0, C, ldc, false, V, ldv, true, 0.0, Y.get(), k);
+    kernels::gemm(nrows, k, k, 1.0, Y.get(), k, false, T, k, transpose, 0.0, Z.get(), k);
+    kernels::gemm(nrows, m, k, -1.0, Z.get(), k, false, V, ldv, false, 1.0, C, ldc);
+}
+
+/** @brief Explicit V (k×m) for k reflectors stored row-wise: row j of
+ *  @p a holds v_j after its diagonal element (a[j·lda + j] is the
+ *  implicit 1).  V gets the 1 at column j and zeros before it.          */
+void unpackV(int k, int m, const double* a, int lda, double* V)
+{
+    for (int j = 0; j < k; ++j) {
+        double* vj = V + static_cast<long>(j) * m;
+        const double* row = a + static_cast<long>(j) * lda;
+        std::fill(vj, vj + j, 0.0);
+        vj[j] = 1.0;
+        std::copy(row + j + 1, row + m, vj + j + 1);
+    }
+}
+
+/** @brief Blocked LQ of the k×m row block @p a (k ≤ m), which is the QR
+ *  of its transpose (LAPACK dgelqf).
+ *
+ *  Each NB-row panel is reduced row by row; the panel's reflectors are
+ *  then applied to all remaining rows at once in compact WY form, so
+ *  the trailing update is three gemm calls.  On exit the lower
+ *  trapezoid holds L and row j holds v_j after the diagonal.           */
+void factorRows(int k, int m, double* a, int lda, double* tau)
+{
+    std::unique_ptr<double[]> V(new double[static_cast<long>(NB) * m]);
+    std::unique_ptr<double[]> T(new double[NB * NB]);
+
+    for (int c0 = 0; c0 < k; c0 += NB) {
+        const int kb = std::min(NB, k - c0);
+        const int cEnd = c0 + kb;
+
+        trace::Span panel("qr panel", "panel", "col", c0);
+        for (int j = c0; j < cEnd; ++j) {
+            double* rj = a + static_cast<long>(j) * lda;
+            double beta;
+            generate(m - j, rj + j, 1, beta, tau[j]);
+            rj[j] = beta;
+            if (tau[j] == 0.0) continue;
+            for (int p = j + 1; p < cEnd; ++p) {            // H_j על שאר שורות הפאנל
+                double* rp = a + static_cast<long>(p) * lda;
+                double s = rp[j];
+                for (int c = j + 1; c < m; ++c) s += rj[c] * rp[c];
+                s *= tau[j];
+                rp[j] -= s;
+                for (int c = j + 1; c < m; ++c) rp[c] -= s * rj[c];
+            }
+        }
+        panel.end();
+        if (cEnd == k) break;
+
+        const int mm = m - c0;
+        unpackV(kb, mm, a + static_cast<long>(c0) * lda + c0, lda, V.get());
+        formT(mm, kb, V.get(), mm, tau + c0, T.get());
+        applyRight(false, k - cEnd, mm, kb, V.get(), mm, T.get(),
+                   a + static_cast<long>(cEnd) * lda + c0, lda);
+    }
+}
+
+/** @brief The k orthonormal rows spanning the rows of the matrix that
+ *  factorRows() reduced: Q = [I 0]·H_{k−1}·…·H₀ (LAPACK dorglq).
+ *  Blocks are applied last to first, each to the rows it can reach.    */
+void formRows(int k, int m, const double* a, int lda, const double* tau, double* Q, int ldq)
+{
+    for (int i = 0; i < k; ++i) {
+        double* qi = Q + static_cast<long>(i) * ldq;
+        std::fill(qi, qi + m, 0.0);
+        qi[i] = 1.0;
+    }
+    std::unique_ptr<double[]> V(new double[static_cast<long>(NB) * m]);
+    std::unique_ptr<double[]> T(new double[NB * NB]);
+    for (int c0 = ((k - 1) / NB) * NB; c0 >= 0; c0 -= NB) {
+        const int kb = std::min(NB, k - c0);
+        const int mm = m - c0;
+        unpackV(kb, mm, a + static_cast<long>(c0) * lda + c0, lda, V.get());
+        formT(mm, kb, V.get(), mm, tau + c0, T.get());
+        applyRight(true, k - c0, mm, kb, V.get(), mm, T.get(),
+                   Q + static_cast<long>(c0) * ldq + c0, ldq);
+    }
+}
+
+} // namespace householder
+} // namespace matrix
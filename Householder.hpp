@@ -0,0 +1,43 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef HOUSEHOLDER_HPP
+#define HOUSEHOLDER_HPP
+
+namespace matrix {
+namespace householder {
+
+/*
+ * Householder reflectors H = I − τ·v·vᵀ with v₀ = 1.
+ * A block of k reflectors H₀·H₁·…·H_{k−1} is kept in compact WY form
+ * I − Vᵀ·T·V, where the k rows of V (k×m, row-major) are the vectors
+ * v_j – explicit 1 at column j, zeros before it – and T is k×k upper
+ * triangular.
+ */
+
+// ---------- יצירת רפלקטור: H·x = (beta, 0, …, 0) ----------
+void generate(int m, double* x, int inc, double& beta, double& tau);
+
+// ---------- בניית T של ייצוג ה-WY ----------
+void formT(int m, int k, const double* V, int ldv, const double* tau, double* T);
+
+// ---------- C ← H·C או Hᵀ·C (C בגודל m×ncols) ----------
+void applyLeft(bool transpose, int m, int ncols, int k,
+               const double* V, int ldv, const double* T, double* C, int ldc);
+
+// ---------- C ← C·H או C·Hᵀ (C בגודל nrows×m) ----------
+void applyRight(bool transpose, int nrows, int m, int k,
+                const double* V, int ldv, const double* T, double* C, int ldc);
+
+// ---------- V מפורש מתוך רפלקטורים השמורים בשורות ----------
+void unpackV(int k, int m, const double* a, int lda, double* V);
+
+// ---------- LQ בלוקי של k×m שורות: a·H₀·…·H_{k−1} משולשת תחתונה ----------
+void factorRows(int k, int m, double* a, int lda, double* tau);
+
+// ---------- k שורות אורתונורמליות: [I 0]·H_{k−1}·…·H₀ ----------
+void formRows(int k, int m, const double* a, int lda, const double* tau, double* Q, int ldq);
+
+} // namespace householder
+} // namespace matrix
+
+#endif // HOUSEHOLDER_HPP
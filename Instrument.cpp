@@ -0,0 +1,219 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Instrument.hpp"
+#include <atomic>
+#include <cstdio>      // std::rename, std::remove
+#include <fstream>     // std::ofstream
+#include <mutex>
+#include <sstream>     // std::ostringstream
+#include <stdexcept>   // std::runtime_error
+#include <vector>
+
+using namespace matrix::instrument;
+
+namespace {
+
+constexpr int FIELDS = 5;              // calls, flops, bytes, allocBytes, nanoseconds
+
+/** @brief One thread's counters.  Only the owner writes (relaxed adds on
+ *  its own cache lines); snapshot() reads them from any thread.        */
+struct alignas(64) Block {
+    std::atomic<std::uint64_t> v[OP_COUNT][FIELDS];
+    int depth[OP_COUNT];               // קינון של אותה פעולה – לבעלים בלבד
+};
+
+struct Registry {
+    std::mutex mtx;
+    std::vector<Block*> live;
+    std::uint64_t retired[OP_COUNT][FIELDS] = {};   // חוטים שסיימו
+};
+
+/** @brief Never destroyed, so threads exiting during shutdown can still
+ *  fold their counters in.                                             */
+Registry& registry()
+{
+    static Registry* r = new Registry;
+    return *r;
+}
+
+struct Local {
+    Block* block;
+    Local() : block(new Block)
+    {
+        for (int o = 0; o < OP_COUNT; ++o) {
+            block->depth[o] = 0;
+            for (int f = 0; f < FIELDS; ++f) block->v[o][f].store(0, std::memory_order_relaxed);
+        }
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        r.live.push_back(block);
+    }
+    ~Local()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        for (int o = 0; o < OP_COUNT; ++o)
+            for (int f = 0; f < FIELDS; ++f) r.retired[o][f] += block->v[o][f].load(std::memory_order_relaxed);
+        for (std::size_t k = 0; k < r.live.size(); ++k)
+            if (r.live[k] == block) {
+                r.live[k] = r.live.back();
+                r.live.pop_back();
+                break;
+            }
+        delete block;
+    }
+};
+
+Block& local()
+{
+    thread_local Local l;
+    return *l.block;
+}
+
+void add(Block& b, Op op, int field, std::uint64_t x)
+{
+    b.v[static_cast<int>(op)][field].fetch_add(x, std::memory_order_relaxed);
+}
+
+const char* const NAMES[OP_COUNT] = {
+    "add", "subtract", "negate", "multiply", "scale", "hadamard", "power",
+    "determinant", "transpose", "compare", "increment", "output", "copy", "allocate"};
+
+/** @brief Write @p text to @p path via a temporary file and rename(), so
+ *  a scraper never sees a half-written file.
+ *  @throw std::runtime_error if the file cannot be written            */
+void writeAtomically(const std::string& path, const std::string& text)
+{
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f << text;
+        if (!f) throw std::runtime_error("cannot write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot rename " + tmp + " to " + path);
+    }
+}
+
+} // namespace
+
+namespace matrix {
+namespace instrument {
+
+const char* opName(Op op)
+{
+    const int k = static_cast<int>(op);
+    return (k >= 0 && k < OP_COUNT) ? NAMES[k] : "unknown";
+}
+
+/** @brief Count one call of @p op (the hooks use Scope instead). */
+void record(Op op, std::uint64_t flops, std::uint64_t bytes, std::uint64_t nanoseconds)
+{
+    Block& b = local();
+    add(b, op, 0, 1);
+    add(b, op, 1, flops);
+    add(b, op, 2, bytes);
+    add(b, op, 4, nanoseconds);
+}
+
+/** @brief Count one buffer allocation of @p bytes. */
+void recordAlloc(std::uint64_t bytes)
+{
+    Block& b = local();
+    add(b, Op::Allocate, 0, 1);
+    add(b, Op::Allocate, 3, bytes);
+}
+
+Scope::Scope(Op op_, std::uint64_t flops_, std::uint64_t bytes_)
+    : op(op_), flops(flops_), bytes(bytes_), start(), outermost(local().depth[static_cast<int>(op_)]++ == 0)
+{
+    if (outermost) start = std::chrono::steady_clock::now();
+}
+
+Scope::~Scope()
+{
+    Block& b = local();
+    --b.depth[static_cast<int>(op)];
+    if (!outermost) return;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    record(op, flops, bytes, static_cast<std::uint64_t>(ns.count()));
+}
+
+/** @brief Totals over every thread that has counted anything. */
+Snapshot snapshot()
+{
+    Snapshot s{};
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    for (int o = 0; o < OP_COUNT; ++o) {
+        std::uint64_t t[FIELDS];
+        for (int f = 0; f < FIELDS; ++f) t[f] = r.retired[o][f];
+        for (const Block* b : r.live)
+            for (int f = 0; f < FIELDS; ++f) t[f] += b->v[o][f].load(std::memory_order_relaxed);
+        s.ops[o] = OpStats{t[0], t[1], t[2], t[3], t[4]};
+    }
+    return s;
+}
+
+/** @brief Zero all counters (meant for quiescent points, e.g. between
+ *  benchmark phases; a concurrent call may still land either side).   */
+void reset()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    for (int o = 0; o < OP_COUNT; ++o)
+        for (int f = 0; f < FIELDS; ++f) {
+            r.retired[o][f] = 0;
+            for (Block* b : r.live) b->v[o][f].store(0, std::memory_order_relaxed);
+        }
+}
+
+/** @brief Prometheus text exposition format, one counter family per
+ *  field, labelled by operator.                                       */
+std::string toPrometheus(const Snapshot& s)
+{
+    struct Family { const char* name; const char* help; };
+    static const Family families[FIELDS] = {
+        {"squaremat_calls_total", "SquareMat operator calls."},
+        {"squaremat_flops_total", "Floating-point operations performed (model)."},
+        {"squaremat_bytes_total", "Bytes read and written (model)."},
+        {"squaremat_alloc_bytes_total", "Bytes allocated for matrix buffers."},
+        {"squaremat_seconds_total", "Inclusive wall time in operators."},
+    };
+    std::ostringstream out;
+    out.precision(9);
+    out << std::fixed;                             // משפיע רק על השניות
+    for (int f = 0; f < FIELDS; ++f) {
+        out << "# HELP " << families[f].name << ' ' << families[f].help << '\n'
+            << "# TYPE " << families[f].name << " counter\n";
+        for (int o = 0; o < OP_COUNT; ++o) {
+            const OpStats& st = s.ops[o];
+            const std::uint64_t v[FIELDS] = {st.calls, st.flops, st.bytes, st.allocBytes, st.nanoseconds};
+            out << families[f].name << "{op=\"" << NAMES[o] << "\"} ";
+            if (f == 4) out << static_cast<double>(v[f]) * 1e-9;
+            else out << v[f];
+            out << '\n';
+        }
+    }
+    return out.str();
+}
+
+std::string toJson(const Snapshot& s)
+{
+    std::ostringstream out;
+    out << "{\n  \"enabled\": " << (enabled ? "true" : "false") << ",\n  \"ops\": {\n";
+    for (int o = 0; o < OP_COUNT; ++o) {
+        const OpStats& st = s.ops[o];
+        out << "    \"" << NAMES[o] << "\": {\"calls\": " << st.calls << ", \"flops\": " << st.flops
+            << ", \"bytes\": " << st.bytes << ", \"alloc_bytes\": " << st.allocBytes
+            << ", \"nanoseconds\": " << st.nanoseconds << '}' << (o + 1 < OP_COUNT ? "," : "") << '\n';
+    }
+    out << "  }\n}\n";
+    return out.str();
+}
+
+void writePrometheus(const std::string& path) { writeAtomically(path, toPrometheus(snapshot())); }
+void writeJson(const std::string& path) { writeAtomically(path, toJson(snapshot())); }
+
+} // namespace instrument
+} // namespace matrix
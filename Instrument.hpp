@@ -0,0 +1,114 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace matrix {
+namespace instrument {
+
+/*
+ * Per-operator counters for SquareMat.  The hooks inside the library
+ * are compiled only with -DSQUAREMAT_INSTRUMENT (make INSTRUMENT=1);
+ * otherwise they expand to nothing and every counter stays zero.  The
+ * API below is always available, so callers need no #ifdefs.
+ *
+ * Counting is per thread (no shared cache lines on the hot path); a
+ * snapshot sums all live threads plus those that have exited.  Times
+ * are inclusive – operator^ also shows up under Multiply – but an
+ * operator calling itself (operator*= → operator*, recursive operator!)
+ * is counted once, at the outermost call.
+ */
+
+// ---------- סוגי פעולות ----------
+enum class Op {
+    Add,          // +  +=
+    Subtract,     // -  (בינארי)
+    Negate,       // -  (אונרי)
+    Multiply,     // *  *=  (מטריצה × מטריצה)
+    Scale,        // *s /s *= /=
+    Hadamard,     // %
+    Power,        // ^
+    Determinant,  // !
+    Transpose,    // ~
+    Compare,      // == != < <= > >=  (סכום איברים)
+    Increment,    // ++ --
+    Output,       // <<
+    Copy,         // בנאי העתקה והשמה
+    Allocate,     // הקצאת באפר
+    Count
+};
+
+constexpr int OP_COUNT = static_cast<int>(Op::Count);
+
+struct OpStats {
+    std::uint64_t calls;
+    std::uint64_t flops;
+    std::uint64_t bytes;          // בתים שנקראו ונכתבו (מודל, לא מדידה)
+    std::uint64_t allocBytes;
+    std::uint64_t nanoseconds;
+};
+
+struct Snapshot {
+    OpStats ops[OP_COUNT];
+    const OpStats& operator[](Op op) const { return ops[static_cast<int>(op)]; }
+};
+
+#ifdef SQUAREMAT_INSTRUMENT
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+const char* opName(Op op);
+
+// ---------- רישום ----------
+void record(Op op, std::uint64_t flops, std::uint64_t bytes, std::uint64_t nanoseconds);
+void recordAlloc(std::uint64_t bytes);
+
+/** RAII timer: counts one call of @p op with its FLOP and byte model. */
+class Scope {
+private:
+    Op op;
+    std::uint64_t flops, bytes;
+    std::chrono::steady_clock::time_point start;
+    bool outermost;
+
+public:
+    Scope(Op op, std::uint64_t flops, std::uint64_t bytes);
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope();
+};
+
+// ---------- קריאה וייצוא ----------
+Snapshot snapshot();
+void reset();
+std::string toPrometheus(const Snapshot& s);
+std::string toJson(const Snapshot& s);
+void writePrometheus(const std::string& path);     // כתיבה אטומית (קובץ זמני + rename)
+void writeJson(const std::string& path);
+
+} // namespace instrument
+} // namespace matrix
+
+// ---------- hooks בתוך הספרייה ----------
+// כל hook הוא גם span של trace (פעיל רק אחרי trace::start); בבנייה עם
+// INSTRUMENT=1 הוא גם סופר, וכשפרופיילינג perf פעיל – מייחס מוני חומרה
+#include "Trace.hpp"
+#ifdef SQUAREMAT_INSTRUMENT
+#include "Perf.hpp"
+#define SQM_SCOPE(op, flops, bytes) \
+    ::matrix::trace::Span sqmTrace_(#op); \
+    ::matrix::instrument::Scope sqmScope_(::matrix::instrument::Op::op, (flops), (bytes)); \
+    ::matrix::perf::Scope sqmPerf_(::matrix::instrument::Op::op)
+#define SQM_ALLOC(bytes) ::matrix::instrument::recordAlloc(bytes)
+#else
+#define SQM_SCOPE(op, flops, bytes) ::matrix::trace::Span sqmTrace_(#op)
+#define SQM_ALLOC(bytes) ((void)0)
+#endif
+
+#endif // INSTRUMENT_HPP
@@ -0,0 +1,245 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Kernels.hpp"
+#include "Async.hpp"
+#include "Numa.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>   // std::min, std::fill
+#include <memory>      // std::unique_ptr
+#include <mutex>
+
+using namespace matrix;
+using namespace matrix::kernels;
+
+namespace {
+
+/** @brief Below this many multiply-adds packing costs more than it saves. */
+constexpr long SMALL_GEMM = 32L * 32 * 32;
+
+/** @brief Process-wide gemm blocking; read and replaced under the mutex. */
+std::mutex configMtx;
+kernels::GemmConfig activeConfig{96, 256, 4096, 0};
+
+/** @brief Per-thread scratch for the packed A block (grown on demand). */
+double* threadPackBuffer(long size)
+{
+    thread_local std::unique_ptr<double[]> buf;
+    thread_local long cap = 0;
+    if (size > cap) {
+        buf.reset(new double[size]);
+        cap = size;
+    }
+    return buf.get();
+}
+
+/** @brief Read op(A)(i,p) from a row-major array. */
+inline double at(const double* A, int ld, bool trans, int i, int p)
+{
+    return trans ? A[static_cast<long>(p) * ld + i] : A[static_cast<long>(i) * ld + p];
+}
+
+/** @brief Straight triple loop for tiny products. */
+void gemmSmall(int m, int n, int k, double alpha,
+               const double* A, int lda, bool transA,
+               const double* B, int ldb, bool transB,
+               double* C, int ldc)
+{
+    for (int i = 0; i < m; ++i) {
+        double* c = C + static_cast<long>(i) * ldc;
+        for (int p = 0; p < k; ++p) {
+            double a = alpha * at(A, lda, transA, i, p);
+            if (!transB) {
+                const double* b = B + static_cast<long>(p) * ldb;
+                for (int j = 0; j < n; ++j) c[j] += a * b[j];
+            } else {
+                for (int j = 0; j < n; ++j) c[j] += a * B[static_cast<long>(j) * ldb + p];
+            }
+        }
+    }
+}
+
+} // namespace
+
+namespace matrix {
+namespace kernels {
+
+/** @brief Pack an @p mc × @p kc block of op(A) into MR-row strips,
+ *  zero-padding the last strip.                                        */
+void packA(int mc, int kc, const double* A, int lda, bool trans, double* dst)
+{
+    for (int ir = 0; ir < mc; ir += MR)
+        for (int p = 0; p < kc; ++p)
+            for (int i = 0; i < MR; ++i)
+                *dst++ = (ir + i < mc) ? at(A, lda, trans, ir + i, p) : 0.0;
+}
+
+/** @brief Pack a @p kc × @p nc block of op(B) into NR-column strips. */
+void packB(int kc, int nc, const double* B, int ldb, bool trans, double* dst)
+{
+    for (int jr = 0; jr < nc; jr += NR)
+        for (int p = 0; p < kc; ++p)
+            for (int j = 0; j < NR; ++j)
+                *dst++ = (jr + j < nc) ? at(B, ldb, trans, p, jr + j) : 0.0;
+}
+
+/** @brief Snapshot of the process-wide blocking parameters used by gemm(). */
+GemmConfig gemmConfig()
+{
+    std::lock_guard<std::mutex> lock(configMtx);
+    return activeConfig;
+}
+
+/** @brief Replace the process-wide blocking parameters.  A gemm already
+ *  running keeps the snapshot it took on entry.                        */
+void setGemmConfig(const GemmConfig& cfg)
+{
+    std::lock_guard<std::mutex> lock(configMtx);
+    activeConfig = cfg;
+}
+
+/** @brief Register-blocked update C(mr×nr) += alpha · a · b.
+ *  @p a is an MR-strip and @p b an NR-strip produced by the packers;
+ *  @p mr / @p nr clip the write-back at matrix edges.                     */
+void microKernel(int kc, const double* a, const double* b,
+                 double* C, int ldc, int mr, int nr, double alpha)
+{
+    double acc[MR][NR] = {};
+    for (int p = 0; p < kc; ++p) {
+        for (int i = 0; i < MR; ++i) {
+            double ai = a[i];
+            for (int j = 0; j < NR; ++j)
+                acc[i][j] += ai * b[j];
+        }
+        a += MR;
+        b += NR;
+    }
+    for (int i = 0; i < mr; ++i)
+        for (int j = 0; j < nr; ++j)
+            C[static_cast<long>(i) * ldc + j] += alpha * acc[i][j];
+}
+
+/** @brief Blocked, multithreaded general product
+ *  C = beta·C + alpha·op(A)·op(B) on row-major arrays.
+ *
+ *  Goto-style loop nest: an NC-wide panel of op(B) is packed once and
+ *  shared, then MC-row blocks of op(A) are packed per thread and swept
+ *  with the MR×NR micro-kernel.  Distinct MC blocks write disjoint rows
+ *  of C, so threads never contend.                                       */
+void gemm(int m, int n, int k, double alpha,
+          const double* A, int lda, bool transA,
+          const double* B, int ldb, bool transB,
+          double beta, double* C, int ldc)
+{
+    gemm(m, n, k, alpha, A, lda, transA, B, ldb, transB, beta, C, ldc, gemmConfig());
+}
+
+/** @brief gemm() under the blocking parameters @p cfg instead of the
+ *  process-wide ones; the autotuner measures candidates through it.    */
+void gemm(int m, int n, int k, double alpha,
+          const double* A, int lda, bool transA,
+          const double* B, int ldb, bool transB,
+          double beta, double* C, int ldc, const GemmConfig& cfg)
+{
+    if (m <= 0 || n <= 0) return;
+
+    if (beta != 1.0)
+        for (int i = 0; i < m; ++i) {
+            double* c = C + static_cast<long>(i) * ldc;
+            if (beta == 0.0) std::fill(c, c + n, 0.0);
+            else for (int j = 0; j < n; ++j) c[j] *= beta;
+        }
+    if (k <= 0 || alpha == 0.0) return;
+
+    if (static_cast<long>(m) * n * k <= SMALL_GEMM) {
+        gemmSmall(m, n, k, alpha, A, lda, transA, B, ldb, transB, C, ldc);
+        return;
+    }
+
+    trace::Span span("gemm", "gemm", "m", m);
+    const int mcMax = std::max(MR, cfg.mc / MR * MR);
+    const int ncMax = std::max(NR, cfg.nc / NR * NR);
+    const int kcMax = std::max(1, cfg.kc);
+
+    const int ncAlloc = std::min(ncMax, (n + NR - 1) / NR * NR);
+    const int kcAlloc = std::min(kcMax, k);
+    std::unique_ptr<double[]> bPack(new double[static_cast<long>(ncAlloc) * kcAlloc]);
+
+    ThreadPool& pool = ThreadPool::instance();
+    async::Job* job = async::current();          // cancellation / progress between tiles
+    const int mBlocks = (m + mcMax - 1) / mcMax;
+    // under first-touch placement, row blocks go to the thread that owns their pages
+    const bool ownerComputes = numa::placement() == numa::Placement::FirstTouch;
+
+    for (int jc = 0; jc < n; jc += ncMax) {
+        const int nc = std::min(ncMax, n - jc);
+        for (int pc = 0; pc < k; pc += kcMax) {
+            const int kc = std::min(kcMax, k - pc);
+            const double* bSrc = transB ? B + static_cast<long>(jc) * ldb + pc
+                                        : B + static_cast<long>(pc) * ldb + jc;
+            packB(kc, nc, bSrc, ldb, transB, bPack.get());
+
+            const auto tile = [&](int blk) {
+                const int ic = blk * mcMax;
+                trace::Span tile("gemm tile", "gemm", "row", ic);
+                const int mc = std::min(mcMax, m - ic);
+                double* aPack = threadPackBuffer(static_cast<long>(mcMax) * kcMax);
+                const double* aSrc = transA ? A + static_cast<long>(pc) * lda + ic
+                                            : A + static_cast<long>(ic) * lda + pc;
+                packA(mc, kc, aSrc, lda, transA, aPack);
+
+                for (int jr = 0; jr < nc; jr += NR)
+                    for (int ir = 0; ir < mc; ir += MR)
+                        microKernel(kc, aPack + static_cast<long>(ir) * kc,
+                                    bPack.get() + static_cast<long>(jr) * kc,
+                                    C + static_cast<long>(ic + ir) * ldc + jc + jr, ldc,
+                                    std::min(MR, mc - ir), std::min(NR, nc - jr), alpha);
+                async::checkpoint(job, 2ULL * mc * nc * kc);
+            };
+            if (ownerComputes) pool.parallelForStatic(0, mBlocks, tile, cfg.threads);
+            else pool.parallelFor(0, mBlocks, tile, cfg.threads);
+        }
+    }
+}
+
+/** @brief Triangular solve with many right-hand sides, in place:
+ *  X ← op(T)⁻¹·X where T is n×n triangular and X is n×m.
+ *
+ *  Each row update is a contiguous axpy over X's columns, and column
+ *  chunks of X are independent, so they are spread across the pool.
+ *  @param lower    T is lower (else upper) triangular as stored
+ *  @param trans    solve with Tᵀ instead of T
+ *  @param unitDiag assume ones on the diagonal (the diagonal is not read) */
+void trsm(bool lower, bool trans, bool unitDiag, int n, int m,
+          const double* T, int ldt, double* X, int ldx)
+{
+    if (n <= 0 || m <= 0) return;
+    const bool forward = (lower != trans);
+    constexpr int CHUNK = 128;
+    const int chunks = (m + CHUNK - 1) / CHUNK;
+    async::Job* job = async::current();
+
+    ThreadPool::instance().parallelFor(0, chunks, [&](int c) {
+        const int j0 = c * CHUNK;
+        const int w  = std::min(CHUNK, m - j0);
+        for (int s = 0; s < n; ++s) {
+            const int i = forward ? s : n - 1 - s;
+            double* xi = X + static_cast<long>(i) * ldx + j0;
+            const int pBegin = forward ? 0 : i + 1;
+            const int pEnd   = forward ? i : n;
+            for (int p = pBegin; p < pEnd; ++p) {
+                const double t = at(T, ldt, trans, i, p);
+                if (t == 0.0) continue;
+                const double* xp = X + static_cast<long>(p) * ldx + j0;
+                for (int j = 0; j < w; ++j) xi[j] -= t * xp[j];
+            }
+            if (!unitDiag) {
+                const double d = T[static_cast<long>(i) * ldt + i];
+                for (int j = 0; j < w; ++j) xi[j] /= d;
+            }
+        }
+        async::checkpoint(job, static_cast<std::uint64_t>(n) * n * w);
+    });
+}
+
+} // namespace kernels
+} // namespace matrix
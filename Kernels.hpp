@@ -0,0 +1,49 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+namespace matrix {
+namespace kernels {
+
+// ---------- פרמטרי חסימה ל-GEMM ----------
+struct GemmConfig {
+    int mc;        // שורות של A בבלוק אחד (נארז פר-חוט)
+    int kc;        // עומק הבלוק (ממד משותף)
+    int nc;        // עמודות של B בפאנל משותף
+    int threads;   // 0 = כל חוטי ה-ThreadPool
+};
+
+/** Micro-kernel register tile: MR rows × NR columns of C. */
+constexpr int MR = 4;
+constexpr int NR = 8;
+
+GemmConfig gemmConfig();                       // עותק של התצורה הפעילה
+void setGemmConfig(const GemmConfig& cfg);     // בטוח מול gemm שרצים במקביל
+
+// ---------- C = beta·C + alpha·op(A)·op(B) (row-major) ----------
+void gemm(int m, int n, int k, double alpha,
+          const double* A, int lda, bool transA,
+          const double* B, int ldb, bool transB,
+          double beta, double* C, int ldc);
+void gemm(int m, int n, int k, double alpha,   // עם תצורה מפורשת (מדידה)
+          const double* A, int lda, bool transA,
+          const double* B, int ldb, bool transB,
+          double beta, double* C, int ldc, const GemmConfig& cfg);
+
+// ---------- אריזה לפורמט של ה-micro-kernel ----------
+void packA(int mc, int kc, const double* A, int lda, bool trans, double* dst);
+void packB(int kc, int nc, const double* B, int ldb, bool trans, double* dst);
+
+// ---------- C(MR×NR) += alpha·a·b על פאנלים ארוזים ----------
+void microKernel(int kc, const double* a, const double* b,
+                 double* C, int ldc, int mr, int nr, double alpha);
+
+// ---------- פתרון משולשי: op(T)·X = X במקום ----------
+void trsm(bool lower, bool trans, bool unitDiag, int n, int m,
+          const double* T, int ldt, double* X, int ldx);
+
+} // namespace kernels
+} // namespace matrix
+
+#endif // KERNELS_HPP
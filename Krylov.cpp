@@ -0,0 +1,603 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Krylov.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min, std::max
+#include <array>       // std::array
+#include <cmath>       // std::sqrt, std::hypot, std::fabs
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::invalid_argument, std::domain_error
+#include <utility>     // std::move
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Vector elements handled by one task of a fused kernel. */
+constexpr int CHUNK = 4096;
+
+/** @brief Matrix rows handled by one task of the dense product. */
+constexpr int ROWS = 64;
+
+/** @brief Run body(i0, i1) over chunks of [0, n) on the pool. */
+template <class Body>
+void forEach(int n, Body body)
+{
+    ThreadPool::instance().parallelFor(0, (n + CHUNK - 1) / CHUNK, [&](int c) {
+        body(c * CHUNK, std::min(n, (c + 1) * CHUNK));
+    });
+}
+
+/**
+ * Fused sweep with K running sums: body(i0, i1, acc) updates its chunk
+ * and adds into acc[0..K).  Partial sums are combined in chunk order,
+ * so the result does not depend on the thread count.
+ */
+template <int K, class Body>
+std::array<double, K> reduce(int n, Body body)
+{
+    const int chunks = (n + CHUNK - 1) / CHUNK;
+    std::unique_ptr<double[]> part(new double[static_cast<long>(chunks) * K]);
+    ThreadPool::instance().parallelFor(0, chunks, [&](int c) {
+        double* acc = part.get() + static_cast<long>(c) * K;
+        std::fill(acc, acc + K, 0.0);
+        body(c * CHUNK, std::min(n, (c + 1) * CHUNK), acc);
+    });
+    std::array<double, K> s{};
+    for (int c = 0; c < chunks; ++c)
+        for (int q = 0; q < K; ++q) s[q] += part[static_cast<long>(c) * K + q];
+    return s;
+}
+
+double dot(int n, const double* x, const double* y)
+{
+    return reduce<1>(n, [&](int i0, int i1, double* acc) {
+        double s = 0.0;
+        for (int i = i0; i < i1; ++i) s += x[i] * y[i];
+        acc[0] = s;
+    })[0];
+}
+
+/** @brief r = b − A·x together with ‖r‖² and ‖b‖² (one sweep after the
+ *  operator); @p r must hold A·x on entry.                              */
+std::array<double, 2> residual(int n, const double* b, double* r)
+{
+    return reduce<2>(n, [&](int i0, int i1, double* acc) {
+        for (int i = i0; i < i1; ++i) {
+            r[i] = b[i] - r[i];
+            acc[0] += r[i] * r[i];
+            acc[1] += b[i] * b[i];
+        }
+    });
+}
+
+void checkSizes(const LinearOperator& A, const Preconditioner* M)
+{
+    if (M && M->size() != A.size()) throw std::invalid_argument("dimension mismatch");
+}
+
+/** @brief b = 0 ⇒ x = 0 exactly; shared early exit of every solver. */
+KrylovResult zeroRhs(int n, double* x)
+{
+    std::fill(x, x + n, 0.0);
+    return KrylovResult{true, 0, 0.0};
+}
+
+/* --------------------------------------------------------------------
+   Conjugate gradient (A symmetric positive definite)
+   ----------------------------------------------------------------- */
+KrylovResult cgImpl(const LinearOperator& A, const double* b, double* x,
+                    const Preconditioner* M, const KrylovOptions& opt)
+{
+    checkSizes(A, M);
+    const int n = A.size();
+    std::unique_ptr<double[]> r(new double[n]), p(new double[n]), q(new double[n]);
+    std::unique_ptr<double[]> zbuf(M ? new double[n] : nullptr);
+    double* z = M ? zbuf.get() : r.get();
+    const double* dinv = M ? M->diagonalInverse() : nullptr;
+
+    A.apply(x, r.get());
+    auto s = residual(n, b, r.get());
+    double rr = s[0];
+    const double bnorm = std::sqrt(s[1]);
+    if (bnorm == 0.0) return zeroRhs(n, x);
+
+    double rz = rr;
+    if (M) {
+        M->apply(r.get(), z);
+        rz = dot(n, r.get(), z);
+    }
+    std::copy(z, z + n, p.get());
+
+    int it = 0;
+    while (std::sqrt(rr) > opt.tol * bnorm && it < opt.maxIter) {
+        ++it;
+        A.apply(p.get(), q.get());
+        const double pq = dot(n, p.get(), q.get());
+        if (pq <= 0.0) break;                                // לא SPD
+        const double alpha = rz / pq;
+
+        // --- x += αp, r −= αq, (z = D⁻¹r) and the new inner products ---
+        double rzNew;
+        if (dinv) {
+            auto t = reduce<2>(n, [&](int i0, int i1, double* acc) {
+                for (int i = i0; i < i1; ++i) {
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * q[i];
+                    z[i] = dinv[i] * r[i];
+                    acc[0] += r[i] * r[i];
+                    acc[1] += r[i] * z[i];
+                }
+            });
+            rr = t[0];
+            rzNew = t[1];
+        } else {
+            rr = reduce<1>(n, [&](int i0, int i1, double* acc) {
+                for (int i = i0; i < i1; ++i) {
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * q[i];
+                    acc[0] += r[i] * r[i];
+                }
+            })[0];
+            rzNew = rr;
+            if (M) {
+                M->apply(r.get(), z);
+                rzNew = dot(n, r.get(), z);
+            }
+        }
+        const double beta = rzNew / rz;
+        rz = rzNew;
+        forEach(n, [&](int i0, int i1) {
+            for (int i = i0; i < i1; ++i) p[i] = z[i] + beta * p[i];
+        });
+    }
+    const double res = std::sqrt(rr) / bnorm;
+    return KrylovResult{res <= opt.tol, it, res};
+}
+
+/* --------------------------------------------------------------------
+   BiCGSTAB (general non-symmetric A), right preconditioned
+   ----------------------------------------------------------------- */
+KrylovResult bicgstabImpl(const LinearOperator& A, const double* b, double* x,
+                          const Preconditioner* M, const KrylovOptions& opt)
+{
+    checkSizes(A, M);
+    const int n = A.size();
+    std::unique_ptr<double[]> r(new double[n]), rh(new double[n]), p(new double[n]),
+                              v(new double[n]), t(new double[n]);
+    std::unique_ptr<double[]> phb(M ? new double[n] : nullptr), shb(M ? new double[n] : nullptr);
+    double* ph = M ? phb.get() : p.get();
+    double* sh = M ? shb.get() : r.get();                    // s נשמר במקום r
+    const double* dinv = M ? M->diagonalInverse() : nullptr;
+
+    A.apply(x, r.get());
+    auto s0 = residual(n, b, r.get());
+    double rr = s0[0];
+    const double bnorm = std::sqrt(s0[1]);
+    if (bnorm == 0.0) return zeroRhs(n, x);
+    std::copy(r.get(), r.get() + n, rh.get());
+
+    double rho = rr, rhoOld = 1.0, alpha = 1.0, omega = 1.0;
+    int it = 0;
+    while (std::sqrt(rr) > opt.tol * bnorm && it < opt.maxIter) {
+        ++it;
+        // --- p = r + β(p − ωv), p̂ = D⁻¹p fused for Jacobi ---
+        const double beta = (it == 1) ? 0.0 : (rho / rhoOld) * (alpha / omega);
+        forEach(n, [&](int i0, int i1) {
+            for (int i = i0; i < i1; ++i) {
+                p[i] = (it == 1) ? r[i] : r[i] + beta * (p[i] - omega * v[i]);
+                if (dinv) ph[i] = dinv[i] * p[i];
+            }
+        });
+        if (M && !dinv) M->apply(p.get(), ph);
+        A.apply(ph, v.get());
+        const double rv = dot(n, rh.get(), v.get());
+        if (rv == 0.0) break;                                // התמוטטות
+        alpha = rho / rv;
+
+        // --- s = r − αv (in r) with ‖s‖², ŝ = D⁻¹s ---
+        const double ss = reduce<1>(n, [&](int i0, int i1, double* acc) {
+            for (int i = i0; i < i1; ++i) {
+                r[i] -= alpha * v[i];
+                acc[0] += r[i] * r[i];
+                if (dinv) sh[i] = dinv[i] * r[i];
+            }
+        })[0];
+        if (std::sqrt(ss) <= opt.tol * bnorm) {
+            forEach(n, [&](int i0, int i1) {
+                for (int i = i0; i < i1; ++i) x[i] += alpha * ph[i];
+            });
+            rr = ss;
+            break;
+        }
+        if (M && !dinv) M->apply(r.get(), sh);
+        A.apply(sh, t.get());
+        auto ts = reduce<2>(n, [&](int i0, int i1, double* acc) {
+            for (int i = i0; i < i1; ++i) {
+                acc[0] += t[i] * r[i];
+                acc[1] += t[i] * t[i];
+            }
+        });
+        omega = (ts[1] > 0.0) ? ts[0] / ts[1] : 0.0;
+        if (omega == 0.0) break;
+
+        // --- x += αp̂ + ωŝ, r = s − ωt, with ‖r‖² and r̂·r ---
+        auto nr = reduce<2>(n, [&](int i0, int i1, double* acc) {
+            for (int i = i0; i < i1; ++i) {
+                x[i] += alpha * ph[i] + omega * sh[i];
+                r[i] -= omega * t[i];
+                acc[0] += r[i] * r[i];
+                acc[1] += rh[i] * r[i];
+            }
+        });
+        rr = nr[0];
+        rhoOld = rho;
+        rho = nr[1];
+        if (rho == 0.0) break;
+    }
+    const double res = std::sqrt(rr) / bnorm;
+    return KrylovResult{res <= opt.tol, it, res};
+}
+
+/* --------------------------------------------------------------------
+   Restarted GMRES(m), right preconditioned
+   ----------------------------------------------------------------- */
+KrylovResult gmresImpl(const LinearOperator& A, const double* b, double* x,
+                       const Preconditioner* M, const KrylovOptions& opt)
+{
+    checkSizes(A, M);
+    const int n = A.size();
+    const int m = std::max(1, std::min(opt.restart, n));
+    std::unique_ptr<double[]> V(new double[static_cast<long>(m + 1) * n]);
+    std::unique_ptr<double[]> H(new double[static_cast<long>(m + 1) * m]);
+    std::unique_ptr<double[]> cs(new double[m]), sn(new double[m]), g(new double[m + 1]),
+                              h(new double[m + 1]), y(new double[m]), w(new double[n]);
+    std::unique_ptr<double[]> zbuf(M ? new double[n] : nullptr);
+    const int chunks = (n + CHUNK - 1) / CHUNK;
+    std::unique_ptr<double[]> part(new double[static_cast<long>(chunks) * (m + 1)]);
+    auto row = [&](int j) { return V.get() + static_cast<long>(j) * n; };
+
+    const double bnorm = std::sqrt(dot(n, b, b));
+    if (bnorm == 0.0) return zeroRhs(n, x);
+
+    int total = 0;
+    double res;
+    for (;;) {
+        A.apply(x, row(0));
+        const double beta = std::sqrt(residual(n, b, row(0))[0]);
+        res = beta / bnorm;
+        if (res <= opt.tol || total >= opt.maxIter) break;
+        forEach(n, [&](int i0, int i1) {
+            for (int i = i0; i < i1; ++i) row(0)[i] /= beta;
+        });
+        std::fill(g.get(), g.get() + m + 1, 0.0);
+        g[0] = beta;
+
+        int j = 0;
+        while (j < m && total < opt.maxIter) {
+            const double* zj = row(j);
+            if (M) {
+                M->apply(row(j), zbuf.get());
+                zj = zbuf.get();
+            }
+            A.apply(zj, w.get());
+
+            // --- classical Gram–Schmidt, twice: one sweep for all j+1
+            //     projections, one fused sweep for the update (+‖w‖²) ---
+            for (int k = 0; k <= j; ++k) H[static_cast<long>(k) * m + j] = 0.0;
+            double ww = 0.0;
+            for (int pass = 0; pass < 2; ++pass) {
+                ThreadPool::instance().parallelFor(0, chunks, [&](int c) {
+                    const int i0 = c * CHUNK, i1 = std::min(n, i0 + CHUNK);
+                    double* acc = part.get() + static_cast<long>(c) * (m + 1);
+                    for (int k = 0; k <= j; ++k) {
+                        const double* vk = row(k);
+                        double s = 0.0;
+                        for (int i = i0; i < i1; ++i) s += vk[i] * w[i];
+                        acc[k] = s;
+                    }
+                });
+                for (int k = 0; k <= j; ++k) {
+                    double s = 0.0;
+                    for (int c = 0; c < chunks; ++c) s += part[static_cast<long>(c) * (m + 1) + k];
+                    h[k] = s;
+                    H[static_cast<long>(k) * m + j] += s;
+                }
+                ww = reduce<1>(n, [&](int i0, int i1, double* acc) {
+                    for (int k = 0; k <= j; ++k) {
+                        const double* vk = row(k);
+                        const double hk = h[k];
+                        for (int i = i0; i < i1; ++i) w[i] -= hk * vk[i];
+                    }
+                    for (int i = i0; i < i1; ++i) acc[0] += w[i] * w[i];
+                })[0];
+            }
+            const double hn = std::sqrt(ww);
+            H[static_cast<long>(j + 1) * m + j] = hn;
+            if (hn > 0.0) {
+                double* vn = row(j + 1);
+                forEach(n, [&](int i0, int i1) {
+                    for (int i = i0; i < i1; ++i) vn[i] = w[i] / hn;
+                });
+            }
+
+            // --- Givens rotations keep H upper triangular ---
+            for (int k = 0; k < j; ++k) {
+                double& a0 = H[static_cast<long>(k) * m + j];
+                double& a1 = H[static_cast<long>(k + 1) * m + j];
+                const double tmp = cs[k] * a0 + sn[k] * a1;
+                a1 = -sn[k] * a0 + cs[k] * a1;
+                a0 = tmp;
+            }
+            double& hjj = H[static_cast<long>(j) * m + j];
+            const double den = std::hypot(hjj, hn);
+            cs[j] = (den > 0.0) ? hjj / den : 1.0;
+            sn[j] = (den > 0.0) ? hn / den : 0.0;
+            hjj = den;
+            H[static_cast<long>(j + 1) * m + j] = 0.0;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] *= cs[j];
+
+            ++j;
+            ++total;
+            if (std::fabs(g[j]) <= opt.tol * bnorm || hn == 0.0) break;
+        }
+
+        // --- y = H⁻¹g, x += M⁻¹·(V·y) ---
+        for (int i = j - 1; i >= 0; --i) {
+            double s = g[i];
+            for (int k = i + 1; k < j; ++k) s -= H[static_cast<long>(i) * m + k] * y[k];
+            y[i] = s / H[static_cast<long>(i) * m + i];
+        }
+        forEach(n, [&](int i0, int i1) {
+            std::fill(w.get() + i0, w.get() + i1, 0.0);
+            for (int k = 0; k < j; ++k) {
+                const double* vk = row(k);
+                const double yk = y[k];
+                for (int i = i0; i < i1; ++i) w[i] += yk * vk[i];
+            }
+            if (!M) for (int i = i0; i < i1; ++i) x[i] += w[i];
+        });
+        if (M) {
+            M->apply(w.get(), zbuf.get());
+            forEach(n, [&](int i0, int i1) {
+                for (int i = i0; i < i1; ++i) x[i] += zbuf[i];
+            });
+        }
+    }
+    return KrylovResult{res <= opt.tol, total, res};
+}
+
+} // namespace
+
+/* ====================================================================
+   Operators
+   ================================================================= */
+
+DenseOperator::DenseOperator(const SquareMat& A_) : A(A_) {}
+
+int DenseOperator::size() const { return A.getN(); }
+
+/** @brief y = A·x, rows split across the pool. */
+void DenseOperator::apply(const double* x, double* y) const
+{
+    const int n = A.getN();
+    const double* a = A.raw();
+    ThreadPool::instance().parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        for (int i = blk * ROWS; i < std::min(n, (blk + 1) * ROWS); ++i) {
+            const double* ai = a + static_cast<long>(i) * n;
+            double acc[4] = {0, 0, 0, 0};
+            int j = 0;
+            for (; j + 4 <= n; j += 4)
+                for (int l = 0; l < 4; ++l) acc[l] += ai[j + l] * x[j + l];
+            double s = (acc[0] + acc[2]) + (acc[1] + acc[3]);
+            for (; j < n; ++j) s += ai[j] * x[j];
+            y[i] = s;
+        }
+    });
+}
+
+SparseOperator::SparseOperator(const SparseMat& A_) : A(A_) {}
+
+int SparseOperator::size() const { return A.getN(); }
+
+void SparseOperator::apply(const double* x, double* y) const { A.multiply(x, y); }
+
+FunctionOperator::FunctionOperator(int n_, std::function<void(const double*, double*)> f_)
+    : n(n_), f(std::move(f_))
+{
+    if (n <= 0) throw std::invalid_argument("size must be positive");
+}
+
+int FunctionOperator::size() const { return n; }
+
+void FunctionOperator::apply(const double* x, double* y) const { f(x, y); }
+
+/* ====================================================================
+   Preconditioners
+   ================================================================= */
+
+/** @brief nullptr: M is not diagonal, the solvers call apply(). */
+const double* Preconditioner::diagonalInverse() const { return nullptr; }
+
+/** @throw std::domain_error on a zero diagonal entry */
+JacobiPreconditioner::JacobiPreconditioner(const SquareMat& A) : dinv(nullptr), n(A.getN())
+{
+    dinv = new double[n];
+    for (int i = 0; i < n; ++i) {
+        if (A(i, i) == 0.0) { delete[] dinv; throw std::domain_error("zero diagonal entry"); }
+        dinv[i] = 1.0 / A(i, i);
+    }
+}
+
+/** @throw std::domain_error on a zero (or missing) diagonal entry */
+JacobiPreconditioner::JacobiPreconditioner(const SparseMat& A) : dinv(nullptr), n(A.getN())
+{
+    dinv = new double[n];
+    for (int i = 0; i < n; ++i) {
+        const double d = A(i, i);
+        if (d == 0.0) { delete[] dinv; throw std::domain_error("zero diagonal entry"); }
+        dinv[i] = 1.0 / d;
+    }
+}
+
+/** @brief Deep-copy constructor. */
+JacobiPreconditioner::JacobiPreconditioner(const JacobiPreconditioner& other)
+    : Preconditioner(other), dinv(nullptr), n(other.n)
+{
+    dinv = new double[n];
+    std::copy(other.dinv, other.dinv + n, dinv);
+}
+
+/** @brief Copy-assignment operator. */
+JacobiPreconditioner& JacobiPreconditioner::operator=(const JacobiPreconditioner& other)
+{
+    if (this == &other) return *this;
+    if (n != other.n) {
+        delete[] dinv;
+        dinv = new double[other.n];
+    }
+    n = other.n;
+    std::copy(other.dinv, other.dinv + n, dinv);
+    return *this;
+}
+
+JacobiPreconditioner::~JacobiPreconditioner() { delete[] dinv; }
+
+int JacobiPreconditioner::size() const { return n; }
+
+void JacobiPreconditioner::apply(const double* r, double* z) const
+{
+    forEach(n, [&](int i0, int i1) {
+        for (int i = i0; i < i1; ++i) z[i] = dinv[i] * r[i];
+    });
+}
+
+const double* JacobiPreconditioner::diagonalInverse() const { return dinv; }
+
+/**
+ * @brief Incomplete LU with zero fill-in (IKJ variant, Saad §10.3).
+ * Row i is eliminated only at positions already present in A, using a
+ * column→position marker; values are then re-packed into a CSR
+ * SparseMat with A's pattern.
+ * @throw std::domain_error on a missing or zero pivot
+ */
+ILU0Preconditioner::ILU0Preconditioner(const SparseMat& A) : lu(A.getN())
+{
+    const SparseMat C = A.toCSR();
+    const int n = C.getN();
+    const long nnz = C.nonZeros();
+    const long* ptr = C.outerIndex();
+    const int* col = C.innerIndex();
+    std::unique_ptr<double[]> val(new double[nnz]);
+    std::copy(C.values(), C.values() + nnz, val.get());
+    std::unique_ptr<long[]> diag(new long[n]), marker(new long[n]);
+    std::fill(marker.get(), marker.get() + n, -1L);
+
+    for (int i = 0; i < n; ++i) {
+        for (long p = ptr[i]; p < ptr[i + 1]; ++p) marker[col[p]] = p;
+        diag[i] = -1;
+        for (long p = ptr[i]; p < ptr[i + 1]; ++p) {
+            const int k = col[p];
+            if (k >= i) {
+                if (k == i) diag[i] = p;
+                break;
+            }
+            const double lik = (val[p] /= val[diag[k]]);
+            for (long q = diag[k] + 1; q < ptr[k + 1]; ++q) {
+                const long pos = marker[col[q]];
+                if (pos >= 0) val[pos] -= lik * val[q];
+            }
+        }
+        if (diag[i] < 0 || val[diag[i]] == 0.0)
+            throw std::domain_error("zero pivot in ILU(0)");
+        for (long p = ptr[i]; p < ptr[i + 1]; ++p) marker[col[p]] = -1;
+    }
+
+    std::unique_ptr<int[]> rows(new int[nnz]);
+    for (int i = 0; i < n; ++i)
+        for (long p = ptr[i]; p < ptr[i + 1]; ++p) rows[p] = i;
+    lu = SparseMat(n, nnz, rows.get(), col, val.get());
+}
+
+/** @brief ILU(0) of the nonzero pattern of a dense matrix. */
+ILU0Preconditioner::ILU0Preconditioner(const SquareMat& A) : ILU0Preconditioner(SparseMat(A)) {}
+
+int ILU0Preconditioner::size() const { return lu.getN(); }
+
+/** @brief z = U⁻¹·L⁻¹·r – forward then backward substitution over the
+ *  CSR rows; the diagonal splits each row.                             */
+void ILU0Preconditioner::apply(const double* r, double* z) const
+{
+    const int n = lu.getN();
+    const long* ptr = lu.outerIndex();
+    const int* col = lu.innerIndex();
+    const double* val = lu.values();
+    for (int i = 0; i < n; ++i) {
+        double s = r[i];
+        for (long p = ptr[i]; p < ptr[i + 1] && col[p] < i; ++p) s -= val[p] * z[col[p]];
+        z[i] = s;
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        double s = z[i];
+        long p = ptr[i + 1] - 1;
+        for (; col[p] > i; --p) s -= val[p] * z[col[p]];
+        z[i] = s / val[p];
+    }
+}
+
+const SparseMat& ILU0Preconditioner::factors() const { return lu; }
+
+/* ====================================================================
+   Solvers
+   ================================================================= */
+
+namespace matrix {
+
+/** @brief Conjugate gradient for symmetric positive-definite A; stops
+ *  when ‖r‖ ≤ tol·‖b‖.  @p x is the initial guess on entry.
+ *  Each iteration is one operator call plus three fused sweeps.        */
+KrylovResult cg(const LinearOperator& A, const double* b, double* x, const KrylovOptions& opt)
+{
+    return cgImpl(A, b, x, nullptr, opt);
+}
+
+/** @brief Preconditioned CG (M must be SPD as well); a Jacobi M is
+ *  folded into the update sweep.                                       */
+KrylovResult cg(const LinearOperator& A, const double* b, double* x,
+                const Preconditioner& M, const KrylovOptions& opt)
+{
+    return cgImpl(A, b, x, &M, opt);
+}
+
+/** @brief Restarted GMRES(opt.restart) with classical Gram–Schmidt
+ *  applied twice – two sweeps over the basis per pass instead of j.   */
+KrylovResult gmres(const LinearOperator& A, const double* b, double* x,
+                   const KrylovOptions& opt)
+{
+    return gmresImpl(A, b, x, nullptr, opt);
+}
+
+/** @brief Right-preconditioned GMRES: the residual it monitors is the
+ *  true ‖b − A·x‖, not the preconditioned one.                         */
+KrylovResult gmres(const LinearOperator& A, const double* b, double* x,
+                   const Preconditioner& M, const KrylovOptions& opt)
+{
+    return gmresImpl(A, b, x, &M, opt);
+}
+
+/** @brief BiCGSTAB for general A (van der Vorst); two operator calls
+ *  and five fused sweeps per iteration.                                */
+KrylovResult bicgstab(const LinearOperator& A, const double* b, double* x,
+                      const KrylovOptions& opt)
+{
+    return bicgstabImpl(A, b, x, nullptr, opt);
+}
+
+/** @brief Right-preconditioned BiCGSTAB. */
+KrylovResult bicgstab(const LinearOperator& A, const double* b, double* x,
+                      const Preconditioner& M, const KrylovOptions& opt)
+{
+    return bicgstabImpl(A, b, x, &M, opt);
+}
+
+} // namespace matrix
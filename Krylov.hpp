@@ -0,0 +1,118 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef KRYLOV_HPP
+#define KRYLOV_HPP
+
+#include "SquareMat.hpp"
+#include "SparseMat.hpp"
+#include <functional>
+
+namespace matrix {
+
+// ---------- אופרטור לינארי: y = A·x ----------
+class LinearOperator {
+public:
+    virtual ~LinearOperator() = default;
+    virtual int size() const = 0;
+    virtual void apply(const double* x, double* y) const = 0;
+};
+
+/** Wraps a SquareMat (row-parallel matrix-vector product). */
+class DenseOperator : public LinearOperator {
+private:
+    const SquareMat& A;
+public:
+    explicit DenseOperator(const SquareMat& A);
+    int size() const override;
+    void apply(const double* x, double* y) const override;
+};
+
+/** Wraps a SparseMat (SpMV in its own format). */
+class SparseOperator : public LinearOperator {
+private:
+    const SparseMat& A;
+public:
+    explicit SparseOperator(const SparseMat& A);
+    int size() const override;
+    void apply(const double* x, double* y) const override;
+};
+
+/** Matrix-free operator: any callable f(x, y) that writes y = A·x. */
+class FunctionOperator : public LinearOperator {
+private:
+    int n;
+    std::function<void(const double*, double*)> f;
+public:
+    FunctionOperator(int n, std::function<void(const double*, double*)> f);
+    int size() const override;
+    void apply(const double* x, double* y) const override;
+};
+
+// ---------- מקדם התניה: z = M⁻¹·r ----------
+class Preconditioner {
+public:
+    virtual ~Preconditioner() = default;
+    virtual int size() const = 0;
+    virtual void apply(const double* r, double* z) const = 0;
+    virtual const double* diagonalInverse() const;     // לא nullptr ⇔ M אלכסונית (מאפשר איחוד לולאות)
+};
+
+/** Jacobi: M = diag(A). */
+class JacobiPreconditioner : public Preconditioner {
+private:
+    double* dinv;
+    int n;
+public:
+    explicit JacobiPreconditioner(const SquareMat& A);
+    explicit JacobiPreconditioner(const SparseMat& A);
+    JacobiPreconditioner(const JacobiPreconditioner& other);
+    JacobiPreconditioner& operator=(const JacobiPreconditioner& other);
+    ~JacobiPreconditioner() override;
+
+    int size() const override;
+    void apply(const double* r, double* z) const override;
+    const double* diagonalInverse() const override;
+};
+
+/** ILU(0): L·U restricted to the sparsity pattern of A. */
+class ILU0Preconditioner : public Preconditioner {
+private:
+    SparseMat lu;      // L (יחידה באלכסון) מתחת, U על האלכסון ומעליו, CSR
+public:
+    explicit ILU0Preconditioner(const SparseMat& A);
+    explicit ILU0Preconditioner(const SquareMat& A);
+
+    int size() const override;
+    void apply(const double* r, double* z) const override;
+    const SparseMat& factors() const;
+};
+
+// ---------- פותרים ----------
+struct KrylovOptions {
+    double tol = 1e-10;      // ‖b − A·x‖ ≤ tol·‖b‖
+    int maxIter = 1000;
+    int restart = 30;        // GMRES בלבד
+};
+
+struct KrylovResult {
+    bool converged;
+    int iterations;
+    double residual;         // ‖b − A·x‖ / ‖b‖
+};
+
+KrylovResult cg(const LinearOperator& A, const double* b, double* x,
+                const KrylovOptions& opt = KrylovOptions());
+KrylovResult cg(const LinearOperator& A, const double* b, double* x,
+                const Preconditioner& M, const KrylovOptions& opt = KrylovOptions());
+KrylovResult gmres(const LinearOperator& A, const double* b, double* x,
+                   const KrylovOptions& opt = KrylovOptions());
+KrylovResult gmres(const LinearOperator& A, const double* b, double* x,
+                   const Preconditioner& M, const KrylovOptions& opt = KrylovOptions());
+KrylovResult bicgstab(const LinearOperator& A, const double* b, double* x,
+                      const KrylovOptions& opt = KrylovOptions());
+KrylovResult bicgstab(const LinearOperator& A, const double* b, double* x,
+                      const Preconditioner& M, const KrylovOptions& opt = KrylovOptions());
+
+} // namespace matrix
+
+#endif // KRYLOV_HPP
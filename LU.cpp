@@ -0,0 +1,177 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "LU.hpp"
+#include "Async.hpp"
+#include "Kernels.hpp"
+#include "Trace.hpp"
+#include <algorithm>   // std::copy, std::swap_ranges, std::min
+#include <cmath>       // std::fabs
+#include <stdexcept>   // std::domain_error, std::invalid_argument
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Panel width of the blocked factorization. */
+constexpr int NB = 64;
+
+} // namespace
+
+/* ====================================================================
+   Factorization
+   ================================================================= */
+
+/** @brief Factor @p A as P·A = L·U (right-looking, blocked).
+ *
+ *  Each NB-wide panel is factored column by column with partial
+ *  pivoting, the matching block row of U is obtained with a triangular
+ *  solve, and the trailing matrix is updated with one GEMM per panel,
+ *  so almost all of the 2n³/3 FLOPs run in kernels::gemm.
+ *  A singular matrix is not an error here; see isSingular().
+ *  @throw OperationCancelled if an asynchronous caller cancels          */
+LU::LU(const SquareMat& A) : lu(A), piv(nullptr), n(A.getN()), sign(1), singular(false)
+{
+    piv = new int[n];
+    try {
+        factor();
+    } catch (...) {
+        delete[] piv;
+        throw;
+    }
+}
+
+/** @brief The blocked loop of the constructor; checks for cancellation
+ *  before every panel.                                                 */
+void LU::factor()
+{
+    double* a = lu.raw();
+    async::Job* job = async::current();
+
+    for (int k0 = 0; k0 < n; k0 += NB) {
+        const int kb = std::min(NB, n - k0);
+        const int kEnd = k0 + kb;
+        async::checkpoint(job);
+
+        // --- panel: columns k0..kEnd, rows k0..n ---
+        trace::Span panel("lu panel", "panel", "col", k0);
+        for (int j = k0; j < kEnd; ++j) {
+            int p = j;
+            double best = std::fabs(a[j * n + j]);
+            for (int i = j + 1; i < n; ++i) {
+                double v = std::fabs(a[i * n + j]);
+                if (v > best) { best = v; p = i; }
+            }
+            piv[j] = p;
+            if (p != j) {
+                std::swap_ranges(a + j * n, a + (j + 1) * n, a + p * n);
+                sign = -sign;
+            }
+            const double d = a[j * n + j];
+            if (d == 0.0) { singular = true; continue; }
+
+            const double* uj = a + j * n;
+            for (int i = j + 1; i < n; ++i) {
+                double* ai = a + i * n;
+                const double l = (ai[j] /= d);
+                for (int c = j + 1; c < kEnd; ++c) ai[c] -= l * uj[c];
+            }
+        }
+        panel.end();
+        if (kEnd == n) break;
+
+        // --- U12 = L11⁻¹·A12 ---
+        kernels::trsm(true, false, true, kb, n - kEnd,
+                      a + k0 * n + k0, n, a + k0 * n + kEnd, n);
+
+        // --- A22 -= L21·U12 ---
+        kernels::gemm(n - kEnd, n - kEnd, kb, -1.0,
+                      a + kEnd * n + k0, n, false,
+                      a + k0 * n + kEnd, n, false,
+                      1.0, a + kEnd * n + kEnd, n);
+    }
+}
+
+/** @brief Deep-copy constructor. */
+LU::LU(const LU& other)
+    : lu(other.lu), piv(nullptr), n(other.n), sign(other.sign), singular(other.singular)
+{
+    piv = new int[n];
+    std::copy(other.piv, other.piv + n, piv);
+}
+
+/** @brief Copy-assignment operator. */
+LU& LU::operator=(const LU& other)
+{
+    if (this == &other) return *this;
+    if (n != other.n) {
+        delete[] piv;
+        piv = new int[other.n];
+    }
+    lu = other.lu;
+    n = other.n;
+    sign = other.sign;
+    singular = other.singular;
+    std::copy(other.piv, other.piv + n, piv);
+    return *this;
+}
+
+/** @brief Destructor – frees the pivot array. */
+LU::~LU() { delete[] piv; }
+
+/* ====================================================================
+   Queries
+   ================================================================= */
+
+/** @brief True if a zero pivot was met (the matrix is singular). */
+bool LU::isSingular() const { return singular; }
+
+/** @brief Packed factors: unit-lower L below the diagonal, U above. */
+const SquareMat& LU::factors() const { return lu; }
+
+/** @brief det(A) = sign(P) · Π uᵢᵢ  – O(n) after factorization. */
+double LU::determinant() const
+{
+    if (singular) return 0.0;
+    const double* a = lu.raw();
+    double det = sign;
+    for (int i = 0; i < n; ++i) det *= a[i * n + i];
+    return det;
+}
+
+/* ====================================================================
+   Solves
+   ================================================================= */
+
+/** @brief Solve A·x = b for a single right-hand side, overwriting @p b.
+ *  @throw std::domain_error if the matrix is singular                 */
+void LU::solveInPlace(double* b) const
+{
+    if (singular) throw std::domain_error("matrix is singular");
+    for (int i = 0; i < n; ++i)
+        if (piv[i] != i) std::swap(b[i], b[piv[i]]);
+    kernels::trsm(true, false, true, n, 1, lu.raw(), n, b, 1);
+    kernels::trsm(false, false, false, n, 1, lu.raw(), n, b, 1);
+}
+
+/** @brief Solve A·X = B for every column of @p B at once.
+ *  @throw std::invalid_argument on dimension mismatch
+ *  @throw std::domain_error if the matrix is singular                 */
+SquareMat LU::solve(const SquareMat& B) const
+{
+    if (B.getN() != n) throw std::invalid_argument("dimension mismatch");
+    if (singular) throw std::domain_error("matrix is singular");
+    SquareMat X(B);
+    double* x = X.raw();
+    for (int i = 0; i < n; ++i)
+        if (piv[i] != i) std::swap_ranges(x + i * n, x + (i + 1) * n, x + piv[i] * n);
+    kernels::trsm(true, false, true, n, n, lu.raw(), n, x, n);
+    kernels::trsm(false, false, false, n, n, lu.raw(), n, x, n);
+    return X;
+}
+
+/** @brief A⁻¹ via solve(I). */
+SquareMat LU::inverse() const
+{
+    SquareMat I(n, 0.0);
+    for (int i = 0; i < n; ++i) I[i][i] = 1.0;
+    return solve(I);
+}
@@ -0,0 +1,43 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef LU_HPP
+#define LU_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * LU factorization with partial pivoting, P·A = L·U.
+ * L (unit diagonal) and U are stored together in one SquareMat.
+ */
+class LU {
+private:
+    SquareMat lu;      // L מתחת לאלכסון, U על האלכסון ומעליו
+    int* piv;          // piv[i] = השורה שהוחלפה עם i בשלב i
+    int n;
+    int sign;          // זוגיות התמורה (±1)
+    bool singular;
+
+    void factor();
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    explicit LU(const SquareMat& A);
+    LU(const LU& other);
+    LU& operator=(const LU& other);
+    ~LU();
+
+    // ---------- תוצאות ----------
+    bool isSingular() const;
+    const SquareMat& factors() const;
+    double determinant() const;
+
+    void solveInPlace(double* b) const;
+    SquareMat solve(const SquareMat& B) const;
+    SquareMat inverse() const;
+};
+
+} // namespace matrix
+
+#endif // LU_HPP
@@ -0,0 +1,148 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "SquareMat.hpp"
+#include "Serialize.hpp"
+#include <bit>         // std::endian
+#include <stdexcept>   // std::invalid_argument, std::runtime_error
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap, madvise
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+using namespace matrix;
+
+namespace {
+
+int adviceFor(Access hint)
+{
+    switch (hint) {
+    case Access::Sequential: return MADV_SEQUENTIAL;
+    case Access::Random:     return MADV_RANDOM;
+    case Access::WillNeed:   return MADV_WILLNEED;
+    default:                 return MADV_NORMAL;
+    }
+}
+
+[[noreturn]] void fail(const std::string& path, const std::string& why)
+{
+    throw std::runtime_error("cannot map " + path + ": " + why);
+}
+
+/** @brief A whole-file mapping, unmapped on scope exit unless released. */
+struct Mapping {
+    void* base = nullptr;
+    std::size_t size = 0;
+    ~Mapping() { if (base) ::munmap(base, size); }
+};
+
+/** @brief Map all of @p path: shared read-only or private copy-on-write. */
+void mapWhole(const std::string& path, bool ro, Mapping& m)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) fail(path, "cannot open");
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        fail(path, "empty or unreadable file");
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, ro ? PROT_READ : PROT_READ | PROT_WRITE,
+                        ro ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    ::close(fd);                                  // המיפוי נשאר תקף
+    if (base == MAP_FAILED) fail(path, "mmap failed");
+    m.base = base;
+    m.size = size;
+}
+
+} // namespace
+
+/* ====================================================================
+   Mapped storage
+   ================================================================= */
+
+/** @brief Adopt an existing mapping; @p data points inside it. */
+SquareMat::SquareMat(int n_, double* data_, void* base, std::size_t bytes, bool ro)
+    : data(data_), n(n_), mapBase(base), mapBytes(bytes), readOnly(ro), numaPlaced(false) {}
+
+/** @brief Free heap storage or unmap the file (or NUMA-placed buffer);
+ *  leaves the object empty.                                            */
+void SquareMat::release()
+{
+    if (mapBase) ::munmap(mapBase, mapBytes);
+    else delete[] data;
+    data = nullptr;
+    mapBase = nullptr;
+    mapBytes = 0;
+    readOnly = false;
+    numaPlaced = false;
+}
+
+/** @brief Map a file written by saveBinary() and use its payload in place.
+ *
+ *  Opening costs one header read: pages fault in lazily on first touch
+ *  and are shared through the page cache by every process mapping the
+ *  same file.
+ *   - MapMode::ReadOnly – shared, read-only pages.  Compound operators
+ *     throw; writing through operator(), operator[] or raw() faults.
+ *   - MapMode::Private  – copy-on-write: writes go to private copies of
+ *     the touched pages and never reach the file.
+ *  Copies and assignments from a mapped matrix produce ordinary heap
+ *  matrices.  @p verify checksums the whole payload, which touches
+ *  every page.
+ *  @throw std::runtime_error if the file cannot be opened or mapped, is
+ *         not a valid binary matrix, is truncated, fails verification,
+ *         or the host is big-endian (the payload is little endian)      */
+SquareMat SquareMat::mapFile(const std::string& path, MapMode mode, Access hint, bool verify)
+{
+    if constexpr (std::endian::native != std::endian::little)
+        fail(path, "payload byte order differs from this host");
+
+    const bool ro = (mode == MapMode::ReadOnly);
+    Mapping m;
+    mapWhole(path, ro, m);
+    if (m.size < BINARY_HEADER_BYTES) fail(path, "truncated header");
+
+    const BinaryHeader h = decodeHeader(static_cast<const unsigned char*>(m.base));
+    if (m.size - BINARY_HEADER_BYTES < h.payloadBytes) fail(path, "truncated payload");
+    double* payload = reinterpret_cast<double*>(static_cast<unsigned char*>(m.base) + BINARY_HEADER_BYTES);
+    ::madvise(m.base, m.size, adviceFor(hint));
+    if (verify && checksum(payload, h.n * h.n) != h.checksum) fail(path, "payload checksum mismatch");
+
+    void* base = m.base;
+    m.base = nullptr;                             // מעכשיו המטריצה אחראית למיפוי
+    return SquareMat(static_cast<int>(h.n), payload, base, m.size, ro);
+}
+
+/** @brief Map n×n native-order doubles stored row-major at byte @p offset
+ *  of any file (e.g. the payload of a .npy file), with the same modes
+ *  and hints as mapFile().
+ *  @throw std::invalid_argument if n ≤ 0, n > MAX_N (operators index
+ *         n*n as int) or @p offset is not a multiple of sizeof(double)
+ *  @throw std::runtime_error if the file cannot be mapped or is too short */
+SquareMat SquareMat::mapRaw(const std::string& path, int n, std::size_t offset,
+                            MapMode mode, Access hint)
+{
+    if (n <= 0) throw std::invalid_argument("n must be positive");
+    if (n > MAX_N) throw std::invalid_argument("matrix dimension too large");
+    if (offset % sizeof(double) != 0) throw std::invalid_argument("misaligned payload offset");
+
+    const bool ro = (mode == MapMode::ReadOnly);
+    Mapping m;
+    mapWhole(path, ro, m);
+    const std::size_t bytes = static_cast<std::size_t>(n) * n * sizeof(double);
+    if (m.size < offset || m.size - offset < bytes) fail(path, "truncated payload");
+    ::madvise(m.base, m.size, adviceFor(hint));
+
+    void* base = m.base;
+    m.base = nullptr;
+    return SquareMat(n, reinterpret_cast<double*>(static_cast<unsigned char*>(base) + offset),
+                     base, m.size, ro);
+}
+
+bool SquareMat::isMapped() const { return mapBase != nullptr && !numaPlaced; }
+bool SquareMat::isReadOnly() const { return readOnly; }
+
+/** @brief Pass an access-pattern hint to the kernel (no-op on heap storage). */
+void SquareMat::advise(Access hint) const
+{
+    if (mapBase) ::madvise(mapBase, mapBytes, adviceFor(hint));
+}
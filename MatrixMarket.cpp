@@ -0,0 +1,451 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "MatrixMarket.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::min, std::max, std::copy
+#include <cctype>      // std::tolower, std::isspace
+#include <charconv>    // std::from_chars, std::to_chars
+#include <climits>     // INT_MAX
+#include <cstring>     // std::memchr, std::memmove
+#include <fstream>     // std::ofstream
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::runtime_error
+#include <vector>
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap, madvise
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Text handed to one parse task. */
+constexpr std::size_t PART_BYTES = std::size_t(4) << 20;
+
+/** @brief Output produced per os.write call. */
+constexpr long BATCH_BYTES = 8L << 20;
+
+/** @brief Worst case of one "i j value\n" line (two ints, one double). */
+constexpr long LINE_MAX_BYTES = 64;
+
+/** @brief Outer indices (rows or columns) formatted by one task. */
+constexpr int OUTER_BLOCK = 64;
+
+enum class Symmetry { General, Symmetric, Skew };
+
+struct Banner {
+    bool coordinate;
+    bool pattern;
+    Symmetry sym;
+    int n;
+    long entries;          // שורות נתונים צפויות בגוף הקובץ
+    const char* body;
+};
+
+/** @brief Entries parsed by one task, symmetric mirrors already added. */
+struct Part {
+    std::vector<int> rows, cols;
+    std::vector<double> vals;
+    long lines = 0;
+};
+
+[[noreturn]] void bad(const std::string& what)
+{
+    throw std::runtime_error("bad Matrix Market file: " + what);
+}
+
+/** @brief Read-only private mapping of a whole text file. */
+struct TextFile {
+    const char* begin = nullptr;
+    std::size_t size = 0;
+
+    explicit TextFile(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("cannot open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            bad("empty or unreadable file");
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+        ::madvise(base, size, MADV_SEQUENTIAL);
+        begin = static_cast<const char*>(base);
+    }
+    TextFile(const TextFile&) = delete;
+    TextFile& operator=(const TextFile&) = delete;
+    ~TextFile() { ::munmap(const_cast<char*>(begin), size); }
+};
+
+const char* lineEnd(const char* p, const char* end)
+{
+    const void* nl = std::memchr(p, '\n', end - p);
+    return nl ? static_cast<const char*>(nl) : end;
+}
+
+const char* skipBlank(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+const char* readLong(const char* p, const char* end, long& v)
+{
+    p = skipBlank(p, end);
+    const std::from_chars_result r = std::from_chars(p, end, v);
+    if (r.ec != std::errc()) bad("malformed integer");
+    return r.ptr;
+}
+
+const char* readDouble(const char* p, const char* end, double& v)
+{
+    p = skipBlank(p, end);
+    if (p < end && *p == '+') ++p;
+    const std::from_chars_result r = std::from_chars(p, end, v);
+    if (r.ec != std::errc()) bad("malformed value");
+    return r.ptr;
+}
+
+/** @brief Parse the banner, comments and size line.
+ *  @throw std::runtime_error for anything but a square real/integer/
+ *         pattern matrix with general or (skew-)symmetric storage     */
+Banner readBanner(const char* p, const char* end)
+{
+    const char* e = lineEnd(p, end);
+    std::vector<std::string> tok;
+    for (const char* q = p; q < e;) {
+        while (q < e && std::isspace(static_cast<unsigned char>(*q))) ++q;
+        const char* s = q;
+        while (q < e && !std::isspace(static_cast<unsigned char>(*q))) ++q;
+        if (q > s) {
+            std::string t(s, q);
+            for (char& c : t) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            tok.push_back(t);
+        }
+    }
+    if (tok.size() != 5 || tok[0] != "%%matrixmarket" || tok[1] != "matrix") bad("missing banner");
+
+    Banner b;
+    if (tok[2] == "coordinate") b.coordinate = true;
+    else if (tok[2] == "array") b.coordinate = false;
+    else bad("unknown format " + tok[2]);
+    if (tok[3] != "real" && tok[3] != "integer" && tok[3] != "pattern") bad("unsupported field " + tok[3]);
+    b.pattern = (tok[3] == "pattern");
+    if (b.pattern && !b.coordinate) bad("pattern field needs coordinate format");
+    if (tok[4] == "general") b.sym = Symmetry::General;
+    else if (tok[4] == "symmetric") b.sym = Symmetry::Symmetric;
+    else if (tok[4] == "skew-symmetric") b.sym = Symmetry::Skew;
+    else bad("unsupported symmetry " + tok[4]);
+
+    // הערות ושורות ריקות עד שורת הגודל
+    p = e;
+    for (;;) {
+        if (p < end) ++p;
+        if (p >= end) bad("missing size line");
+        e = lineEnd(p, end);
+        const char* q = skipBlank(p, e);
+        if (q < e && *q != '%') break;
+        p = e;
+    }
+
+    long rows, cols, nnz = 0;
+    const char* q = readLong(p, e, rows);
+    q = readLong(q, e, cols);
+    if (b.coordinate) q = readLong(q, e, nnz);
+    if (skipBlank(q, e) != e) bad("malformed size line");
+    if (rows != cols) bad("matrix is not square");
+    if (rows <= 0 || rows > INT_MAX) bad("invalid dimension");
+    if (nnz < 0) bad("invalid entry count");
+
+    b.n = static_cast<int>(rows);
+    const long n = rows;
+    if (b.coordinate) b.entries = nnz;
+    else if (b.sym == Symmetry::General) b.entries = n * n;
+    else if (b.sym == Symmetry::Symmetric) b.entries = n * (n + 1) / 2;
+    else b.entries = n * (n - 1) / 2;
+    b.body = (e < end) ? e + 1 : end;
+    return b;
+}
+
+/** @brief Parse the data lines in [p, end).  Coordinate entries land in
+ *  rows/cols/vals (0-based, mirrored for symmetric storage); array
+ *  values land in vals in file order.                                */
+void parsePart(const char* p, const char* end, const Banner& b, Part& out)
+{
+    while (p < end) {
+        p = skipBlank(p, end);
+        if (p == end) break;
+        if (*p == '\n') { ++p; continue; }
+        if (*p == '%') { p = lineEnd(p, end); continue; }
+
+        double v = 1.0;
+        if (b.coordinate) {
+            long i, j;
+            p = readLong(p, end, i);
+            p = readLong(p, end, j);
+            if (!b.pattern) p = readDouble(p, end, v);
+            if (i < 1 || i > b.n || j < 1 || j > b.n) bad("index out of range");
+            out.rows.push_back(static_cast<int>(i - 1));
+            out.cols.push_back(static_cast<int>(j - 1));
+            out.vals.push_back(v);
+            if (b.sym != Symmetry::General && i != j) {
+                out.rows.push_back(static_cast<int>(j - 1));
+                out.cols.push_back(static_cast<int>(i - 1));
+                out.vals.push_back(b.sym == Symmetry::Skew ? -v : v);
+            }
+        } else {
+            p = readDouble(p, end, v);
+            out.vals.push_back(v);
+        }
+        ++out.lines;
+        p = skipBlank(p, end);
+        if (p < end && *p != '\n') bad("trailing characters on a data line");
+    }
+}
+
+/** @brief Split the body at line boundaries and parse the pieces on the
+ *  thread pool; pieces come back in file order.                       */
+std::vector<Part> parseBody(const Banner& b, const char* end)
+{
+    const std::size_t bytes = end - b.body;
+    const int parts = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(
+        bytes / PART_BYTES + 1, 64 * static_cast<std::size_t>(ThreadPool::instance().size()))));
+    std::vector<const char*> cut(parts + 1);
+    cut[0] = b.body;
+    cut[parts] = end;
+    for (int k = 1; k < parts; ++k) {
+        const char* c = std::max(cut[k - 1], b.body + bytes * k / parts);
+        if (c == b.body || c == end || c[-1] == '\n') {
+            cut[k] = c;
+        } else {
+            const char* e = lineEnd(c, end);
+            cut[k] = (e < end) ? e + 1 : end;
+        }
+    }
+
+    std::vector<Part> out(parts);
+    ThreadPool::instance().parallelFor(0, parts, [&](int k) { parsePart(cut[k], cut[k + 1], b, out[k]); });
+
+    long lines = 0;
+    for (const Part& pt : out) lines += pt.lines;
+    if (lines != b.entries)
+        bad("expected " + std::to_string(b.entries) + " entries, found " + std::to_string(lines));
+    return out;
+}
+
+/** @brief Row and column of the @p t-th stored value of an array file
+ *  (column-major; lower triangle from the diagonal, or below it for
+ *  skew-symmetric).                                                    */
+void locate(long t, int n, Symmetry sym, int& i, int& j)
+{
+    if (sym == Symmetry::General) {
+        i = static_cast<int>(t % n);
+        j = static_cast<int>(t / n);
+        return;
+    }
+    const int skip = (sym == Symmetry::Skew) ? 1 : 0;
+    j = 0;
+    for (long len = n - skip; t >= len; len = n - j - skip) {
+        t -= len;
+        ++j;
+    }
+    i = j + skip + static_cast<int>(t);
+}
+
+/**
+ * Format units [0, count) and write them in order, in batches of about
+ * BATCH_BYTES.  Each unit is formatted by a pool task into its own slot
+ * of bound(u) bytes; the slots are then compacted in order, so the text
+ * is identical to a serial write.
+ */
+template <class Bound, class Fill>
+void writeUnits(std::ostream& os, int count, Bound bound, Fill fill)
+{
+    std::vector<char> buf;
+    std::vector<long> slot, len;
+    for (int u0 = 0; u0 < count;) {
+        int u1 = u0;
+        long total = 0;
+        slot.clear();
+        while (u1 < count && (u1 == u0 || total + bound(u1) <= BATCH_BYTES)) {
+            slot.push_back(total);
+            total += bound(u1++);
+        }
+        if (buf.size() < static_cast<std::size_t>(total)) buf.resize(total);
+        len.assign(u1 - u0, 0);
+        ThreadPool::instance().parallelFor(u0, u1, [&](int u) {
+            char* s = buf.data() + slot[u - u0];
+            len[u - u0] = fill(u, s) - s;
+        });
+        char* out = buf.data();
+        for (int u = u0; u < u1; ++u) {                  // דחיסה לפי הסדר
+            std::memmove(out, buf.data() + slot[u - u0], len[u - u0]);
+            out += len[u - u0];
+        }
+        os.write(buf.data(), out - buf.data());
+        u0 = u1;
+    }
+}
+
+char* putIndex(char* p, int i)
+{
+    return std::to_chars(p, p + 12, i + 1).ptr;
+}
+
+char* putValue(char* p, double v)
+{
+    return std::to_chars(p, p + 32, v).ptr;
+}
+
+} // namespace
+
+namespace matrix {
+
+/** @brief Load a .mtx file into a dense matrix.
+ *
+ *  The file is memory-mapped and its body split at line boundaries into
+ *  pieces of about 4 MiB, each parsed with std::from_chars by a pool
+ *  task.  Duplicate coordinate entries are summed.
+ *  @throw std::runtime_error if the file cannot be read or is malformed,
+ *         not square, larger than SquareMat::MAX_N (such files load
+ *         only through loadMatrixMarketSparse), or uses an unsupported
+ *         field or symmetry                                            */
+SquareMat loadMatrixMarket(const std::string& path)
+{
+    const TextFile f(path);
+    const char* end = f.begin + f.size;
+    const Banner b = readBanner(f.begin, end);
+    if (b.n > SquareMat::MAX_N) bad("matrix too large for a dense SquareMat; use loadMatrixMarketSparse");
+    const std::vector<Part> parts = parseBody(b, end);
+
+    const int n = b.n;
+    SquareMat m(n, 0.0);
+    double* a = m.raw();
+    if (b.coordinate) {
+        for (const Part& pt : parts)
+            for (std::size_t k = 0; k < pt.vals.size(); ++k)
+                a[static_cast<long>(pt.rows[k]) * n + pt.cols[k]] += pt.vals[k];
+        return m;
+    }
+
+    std::vector<long> first(parts.size(), 0);
+    for (std::size_t k = 1; k < parts.size(); ++k) first[k] = first[k - 1] + parts[k - 1].lines;
+    ThreadPool::instance().parallelFor(0, static_cast<int>(parts.size()), [&](int k) {
+        int i, j;
+        locate(first[k], n, b.sym, i, j);
+        for (double v : parts[k].vals) {
+            a[static_cast<long>(i) * n + j] = v;
+            if (b.sym != Symmetry::General) a[static_cast<long>(j) * n + i] = (b.sym == Symmetry::Skew) ? -v : v;
+            if (++i == n) {
+                ++j;
+                i = (b.sym == Symmetry::General) ? 0 : j + (b.sym == Symmetry::Skew ? 1 : 0);
+            }
+        }
+    });
+    return m;
+}
+
+/** @brief Load a .mtx file straight into sparse storage (array files
+ *  are read densely and then compressed, dropping zeros).
+ *  @throw std::runtime_error as loadMatrixMarket()                    */
+SparseMat loadMatrixMarketSparse(const std::string& path, SparseFormat fmt)
+{
+    const TextFile f(path);
+    const char* end = f.begin + f.size;
+    const Banner b = readBanner(f.begin, end);
+    if (!b.coordinate) return SparseMat(loadMatrixMarket(path), fmt);
+    const std::vector<Part> parts = parseBody(b, end);
+
+    std::vector<long> first(parts.size() + 1, 0);
+    for (std::size_t k = 0; k < parts.size(); ++k) first[k + 1] = first[k] + static_cast<long>(parts[k].vals.size());
+    const long total = first.back();
+    std::unique_ptr<int[]> rows(new int[total]), cols(new int[total]);
+    std::unique_ptr<double[]> vals(new double[total]);
+    ThreadPool::instance().parallelFor(0, static_cast<int>(parts.size()), [&](int k) {
+        const Part& pt = parts[k];
+        std::copy(pt.rows.begin(), pt.rows.end(), rows.get() + first[k]);
+        std::copy(pt.cols.begin(), pt.cols.end(), cols.get() + first[k]);
+        std::copy(pt.vals.begin(), pt.vals.end(), vals.get() + first[k]);
+    });
+    return SparseMat(b.n, total, rows.get(), cols.get(), vals.get(), fmt);
+}
+
+/** @brief Write @p m as "array real general" (column-major, one value
+ *  per line), columns formatted in parallel.
+ *  @throw std::runtime_error if the stream fails                       */
+void saveMatrixMarket(const SquareMat& m, std::ostream& os)
+{
+    const int n = m.getN();
+    const double* a = m.raw();
+    os << "%%MatrixMarket matrix array real general\n" << n << ' ' << n << '\n';
+    writeUnits(os, n, [&](int) { return 33L * n; }, [&](int j, char* p) {
+        for (int i = 0; i < n; ++i) {
+            p = putValue(p, a[static_cast<long>(i) * n + j]);
+            *p++ = '\n';
+        }
+        return p;
+    });
+    if (!os) throw std::runtime_error("failed to write Matrix Market file");
+}
+
+/** @throw std::runtime_error if the file cannot be created or written */
+void saveMatrixMarket(const SquareMat& m, const std::string& path)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    saveMatrixMarket(m, f);
+}
+
+/** @brief Write @p m as "coordinate real general", in storage order
+ *  (by row for CSR, by column for CSC).
+ *  @throw std::runtime_error if the stream fails                       */
+void saveMatrixMarket(const SparseMat& m, std::ostream& os)
+{
+    const int n = m.getN();
+    const long* outer = m.outerIndex();
+    const int* inner = m.innerIndex();
+    const double* vals = m.values();
+    const bool csr = (m.format() == SparseFormat::CSR);
+    os << "%%MatrixMarket matrix coordinate real general\n"
+       << n << ' ' << n << ' ' << m.nonZeros() << '\n';
+
+    const int blocks = (n + OUTER_BLOCK - 1) / OUTER_BLOCK;
+    auto range = [&](int blk, int& o0, int& o1) {
+        o0 = blk * OUTER_BLOCK;
+        o1 = std::min(n, o0 + OUTER_BLOCK);
+    };
+    writeUnits(os, blocks,
+        [&](int blk) {
+            int o0, o1;
+            range(blk, o0, o1);
+            return (outer[o1] - outer[o0]) * LINE_MAX_BYTES;
+        },
+        [&](int blk, char* p) {
+            int o0, o1;
+            range(blk, o0, o1);
+            for (int o = o0; o < o1; ++o)
+                for (long k = outer[o]; k < outer[o + 1]; ++k) {
+                    p = putIndex(p, csr ? o : inner[k]);
+                    *p++ = ' ';
+                    p = putIndex(p, csr ? inner[k] : o);
+                    *p++ = ' ';
+                    p = putValue(p, vals[k]);
+                    *p++ = '\n';
+                }
+            return p;
+        });
+    if (!os) throw std::runtime_error("failed to write Matrix Market file");
+}
+
+/** @throw std::runtime_error if the file cannot be created or written */
+void saveMatrixMarket(const SparseMat& m, const std::string& path)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    saveMatrixMarket(m, f);
+}
+
+} // namespace matrix
@@ -0,0 +1,34 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef MATRIXMARKET_HPP
+#define MATRIXMARKET_HPP
+
+#include "SquareMat.hpp"
+#include "SparseMat.hpp"
+#include <iostream>
+#include <string>
+
+namespace matrix {
+
+/*
+ * Matrix Market exchange format (.mtx) for square real matrices.
+ * Reading accepts the "coordinate" and "array" formats, the "real",
+ * "integer" and "pattern" fields, and "general", "symmetric" and
+ * "skew-symmetric" storage; symmetric halves are expanded.  Writing
+ * produces "array real general" for a SquareMat and "coordinate real
+ * general" for a SparseMat, every value in its shortest round-trip form.
+ */
+
+// ---------- קריאה (פענוח מקבילי עם std::from_chars) ----------
+SquareMat loadMatrixMarket(const std::string& path);
+SparseMat loadMatrixMarketSparse(const std::string& path, SparseFormat fmt = SparseFormat::CSR);
+
+// ---------- כתיבה ----------
+void saveMatrixMarket(const SquareMat& m, std::ostream& os);
+void saveMatrixMarket(const SquareMat& m, const std::string& path);
+void saveMatrixMarket(const SparseMat& m, std::ostream& os);
+void saveMatrixMarket(const SparseMat& m, const std::string& path);
+
+} // namespace matrix
+
+#endif // MATRIXMARKET_HPP
@@ -0,0 +1,251 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Npy.hpp"
+#include <algorithm>   // std::min, std::reverse, std::copy
+#include <bit>         // std::endian
+#include <climits>     // INT_MAX
+#include <cstdint>     // std::int32_t, std::int64_t
+#include <cstring>     // std::memcmp, std::memcpy
+#include <fstream>     // std::ifstream, std::ofstream
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::runtime_error
+
+using namespace matrix;
+
+namespace {
+
+constexpr char MAGIC[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+
+/** @brief Header plus padding is a multiple of this, so the payload is
+ *  64-byte aligned (NumPy itself pads to 64 since 1.18).               */
+constexpr std::size_t ALIGN = 64;
+
+/** @brief Elements moved per read/write call (8 MiB of doubles). */
+constexpr std::size_t CHUNK = std::size_t(1) << 20;
+
+constexpr bool NATIVE_LITTLE = (std::endian::native == std::endian::little);
+
+struct NpyHeader {
+    char kind;             // 'f' או 'i'
+    int size;              // בתים לאיבר
+    bool little;
+    bool fortran;
+    int n;
+    std::size_t dataOffset;
+};
+
+[[noreturn]] void bad(const std::string& what)
+{
+    throw std::runtime_error("bad .npy file: " + what);
+}
+
+/** @brief Position just past "'key':" and any blanks in the header dict. */
+std::size_t valueOf(const std::string& h, const char* key)
+{
+    std::size_t p = h.find(std::string("'") + key + "'");
+    if (p == std::string::npos) bad(std::string("missing '") + key + "'");
+    p = h.find(':', p);
+    if (p == std::string::npos) bad("malformed header");
+    ++p;
+    while (p < h.size() && h[p] == ' ') ++p;
+    return p;
+}
+
+long parseInt(const std::string& h, std::size_t& p)
+{
+    while (p < h.size() && h[p] == ' ') ++p;
+    long v = 0;
+    bool any = false;
+    for (; p < h.size() && h[p] >= '0' && h[p] <= '9'; ++p) {
+        v = v * 10 + (h[p] - '0');
+        if (v > INT_MAX) bad("shape too large");
+        any = true;
+    }
+    if (!any) bad("malformed shape");
+    return v;
+}
+
+/** @brief Read and parse the magic, version and header dict.
+ *  @throw std::runtime_error for anything but a square 2-D array of a
+ *         supported dtype with n ≤ SquareMat::MAX_N                  */
+NpyHeader readHeader(std::istream& is)
+{
+    unsigned char pre[10];
+    is.read(reinterpret_cast<char*>(pre), 10);
+    if (is.gcount() != 10 || std::memcmp(pre, MAGIC, 6) != 0) bad("not a .npy file");
+    const int major = pre[6];
+    if (major < 1 || major > 3) bad("unsupported version");
+
+    std::size_t len = pre[8] | (std::size_t(pre[9]) << 8), prefix = 10;
+    if (major >= 2) {
+        unsigned char more[2];
+        is.read(reinterpret_cast<char*>(more), 2);
+        if (is.gcount() != 2) bad("truncated header");
+        len |= (std::size_t(more[0]) << 16) | (std::size_t(more[1]) << 24);
+        prefix = 12;
+    }
+    std::string h(len, '\0');
+    is.read(h.data(), static_cast<std::streamsize>(len));
+    if (is.gcount() != static_cast<std::streamsize>(len)) bad("truncated header");
+
+    NpyHeader out;
+    std::size_t p = valueOf(h, "descr");
+    const char quote = h[p];
+    const std::size_t close = h.find(quote, p + 1);
+    if ((quote != '\'' && quote != '"') || close == std::string::npos || close - p < 4)
+        bad("malformed descr");
+    const std::string descr = h.substr(p + 1, close - p - 1);
+    out.little = (descr[0] == '<') || (descr[0] == '=' && NATIVE_LITTLE) || descr[0] == '|';
+    if (descr[0] != '<' && descr[0] != '>' && descr[0] != '=' && descr[0] != '|') bad("malformed descr");
+    out.kind = descr[1];
+    const std::string size = descr.substr(2);
+    out.size = (size == "4") ? 4 : (size == "8") ? 8 : 0;
+    if ((out.kind != 'f' && out.kind != 'i') || out.size == 0) bad("unsupported dtype " + descr);
+
+    p = valueOf(h, "fortran_order");
+    if (h.compare(p, 4, "True") == 0) out.fortran = true;
+    else if (h.compare(p, 5, "False") == 0) out.fortran = false;
+    else bad("malformed fortran_order");
+
+    p = valueOf(h, "shape");
+    if (h[p] != '(') bad("malformed shape");
+    ++p;
+    const long rows = parseInt(h, p);
+    while (p < h.size() && (h[p] == ' ' || h[p] == ',')) ++p;
+    const long cols = parseInt(h, p);
+    while (p < h.size() && (h[p] == ' ' || h[p] == ',')) ++p;
+    if (p >= h.size() || h[p] != ')') bad("expected a 2-D array");
+    if (rows != cols || rows == 0) bad("expected a non-empty square array");
+    if (rows > SquareMat::MAX_N) bad("array too large for a SquareMat");
+
+    out.n = static_cast<int>(rows);
+    out.dataOffset = prefix + len;
+    return out;
+}
+
+/** @brief Convert @p count stored elements of type @p T to doubles. */
+template <class T>
+void convert(const unsigned char* src, std::size_t count, bool swap, double* dst)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned char b[sizeof(T)];
+        std::memcpy(b, src + i * sizeof(T), sizeof(T));
+        if (swap) std::reverse(b, b + sizeof(T));
+        T v;
+        std::memcpy(&v, b, sizeof(T));
+        dst[i] = static_cast<double>(v);
+    }
+}
+
+bool mappable(const NpyHeader& h)
+{
+    return NATIVE_LITTLE && h.kind == 'f' && h.size == 8 && h.little && !h.fortran &&
+           h.dataOffset % sizeof(double) == 0;
+}
+
+} // namespace
+
+namespace matrix {
+
+/** @brief Write @p m as a version 1.0 '<f8' C-order .npy file.
+ *  @throw std::runtime_error if the stream fails                       */
+void saveNpy(const SquareMat& m, std::ostream& os)
+{
+    const int n = m.getN();
+    std::string dict = "{'descr': '<f8', 'fortran_order': False, 'shape': (" +
+                       std::to_string(n) + ", " + std::to_string(n) + "), }";
+    const std::size_t total = (10 + dict.size() + 1 + ALIGN - 1) / ALIGN * ALIGN;
+    dict.append(total - 10 - dict.size() - 1, ' ');
+    dict.push_back('\n');
+
+    const std::size_t len = dict.size();
+    const char pre[10] = {MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3], MAGIC[4], MAGIC[5], 1, 0,
+                          static_cast<char>(len & 0xff), static_cast<char>(len >> 8)};
+    os.write(pre, 10);
+    os.write(dict.data(), static_cast<std::streamsize>(len));
+
+    const std::size_t count = static_cast<std::size_t>(n) * n;
+    const double* a = m.raw();
+    std::unique_ptr<double[]> tmp(NATIVE_LITTLE ? nullptr : new double[CHUNK]);
+    for (std::size_t off = 0; off < count && os; off += CHUNK) {
+        const std::size_t k = std::min(CHUNK, count - off);
+        const double* src = a + off;
+        if (!NATIVE_LITTLE) {
+            convert<double>(reinterpret_cast<const unsigned char*>(src), k, true, tmp.get());
+            src = tmp.get();
+        }
+        os.write(reinterpret_cast<const char*>(src), static_cast<std::streamsize>(k * sizeof(double)));
+    }
+    if (!os) throw std::runtime_error("failed to write .npy");
+}
+
+/** @throw std::runtime_error if the file cannot be created or written */
+void saveNpy(const SquareMat& m, const std::string& path)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    saveNpy(m, f);
+}
+
+/** @brief Read a square .npy array into a new matrix.
+ *
+ *  Native-order float64 is read straight into the matrix buffer; other
+ *  dtypes and byte orders go through an 8 MiB staging buffer.  A
+ *  Fortran-order array is transposed once at the end.
+ *  @throw std::runtime_error on an unsupported or truncated file      */
+SquareMat loadNpy(std::istream& is)
+{
+    const NpyHeader h = readHeader(is);
+    SquareMat m(h.n);
+    double* a = m.raw();
+    const std::size_t count = static_cast<std::size_t>(h.n) * h.n;
+    const bool swap = (h.little != NATIVE_LITTLE);
+
+    if (h.kind == 'f' && h.size == 8 && !swap) {
+        for (std::size_t off = 0; off < count; off += CHUNK) {
+            const std::streamsize bytes = static_cast<std::streamsize>(std::min(CHUNK, count - off) * 8);
+            is.read(reinterpret_cast<char*>(a + off), bytes);
+            if (is.gcount() != bytes) bad("truncated payload");
+        }
+    } else {
+        std::unique_ptr<unsigned char[]> buf(new unsigned char[CHUNK * h.size]);
+        for (std::size_t off = 0; off < count; off += CHUNK) {
+            const std::size_t k = std::min(CHUNK, count - off);
+            const std::streamsize bytes = static_cast<std::streamsize>(k * h.size);
+            is.read(reinterpret_cast<char*>(buf.get()), bytes);
+            if (is.gcount() != bytes) bad("truncated payload");
+            if (h.kind == 'f' && h.size == 8) convert<double>(buf.get(), k, swap, a + off);
+            else if (h.kind == 'f') convert<float>(buf.get(), k, swap, a + off);
+            else if (h.size == 8) convert<std::int64_t>(buf.get(), k, swap, a + off);
+            else convert<std::int32_t>(buf.get(), k, swap, a + off);
+        }
+    }
+    if (h.fortran) m = ~m;
+    return m;
+}
+
+/** @throw std::runtime_error if the file cannot be opened or is invalid */
+SquareMat loadNpy(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    return loadNpy(f);
+}
+
+/** @brief Open a .npy file without copying when possible.
+ *
+ *  A C-order '<f8' array on a little-endian host is memory-mapped in
+ *  place (see SquareMat::mapFile for the meaning of @p mode and
+ *  @p hint); anything else is converted by loadNpy() into an ordinary
+ *  heap matrix, so isMapped() tells which path was taken.
+ *  @throw std::runtime_error if the file cannot be opened or is invalid */
+SquareMat mapNpy(const std::string& path, MapMode mode, Access hint)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    const NpyHeader h = readHeader(f);
+    if (!mappable(h)) return loadNpy(path);
+    f.close();
+    return SquareMat::mapRaw(path, h.n, h.dataOffset, mode, hint);
+}
+
+} // namespace matrix
@@ -0,0 +1,34 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef NPY_HPP
+#define NPY_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+#include <string>
+
+namespace matrix {
+
+/*
+ * NumPy .npy files (format versions 1.0–3.0) holding a square 2-D array.
+ * Writing always produces version 1.0, dtype '<f8', C order, with the
+ * header padded so the payload starts on a 64-byte boundary.  Reading
+ * accepts float64, float32, int64 and int32 in either byte order and
+ * either C or Fortran order, converting to double.
+ */
+
+// ---------- כתיבה ----------
+void saveNpy(const SquareMat& m, std::ostream& os);
+void saveNpy(const SquareMat& m, const std::string& path);
+
+// ---------- קריאה (העתקה לזיכרון) ----------
+SquareMat loadNpy(std::istream& is);
+SquareMat loadNpy(const std::string& path);
+
+// ---------- קריאה ללא העתקה: mmap כשהפורמט תואם, אחרת loadNpy ----------
+SquareMat mapNpy(const std::string& path, MapMode mode = MapMode::ReadOnly,
+                 Access hint = Access::Normal);
+
+} // namespace matrix
+
+#endif // NPY_HPP
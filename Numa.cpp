@@ -0,0 +1,201 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Numa.hpp"
+#include <algorithm>   // std::copy, std::fill
+#include <atomic>
+#include <cstdlib>     // std::getenv
+#include <cstring>     // std::strcmp
+#include <fstream>     // std::ifstream
+#include <new>         // std::bad_alloc
+#include <string>
+#include <thread>      // std::thread::hardware_concurrency
+#include <sys/mman.h>  // mmap
+#include <sys/syscall.h>
+#include <unistd.h>    // syscall, sysconf
+
+using namespace matrix;
+
+namespace {
+
+// מתוך <numaif.h> – בלי תלות ב-libnuma
+constexpr int MPOL_INTERLEAVE_ = 3;
+constexpr int MPOL_F_NODE_ = 1 << 0;
+constexpr int MPOL_F_ADDR_ = 1 << 1;
+constexpr int MASK_BITS = 1024;                  // MAX_NUMNODES של ליבות נפוצות
+
+std::atomic<int> policy{static_cast<int>(numa::Placement::Default)};
+std::atomic<std::size_t> minBytes{std::size_t(4) << 20};
+
+/** @brief Parse a sysfs list such as "0-3,8,10-11". */
+std::vector<int> parseList(const std::string& path)
+{
+    std::vector<int> out;
+    std::ifstream f(path);
+    std::string text;
+    if (!std::getline(f, text)) return out;
+    std::size_t p = 0;
+    while (p < text.size()) {
+        const std::size_t comma = text.find(',', p);
+        const std::string item = text.substr(p, comma == std::string::npos ? std::string::npos : comma - p);
+        p = (comma == std::string::npos) ? text.size() : comma + 1;
+        if (item.empty()) continue;
+        try {
+            const std::size_t dash = item.find('-');
+            const int lo = std::stoi(item.substr(0, dash));
+            const int hi = (dash == std::string::npos) ? lo : std::stoi(item.substr(dash + 1));
+            for (int v = lo; v <= hi; ++v) out.push_back(v);
+        } catch (...) {
+            return {};                                   // רשימה פגומה – כאילו אין מידע
+        }
+    }
+    return out;
+}
+
+const char* NODE_DIR = "/sys/devices/system/node/";
+
+std::vector<int> onlineNodes() { return parseList(std::string(NODE_DIR) + "online"); }
+
+/** @brief Nodes that own memory ("has_memory", else "online"). */
+std::vector<int> memoryNodes()
+{
+    std::vector<int> nodes = parseList(std::string(NODE_DIR) + "has_memory");
+    return nodes.empty() ? onlineNodes() : nodes;
+}
+
+/** @brief Spread the pages of [p, p+bytes) round-robin over every memory
+ *  node.  Failure (no NUMA support in the kernel) leaves the default
+ *  policy, which is still correct.                                    */
+void interleave(void* p, std::size_t bytes)
+{
+    unsigned long mask[MASK_BITS / (8 * sizeof(unsigned long))] = {};
+    bool any = false;
+    for (int node : memoryNodes())
+        if (node >= 0 && node < MASK_BITS) {
+            mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+            any = true;
+        }
+    if (any) ::syscall(SYS_mbind, p, bytes, MPOL_INTERLEAVE_, mask, MASK_BITS + 1, 0);
+}
+
+} // namespace
+
+/* ====================================================================
+   Topology
+   ================================================================= */
+
+/** @brief Online NUMA nodes (1 when sysfs has no node directory). */
+int numa::nodeCount()
+{
+    const std::size_t c = onlineNodes().size();
+    return c ? static_cast<int>(c) : 1;
+}
+
+/** @brief CPUs of @p node from sysfs; empty if the node is unknown. */
+std::vector<int> numa::cpusOfNode(int node)
+{
+    return parseList(std::string(NODE_DIR) + "node" + std::to_string(node) + "/cpulist");
+}
+
+/** @brief Every CPU, node by node – the order pinPool() spreads workers
+ *  over, so consecutive pool slots share a node.                      */
+std::vector<int> numa::cpuOrder()
+{
+    std::vector<int> cpus;
+    for (int node : onlineNodes()) {
+        const std::vector<int> c = cpusOfNode(node);
+        cpus.insert(cpus.end(), c.begin(), c.end());
+    }
+    if (cpus.empty()) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        for (unsigned c = 0; c < (hw ? hw : 1); ++c) cpus.push_back(static_cast<int>(c));
+    }
+    return cpus;
+}
+
+/** @brief Node holding the page at @p p (faulting it in if needed). */
+int numa::nodeOf(const void* p)
+{
+    int node = -1;
+    if (::syscall(SYS_get_mempolicy, &node, nullptr, 0UL, const_cast<void*>(p),
+                  MPOL_F_NODE_ | MPOL_F_ADDR_) != 0)
+        return -1;
+    return node;
+}
+
+/* ====================================================================
+   Policy
+   ================================================================= */
+
+/** @brief Select the placement policy for matrices of at least
+ *  @p thresholdBytes; smaller ones always use the heap.               */
+void numa::setPlacement(Placement p, std::size_t thresholdBytes)
+{
+    minBytes.store(thresholdBytes, std::memory_order_relaxed);
+    policy.store(static_cast<int>(p), std::memory_order_relaxed);
+}
+
+numa::Placement numa::placement() { return static_cast<Placement>(policy.load(std::memory_order_relaxed)); }
+
+std::size_t numa::threshold() { return minBytes.load(std::memory_order_relaxed); }
+
+/** @brief Pin @p pool's workers over cpuOrder(). */
+bool numa::pinPool(ThreadPool& pool)
+{
+    const std::vector<int> cpus = cpuOrder();
+    return pool.pinWorkers(cpus.data(), static_cast<int>(cpus.size()));
+}
+
+/* ====================================================================
+   Allocation
+   ================================================================= */
+
+/** @brief Map an anonymous rows×cols buffer, place it per placement()
+ *  and initialize it – row by row on the owning pool thread, so under
+ *  FirstTouch the first write (which decides the node) comes from the
+ *  thread that later computes on those rows.
+ *  @param bytes receives the mapped length (for munmap)
+ *  @return nullptr if the policy is Default or the buffer is below threshold()
+ *  @throw std::bad_alloc if the mapping fails                          */
+double* numa::allocate(std::size_t rows, std::size_t cols, const double* src, double fill,
+                       std::size_t& bytes)
+{
+    const Placement p = placement();
+    const std::size_t need = rows * cols * sizeof(double);
+    if (p == Placement::Default || need < threshold() || need == 0) return nullptr;
+
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    bytes = (need + page - 1) / page * page;
+    void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) throw std::bad_alloc();
+    if (p == Placement::Interleave) interleave(base, bytes);
+
+    double* data = static_cast<double*>(base);
+    ThreadPool::instance().parallelForStatic(0, static_cast<int>(rows), [&](int i) {
+        double* row = data + static_cast<std::size_t>(i) * cols;
+        if (src) std::copy(src + static_cast<std::size_t>(i) * cols, src + (i + 1) * cols, row);
+        else std::fill(row, row + cols, fill);
+    });
+    return data;
+}
+
+namespace {
+
+/** @brief Apply $SQUAREMAT_NUMA before main() runs. */
+struct PolicyFromEnv {
+    PolicyFromEnv()
+    {
+        const char* env = std::getenv("SQUAREMAT_NUMA");
+        if (!env) return;
+        try {
+            if (std::strcmp(env, "interleave") == 0) {
+                numa::setPlacement(numa::Placement::Interleave);
+            } else if (std::strcmp(env, "firsttouch") == 0) {
+                numa::setPlacement(numa::Placement::FirstTouch);
+                numa::pinPool();
+            }
+        } catch (...) {
+            // אין sysfs או הצמדה נכשלה – נשארים עם ברירת המחדל
+        }
+    }
+} policyFromEnv;
+
+} // namespace
@@ -0,0 +1,56 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include "ThreadPool.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace matrix {
+namespace numa {
+
+/*
+ * NUMA placement of large SquareMat buffers.  With the Default policy a
+ * matrix lives wherever the constructing thread first touches it – on a
+ * multi-socket host, one node's memory controller then serves every
+ * thread of a parallel product.  The other policies place buffers of at
+ * least threshold() bytes explicitly:
+ *
+ *   FirstTouch – each pool thread initializes its own contiguous share
+ *                of the rows (ThreadPool::parallelForStatic), so the
+ *                pages land on that thread's node; gemm then hands row
+ *                blocks to threads with the same static split.
+ *   Interleave – pages are spread round-robin over all memory nodes
+ *                (mbind MPOL_INTERLEAVE); even bandwidth, no locality.
+ *
+ * FirstTouch only pays off with pinned workers (pinPool()).  Uses the
+ * raw mbind/get_mempolicy system calls and sysfs – no libnuma needed.
+ * SQUAREMAT_NUMA=firsttouch|interleave sets the policy at load time;
+ * firsttouch also pins the global pool.
+ */
+
+enum class Placement { Default, FirstTouch, Interleave };
+
+// ---------- טופולוגיה ----------
+int nodeCount();                        // צמתים פעילים, 1 כשאין מידע
+std::vector<int> cpusOfNode(int node);
+std::vector<int> cpuOrder();            // כל המעבדים, מקובצים לפי צומת
+int nodeOf(const void* p);              // הצומת של הדף, -1 אם לא ידוע
+
+// ---------- מדיניות ----------
+void setPlacement(Placement p, std::size_t thresholdBytes = std::size_t(4) << 20);
+Placement placement();
+std::size_t threshold();
+bool pinPool(ThreadPool& pool = ThreadPool::instance());   // false אם ההצמדה נכשלה
+
+// ---------- הקצאה ----------
+// באפר rows×cols לפי המדיניות, מאותחל מ-src (אם לא nullptr) או ב-fill.
+// מחזיר nullptr כשהמדיניות Default או שהבאפר קטן מהסף; שחרור ב-munmap(p, bytes).
+double* allocate(std::size_t rows, std::size_t cols, const double* src, double fill,
+                 std::size_t& bytes);
+
+} // namespace numa
+} // namespace matrix
+
+#endif // NUMA_HPP
@@ -0,0 +1,269 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "OutOfCore.hpp"
+#include "Kernels.hpp"
+#include "Serialize.hpp"
+#include <algorithm>   // std::min
+#include <bit>         // std::endian
+#include <cerrno>      // errno, EINTR
+#include <chrono>      // std::chrono::steady_clock
+#include <condition_variable>
+#include <deque>
+#include <future>      // std::packaged_task, std::future
+#include <memory>      // std::unique_ptr
+#include <mutex>
+#include <stdexcept>   // std::invalid_argument, std::runtime_error
+#include <thread>
+#include <vector>
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // fstat, stat
+#include <unistd.h>    // pread, pwrite, close
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Closes the descriptor when it goes out of scope. */
+struct File {
+    int fd;
+    explicit File(int fd_) : fd(fd_) {}
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+    ~File() { if (fd >= 0) ::close(fd); }
+};
+
+/**
+ * A few threads that run blocking pread/pwrite calls in FIFO order.
+ * Queued jobs that have not started when the queue is destroyed are
+ * dropped; running ones finish first, so buffers declared before the
+ * queue outlive every transfer.
+ */
+class IoQueue {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::packaged_task<void()>> jobs;
+    std::mutex mtx;
+    std::condition_variable ready;
+    bool stopping = false;
+
+    void loop()
+    {
+        for (;;) {
+            std::packaged_task<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+public:
+    explicit IoQueue(int threads)
+    {
+        for (int t = 0; t < threads; ++t) workers.emplace_back([this] { loop(); });
+    }
+    IoQueue(const IoQueue&) = delete;
+    IoQueue& operator=(const IoQueue&) = delete;
+    ~IoQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (std::thread& w : workers) w.join();
+    }
+
+    template <class Fn>
+    std::future<void> submit(Fn fn)
+    {
+        std::packaged_task<void()> job(std::move(fn));
+        std::future<void> f = job.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            jobs.push_back(std::move(job));
+        }
+        ready.notify_one();
+        return f;
+    }
+};
+
+using Pending = std::vector<std::future<void>>;
+
+void readFully(int fd, char* buf, std::size_t bytes, off_t off)
+{
+    while (bytes > 0) {
+        const ssize_t got = ::pread(fd, buf, bytes, off);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) throw std::runtime_error("out-of-core read failed");
+        buf += got;
+        bytes -= static_cast<std::size_t>(got);
+        off += got;
+    }
+}
+
+void writeFully(int fd, const char* buf, std::size_t bytes, off_t off)
+{
+    while (bytes > 0) {
+        const ssize_t put = ::pwrite(fd, buf, bytes, off);
+        if (put < 0 && errno == EINTR) continue;
+        if (put <= 0) throw std::runtime_error("out-of-core write failed");
+        buf += put;
+        bytes -= static_cast<std::size_t>(put);
+        off += put;
+    }
+}
+
+/** @brief Queue a read (or write) of @p count doubles at payload
+ *  element @p first, split into one piece per I/O thread.            */
+Pending transfer(IoQueue& io, int pieces, bool write, int fd, double* buf,
+                 std::size_t count, std::size_t first)
+{
+    Pending out;
+    const std::size_t step = (count + pieces - 1) / pieces;
+    for (std::size_t s = 0; s < count; s += step) {
+        char* p = reinterpret_cast<char*>(buf + s);
+        const std::size_t bytes = std::min(step, count - s) * sizeof(double);
+        const off_t off = static_cast<off_t>(BINARY_HEADER_BYTES + (first + s) * sizeof(double));
+        out.push_back(io.submit([=] {
+            if (write) writeFully(fd, p, bytes, off);
+            else readFully(fd, p, bytes, off);
+        }));
+    }
+    return out;
+}
+
+void wait(Pending& p)
+{
+    for (std::future<void>& f : p) f.get();
+    p.clear();
+}
+
+/** @brief Open an input file and validate its header and size. */
+int openInput(const std::string& path, File& f, struct stat& st)
+{
+    f.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (f.fd < 0) throw std::runtime_error("cannot open " + path);
+    if (::fstat(f.fd, &st) != 0) throw std::runtime_error("cannot stat " + path);
+
+    unsigned char head[BINARY_HEADER_BYTES];
+    if (static_cast<std::size_t>(st.st_size) < BINARY_HEADER_BYTES)
+        throw std::runtime_error("bad matrix file: truncated header");
+    readFully(f.fd, reinterpret_cast<char*>(head), BINARY_HEADER_BYTES, 0);
+    const BinaryHeader h = decodeHeader(head);
+    if (static_cast<std::size_t>(st.st_size) - BINARY_HEADER_BYTES < h.payloadBytes)
+        throw std::runtime_error("bad matrix file: truncated payload");
+    return static_cast<int>(h.n);
+}
+
+} // namespace
+
+namespace matrix {
+
+/** @brief Out-of-core C = A·B on binary matrix files (see OutOfCore.hpp).
+ *
+ *  The budget is split into prefetchDepth strip buffers of B
+ *  (stripRows × n each) plus one panel each of A and C, whose height is
+ *  whatever remains.  Strips are numbered globally across panels, so
+ *  prefetching runs straight through panel boundaries; the A read and
+ *  the C write of each panel are split over the I/O threads but not
+ *  overlapped, as they move only 2n² doubles in total.  C's header is
+ *  written last, so an interrupted run never leaves a valid-looking file.
+ *  @throw std::invalid_argument on bad options, a budget too small for
+ *         one panel row, mismatched dimensions, or C aliasing an input
+ *  @throw std::runtime_error on I/O errors or invalid input files      */
+OutOfCoreStats multiplyFiles(const std::string& pathA, const std::string& pathB,
+                             const std::string& pathC, const OutOfCoreOptions& opt)
+{
+    if (opt.stripRows <= 0 || opt.prefetchDepth < 2 || opt.ioThreads <= 0)
+        throw std::invalid_argument("invalid out-of-core options");
+    if constexpr (std::endian::native != std::endian::little)
+        throw std::runtime_error("out-of-core multiply needs a little-endian host");
+
+    File fa(-1), fb(-1);
+    struct stat sa, sb, sc;
+    const int n = openInput(pathA, fa, sa);
+    if (openInput(pathB, fb, sb) != n) throw std::invalid_argument("dimension mismatch");
+    if (::stat(pathC.c_str(), &sc) == 0 &&
+        ((sc.st_dev == sa.st_dev && sc.st_ino == sa.st_ino) ||
+         (sc.st_dev == sb.st_dev && sc.st_ino == sb.st_ino)))
+        throw std::invalid_argument("output file aliases an input");
+
+    const std::size_t N = static_cast<std::size_t>(n);
+    const int kb = std::min(opt.stripRows, n);
+    const int depth = opt.prefetchDepth;
+    const std::size_t stripDoubles = static_cast<std::size_t>(kb) * N;
+    const std::size_t stripBytes = depth * stripDoubles * sizeof(double);
+    const std::size_t rowBytes = 2 * N * sizeof(double);           // A + C
+    if (opt.memoryBytes < stripBytes + rowBytes)
+        throw std::invalid_argument("memory budget too small for one panel row");
+    const int h = static_cast<int>(std::min<std::size_t>(N, (opt.memoryBytes - stripBytes) / rowBytes));
+
+    std::unique_ptr<double[]> aPanel(new double[h * N]);
+    std::unique_ptr<double[]> cPanel(new double[h * N]);
+    std::unique_ptr<double[]> strips(new double[depth * stripDoubles]);
+    std::vector<Pending> inFlight(depth);
+
+    File fc(::open(pathC.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (fc.fd < 0) throw std::runtime_error("cannot open " + pathC);
+
+    const int panels = (n + h - 1) / h;
+    const int nk = (n + kb - 1) / kb;
+    const long total = static_cast<long>(panels) * nk;
+    OutOfCoreStats st{h, panels, 0, 0, 0.0};
+    IoQueue io(opt.ioThreads);      // after the buffers: destroyed first
+
+    auto issue = [&](long t) {
+        if (t >= total) return;
+        const int k0 = static_cast<int>(t % nk) * kb;
+        const std::size_t count = static_cast<std::size_t>(std::min(kb, n - k0)) * N;
+        inFlight[t % depth] = transfer(io, opt.ioThreads, false, fb.fd,
+                                       strips.get() + (t % depth) * stripDoubles,
+                                       count, static_cast<std::size_t>(k0) * N);
+        st.bytesRead += count * sizeof(double);
+    };
+    for (long t = 0; t < depth; ++t) issue(t);
+
+    Checksum sum;
+    for (int p = 0; p < panels; ++p) {
+        const int r0 = p * h, rows = std::min(h, n - r0);
+        const std::size_t count = static_cast<std::size_t>(rows) * N;
+        Pending a = transfer(io, opt.ioThreads, false, fa.fd, aPanel.get(), count,
+                             static_cast<std::size_t>(r0) * N);
+        wait(a);
+        st.bytesRead += count * sizeof(double);
+
+        for (int k = 0; k < nk; ++k) {
+            const long t = static_cast<long>(p) * nk + k;
+            const auto start = std::chrono::steady_clock::now();
+            wait(inFlight[t % depth]);
+            st.ioWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const int k0 = k * kb;
+            kernels::gemm(rows, n, std::min(kb, n - k0), 1.0,
+                          aPanel.get() + k0, n, false,
+                          strips.get() + (t % depth) * stripDoubles, n, false,
+                          k == 0 ? 0.0 : 1.0, cPanel.get(), n);
+            issue(t + depth);
+        }
+
+        sum.update(reinterpret_cast<const std::uint64_t*>(cPanel.get()), count);
+        Pending c = transfer(io, opt.ioThreads, true, fc.fd, cPanel.get(), count,
+                             static_cast<std::size_t>(r0) * N);
+        wait(c);
+        st.bytesWritten += count * sizeof(double);
+    }
+
+    // version 1, float64, little endian, dense row-major
+    const BinaryHeader hc{1, 1, 1, 0, N, N * N * sizeof(double), sum.finish()};
+    unsigned char head[BINARY_HEADER_BYTES];
+    encodeHeader(hc, head);
+    writeFully(fc.fd, reinterpret_cast<const char*>(head), BINARY_HEADER_BYTES, 0);
+    st.bytesWritten += BINARY_HEADER_BYTES;
+    return st;
+}
+
+} // namespace matrix
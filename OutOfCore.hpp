@@ -0,0 +1,46 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef OUTOFCORE_HPP
+#define OUTOFCORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace matrix {
+
+// ---------- הגדרות לכפל מחוץ לזיכרון ----------
+struct OutOfCoreOptions {
+    std::size_t memoryBytes = std::size_t(1) << 30;   // תקציב זיכרון כולל לבאפרים
+    int stripRows = 256;       // שורות של B בכל רצועה נקראת
+    int prefetchDepth = 3;     // רצועות בזיכרון בו-זמנית (אחת בחישוב, השאר בקריאה)
+    int ioThreads = 2;         // חוטי pread/pwrite
+};
+
+struct OutOfCoreStats {
+    int panelRows;             // שורות של A ו-C בכל פאנל
+    int panels;
+    std::uint64_t bytesRead;
+    std::uint64_t bytesWritten;
+    double ioWaitSeconds;      // זמן שהחישוב המתין לקריאה
+};
+
+/**
+ * C = A·B for matrices stored in the binary file format (Serialize.hpp)
+ * that need not fit in memory.
+ *
+ * A and C are processed in row panels as tall as the memory budget
+ * allows; each panel of A is read once and each panel of C is written
+ * once, while B streams through in contiguous row strips — so B is read
+ * once per panel and the total I/O is about n²·(2 + n/panelRows) doubles.
+ * Strip reads run on a small pool of pread threads, prefetchDepth − 1
+ * strips ahead of the blocked GEMM, so I/O and compute overlap.
+ * @p pathC may not name either input.
+ */
+OutOfCoreStats multiplyFiles(const std::string& pathA, const std::string& pathB,
+                             const std::string& pathC,
+                             const OutOfCoreOptions& opt = OutOfCoreOptions());
+
+} // namespace matrix
+
+#endif // OUTOFCORE_HPP
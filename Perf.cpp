@@ -0,0 +1,349 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Perf.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <cstdlib>     // std::strtol
+#include <cstring>     // std::memset
+#include <fstream>     // std::ifstream
+#include <iomanip>     // std::setw
+#include <mutex>
+#include <sstream>     // std::ostringstream
+#include <vector>
+#include <dirent.h>    // opendir, readdir
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>    // syscall, read, close
+
+using namespace matrix::perf;
+using matrix::instrument::OP_COUNT;
+
+namespace {
+
+const char* const NAMES[EVENT_COUNT] = {
+    "cycles", "instructions", "L1D-misses", "LLC-misses", "dTLB-misses", "fp-ops", "task-clock"};
+
+/** @brief One thread's counter group; slot[e] is the event's position in
+ *  the group read, or -1 when it could not be opened.                  */
+struct Group {
+    int fds[EVENT_COUNT];
+    int slot[EVENT_COUNT];
+    int members;
+};
+
+struct State {
+    std::mutex mtx;
+    std::vector<Group> groups;
+    bool available[EVENT_COUNT] = {};
+    Profile profile{};
+};
+
+/** @brief Never destroyed (see instrument::registry). */
+State& state()
+{
+    static State* s = new State;
+    return *s;
+}
+
+std::atomic<bool> running{false};
+std::atomic<unsigned> sessions{0};             // גדל בכל start()/stop()
+thread_local int depth[OP_COUNT] = {};
+
+std::atomic<int> openScopes{0};                // Scopes חמושים בכל החוטים
+std::atomic<unsigned> overlapCount{0};         // גדל כשנפתח Scope בזמן ש-Scope בחוט אחר פתוח
+thread_local int threadScopes = 0;             // Scopes חמושים בחוט הזה
+
+std::string cpuVendor()
+{
+    std::ifstream f("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(f, line))
+        if (line.rfind("vendor_id", 0) == 0) return line.substr(line.find(':') + 2);
+    return "";
+}
+
+/** @brief perf_event_attr for @p e, or false if this CPU has no such event. */
+bool describe(Event e, perf_event_attr& a)
+{
+    std::memset(&a, 0, sizeof a);
+    a.size = sizeof a;
+    a.exclude_kernel = 1;                      // עובד גם עם perf_event_paranoid = 2
+    a.exclude_hv = 1;
+    a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    const auto cacheMiss = [](unsigned cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+    switch (e) {
+    case Event::Cycles:       a.type = PERF_TYPE_HARDWARE; a.config = PERF_COUNT_HW_CPU_CYCLES; return true;
+    case Event::Instructions: a.type = PERF_TYPE_HARDWARE; a.config = PERF_COUNT_HW_INSTRUCTIONS; return true;
+    case Event::L1DMisses:    a.type = PERF_TYPE_HW_CACHE; a.config = cacheMiss(PERF_COUNT_HW_CACHE_L1D); return true;
+    case Event::LLCMisses:    a.type = PERF_TYPE_HARDWARE; a.config = PERF_COUNT_HW_CACHE_MISSES; return true;
+    case Event::DTLBMisses:   a.type = PERF_TYPE_HW_CACHE; a.config = cacheMiss(PERF_COUNT_HW_CACHE_DTLB); return true;
+    case Event::TaskClock:    a.type = PERF_TYPE_SOFTWARE; a.config = PERF_COUNT_SW_TASK_CLOCK; return true;
+    case Event::FpOps: {
+#if defined(__x86_64__) || defined(__i386__)
+        static const std::string vendor = cpuVendor();
+        a.type = PERF_TYPE_RAW;
+        if (vendor == "GenuineIntel") { a.config = 0xffc7; return true; }   // FP_ARITH_INST_RETIRED, כל ה-umasks
+        if (vendor == "AuthenticAMD") { a.config = 0xff03; return true; }   // Retired SSE/AVX FLOPs (Zen)
+#endif
+        return false;
+    }
+    default: return false;
+    }
+}
+
+/** @brief Open every describable event on thread @p tid as one group. */
+Group openGroup(int tid)
+{
+    Group g;
+    g.members = 0;
+    for (int e = 0; e < EVENT_COUNT; ++e) {
+        g.fds[e] = -1;
+        g.slot[e] = -1;
+        perf_event_attr a;
+        if (!describe(static_cast<Event>(e), a)) continue;
+        int groupFd = -1;                      // האירוע הראשון שנפתח הוא המוביל
+        for (int k = 0; k < e; ++k)
+            if (g.slot[k] == 0) groupFd = g.fds[k];
+        const long fd = syscall(SYS_perf_event_open, &a, tid, -1, groupFd, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0) continue;
+        g.fds[e] = static_cast<int>(fd);
+        g.slot[e] = g.members++;
+    }
+    return g;
+}
+
+void closeGroup(const Group& g)
+{
+    for (int e = 0; e < EVENT_COUNT; ++e)
+        if (g.fds[e] >= 0) ::close(g.fds[e]);
+}
+
+/** @brief Sum of all groups, scaled by enabled/running time when the
+ *  kernel had to multiplex the group.  Caller holds the state mutex.   */
+Reading readLocked(const State& s)
+{
+    Reading r{};
+    std::uint64_t buf[3 + EVENT_COUNT];
+    for (const Group& g : s.groups) {
+        int leader = -1;
+        for (int e = 0; e < EVENT_COUNT; ++e)
+            if (g.slot[e] == 0) leader = g.fds[e];
+        if (leader < 0) continue;
+        const ssize_t got = ::read(leader, buf, sizeof buf);
+        if (got < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) continue;
+        const std::uint64_t enabled = buf[1], runningTime = buf[2];
+        if (runningTime == 0) continue;
+        const double scale = (runningTime < enabled) ? double(enabled) / double(runningTime) : 1.0;
+        for (int e = 0; e < EVENT_COUNT; ++e)
+            if (g.slot[e] >= 0 && static_cast<std::uint64_t>(g.slot[e]) < buf[0])
+                r.value[e] += static_cast<std::uint64_t>(double(buf[3 + g.slot[e]]) * scale);
+    }
+    return r;
+}
+
+/** @brief Thread ids of the process, from /proc/self/task. */
+std::vector<int> threadIds()
+{
+    std::vector<int> tids;
+    if (DIR* d = ::opendir("/proc/self/task")) {
+        while (const dirent* ent = ::readdir(d))
+            if (ent->d_name[0] != '.') tids.push_back(static_cast<int>(std::strtol(ent->d_name, nullptr, 10)));
+        ::closedir(d);
+    }
+    return tids;
+}
+
+} // namespace
+
+namespace matrix {
+namespace perf {
+
+/** @brief Per-event difference, clamped at zero: multiplex-scaled
+ *  counts are estimates and need not grow monotonically.              */
+Reading operator-(const Reading& a, const Reading& b)
+{
+    Reading r{};
+    for (int e = 0; e < EVENT_COUNT; ++e) r.value[e] = a.value[e] > b.value[e] ? a.value[e] - b.value[e] : 0;
+    return r;
+}
+
+const char* eventName(Event e)
+{
+    const int k = static_cast<int>(e);
+    return (k >= 0 && k < EVENT_COUNT) ? NAMES[k] : "unknown";
+}
+
+/* ====================================================================
+   Session
+   ================================================================= */
+
+/** @brief Open counters on every thread of the process (starting the
+ *  ThreadPool first, so its workers are included).  Re-opens them when
+ *  already active.
+ *  @return true if at least one event can be counted                  */
+bool start()
+{
+    ThreadPool::instance();
+    stop();
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    const int self = static_cast<int>(::syscall(SYS_gettid));
+    bool any = false;
+    for (int e = 0; e < EVENT_COUNT; ++e) s.available[e] = false;
+    for (int tid : threadIds()) {
+        Group g = openGroup(tid);
+        if (g.members == 0) continue;
+        if (tid == self)
+            for (int e = 0; e < EVENT_COUNT; ++e) s.available[e] = g.slot[e] >= 0;
+        s.groups.push_back(g);
+        any = true;
+    }
+    running.store(any, std::memory_order_release);
+    return any;
+}
+
+/** @brief Close all counters; the accumulated profile is kept. */
+void stop()
+{
+    running.store(false, std::memory_order_release);
+    sessions.fetch_add(1, std::memory_order_acq_rel);
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    for (const Group& g : s.groups) closeGroup(g);
+    s.groups.clear();
+}
+
+bool active() { return running.load(std::memory_order_acquire); }
+
+bool available(Event e)
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    const int k = static_cast<int>(e);
+    return k >= 0 && k < EVENT_COUNT && s.available[k];
+}
+
+/** @brief Counts since start() over all counted threads (zero if inactive). */
+Reading read()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    return readLocked(s);
+}
+
+/* ====================================================================
+   Attribution
+   ================================================================= */
+
+double OpProfile::ipc() const
+{
+    const std::uint64_t c = totals[Event::Cycles];
+    return c ? double(totals[Event::Instructions]) / double(c) : 0.0;
+}
+
+double OpProfile::perKiloInstruction(Event e) const
+{
+    const std::uint64_t i = totals[Event::Instructions];
+    return i ? 1000.0 * double(totals[e]) / double(i) : 0.0;
+}
+
+Profile profile()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    return s.profile;
+}
+
+void reset()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    s.profile = Profile{};
+}
+
+/** @brief One row per operator that was called: counts, IPC and misses
+ *  per thousand instructions; "-" for events this machine cannot count.
+ *  "shared" counts calls left out of the totals (see Scope).         */
+std::string report(const Profile& p)
+{
+    bool avail[EVENT_COUNT];
+    for (int e = 0; e < EVENT_COUNT; ++e) avail[e] = available(static_cast<Event>(e));
+
+    std::ostringstream out;
+    out << std::left << std::setw(12) << "op" << std::right << std::setw(9) << "calls" << std::setw(8) << "shared"
+        << std::setw(15) << "cycles" << std::setw(15) << "instructions" << std::setw(7) << "IPC"
+        << std::setw(10) << "L1D/ki" << std::setw(10) << "LLC/ki" << std::setw(10) << "dTLB/ki"
+        << std::setw(15) << "fp-ops" << std::setw(12) << "cpu ms" << '\n';
+    out << std::fixed;
+    const auto cell = [&](int width, bool ok, auto value, int precision) {
+        out << std::setw(width) << std::setprecision(precision);
+        if (ok) out << value;
+        else out << "-";
+    };
+    for (int o = 0; o < OP_COUNT; ++o) {
+        const OpProfile& op = p.ops[o];
+        if (!op.calls) continue;
+        const bool ipc = avail[int(Event::Cycles)] && avail[int(Event::Instructions)];
+        out << std::left << std::setw(12) << instrument::opName(static_cast<instrument::Op>(o))
+            << std::right << std::setw(9) << op.calls << std::setw(8) << op.overlapped;
+        cell(15, avail[int(Event::Cycles)], op.totals[Event::Cycles], 0);
+        cell(15, avail[int(Event::Instructions)], op.totals[Event::Instructions], 0);
+        cell(7, ipc, op.ipc(), 2);
+        for (Event e : {Event::L1DMisses, Event::LLCMisses, Event::DTLBMisses})
+            cell(10, avail[int(e)] && avail[int(Event::Instructions)], op.perKiloInstruction(e), 2);
+        cell(15, avail[int(Event::FpOps)], op.totals[Event::FpOps], 0);
+        cell(12, avail[int(Event::TaskClock)], op.totals[Event::TaskClock] * 1e-6, 3);
+        out << '\n';
+    }
+    return out.str();
+}
+
+/** @brief Arms the outermost scope of @p op on this thread.  Scopes
+ *  already open on other threads mark both sides as overlapping; scopes
+ *  nested on the same thread do not.                                   */
+Scope::Scope(instrument::Op op_)
+    : op(op_), counted(false), armed(false), session(0), overlaps(0), shared(false), begin{}
+{
+    if (!active()) return;
+    counted = true;
+    if (depth[static_cast<int>(op)]++ != 0) return;
+    armed = true;
+    session = sessions.load(std::memory_order_acquire);
+    overlaps = overlapCount.load(std::memory_order_acquire);      // לפני ההרשמה – כדי לא לפספס חפיפה
+    shared = openScopes.fetch_add(1, std::memory_order_acq_rel) > threadScopes;
+    ++threadScopes;
+    if (shared) overlapCount.fetch_add(1, std::memory_order_acq_rel);
+    begin = read();
+}
+
+/** @brief Adds the counter delta to the operator's totals, unless
+ *  another thread's operator ran during the scope – process-wide
+ *  counters cannot tell the two apart.                                */
+Scope::~Scope()
+{
+    if (!counted) return;
+    --depth[static_cast<int>(op)];
+    if (!armed) return;
+    --threadScopes;
+    openScopes.fetch_sub(1, std::memory_order_acq_rel);
+    const bool overlapped = shared || overlapCount.load(std::memory_order_acquire) != overlaps;
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    if (sessions.load(std::memory_order_acquire) != session || !active()) return;   // start()/stop() באמצע
+    OpProfile& p = s.profile.ops[static_cast<int>(op)];
+    ++p.calls;
+    if (overlapped) {
+        ++p.overlapped;
+        return;
+    }
+    const Reading delta = readLocked(s) - begin;
+    for (int e = 0; e < EVENT_COUNT; ++e) p.totals.value[e] += delta.value[e];
+}
+
+Region::Region() : begin(read()) {}
+
+Reading Region::elapsed() const { return read() - begin; }
+
+} // namespace perf
+} // namespace matrix
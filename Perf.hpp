@@ -0,0 +1,115 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef PERF_HPP
+#define PERF_HPP
+
+#include "Instrument.hpp"
+#include <cstdint>
+#include <string>
+
+namespace matrix {
+namespace perf {
+
+/*
+ * Hardware counter profiling through Linux perf_event_open.  start()
+ * opens one counter group on every thread of the process (the calling
+ * thread and the ThreadPool workers), so a reading covers the whole
+ * parallel kernel, not just the caller.  Threads created afterwards –
+ * e.g. by ThreadPool::resize() – are not counted until start() is
+ * called again.
+ *
+ * In an instrumented build (make INSTRUMENT=1) every SquareMat operator
+ * hook also opens a perf::Scope, so while profiling is active the
+ * counter deltas of each operator invocation are attributed to that
+ * operator.  The counters are process-wide, so attribution holds only
+ * while one operator runs at a time: an invocation that overlaps an
+ * operator on another thread (a second caller, the async driver) is
+ * counted in OpProfile::overlapped and its delta is not attributed.
+ * Region measures any block of user code, in any build.
+ *
+ * Events the kernel or CPU cannot count (no PMU in a VM, a restrictive
+ * perf_event_paranoid, a non-x86 FP event) are reported unavailable and
+ * read as zero.  Counts are user-space only and scaled for multiplexing.
+ */
+
+// ---------- אירועים ----------
+enum class Event {
+    Cycles,
+    Instructions,
+    L1DMisses,      // החטאות קריאה ב-L1D
+    LLCMisses,      // החטאות במטמון האחרון
+    DTLBMisses,     // החטאות קריאה ב-dTLB
+    FpOps,          // Intel: פקודות FP אריתמטיות; AMD Zen: FLOPs
+    TaskClock,      // זמן CPU בננו-שניות (אירוע תוכנה)
+    Count
+};
+
+constexpr int EVENT_COUNT = static_cast<int>(Event::Count);
+
+struct Reading {
+    std::uint64_t value[EVENT_COUNT];
+    std::uint64_t operator[](Event e) const { return value[static_cast<int>(e)]; }
+};
+
+Reading operator-(const Reading& a, const Reading& b);   // הפרש שלילי (הערכת multiplexing) → 0
+
+const char* eventName(Event e);
+
+// ---------- הפעלה ----------
+bool start();                   // true אם לפחות אירוע אחד נספר
+void stop();
+bool active();
+bool available(Event e);
+Reading read();                 // מצטבר מאז start(), כל החוטים
+
+// ---------- ייחוס לאופרטורים ----------
+struct OpProfile {
+    std::uint64_t calls;
+    std::uint64_t overlapped;               // קריאות שחפפו אופרטור בחוט אחר – לא יוחסו
+    Reading totals;
+
+    double ipc() const;                     // instructions / cycles
+    double perKiloInstruction(Event e) const;
+};
+
+struct Profile {
+    OpProfile ops[instrument::OP_COUNT];
+    const OpProfile& operator[](instrument::Op op) const { return ops[static_cast<int>(op)]; }
+};
+
+Profile profile();
+void reset();
+std::string report(const Profile& p);       // טבלה: IPC ו-MPKI לכל אופרטור
+
+/** RAII: attributes the counter delta of its lifetime to @p op (outermost only). */
+class Scope {
+private:
+    instrument::Op op;
+    bool counted;                   // העמיק את מונה הקינון
+    bool armed;                     // הקריאה החיצונית ביותר – מודדת
+    unsigned session;
+    unsigned overlaps;              // מונה החפיפות בתחילת הטווח
+    bool shared;                    // כבר בתחילה רץ אופרטור בחוט אחר
+    Reading begin;
+
+public:
+    explicit Scope(instrument::Op op);
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope();
+};
+
+/** Counter delta of an arbitrary block of code. */
+class Region {
+private:
+    Reading begin;
+
+public:
+    Region();
+    Reading elapsed() const;
+};
+
+} // namespace perf
+} // namespace matrix
+
+#endif // PERF_HPP
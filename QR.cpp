@@ -0,0 +1,195 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "QR.hpp"
+#include "Householder.hpp"
+#include "Kernels.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min, std::max
+#include <utility>     // std::swap
+#include <cmath>       // std::fabs, std::hypot
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::domain_error, std::invalid_argument
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Reflectors per panel / per block application. */
+constexpr int NB = 64;
+
+} // namespace
+
+/* ====================================================================
+   Factorization
+   ================================================================= */
+
+/** @brief Factor @p A = Q·R (LAPACK dgeqrf).
+ *
+ *  The transposed copy is reduced by householder::factorRows(): each
+ *  NB-wide panel is factored column by column, then its reflectors are
+ *  gathered into compact WY form I − Vᵀ·T·V and applied to all trailing
+ *  columns at once with three gemm calls, so the bulk of the 4n³/3
+ *  FLOPs runs at GEMM speed instead of as n separate rank-1 updates.    */
+QR::QR(const SquareMat& A) : qrT(~A), tau(nullptr), n(A.getN())
+{
+    std::unique_ptr<double[]> t(new double[n]);
+    householder::factorRows(n, n, qrT.raw(), n, t.get());   // gemm – עלול לזרוק
+    tau = t.release();
+}
+
+/** @brief Deep-copy constructor. */
+QR::QR(const QR& other) : qrT(other.qrT), tau(nullptr), n(other.n)
+{
+    std::unique_ptr<double[]> t(new double[n]);
+    std::copy(other.tau, other.tau + n, t.get());
+    tau = t.release();
+}
+
+/** @brief Copy-assignment operator (copy-and-swap: on a throw *this is
+ *  unchanged).                                                        */
+QR& QR::operator=(const QR& other)
+{
+    if (this == &other) return *this;
+    QR tmp(other);
+    qrT = tmp.qrT;                                // SquareMat::operator= – חזק בפני חריגות
+    std::swap(tau, tmp.tau);
+    n = other.n;
+    return *this;
+}
+
+/** @brief Destructor – frees the reflector scalars. */
+QR::~QR() { delete[] tau; }
+
+/* ====================================================================
+   Queries
+   ================================================================= */
+
+int QR::getN() const { return n; }
+
+/** @brief The upper-triangular factor R as a dense matrix. */
+SquareMat QR::R() const
+{
+    SquareMat Rm(n, 0.0);
+    const double* a = qrT.raw();
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i <= j; ++i) Rm[i][j] = a[static_cast<long>(j) * n + i];
+    return Rm;
+}
+
+/** @brief True if some rᵢᵢ is exactly zero. */
+bool QR::isSingular() const
+{
+    const double* a = qrT.raw();
+    for (int i = 0; i < n; ++i)
+        if (a[static_cast<long>(i) * n + i] == 0.0) return true;
+    return false;
+}
+
+/** @brief det(A) = det(Q)·Π rᵢᵢ; every non-trivial reflector has
+ *  determinant −1.  No pivoting, so it is backward stable for any A.   */
+double QR::determinant() const
+{
+    const double* a = qrT.raw();
+    double det = 1.0;
+    for (int i = 0; i < n; ++i) {
+        det *= a[static_cast<long>(i) * n + i];
+        if (tau[i] != 0.0) det = -det;
+    }
+    return det;
+}
+
+/* ====================================================================
+   Implicit Q
+   ================================================================= */
+
+/** @brief B ← Q·B, or Qᵀ·B when @p transpose is set.
+ *  @p B is n×ncols row-major (one right-hand side per column); the
+ *  reflectors are applied NB at a time through householder::applyLeft. */
+void QR::applyQ(double* B, int ncols, bool transpose) const
+{
+    const double* a = qrT.raw();
+    const int blocks = (n + NB - 1) / NB;
+    std::unique_ptr<double[]> V(new double[static_cast<long>(NB) * n]);
+    std::unique_ptr<double[]> T(new double[NB * NB]);
+
+    for (int s = 0; s < blocks; ++s) {
+        const int b = transpose ? s : blocks - 1 - s;        // Qᵀ: קדימה, Q: אחורה
+        const int c0 = b * NB;
+        const int kb = std::min(NB, n - c0);
+        const int m = n - c0;
+        householder::unpackV(kb, m, a + static_cast<long>(c0) * n + c0, n, V.get());
+        householder::formT(m, kb, V.get(), m, tau + c0, T.get());
+        householder::applyLeft(transpose, m, ncols, kb, V.get(), m, T.get(),
+                               B + static_cast<long>(c0) * ncols, ncols);
+    }
+}
+
+/** @brief Q·B (or Qᵀ·B) without forming Q.
+ *  @throw std::invalid_argument on dimension mismatch                 */
+SquareMat QR::multiplyQ(const SquareMat& B, bool transpose) const
+{
+    if (B.getN() != n) throw std::invalid_argument("dimension mismatch");
+    SquareMat X(B);
+    applyQ(X.raw(), n, transpose);
+    return X;
+}
+
+/* ====================================================================
+   Solves
+   ================================================================= */
+
+/** @brief Solve A·x = b (x = R⁻¹·Qᵀ·b), overwriting @p b.
+ *  @throw std::domain_error if the matrix is singular                 */
+void QR::solveInPlace(double* b) const
+{
+    if (isSingular()) throw std::domain_error("matrix is singular");
+    applyQ(b, 1, true);
+    kernels::trsm(true, true, false, n, 1, qrT.raw(), n, b, 1);   // Rᵀ שמור כמשולש תחתון
+}
+
+/** @brief Solve A·X = B for every column of @p B at once.
+ *  @throw std::invalid_argument on dimension mismatch
+ *  @throw std::domain_error if the matrix is singular                 */
+SquareMat QR::solve(const SquareMat& B) const
+{
+    if (B.getN() != n) throw std::invalid_argument("dimension mismatch");
+    if (isSingular()) throw std::domain_error("matrix is singular");
+    SquareMat X(B);
+    applyQ(X.raw(), n, true);
+    kernels::trsm(true, true, false, n, n, qrT.raw(), n, X.raw(), n);
+    return X;
+}
+
+/**
+ * @brief Least-squares solution of min ‖A·x − b‖₂.
+ *
+ * With c = Qᵀ·b, the unknowns whose |rᵢᵢ| ≤ rcond·max|rⱼⱼ| are set to
+ * zero and the remaining triangular system is solved; the returned
+ * value is the residual norm ‖A·x − b‖.  For full-rank A this is the
+ * exact solution (residual 0); for rank-deficient A it is a basic
+ * solution – there is no column pivoting, so it is not the minimum-norm
+ * one.
+ */
+double QR::leastSquares(const double* b, double* x, double rcond) const
+{
+    const double* a = qrT.raw();
+    std::unique_ptr<double[]> c(new double[n]);
+    std::copy(b, b + n, c.get());
+    applyQ(c.get(), 1, true);
+
+    double rmax = 0.0;
+    for (int i = 0; i < n; ++i) rmax = std::max(rmax, std::fabs(a[static_cast<long>(i) * n + i]));
+    const double cut = rcond * rmax;
+
+    double resid = 0.0;
+    for (int i = n - 1; i >= 0; --i) {
+        const double rii = a[static_cast<long>(i) * n + i];
+        double s = c[i];
+        for (int j = i + 1; j < n; ++j) s -= a[static_cast<long>(j) * n + i] * x[j];
+        if (std::fabs(rii) <= cut) {
+            x[i] = 0.0;
+            resid = std::hypot(resid, s);
+        } else {
+            x[i] = s / rii;
+        }
+    }
+    return resid;
+}
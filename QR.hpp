@@ -0,0 +1,49 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef QR_HPP
+#define QR_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * Householder QR factorization, A = Q·R.
+ *
+ * Q = H₀·H₁·…·H_{n−2} is never formed: the reflectors stay in the
+ * factored matrix and are applied block-wise (compact WY) by applyQ().
+ * The factors are kept transposed – row j holds column j of A – so the
+ * reflector vectors and the columns of R are contiguous.
+ */
+class QR {
+private:
+    SquareMat qrT;     // שורה j: R(0..j, j) עד האלכסון, v_j אחריו
+    double* tau;       // סקלרים של הרפלקטורים
+    int n;
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    explicit QR(const SquareMat& A);
+    QR(const QR& other);
+    QR& operator=(const QR& other);
+    ~QR();
+
+    // ---------- תוצאות ----------
+    int getN() const;
+    SquareMat R() const;
+    bool isSingular() const;
+    double determinant() const;
+
+    // ---------- הפעלת Q בלי ליצור אותו ----------
+    void applyQ(double* B, int ncols, bool transpose = false) const;   // B בגודל n×ncols
+    SquareMat multiplyQ(const SquareMat& B, bool transpose = false) const;
+
+    // ---------- פתרון ----------
+    void solveInPlace(double* b) const;
+    SquareMat solve(const SquareMat& B) const;
+    double leastSquares(const double* b, double* x, double rcond = 1e-12) const;
+};
+
+} // namespace matrix
+
+#endif // QR_HPP
@@ -0,0 +1,440 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "SVD.hpp"
+#include "Householder.hpp"
+#include "Kernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min, std::max, std::swap, std::swap_ranges
+#include <cfloat>      // DBL_EPSILON
+#include <cmath>       // std::fabs, std::hypot, std::copysign
+#include <memory>      // std::unique_ptr
+#include <random>      // std::mt19937_64, std::normal_distribution
+#include <stdexcept>   // std::invalid_argument, std::out_of_range, std::logic_error, std::runtime_error
+
+using namespace matrix;
+
+namespace {
+
+constexpr double EPS = DBL_EPSILON;
+
+/** @brief Columns (or rows) handled by one task of a reflector update. */
+constexpr int CHUNK = 64;
+
+/** @brief Rotate rows @p p and @p q of a row-major matrix:
+ *  (x, y) ← (x·c + y·s, y·c − x·s).                                   */
+void rotateRows(double* M, int n, int p, int q, double c, double s)
+{
+    double* xp = M + static_cast<long>(p) * n;
+    double* xq = M + static_cast<long>(q) * n;
+    for (int j = 0; j < n; ++j) {
+        const double x = xp[j], y = xq[j];
+        xp[j] = x * c + y * s;
+        xq[j] = y * c - x * s;
+    }
+}
+
+/**
+ * Golub–Kahan bidiagonalization Uᵀ·A·V = B (LAPACK dgebd2).
+ *
+ * Column j is reduced by a left reflector, row j by a right one; both
+ * rank-1 updates are split across the pool (left: by column ranges,
+ * right: by rows) so each task walks contiguous memory.  Left vectors
+ * stay below the diagonal, right vectors right of the superdiagonal.
+ */
+void bidiagonalize(double* a, int n, double* d, double* e, double* tauq, double* taup)
+{
+    ThreadPool& pool = ThreadPool::instance();
+    for (int j = 0; j < n; ++j) {
+        double* rj = a + static_cast<long>(j) * n;
+
+        // --- left reflector: A(j+1:n, j) → 0 ---
+        double beta;
+        householder::generate(n - j, rj + j, n, beta, tauq[j]);
+        rj[j] = beta;
+        d[j] = beta;
+        const double tq = tauq[j];
+        if (tq != 0.0 && j + 1 < n) {
+            pool.parallelFor(0, (n - j - 1 + CHUNK - 1) / CHUNK, [&](int blk) {
+                const int c0 = j + 1 + blk * CHUNK;
+                const int c1 = std::min(n, c0 + CHUNK);
+                double w[CHUNK];
+                for (int c = c0; c < c1; ++c) w[c - c0] = rj[c];
+                for (int r = j + 1; r < n; ++r) {
+                    const double* ar = a + static_cast<long>(r) * n;
+                    const double v = ar[j];
+                    for (int c = c0; c < c1; ++c) w[c - c0] += v * ar[c];
+                }
+                for (int c = c0; c < c1; ++c) rj[c] -= tq * w[c - c0];
+                for (int r = j + 1; r < n; ++r) {
+                    double* ar = a + static_cast<long>(r) * n;
+                    const double v = tq * ar[j];
+                    for (int c = c0; c < c1; ++c) ar[c] -= v * w[c - c0];
+                }
+            });
+        }
+
+        if (j + 1 >= n) { taup[j] = 0.0; break; }
+
+        // --- right reflector: A(j, j+2:n) → 0 ---
+        householder::generate(n - j - 1, rj + j + 1, 1, beta, taup[j]);
+        rj[j + 1] = beta;
+        e[j] = beta;
+        const double tp = taup[j];
+        if (tp == 0.0) continue;
+        pool.parallelFor(0, (n - j - 1 + CHUNK - 1) / CHUNK, [&](int blk) {
+            const int r0 = j + 1 + blk * CHUNK;
+            const int r1 = std::min(n, r0 + CHUNK);
+            for (int r = r0; r < r1; ++r) {
+                double* ar = a + static_cast<long>(r) * n;
+                double s = ar[j + 1];
+                for (int c = j + 2; c < n; ++c) s += ar[c] * rj[c];
+                s *= tp;
+                ar[j + 1] -= s;
+                for (int c = j + 2; c < n; ++c) ar[c] -= s * rj[c];
+            }
+        });
+    }
+}
+
+/**
+ * Implicit-shift QR on the bidiagonal (d, e) – the Golub–Reinsch
+ * iteration of EISPACK svd.  Rotations are applied to the rows of
+ * UT and VT, which therefore accumulate Uᵀ and Vᵀ.  On exit d holds
+ * the (unsorted, non-negative) singular values.
+ */
+void bidiagonalQR(int n, double* d, const double* eIn, double* UT, double* VT)
+{
+    std::unique_ptr<double[]> rv1(new double[n]);
+    rv1[0] = 0.0;
+    for (int i = 1; i < n; ++i) rv1[i] = eIn[i - 1];
+    double anorm = 0.0;
+    for (int i = 0; i < n; ++i) anorm = std::max(anorm, std::fabs(d[i]) + std::fabs(rv1[i]));
+    const double tol = EPS * anorm;
+
+    for (int k = n - 1; k >= 0; --k) {
+        for (int its = 0;; ++its) {
+            bool cancel = true;
+            int l, nm = 0;
+            for (l = k; l >= 0; --l) {                   // חיפוש פיצול
+                nm = l - 1;
+                if (l == 0 || std::fabs(rv1[l]) <= tol) { cancel = false; break; }
+                if (std::fabs(d[nm]) <= tol) break;
+            }
+            if (cancel) {                               // d[nm] ≈ 0: מאפסים את rv1[l]
+                double c = 0.0, s = 1.0;
+                for (int i = l; i <= k; ++i) {
+                    const double f = s * rv1[i];
+                    rv1[i] *= c;
+                    if (std::fabs(f) <= tol) break;
+                    const double g = d[i];
+                    const double h = std::hypot(f, g);
+                    d[i] = h;
+                    c = g / h;
+                    s = -f / h;
+                    rotateRows(UT, n, nm, i, c, s);
+                }
+            }
+            const double z = d[k];
+            if (l == k) {                               // התכנס
+                if (z < 0.0) {
+                    d[k] = -z;
+                    double* vk = VT + static_cast<long>(k) * n;
+                    for (int j = 0; j < n; ++j) vk[j] = -vk[j];
+                }
+                break;
+            }
+            if (its == 75) throw std::runtime_error("SVD did not converge");
+
+            // --- Wilkinson-type shift from the trailing 2×2 ---
+            double x = d[l];
+            nm = k - 1;
+            double y = d[nm];
+            double g = rv1[nm];
+            double h = rv1[k];
+            double f = ((y - z) * (y + z) + (g - h) * (g + h)) / (2.0 * h * y);
+            g = std::hypot(f, 1.0);
+            f = ((x - z) * (x + z) + h * ((y / (f + std::copysign(g, f))) - h)) / x;
+
+            // --- chase the bulge ---
+            double c = 1.0, s = 1.0;
+            for (int j = l; j <= nm; ++j) {
+                const int i = j + 1;
+                g = rv1[i];
+                y = d[i];
+                h = s * g;
+                g = c * g;
+                double zz = std::hypot(f, h);
+                rv1[j] = zz;
+                c = f / zz;
+                s = h / zz;
+                f = x * c + g * s;
+                g = g * c - x * s;
+                h = y * s;
+                y *= c;
+                rotateRows(VT, n, j, i, c, s);
+                zz = std::hypot(f, h);
+                d[j] = zz;
+                if (zz != 0.0) { c = f / zz; s = h / zz; }
+                f = c * g + s * y;
+                x = c * y - s * g;
+                rotateRows(UT, n, j, i, c, s);
+            }
+            rv1[l] = 0.0;
+            rv1[k] = f;
+            d[k] = x;
+        }
+    }
+}
+
+/** @brief Full SVD of the n×n row-major @p a0: sigma descending, rows
+ *  of UT / VT the matching left / right singular vectors.               */
+void fullSVD(int n, const double* a0, double* sigma, double* UT, double* VT)
+{
+    std::unique_ptr<double[]> a(new double[static_cast<long>(n) * n]);
+    std::copy(a0, a0 + static_cast<long>(n) * n, a.get());
+    std::unique_ptr<double[]> e(new double[n]), tauq(new double[n]), taup(new double[n]);
+    e[n - 1] = 0.0;
+    bidiagonalize(a.get(), n, sigma, e.get(), tauq.get(), taup.get());
+
+    // --- Uᵀ = H_{n−1}·…·H₀ : the left vectors, gathered into rows ---
+    {
+        std::unique_ptr<double[]> L(new double[static_cast<long>(n) * n]);
+        for (int j = 0; j < n; ++j)
+            for (int r = j + 1; r < n; ++r)
+                L[static_cast<long>(j) * n + r] = a[static_cast<long>(r) * n + j];
+        householder::formRows(n, n, L.get(), n, tauq.get(), UT, n);
+    }
+
+    // --- Vᵀ = 1 ⊕ (G_{n−2}·…·G₀) ---
+    std::fill(VT, VT + static_cast<long>(n) * n, 0.0);
+    VT[0] = 1.0;
+    if (n > 1) householder::formRows(n - 1, n - 1, a.get() + 1, n, taup.get(), VT + n + 1, n);
+
+    bidiagonalQR(n, sigma, e.get(), UT, VT);
+
+    for (int i = 0; i < n - 1; ++i) {                    // מיון יורד
+        int best = i;
+        for (int j = i + 1; j < n; ++j) if (sigma[j] > sigma[best]) best = j;
+        if (best == i) continue;
+        std::swap(sigma[i], sigma[best]);
+        std::swap_ranges(UT + static_cast<long>(i) * n, UT + static_cast<long>(i + 1) * n,
+                         UT + static_cast<long>(best) * n);
+        std::swap_ranges(VT + static_cast<long>(i) * n, VT + static_cast<long>(i + 1) * n,
+                         VT + static_cast<long>(best) * n);
+    }
+}
+
+/** @brief Replace the l rows of @p Y (l×n) by an orthonormal basis of
+ *  their span – Householder LQ, then the explicit Q.                    */
+void orthonormalizeRows(int l, int n, double* Y)
+{
+    std::unique_ptr<double[]> tau(new double[l]);
+    householder::factorRows(l, n, Y, n, tau.get());
+    std::unique_ptr<double[]> F(new double[static_cast<long>(l) * n]);
+    std::copy(Y, Y + static_cast<long>(l) * n, F.get());
+    householder::formRows(l, n, F.get(), n, tau.get(), Y, n);
+}
+
+} // namespace
+
+/* ====================================================================
+   Construction
+   ================================================================= */
+
+/** @brief Full SVD (bidiagonalization + implicit QR), O(n³).
+ *  @throw std::runtime_error if the iteration does not converge (e.g.
+ *         NaN or Inf entries); nothing is leaked                      */
+SVD::SVD(const SquareMat& A) : sigma(nullptr), left(nullptr), right(nullptr), n(A.getN()), k(n)
+{
+    std::unique_ptr<double[]> s(new double[n]), u(new double[static_cast<long>(n) * n]),
+                              v(new double[static_cast<long>(n) * n]);
+    fullSVD(n, A.raw(), s.get(), u.get(), v.get());
+    sigma = s.release();
+    left = u.release();
+    right = v.release();
+}
+
+/**
+ * @brief Top-@p topK singular triplets by randomized range finding.
+ *
+ * Y = A·Ω for a Gaussian Ω with topK+oversample columns, refined by
+ * @p powerIters rounds of (A·Aᵀ) with re-orthonormalization in
+ * between; with Q an orthonormal basis of Y, the small matrix Qᵀ·A is
+ * LQ-factored and its l×l factor decomposed exactly.  Everything is
+ * kept transposed (one vector per row) so every pass is one gemm.
+ * The test matrix is seeded deterministically.
+ * @throw std::invalid_argument unless 0 < topK ≤ n and the other
+ *        parameters are non-negative
+ */
+SVD::SVD(const SquareMat& A, int topK, int oversample, int powerIters)
+    : sigma(nullptr), left(nullptr), right(nullptr), n(A.getN()), k(topK)
+{
+    if (topK <= 0 || topK > n) throw std::invalid_argument("topK must be in [1, n]");
+    if (oversample < 0 || powerIters < 0) throw std::invalid_argument("negative parameter");
+
+    const int l = std::min(n, topK + oversample);
+    const double* a = A.raw();
+    const long ln = static_cast<long>(l) * n;
+
+    std::unique_ptr<double[]> Om(new double[ln]), Y(new double[ln]);
+    std::mt19937_64 gen(0x5eed);
+    std::normal_distribution<double> dist;
+    for (long i = 0; i < ln; ++i) Om[i] = dist(gen);
+
+    // --- Yᵀ = Ωᵀ·Aᵀ, then power iterations ---
+    kernels::gemm(l, n, n, 1.0, Om.get(), n, false, a, n, true, 0.0, Y.get(), n);
+    orthonormalizeRows(l, n, Y.get());
+    for (int it = 0; it < powerIters; ++it) {
+        kernels::gemm(l, n, n, 1.0, Y.get(), n, false, a, n, false, 0.0, Om.get(), n);  // Qᵀ·A
+        orthonormalizeRows(l, n, Om.get());
+        kernels::gemm(l, n, n, 1.0, Om.get(), n, false, a, n, true, 0.0, Y.get(), n);   // (A·Z)ᵀ
+        orthonormalizeRows(l, n, Y.get());
+    }
+
+    // --- B = Qᵀ·A = L·Q₂, SVD(L) = Ũ·Σ·Ṽᵀ ---
+    std::unique_ptr<double[]> B(new double[ln]), Q2(new double[ln]), tau(new double[l]);
+    kernels::gemm(l, n, n, 1.0, Y.get(), n, false, a, n, false, 0.0, B.get(), n);
+    householder::factorRows(l, n, B.get(), n, tau.get());
+    householder::formRows(l, n, B.get(), n, tau.get(), Q2.get(), n);
+
+    std::unique_ptr<double[]> Lsq(new double[static_cast<long>(l) * l]);
+    for (int i = 0; i < l; ++i)
+        for (int j = 0; j < l; ++j)
+            Lsq[static_cast<long>(i) * l + j] = (j <= i) ? B[static_cast<long>(i) * n + j] : 0.0;
+    std::unique_ptr<double[]> s(new double[l]), UT(new double[static_cast<long>(l) * l]),
+                              VT(new double[static_cast<long>(l) * l]);
+    fullSVD(l, Lsq.get(), s.get(), UT.get(), VT.get());
+
+    // --- lift back: uᵢ = Q·ũᵢ, vᵢ = Q₂ᵀ·ṽᵢ ---
+    std::unique_ptr<double[]> u(new double[static_cast<long>(k) * n]), v(new double[static_cast<long>(k) * n]);
+    kernels::gemm(k, n, l, 1.0, UT.get(), l, false, Y.get(), n, false, 0.0, u.get(), n);
+    kernels::gemm(k, n, l, 1.0, VT.get(), l, false, Q2.get(), n, false, 0.0, v.get(), n);
+    sigma = s.release();                                     // l ≥ k ערכים, הראשונים k בשימוש
+    left = u.release();
+    right = v.release();
+}
+
+/** @brief Deep-copy constructor. */
+SVD::SVD(const SVD& other)
+    : sigma(nullptr), left(nullptr), right(nullptr), n(other.n), k(other.k)
+{
+    const long kn = static_cast<long>(k) * n;
+    std::unique_ptr<double[]> s(new double[k]), u(new double[kn]), v(new double[kn]);
+    std::copy(other.sigma, other.sigma + k, s.get());
+    std::copy(other.left, other.left + kn, u.get());
+    std::copy(other.right, other.right + kn, v.get());
+    sigma = s.release();
+    left = u.release();
+    right = v.release();
+}
+
+/** @brief Copy-assignment operator. */
+SVD& SVD::operator=(const SVD& other)
+{
+    if (this == &other) return *this;
+    SVD tmp(other);
+    std::swap(sigma, tmp.sigma);
+    std::swap(left, tmp.left);
+    std::swap(right, tmp.right);
+    n = other.n;
+    k = other.k;
+    return *this;
+}
+
+/** @brief Destructor – frees values and vectors. */
+SVD::~SVD()
+{
+    delete[] sigma;
+    delete[] left;
+    delete[] right;
+}
+
+/* ====================================================================
+   Queries
+   ================================================================= */
+
+int SVD::getN() const { return n; }
+
+/** @brief Number of computed triplets (n, or topK). */
+int SVD::count() const { return k; }
+
+/** @brief i-th singular value (descending).
+ *  @throw std::out_of_range if @p i is outside [0,count()-1]           */
+double SVD::singularValue(int i) const
+{
+    if (i < 0 || i >= k) throw std::out_of_range("index out of range");
+    return sigma[i];
+}
+
+/** @brief All computed singular values, descending. */
+const double* SVD::singularValues() const { return sigma; }
+
+/** @brief Unit left singular vector uᵢ – n contiguous doubles. */
+const double* SVD::leftVector(int i) const
+{
+    if (i < 0 || i >= k) throw std::out_of_range("index out of range");
+    return left + static_cast<long>(i) * n;
+}
+
+/** @brief Unit right singular vector vᵢ – n contiguous doubles. */
+const double* SVD::rightVector(int i) const
+{
+    if (i < 0 || i >= k) throw std::out_of_range("index out of range");
+    return right + static_cast<long>(i) * n;
+}
+
+/** @brief Left vectors as columns (columns past count() are zero). */
+SquareMat SVD::U() const
+{
+    SquareMat M(n, 0.0);
+    for (int t = 0; t < k; ++t)
+        for (int r = 0; r < n; ++r) M[r][t] = left[static_cast<long>(t) * n + r];
+    return M;
+}
+
+/** @brief Right vectors as columns (columns past count() are zero). */
+SquareMat SVD::V() const
+{
+    SquareMat M(n, 0.0);
+    for (int t = 0; t < k; ++t)
+        for (int r = 0; r < n; ++r) M[r][t] = right[static_cast<long>(t) * n + r];
+    return M;
+}
+
+/* ====================================================================
+   Derived quantities
+   ================================================================= */
+
+/** @brief Spectral norm ‖A‖₂ = σ₀ (valid for top-k as well). */
+double SVD::norm2() const { return sigma[0]; }
+
+/** @brief κ₂(A) = σ_max / σ_min (infinite for a singular matrix).
+ *  @throw std::logic_error if only the top-k triplets were computed   */
+double SVD::conditionNumber() const
+{
+    if (k < n) throw std::logic_error("requires the full decomposition");
+    return sigma[n - 1] == 0.0 ? HUGE_VAL : sigma[0] / sigma[n - 1];
+}
+
+/** @brief Numerical rank: σᵢ > tol, default tol = n·ε·σ₀.
+ *  @throw std::logic_error if only the top-k triplets were computed   */
+int SVD::rank(double tol) const
+{
+    if (k < n) throw std::logic_error("requires the full decomposition");
+    if (tol < 0.0) tol = n * EPS * sigma[0];
+    int r = 0;
+    while (r < n && sigma[r] > tol) ++r;
+    return r;
+}
+
+/** @brief U_k·Σ_k·V_kᵀ – the best rank-count() approximation of A,
+ *  formed with one gemm.                                                */
+SquareMat SVD::reconstruct() const
+{
+    std::unique_ptr<double[]> SU(new double[static_cast<long>(k) * n]);
+    for (int t = 0; t < k; ++t)
+        for (int r = 0; r < n; ++r)
+            SU[static_cast<long>(t) * n + r] = sigma[t] * left[static_cast<long>(t) * n + r];
+    SquareMat M(n, 0.0);
+    kernels::gemm(n, n, k, 1.0, SU.get(), n, true, right, n, false, 0.0, M.raw(), n);
+    return M;
+}
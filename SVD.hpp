@@ -0,0 +1,56 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef SVD_HPP
+#define SVD_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * Singular value decomposition A = U·Σ·Vᵀ.
+ *
+ * The full decomposition reduces A to upper-bidiagonal form with
+ * Householder reflectors and diagonalizes it by implicit-shift QR
+ * (Golub–Kahan–Reinsch).  The top-k constructor is a randomized range
+ * finder (Halko–Martinsson–Tropp): a few gemm passes with a Gaussian
+ * test matrix and power iterations, then an exact SVD of a small
+ * (k+oversample)² problem – O(n²k) instead of O(n³).
+ * Singular values are returned in descending order.
+ */
+class SVD {
+private:
+    double* sigma;     // count() ערכים סינגולריים, בסדר יורד
+    double* left;      // count() וקטורים שמאליים באורך n, וקטור לכל שורה
+    double* right;     // count() וקטורים ימניים באורך n
+    int n;
+    int k;
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    explicit SVD(const SquareMat& A);
+    SVD(const SquareMat& A, int topK, int oversample = 10, int powerIters = 2);
+    SVD(const SVD& other);
+    SVD& operator=(const SVD& other);
+    ~SVD();
+
+    // ---------- תוצאות ----------
+    int getN() const;
+    int count() const;
+    double singularValue(int i) const;
+    const double* singularValues() const;
+    const double* leftVector(int i) const;
+    const double* rightVector(int i) const;
+    SquareMat U() const;                     // עמודה i = וקטור שמאלי i
+    SquareMat V() const;                     // עמודה i = וקטור ימני i
+
+    // ---------- שימושים ----------
+    double norm2() const;
+    double conditionNumber() const;
+    int rank(double tol = -1.0) const;
+    SquareMat reconstruct() const;           // Σ σᵢ·uᵢ·vᵢᵀ על הזוגות שחושבו
+};
+
+} // namespace matrix
+
+#endif // SVD_HPP
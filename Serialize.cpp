@@ -0,0 +1,265 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Serialize.hpp"
+#include <algorithm>   // std::min, std::copy
+#include <bit>         // std::endian, std::bit_cast
+#include <cstring>     // std::memcmp, std::memcpy
+#include <fstream>     // std::ifstream, std::ofstream
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::runtime_error
+
+using namespace matrix;
+
+namespace {
+
+constexpr unsigned char MAGIC[8] = {'S', 'Q', 'M', 'A', 'T', 'R', 'I', 'X'};
+constexpr std::uint16_t VERSION = 1;
+constexpr std::uint8_t DTYPE_F64 = 1;
+constexpr std::uint8_t LITTLE = 1;
+constexpr std::uint8_t LAYOUT_DENSE = 0;
+
+/** @brief Doubles moved per read/write call (8 MiB). */
+constexpr std::size_t CHUNK = std::size_t(1) << 20;
+
+constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t P3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+
+constexpr bool NATIVE_LITTLE = (std::endian::native == std::endian::little);
+
+inline std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline std::uint64_t round64(std::uint64_t acc, std::uint64_t w)
+{
+    return rotl(acc + w * P2, 31) * P1;
+}
+
+inline std::uint64_t byteswap64(std::uint64_t x)
+{
+    x = ((x & 0x00FF00FF00FF00FFULL) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFULL);
+    x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+    return (x << 32) | (x >> 32);
+}
+
+/** @brief In-place native ↔ little-endian (a no-op on little-endian hosts). */
+void toLittle(double* p, std::size_t count)
+{
+    if (NATIVE_LITTLE) return;
+    for (std::size_t i = 0; i < count; ++i)
+        p[i] = std::bit_cast<double>(byteswap64(std::bit_cast<std::uint64_t>(p[i])));
+}
+
+void putLE(unsigned char* out, std::uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) out[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+std::uint64_t getLE(const unsigned char* in, int bytes)
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+    return v;
+}
+
+/** @brief Checksum of the first 40 header bytes. */
+std::uint64_t headerChecksum(const unsigned char* h)
+{
+    std::uint64_t w[5];
+    for (int i = 0; i < 5; ++i) w[i] = getLE(h + 8 * i, 8);
+    Checksum c;
+    c.update(w, 5);
+    return c.finish();
+}
+
+[[noreturn]] void bad(const char* what)
+{
+    throw std::runtime_error(std::string("bad matrix file: ") + what);
+}
+
+/** @brief Add a chunk of doubles (native order) to the checksum. */
+void hashDoubles(Checksum& c, const double* p, std::size_t count)
+{
+    static_assert(sizeof(double) == sizeof(std::uint64_t));
+    c.update(reinterpret_cast<const std::uint64_t*>(p), count);
+}
+
+} // namespace
+
+/* ====================================================================
+   Checksum
+   ================================================================= */
+
+/**
+ * A 64-bit checksum over the bit patterns of the payload words, in the
+ * style of xxHash64: four independent lanes absorb 32 bytes per round
+ * (so it runs at memory speed), followed by a final avalanche.
+ * Hashing the values rather than bytes makes it endian-neutral.
+ */
+Checksum::Checksum() : lane{P1 + P2, P2, 0, 0 - P1}, pending{0, 0, 0, 0}, pendingCount(0), total(0) {}
+
+/** @brief Absorb @p count more words; may be called chunk by chunk. */
+void Checksum::update(const std::uint64_t* words, std::size_t count)
+{
+    total += count;
+    std::size_t i = 0;
+    while (pendingCount > 0 && pendingCount < 4 && i < count) pending[pendingCount++] = words[i++];
+    if (pendingCount == 4) {
+        for (int l = 0; l < 4; ++l) lane[l] = round64(lane[l], pending[l]);
+        pendingCount = 0;
+    }
+    for (; i + 4 <= count; i += 4)
+        for (int l = 0; l < 4; ++l) lane[l] = round64(lane[l], words[i + l]);
+    while (i < count) pending[pendingCount++] = words[i++];
+}
+
+/** @brief Final value (the object can keep absorbing afterwards). */
+std::uint64_t Checksum::finish() const
+{
+    std::uint64_t h = rotl(lane[0], 1) + rotl(lane[1], 7) + rotl(lane[2], 12) + rotl(lane[3], 18);
+    for (int l = 0; l < 4; ++l) h = (h ^ round64(0, lane[l])) * P1 + P4;
+    h += total * 8;
+    for (int k = 0; k < pendingCount; ++k) h = rotl(h ^ round64(0, pending[k]), 27) * P1 + P4;
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+namespace matrix {
+
+/** @brief Checksum of @p count doubles in one call. */
+std::uint64_t checksum(const double* data, std::size_t count)
+{
+    Checksum c;
+    hashDoubles(c, data, count);
+    return c.finish();
+}
+
+/* ====================================================================
+   Header
+   ================================================================= */
+
+/** @brief Serialize @p h into 64 bytes, computing the header checksum. */
+void encodeHeader(const BinaryHeader& h, unsigned char* out)
+{
+    std::memset(out, 0, BINARY_HEADER_BYTES);
+    std::memcpy(out, MAGIC, 8);
+    putLE(out + 8, h.version, 2);
+    out[10] = h.dtype;
+    out[11] = h.endianness;
+    out[12] = h.layout;
+    putLE(out + 16, h.n, 8);
+    putLE(out + 24, h.payloadBytes, 8);
+    putLE(out + 32, h.checksum, 8);
+    putLE(out + 40, headerChecksum(out), 8);
+}
+
+/** @brief Parse and validate 64 header bytes.
+ *  @throw std::runtime_error on a wrong magic, unsupported version,
+ *         dtype, endianness or layout, a corrupt header, n outside
+ *         1..SquareMat::MAX_N, or a payload size that does not match n */
+BinaryHeader decodeHeader(const unsigned char* in)
+{
+    if (std::memcmp(in, MAGIC, 8) != 0) bad("not a SquareMat binary file");
+    if (getLE(in + 40, 8) != headerChecksum(in)) bad("header checksum mismatch");
+
+    BinaryHeader h;
+    h.version = static_cast<std::uint16_t>(getLE(in + 8, 2));
+    h.dtype = in[10];
+    h.endianness = in[11];
+    h.layout = in[12];
+    h.n = getLE(in + 16, 8);
+    h.payloadBytes = getLE(in + 24, 8);
+    h.checksum = getLE(in + 32, 8);
+
+    if (h.version != VERSION) bad("unsupported version");
+    if (h.dtype != DTYPE_F64) bad("unsupported dtype");
+    if (h.endianness != LITTLE) bad("unsupported endianness");
+    if (h.layout != LAYOUT_DENSE) bad("unsupported layout");
+    if (h.n == 0 || h.n > static_cast<std::uint64_t>(SquareMat::MAX_N)) bad("invalid dimension");
+    if (h.payloadBytes != h.n * h.n * sizeof(double)) bad("payload size does not match n");   // n ≤ MAX_N – בלי גלישה
+    return h;
+}
+
+/* ====================================================================
+   Save / load
+   ================================================================= */
+
+/** @brief Write header + payload.  On little-endian hosts the payload
+ *  goes straight from the matrix buffer in 8 MiB writes.
+ *  @throw std::runtime_error if the stream fails                       */
+void saveBinary(const SquareMat& m, std::ostream& os)
+{
+    const std::size_t count = static_cast<std::size_t>(m.getN()) * m.getN();
+    const double* a = m.raw();
+
+    BinaryHeader h{VERSION, DTYPE_F64, LITTLE, LAYOUT_DENSE,
+                   static_cast<std::uint64_t>(m.getN()), count * sizeof(double),
+                   checksum(a, count)};
+    unsigned char head[BINARY_HEADER_BYTES];
+    encodeHeader(h, head);
+    os.write(reinterpret_cast<const char*>(head), BINARY_HEADER_BYTES);
+
+    std::unique_ptr<double[]> tmp(NATIVE_LITTLE ? nullptr : new double[CHUNK]);
+    for (std::size_t off = 0; off < count && os; off += CHUNK) {
+        const std::size_t len = std::min(CHUNK, count - off);
+        const double* src = a + off;
+        if (!NATIVE_LITTLE) {
+            std::copy(src, src + len, tmp.get());
+            toLittle(tmp.get(), len);
+            src = tmp.get();
+        }
+        os.write(reinterpret_cast<const char*>(src), static_cast<std::streamsize>(len * sizeof(double)));
+    }
+    if (!os) throw std::runtime_error("failed to write matrix");
+}
+
+/** @throw std::runtime_error if the file cannot be created or written */
+void saveBinary(const SquareMat& m, const std::string& path)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    saveBinary(m, f);
+}
+
+/** @brief Read a matrix written by saveBinary().
+ *
+ *  The header is validated first; the payload is then read in 8 MiB
+ *  chunks directly into the new matrix's buffer, with the checksum
+ *  accumulated chunk by chunk.
+ *  @throw std::runtime_error on a bad header, a truncated payload or a
+ *         checksum mismatch                                           */
+SquareMat loadBinary(std::istream& is)
+{
+    unsigned char head[BINARY_HEADER_BYTES];
+    is.read(reinterpret_cast<char*>(head), BINARY_HEADER_BYTES);
+    if (is.gcount() != static_cast<std::streamsize>(BINARY_HEADER_BYTES)) bad("truncated header");
+    const BinaryHeader h = decodeHeader(head);
+
+    SquareMat m(static_cast<int>(h.n));
+    double* a = m.raw();
+    const std::size_t count = h.n * h.n;
+    Checksum sum;
+    for (std::size_t off = 0; off < count; off += CHUNK) {
+        const std::size_t len = std::min(CHUNK, count - off);
+        const std::streamsize bytes = static_cast<std::streamsize>(len * sizeof(double));
+        is.read(reinterpret_cast<char*>(a + off), bytes);
+        if (is.gcount() != bytes) bad("truncated payload");
+        toLittle(a + off, len);
+        hashDoubles(sum, a + off, len);
+    }
+    if (sum.finish() != h.checksum) bad("payload checksum mismatch");
+    return m;
+}
+
+/** @throw std::runtime_error if the file cannot be opened or is invalid */
+SquareMat loadBinary(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    return loadBinary(f);
+}
+
+} // namespace matrix
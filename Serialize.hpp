@@ -0,0 +1,73 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef SERIALIZE_HPP
+#define SERIALIZE_HPP
+
+#include "SquareMat.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace matrix {
+
+/*
+ * Binary matrix file, version 1.  A 64-byte header (all fields little
+ * endian) followed by the n×n doubles, row-major, little endian.  The
+ * header size keeps the payload 64-byte aligned, so a file can also be
+ * memory-mapped and used in place.
+ *
+ *   offset  size  field
+ *        0     8  magic "SQMATRIX"
+ *        8     2  version (1)
+ *       10     1  dtype (1 = float64)
+ *       11     1  endianness of the payload (1 = little)
+ *       12     1  layout (0 = dense row-major)
+ *       13     3  reserved (0)
+ *       16     8  n
+ *       24     8  payload size in bytes (n·n·8)
+ *       32     8  payload checksum
+ *       40     8  header checksum (of bytes 0..39)
+ *       48    16  reserved (0)
+ */
+constexpr std::size_t BINARY_HEADER_BYTES = 64;
+
+struct BinaryHeader {
+    std::uint16_t version;
+    std::uint8_t dtype;
+    std::uint8_t endianness;
+    std::uint8_t layout;
+    std::uint64_t n;
+    std::uint64_t payloadBytes;
+    std::uint64_t checksum;
+};
+
+// ---------- סכום ביקורת (64 ביט, בסגנון xxHash) ----------
+class Checksum {
+private:
+    std::uint64_t lane[4];
+    std::uint64_t pending[4];    // מילים שעוד לא מילאו סבב של 32 בתים
+    int pendingCount;
+    std::uint64_t total;         // מספר המילים שנצברו
+
+public:
+    Checksum();
+    void update(const std::uint64_t* words, std::size_t count);
+    std::uint64_t finish() const;
+};
+
+std::uint64_t checksum(const double* data, std::size_t count);
+
+// ---------- כותרת ----------
+void encodeHeader(const BinaryHeader& h, unsigned char* out);
+BinaryHeader decodeHeader(const unsigned char* in);
+
+// ---------- שמירה / טעינה ----------
+void saveBinary(const SquareMat& m, std::ostream& os);
+void saveBinary(const SquareMat& m, const std::string& path);
+SquareMat loadBinary(std::istream& is);
+SquareMat loadBinary(const std::string& path);
+
+} // namespace matrix
+
+#endif // SERIALIZE_HPP
@@ -0,0 +1,506 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "SparseMat.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::copy, std::fill, std::sort, std::min
+#include <cmath>       // std::fabs
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::invalid_argument, std::out_of_range
+#include <utility>     // std::swap
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Rows handled by one task in the row-parallel loops. */
+constexpr int ROWS = 256;
+
+/** @brief Number of tasks for loops that need an O(n) workspace per
+ *  task – a few per thread for balance, but not one per row block.    */
+int workspaceTasks(int n)
+{
+    return std::min(n, 4 * ThreadPool::instance().size());
+}
+
+/** @brief One (index, value) pair while building a compressed row. */
+struct Entry {
+    int col;
+    double val;
+    bool operator<(const Entry& o) const { return col < o.col; }
+};
+
+} // namespace
+
+/* ====================================================================
+   Rule-of-Three
+   ================================================================= */
+
+/** @brief Allocate storage for @p nnz entries (contents uninitialised
+ *  except outer[0] = 0 and outer[n] = nnz).                            */
+SparseMat::SparseMat(int n_, SparseFormat fmt_, long nnz)
+    : outer(nullptr), inner(nullptr), vals(nullptr), n(n_), fmt(fmt_)
+{
+    if (n <= 0) throw std::invalid_argument("n must be positive");
+    std::unique_ptr<long[]> o(new long[n + 1]);
+    std::unique_ptr<int[]> in(new int[nnz]);
+    vals = new double[nnz];
+    outer = o.release();
+    inner = in.release();
+    std::fill(outer, outer + n + 1, 0L);
+    outer[n] = nnz;
+}
+
+/** @brief The n×n zero matrix (no stored entries). */
+SparseMat::SparseMat(int n_, SparseFormat fmt_) : SparseMat(n_, fmt_, 0L) {}
+
+/** @brief Compress a dense matrix, dropping entries with |aᵢⱼ| ≤ @p dropTol. */
+SparseMat::SparseMat(const SquareMat& A, SparseFormat fmt_, double dropTol)
+    : outer(nullptr), inner(nullptr), vals(nullptr), n(A.getN()), fmt(SparseFormat::CSR)
+{
+    const double* a = A.raw();
+    std::unique_ptr<long[]> counts(new long[n + 1]);
+    ThreadPool::instance().parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        for (int i = blk * ROWS; i < std::min(n, (blk + 1) * ROWS); ++i) {
+            long c = 0;
+            for (int j = 0; j < n; ++j) c += std::fabs(a[static_cast<long>(i) * n + j]) > dropTol;
+            counts[i + 1] = c;
+        }
+    });
+    counts[0] = 0;
+    for (int i = 0; i < n; ++i) counts[i + 1] += counts[i];
+
+    std::unique_ptr<int[]> in(new int[counts[n]]);
+    vals = new double[counts[n]];
+    outer = counts.release();
+    inner = in.release();
+    ThreadPool::instance().parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        for (int i = blk * ROWS; i < std::min(n, (blk + 1) * ROWS); ++i) {
+            long p = outer[i];
+            for (int j = 0; j < n; ++j) {
+                const double v = a[static_cast<long>(i) * n + j];
+                if (std::fabs(v) > dropTol) { inner[p] = j; vals[p] = v; ++p; }
+            }
+        }
+    });
+    if (fmt_ == SparseFormat::CSC) *this = asFormat(SparseFormat::CSC);
+}
+
+/** @brief Build from coordinate triplets (rows[k], cols[k], values[k]);
+ *  duplicate coordinates are summed.
+ *  @throw std::out_of_range if an index is outside [0,n-1]            */
+SparseMat::SparseMat(int n_, long nnz, const int* rows, const int* cols,
+                     const double* values, SparseFormat fmt_)
+    : outer(nullptr), inner(nullptr), vals(nullptr), n(n_), fmt(SparseFormat::CSR)
+{
+    if (n <= 0) throw std::invalid_argument("n must be positive");
+    for (long k = 0; k < nnz; ++k)
+        if (rows[k] < 0 || rows[k] >= n || cols[k] < 0 || cols[k] >= n)
+            throw std::out_of_range("index out of range");
+
+    // --- bucket by row ---
+    std::unique_ptr<long[]> start(new long[n + 1]);
+    std::fill(start.get(), start.get() + n + 1, 0L);
+    for (long k = 0; k < nnz; ++k) ++start[rows[k] + 1];
+    for (int i = 0; i < n; ++i) start[i + 1] += start[i];
+    std::unique_ptr<Entry[]> bucket(new Entry[nnz]);
+    std::unique_ptr<long[]> fill(new long[n]);
+    std::copy(start.get(), start.get() + n, fill.get());
+    for (long k = 0; k < nnz; ++k) bucket[fill[rows[k]]++] = Entry{cols[k], values[k]};
+
+    // --- sort each row and merge duplicates in place ---
+    std::unique_ptr<long[]> o(new long[n + 1]);
+    o[0] = 0;
+    for (int i = 0; i < n; ++i) {
+        Entry* b = bucket.get() + start[i];
+        Entry* e = bucket.get() + start[i + 1];
+        std::sort(b, e);
+        long len = 0;
+        for (Entry* p = b; p < e; ++p) {
+            if (len > 0 && b[len - 1].col == p->col) b[len - 1].val += p->val;
+            else b[len++] = *p;
+        }
+        o[i + 1] = o[i] + len;
+    }
+
+    std::unique_ptr<int[]> in(new int[o[n]]);
+    vals = new double[o[n]];
+    outer = o.release();
+    inner = in.release();
+    for (int i = 0; i < n; ++i)
+        for (long p = outer[i]; p < outer[i + 1]; ++p) {
+            const Entry& en = bucket[start[i] + (p - outer[i])];
+            inner[p] = en.col;
+            vals[p] = en.val;
+        }
+    if (fmt_ == SparseFormat::CSC) *this = asFormat(SparseFormat::CSC);
+}
+
+/** @brief Deep-copy constructor (O(n + nnz)). */
+SparseMat::SparseMat(const SparseMat& other) : SparseMat(other.n, other.fmt, other.nonZeros())
+{
+    std::copy(other.outer, other.outer + n + 1, outer);
+    std::copy(other.inner, other.inner + other.nonZeros(), inner);
+    std::copy(other.vals, other.vals + other.nonZeros(), vals);
+}
+
+/** @brief Copy-assignment operator (copy-and-swap: a failed allocation
+ *  leaves *this unchanged).                                            */
+SparseMat& SparseMat::operator=(const SparseMat& other)
+{
+    if (this == &other) return *this;
+    SparseMat copy(other);
+    std::swap(outer, copy.outer);
+    std::swap(inner, copy.inner);
+    std::swap(vals, copy.vals);
+    std::swap(n, copy.n);
+    std::swap(fmt, copy.fmt);
+    return *this;                                  // copy משחרר את המערכים הישנים
+}
+
+/** @brief Destructor – frees the three compressed arrays. */
+SparseMat::~SparseMat()
+{
+    delete[] outer;
+    delete[] inner;
+    delete[] vals;
+}
+
+/** @brief Sparse identity (n stored ones). */
+SparseMat SparseMat::identity(int n, SparseFormat fmt)
+{
+    SparseMat I(n, fmt, static_cast<long>(n));
+    for (int i = 0; i < n; ++i) {
+        I.outer[i] = i;
+        I.inner[i] = i;
+        I.vals[i] = 1.0;
+    }
+    return I;
+}
+
+/* ====================================================================
+   Access / conversion
+   ================================================================= */
+
+/** @brief Value of element (i,j) – binary search inside row/column.
+ *  @throw std::out_of_range if indices are outside [0,n-1]            */
+double SparseMat::operator()(int i, int j) const
+{
+    if (i < 0 || i >= n || j < 0 || j >= n)
+        throw std::out_of_range("index out of range");
+    const int o = (fmt == SparseFormat::CSR) ? i : j;
+    const int in = (fmt == SparseFormat::CSR) ? j : i;
+    const int* b = inner + outer[o];
+    const int* e = inner + outer[o + 1];
+    const int* p = std::lower_bound(b, e, in);
+    return (p != e && *p == in) ? vals[p - inner] : 0.0;
+}
+
+int SparseMat::getN() const { return n; }
+long SparseMat::nonZeros() const { return outer[n]; }
+SparseFormat SparseMat::format() const { return fmt; }
+const long* SparseMat::outerIndex() const { return outer; }
+const int* SparseMat::innerIndex() const { return inner; }
+const double* SparseMat::values() const { return vals; }
+
+/** @brief Re-compress along the other dimension (counting sort, O(n+nnz)).
+ *  The result describes the transpose if the format tag is kept – the
+ *  callers flip or keep the tag as needed.                             */
+SparseMat SparseMat::transposedStorage() const
+{
+    SparseMat t(n, fmt, nonZeros());
+    std::fill(t.outer, t.outer + n + 1, 0L);
+    for (long p = 0; p < nonZeros(); ++p) ++t.outer[inner[p] + 1];
+    for (int i = 0; i < n; ++i) t.outer[i + 1] += t.outer[i];
+
+    std::unique_ptr<long[]> next(new long[n]);
+    std::copy(t.outer, t.outer + n, next.get());
+    for (int o = 0; o < n; ++o)
+        for (long p = outer[o]; p < outer[o + 1]; ++p) {
+            const long q = next[inner[p]]++;
+            t.inner[q] = o;
+            t.vals[q] = vals[p];
+        }
+    return t;
+}
+
+/** @brief Same matrix in format @p f. */
+SparseMat SparseMat::asFormat(SparseFormat f) const
+{
+    if (f == fmt) return *this;
+    SparseMat t = transposedStorage();
+    t.fmt = f;
+    return t;
+}
+
+SparseMat SparseMat::toCSR() const { return asFormat(SparseFormat::CSR); }
+SparseMat SparseMat::toCSC() const { return asFormat(SparseFormat::CSC); }
+
+/** @brief Expand to a dense SquareMat. */
+SquareMat SparseMat::toSquareMat() const
+{
+    SquareMat res(n, 0.0);
+    double* d = res.raw();
+    for (int o = 0; o < n; ++o)
+        for (long p = outer[o]; p < outer[o + 1]; ++p) {
+            const long r = (fmt == SparseFormat::CSR) ? o : inner[p];
+            const long c = (fmt == SparseFormat::CSR) ? inner[p] : o;
+            d[r * n + c] = vals[p];
+        }
+    return res;
+}
+
+/* ====================================================================
+   Products and sums
+   ================================================================= */
+
+/** @brief SpMV y = A·x.
+ *  CSR: rows are split across the pool.  CSC: each task scatters a
+ *  range of columns into a private copy of y, and the copies are then
+ *  reduced row-block by row-block.                                    */
+void SparseMat::multiply(const double* x, double* y) const
+{
+    ThreadPool& pool = ThreadPool::instance();
+    if (fmt == SparseFormat::CSR) {
+        pool.parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+            for (int i = blk * ROWS; i < std::min(n, (blk + 1) * ROWS); ++i) {
+                double s = 0.0;
+                for (long p = outer[i]; p < outer[i + 1]; ++p) s += vals[p] * x[inner[p]];
+                y[i] = s;
+            }
+        });
+        return;
+    }
+
+    const int tasks = std::min(n, pool.size());
+    std::unique_ptr<double[]> part(new double[static_cast<long>(tasks) * n]);
+    pool.parallelFor(0, tasks, [&](int t) {
+        double* yt = part.get() + static_cast<long>(t) * n;
+        std::fill(yt, yt + n, 0.0);
+        const int c0 = static_cast<int>(static_cast<long>(n) * t / tasks);
+        const int c1 = static_cast<int>(static_cast<long>(n) * (t + 1) / tasks);
+        for (int j = c0; j < c1; ++j) {
+            const double xj = x[j];
+            if (xj == 0.0) continue;
+            for (long p = outer[j]; p < outer[j + 1]; ++p) yt[inner[p]] += vals[p] * xj;
+        }
+    });
+    pool.parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        for (int i = blk * ROWS; i < std::min(n, (blk + 1) * ROWS); ++i) {
+            double s = 0.0;
+            for (int t = 0; t < tasks; ++t) s += part[static_cast<long>(t) * n + i];
+            y[i] = s;
+        }
+    });
+}
+
+/** @brief Sparse + sparse: sorted merge of each row (or column),
+ *  counted first so the result is allocated exactly once.            */
+SparseMat SparseMat::operator+(const SparseMat& rhs) const
+{
+    if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    SparseMat conv(1);
+    const SparseMat* r = &rhs;
+    if (rhs.fmt != fmt) { conv = rhs.asFormat(fmt); r = &conv; }
+
+    auto merge = [&](int o, int* outIdx, double* outVal) {
+        long a = outer[o], ae = outer[o + 1];
+        long b = r->outer[o], be = r->outer[o + 1];
+        long len = 0;
+        while (a < ae || b < be) {
+            int ia = (a < ae) ? inner[a] : n;
+            int ib = (b < be) ? r->inner[b] : n;
+            if (outIdx) {
+                outIdx[len] = std::min(ia, ib);
+                outVal[len] = (ia <= ib ? vals[a] : 0.0) + (ib <= ia ? r->vals[b] : 0.0);
+            }
+            if (ia <= ib) ++a;
+            if (ib <= ia) ++b;
+            ++len;
+        }
+        return len;
+    };
+
+    std::unique_ptr<long[]> counts(new long[n + 1]);
+    ThreadPool& pool = ThreadPool::instance();
+    pool.parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        for (int o = blk * ROWS; o < std::min(n, (blk + 1) * ROWS); ++o)
+            counts[o + 1] = merge(o, nullptr, nullptr);
+    });
+    counts[0] = 0;
+    for (int o = 0; o < n; ++o) counts[o + 1] += counts[o];
+
+    SparseMat res(n, fmt, counts[n]);
+    std::copy(counts.get(), counts.get() + n + 1, res.outer);
+    pool.parallelFor(0, (n + ROWS - 1) / ROWS, [&](int blk) {
+        for (int o = blk * ROWS; o < std::min(n, (blk + 1) * ROWS); ++o)
+            merge(o, res.inner + res.outer[o], res.vals + res.outer[o]);
+    });
+    return res;
+}
+
+/** @brief SpGEMM with Gustavson's row-by-row algorithm.
+ *
+ *  Each task owns a contiguous range of result rows and a private dense
+ *  accumulator (value array + marker array of length n).  A symbolic
+ *  pass counts the entries of every row, the counts are prefix-summed,
+ *  and a numeric pass fills the exactly-sized result.  For two CSC
+ *  operands the same routine runs on the transposed view:
+ *  CSC(A·B) = CSR(Bᵀ·Aᵀ).                                              */
+SparseMat SparseMat::operator*(const SparseMat& rhs) const
+{
+    if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    SparseMat conv(1);
+    const SparseMat* r = &rhs;
+    if (rhs.fmt != fmt) { conv = rhs.asFormat(fmt); r = &conv; }
+
+    const SparseMat& X = (fmt == SparseFormat::CSR) ? *this : *r;
+    const SparseMat& Y = (fmt == SparseFormat::CSR) ? *r : *this;
+
+    ThreadPool& pool = ThreadPool::instance();
+    const int tasks = workspaceTasks(n);
+    std::unique_ptr<long[]> counts(new long[n + 1]);
+
+    pool.parallelFor(0, tasks, [&](int t) {
+        const int r0 = static_cast<int>(static_cast<long>(n) * t / tasks);
+        const int r1 = static_cast<int>(static_cast<long>(n) * (t + 1) / tasks);
+        std::unique_ptr<int[]> marker(new int[n]);
+        std::fill(marker.get(), marker.get() + n, -1);
+        for (int i = r0; i < r1; ++i) {
+            long cnt = 0;
+            for (long p = X.outer[i]; p < X.outer[i + 1]; ++p) {
+                const int k = X.inner[p];
+                for (long q = Y.outer[k]; q < Y.outer[k + 1]; ++q)
+                    if (marker[Y.inner[q]] != i) { marker[Y.inner[q]] = i; ++cnt; }
+            }
+            counts[i + 1] = cnt;
+        }
+    });
+    counts[0] = 0;
+    for (int i = 0; i < n; ++i) counts[i + 1] += counts[i];
+
+    SparseMat res(n, fmt, counts[n]);
+    std::copy(counts.get(), counts.get() + n + 1, res.outer);
+
+    pool.parallelFor(0, tasks, [&](int t) {
+        const int r0 = static_cast<int>(static_cast<long>(n) * t / tasks);
+        const int r1 = static_cast<int>(static_cast<long>(n) * (t + 1) / tasks);
+        std::unique_ptr<int[]> marker(new int[n]);
+        std::unique_ptr<double[]> acc(new double[n]);
+        std::fill(marker.get(), marker.get() + n, -1);
+        for (int i = r0; i < r1; ++i) {
+            int* cols = res.inner + res.outer[i];
+            int len = 0;
+            for (long p = X.outer[i]; p < X.outer[i + 1]; ++p) {
+                const int k = X.inner[p];
+                const double a = X.vals[p];
+                for (long q = Y.outer[k]; q < Y.outer[k + 1]; ++q) {
+                    const int j = Y.inner[q];
+                    if (marker[j] != i) { marker[j] = i; cols[len++] = j; acc[j] = a * Y.vals[q]; }
+                    else acc[j] += a * Y.vals[q];
+                }
+            }
+            std::sort(cols, cols + len);
+            double* v = res.vals + res.outer[i];
+            for (int c = 0; c < len; ++c) v[c] = acc[cols[c]];
+        }
+    });
+    return res;
+}
+
+/** @brief Multiply every stored value by scalar @p s. */
+SparseMat SparseMat::operator*(double s) const
+{
+    SparseMat res(*this);
+    for (long p = 0; p < nonZeros(); ++p) res.vals[p] *= s;
+    return res;
+}
+
+/** @brief Sparse × dense: every result row is a combination of the rows
+ *  of @p rhs selected by the nonzeros – O(nnz·n).                      */
+SquareMat SparseMat::operator*(const SquareMat& rhs) const
+{
+    if (n != rhs.getN()) throw std::invalid_argument("dimension mismatch");
+    SparseMat conv(1);
+    const SparseMat* a = this;
+    if (fmt != SparseFormat::CSR) { conv = toCSR(); a = &conv; }
+
+    SquareMat res(n, 0.0);
+    const double* b = rhs.raw();
+    double* c = res.raw();
+    ThreadPool::instance().parallelFor(0, (n + 63) / 64, [&](int blk) {
+        for (int i = blk * 64; i < std::min(n, (blk + 1) * 64); ++i) {
+            double* ci = c + static_cast<long>(i) * n;
+            for (long p = a->outer[i]; p < a->outer[i + 1]; ++p) {
+                const double v = a->vals[p];
+                const double* bk = b + static_cast<long>(a->inner[p]) * n;
+                for (int j = 0; j < n; ++j) ci[j] += v * bk[j];
+            }
+        }
+    });
+    return res;
+}
+
+/** @brief Transpose in the same format (one counting-sort pass). */
+SparseMat SparseMat::operator~() const
+{
+    return transposedStorage();
+}
+
+/** @brief Sparse power by binary exponentiation over SpGEMM. */
+SparseMat SparseMat::operator^(int e) const
+{
+    if (e < 0) throw std::invalid_argument("negative exponent");
+    SparseMat base(*this);
+    SparseMat res = identity(n, fmt);
+    while (e) {
+        if (e & 1) res = res * base;
+        e >>= 1;
+        if (e) base = base * base;
+    }
+    return res;
+}
+
+namespace matrix {
+
+/** @brief Dense × sparse: row i of the result accumulates
+ *  lhs(i,k) · (row k of @p rhs) over k.                               */
+SquareMat operator*(const SquareMat& lhs, const SparseMat& rhs)
+{
+    const int n = rhs.getN();
+    if (n != lhs.getN()) throw std::invalid_argument("dimension mismatch");
+    const SparseMat s = rhs.toCSR();
+    const long* op = s.outerIndex();
+    const int* ix = s.innerIndex();
+    const double* v = s.values();
+
+    SquareMat res(n, 0.0);
+    const double* a = lhs.raw();
+    double* c = res.raw();
+    ThreadPool::instance().parallelFor(0, (n + 63) / 64, [&](int blk) {
+        for (int i = blk * 64; i < std::min(n, (blk + 1) * 64); ++i) {
+            double* ci = c + static_cast<long>(i) * n;
+            for (int k = 0; k < n; ++k) {
+                const double aik = a[static_cast<long>(i) * n + k];
+                if (aik == 0.0) continue;
+                for (long p = op[k]; p < op[k + 1]; ++p) ci[ix[p]] += aik * v[p];
+            }
+        }
+    });
+    return res;
+}
+
+/** @brief Print the stored entries as "(i, j) value" lines. */
+std::ostream& operator<<(std::ostream& os, const SparseMat& m)
+{
+    const long* op = m.outerIndex();
+    const int* ix = m.innerIndex();
+    const double* v = m.values();
+    for (int o = 0; o < m.getN(); ++o)
+        for (long p = op[o]; p < op[o + 1]; ++p) {
+            const int i = (m.format() == SparseFormat::CSR) ? o : ix[p];
+            const int j = (m.format() == SparseFormat::CSR) ? ix[p] : o;
+            os << '(' << i << ", " << j << ") " << v[p] << '\n';
+        }
+    return os;
+}
+
+} // namespace matrix
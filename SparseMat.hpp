@@ -0,0 +1,72 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef SPARSEMAT_HPP
+#define SPARSEMAT_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+
+namespace matrix {
+
+enum class SparseFormat { CSR, CSC };
+
+/**
+ * Sparse n×n matrix in compressed row (CSR) or compressed column (CSC)
+ * form.  For CSR, row i owns entries outer[i] … outer[i+1]-1 of
+ * inner (column indices, sorted ascending) and values; CSC is the same
+ * with rows and columns swapped.
+ */
+class SparseMat {
+private:
+    long* outer;      // n+1 היסטים (שורות ב-CSR / עמודות ב-CSC)
+    int* inner;       // אינדקס עמודה (CSR) / שורה (CSC) לכל איבר
+    double* vals;
+    int n;
+    SparseFormat fmt;
+
+    SparseMat(int n, SparseFormat fmt, long nnz);       // מקצה בלבד
+    SparseMat transposedStorage() const;
+    SparseMat asFormat(SparseFormat f) const;
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    explicit SparseMat(int n, SparseFormat fmt = SparseFormat::CSR);   // מטריצת אפס
+    explicit SparseMat(const SquareMat& A, SparseFormat fmt = SparseFormat::CSR,
+                       double dropTol = 0.0);
+    SparseMat(int n, long nnz, const int* rows, const int* cols, const double* values,
+              SparseFormat fmt = SparseFormat::CSR);                   // COO, כפילויות מסוכמות
+    SparseMat(const SparseMat& other);
+    SparseMat& operator=(const SparseMat& other);
+    ~SparseMat();
+
+    static SparseMat identity(int n, SparseFormat fmt = SparseFormat::CSR);
+
+    // ---------- גישה ----------
+    double operator()(int i, int j) const;
+    int getN() const;
+    long nonZeros() const;
+    SparseFormat format() const;
+    const long* outerIndex() const;
+    const int* innerIndex() const;
+    const double* values() const;
+
+    SparseMat toCSR() const;
+    SparseMat toCSC() const;
+    SquareMat toSquareMat() const;
+
+    // ---------- פעולות ----------
+    void multiply(const double* x, double* y) const;      // SpMV: y = A·x
+    SparseMat operator+(const SparseMat& rhs) const;
+    SparseMat operator*(const SparseMat& rhs) const;      // SpGEMM (Gustavson)
+    SparseMat operator*(double s) const;
+    SquareMat operator*(const SquareMat& rhs) const;      // דליל × צפוף
+    SparseMat operator~() const;
+    SparseMat operator^(int e) const;
+};
+
+SquareMat operator*(const SquareMat& lhs, const SparseMat& rhs);   // צפוף × דליל
+std::ostream& operator<<(std::ostream& out, const SparseMat& m);
+
+} // namespace matrix
+
+#endif // SPARSEMAT_HPP
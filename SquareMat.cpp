@@ -1,51 +1,117 @@
 // adi.gamzu@msmail.ariel.ac.il
 #include "SquareMat.hpp"
+#include "Kernels.hpp"
+#include "Format.hpp"
+#include "Instrument.hpp"
+#include "Numa.hpp"
 #include <algorithm>   // std::copy, std::fill
+#include <utility>     // std::swap
 #include <numeric>     // std::accumulate
-#include <stdexcept>   // std::invalid_argument, std::out_of_range
+#include <stdexcept>   // std::invalid_argument, std::out_of_range, std::logic_error, std::length_error
 #include <iostream>
 
 using namespace matrix;
 
+namespace {
+
+/** @brief FLOP model of operator^(e): one n³ product per squaring and
+ *  per set bit of @p e.                                                */
+[[maybe_unused]] std::uint64_t powerFlops(int e, int n)
+{
+    std::uint64_t products = 0;
+    for (; e > 0; e >>= 1) products += 1 + (e & 1);
+    return products * 2 * static_cast<std::uint64_t>(n) * n * n;
+}
+
+/** @brief FLOP model of the Laplace expansion: f(n) = n·(f(n−1) + 3). */
+[[maybe_unused]] std::uint64_t laplaceFlops(int n)
+{
+    std::uint64_t f = (n >= 2) ? 3 : 0;
+    for (int k = 3; k <= n; ++k) f = k * (f + 3);
+    return f;
+}
+
+} // namespace
+
 /* ====================================================================
    Rule-of-Three
    ================================================================= */
 
+/** @brief Give an empty object n×n storage initialized from @p src (or
+ *  with @p fill): NUMA-placed when numa::placement() asks for it and the
+ *  matrix is large enough, otherwise on the heap.
+ *  @throw std::length_error if n > MAX_N (n*n would overflow int)     */
+void SquareMat::allocate(const double* src, double fill)
+{
+    if (n > MAX_N) throw std::length_error("matrix dimension too large");
+    const std::size_t count = static_cast<std::size_t>(n) * static_cast<std::size_t>(n);
+    std::size_t bytes = 0;
+    if (double* placed = numa::allocate(n, n, src, fill, bytes)) {
+        data = placed;
+        mapBase = placed;
+        mapBytes = bytes;
+        numaPlaced = true;
+    } else {
+        data = new double[count];
+        if (src) std::copy(src, src + count, data);
+        else std::fill(data, data + count, fill);
+    }
+    SQM_ALLOC(8ULL * n * n);
+}
+
 /** @brief Construct an @c n×n matrix filled with @p initVal.
  *  @param n_      dimension (must be > 0)  
  *  @param initVal value to fill every element with  
- *  @throw std::invalid_argument if @p n_ ≤ 0                                   */
-SquareMat::SquareMat(int n_, double initVal) : data(nullptr), n(n_)
+ *  @throw std::invalid_argument if @p n_ ≤ 0
+ *  @throw std::length_error if @p n_ > MAX_N                                   */
+SquareMat::SquareMat(int n_, double initVal)
+    : data(nullptr), n(n_), mapBase(nullptr), mapBytes(0), readOnly(false), numaPlaced(false)
 {
     if (n <= 0) throw std::invalid_argument("n must be positive");
-    data = new double[n * n];
-    std::fill(data, data + n * n, initVal);
+    allocate(nullptr, initVal);
 }
 
-/** @brief Deep-copy constructor (O(n²)). */
-SquareMat::SquareMat(const SquareMat& other) : data(nullptr), n(other.n)
+/** @brief Deep-copy constructor (O(n²)); a copy of a mapped matrix is
+ *  an ordinary heap (or NUMA-placed) matrix.                           */
+SquareMat::SquareMat(const SquareMat& other)
+    : data(nullptr), n(other.n), mapBase(nullptr), mapBytes(0), readOnly(false), numaPlaced(false)
 {
-    data = new double[n * n];
-    std::copy(other.data, other.data + n * n, data);
+    SQM_SCOPE(Copy, 0, 16ULL * n * n);
+    allocate(other.data, 0.0);
 }
 
 /** @brief Copy-assignment operator.  
- *  Handles self-assignment and re-allocation when @p other.n differs. */
+ *  Handles self-assignment and re-allocation when @p other.n differs;
+ *  a mapped target drops its mapping and becomes a heap matrix.  A
+ *  same-size NUMA-placed target keeps its pages (and their placement). */
 SquareMat& SquareMat::operator=(const SquareMat& other)
 {
     if (this == &other) return *this;
+    SQM_SCOPE(Copy, 0, 16ULL * other.n * other.n);
 
-    if (n != other.n) {
-        delete[] data;
-        n = other.n;
-        data = new double[n * n];
+    if (n == other.n && !isMapped()) {
+        std::copy(other.data, other.data + n * n, data);
+        return *this;
     }
-    std::copy(other.data, other.data + n * n, data);
-    return *this;
+    SquareMat fresh(other.n, nullptr, nullptr, 0, false);   // ללא Copy מקונן במדדים
+    fresh.allocate(other.data, 0.0);
+    std::swap(n, fresh.n);
+    std::swap(data, fresh.data);
+    std::swap(mapBase, fresh.mapBase);
+    std::swap(mapBytes, fresh.mapBytes);
+    std::swap(readOnly, fresh.readOnly);
+    std::swap(numaPlaced, fresh.numaPlaced);
+    return *this;                                          // fresh משחרר את האחסון הישן
 }
 
-/** @brief Destructor – frees the contiguous @c double* buffer. */
-SquareMat::~SquareMat() { delete[] data; }
+/** @brief Destructor – frees the buffer or unmaps the file (release() is in MappedMat.cpp). */
+SquareMat::~SquareMat() { release(); }
+
+/** @throw std::logic_error on a read-only mapped matrix */
+void SquareMat::requireWritable() const
+{
+    if (readOnly) throw std::logic_error("matrix is a read-only mapping");
+}
 
 /* ====================================================================
    Element access
@@ -100,6 +166,7 @@ double SquareMat::sum() const
  *  @throw std::invalid_argument if dimensions differ.                     */
 SquareMat SquareMat::operator%(const SquareMat& other) const {
     if (n != other.n) throw std::invalid_argument("dimension mismatch");
+    SQM_SCOPE(Hadamard, 1ULL * n * n, 24ULL * n * n);
     SquareMat res(n);
     for (int k = 0; k < n * n; ++k)
         res.data[k] = data[k] * other.data[k];
@@ -110,6 +177,7 @@ SquareMat SquareMat::operator%(const SquareMat& other) const {
 SquareMat SquareMat::operator+(const SquareMat& rhs) const
 {
     if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    SQM_SCOPE(Add, 1ULL * n * n, 24ULL * n * n);
     SquareMat res(n);
     for (int k = 0; k < n * n; ++k)
         res.data[k] = data[k] + rhs.data[k];
@@ -120,6 +188,8 @@ SquareMat SquareMat::operator+(const SquareMat& rhs) const
 SquareMat& SquareMat::operator+=(const SquareMat& rhs)
 {
     if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    requireWritable();
+    SQM_SCOPE(Add, 1ULL * n * n, 24ULL * n * n);
     for (int k = 0; k < n * n; ++k)
         data[k] += rhs.data[k];
     return *this;
@@ -129,6 +199,7 @@ SquareMat& SquareMat::operator+=(const SquareMat& rhs)
 SquareMat SquareMat::operator-(const SquareMat& rhs) const
 {
     if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    SQM_SCOPE(Subtract, 1ULL * n * n, 24ULL * n * n);
     SquareMat res(n);
     for (int k = 0; k < n * n; ++k)
         res.data[k] = data[k] - rhs.data[k];
@@ -138,6 +209,7 @@ SquareMat SquareMat::operator-(const SquareMat& rhs) const
 /** @brief Unary minus – returns @c (-mat). */
 SquareMat SquareMat::operator-() const
 {
+    SQM_SCOPE(Negate, 1ULL * n * n, 16ULL * n * n);
     SquareMat res(n);
     for (int k = 0; k < n * n; ++k)
         res.data[k] = -data[k];
@@ -146,21 +218,23 @@ SquareMat SquareMat::operator-() const
 
 /* ------------------ matrix × matrix ------------------ */
 
-/** @brief Classic O(n³) matrix multiplication. */
+/** @brief Matrix multiplication through the blocked, multithreaded
+ *  kernels::gemm (packed panels + register micro-kernel).               */
 SquareMat SquareMat::operator*(const SquareMat& rhs) const
 {
     if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    SQM_SCOPE(Multiply, 2ULL * n * n * n, 24ULL * n * n);
     SquareMat res(n, 0.0);
-    for (int i = 0; i < n; ++i)
-        for (int k = 0; k < n; ++k)
-            for (int j = 0; j < n; ++j)
-                res(i, j) += (*this)(i, k) * rhs(k, j);
+    kernels::gemm(n, n, n, 1.0, data, n, false, rhs.data, n, false,
+                  0.0, res.data, n);
     return res;
 }
 
 /** @brief In-place matrix multiplication. */
 SquareMat& SquareMat::operator*=(const SquareMat& rhs)
 {
+    requireWritable();
+    SQM_SCOPE(Multiply, 2ULL * n * n * n, 24ULL * n * n);
     *this = *this * rhs;
     return *this;
 }
@@ -170,6 +244,7 @@ SquareMat& SquareMat::operator*=(const SquareMat& rhs)
 /** @brief Multiply every element by scalar @p s (creates new matrix). */
 SquareMat SquareMat::operator*(double s) const
 {
+    SQM_SCOPE(Scale, 1ULL * n * n, 16ULL * n * n);
     SquareMat res(n);
     for (int k = 0; k < n * n; ++k)
         res.data[k] = data[k] * s;
@@ -179,6 +254,8 @@ SquareMat SquareMat::operator*(double s) const
 /** @brief In-place scalar multiplication. */
 SquareMat& SquareMat::operator*=(double s)
 {
+    requireWritable();
+    SQM_SCOPE(Scale, 1ULL * n * n, 16ULL * n * n);
     for (int k = 0; k < n * n; ++k)
         data[k] *= s;
     return *this;
@@ -193,6 +270,7 @@ SquareMat operator*(double s, const SquareMat& m) { return m * s; }
 SquareMat SquareMat::operator/(double s) const
 {
     if (s == 0) throw std::invalid_argument("division by zero");
+    SQM_SCOPE(Scale, 1ULL * n * n, 16ULL * n * n);
     SquareMat res(n);
     for (int k = 0; k < n * n; ++k)
         res.data[k] = data[k] / s;
@@ -203,6 +281,8 @@ SquareMat SquareMat::operator/(double s) const
 SquareMat& SquareMat::operator/=(double s)
 {
     if (s == 0) throw std::invalid_argument("division by zero");
+    requireWritable();
+    SQM_SCOPE(Scale, 1ULL * n * n, 16ULL * n * n);
     for (int k = 0; k < n * n; ++k)
         data[k] /= s;
     return *this;
@@ -212,12 +292,16 @@ SquareMat& SquareMat::operator/=(double s)
    Comparison (sum of elements)
    ================================================================= */
 
-bool SquareMat::operator==(const SquareMat& rhs) const { return sum() == rhs.sum(); }
-bool SquareMat::operator!=(const SquareMat& rhs) const { return !(*this == rhs); }
-bool SquareMat::operator< (const SquareMat& rhs) const { return sum()  < rhs.sum(); }
-bool SquareMat::operator<=(const SquareMat& rhs) const { return sum() <= rhs.sum(); }
-bool SquareMat::operator> (const SquareMat& rhs) const { return sum()  > rhs.sum(); }
-bool SquareMat::operator>=(const SquareMat& rhs) const { return sum() >= rhs.sum(); }
+#define SQM_COMPARE SQM_SCOPE(Compare, 2ULL * n * n, 8ULL * (n * n + rhs.n * rhs.n))
+
+bool SquareMat::operator==(const SquareMat& rhs) const { SQM_COMPARE; return sum() == rhs.sum(); }
+bool SquareMat::operator!=(const SquareMat& rhs) const { SQM_COMPARE; return !(*this == rhs); }
+bool SquareMat::operator< (const SquareMat& rhs) const { SQM_COMPARE; return sum()  < rhs.sum(); }
+bool SquareMat::operator<=(const SquareMat& rhs) const { SQM_COMPARE; return sum() <= rhs.sum(); }
+bool SquareMat::operator> (const SquareMat& rhs) const { SQM_COMPARE; return sum()  > rhs.sum(); }
+bool SquareMat::operator>=(const SquareMat& rhs) const { SQM_COMPARE; return sum() >= rhs.sum(); }
+
+#undef SQM_COMPARE
 
 /* ====================================================================
    Transpose
@@ -226,6 +310,7 @@ bool SquareMat::operator>=(const SquareMat& rhs) const { return sum() >= rhs.sum
 /** @brief Return the transpose (~mat). */
 SquareMat SquareMat::operator~() const
 {
+    SQM_SCOPE(Transpose, 0, 16ULL * n * n);
     SquareMat res(n);
     for (int i = 0; i < n; ++i)
         for (int j = 0; j < n; ++j)
@@ -237,9 +322,9 @@ SquareMat SquareMat::operator~() const
    ++ / -- (prefix & postfix)
    ================================================================= */
 
-SquareMat& SquareMat::operator++()          { for (int k = 0; k < n * n; ++k) ++data[k]; return *this; }
+SquareMat& SquareMat::operator++()          { requireWritable(); SQM_SCOPE(Increment, 1ULL * n * n, 16ULL * n * n); for (int k = 0; k < n * n; ++k) ++data[k]; return *this; }
 SquareMat  SquareMat::operator++(int)       { SquareMat tmp(*this); ++(*this); return tmp; }
-SquareMat& SquareMat::operator--()          { for (int k = 0; k < n * n; ++k) --data[k]; return *this; }
+SquareMat& SquareMat::operator--()          { requireWritable(); SQM_SCOPE(Increment, 1ULL * n * n, 16ULL * n * n); for (int k = 0; k < n * n; ++k) --data[k]; return *this; }
 SquareMat  SquareMat::operator--(int)       { SquareMat tmp(*this); --(*this); return tmp; }
 
 /* ====================================================================
@@ -250,6 +335,7 @@ SquareMat  SquareMat::operator--(int)       { SquareMat tmp(*this); --(*this); r
 SquareMat SquareMat::operator^(int e) const
 {
     if (e < 0) throw std::invalid_argument("negative exponent");
+    SQM_SCOPE(Power, powerFlops(e, n), 24ULL * n * n);
     SquareMat base(*this);
     SquareMat res(n, 0.0);
     for (int i = 0; i < n; ++i) res(i, i) = 1;   // identity
@@ -269,6 +355,7 @@ SquareMat SquareMat::operator^(int e) const
  *  Only demonstrative for n≤3 – O(n!).                            */
 double SquareMat::operator!() const
 {
+    SQM_SCOPE(Determinant, laplaceFlops(n), 8ULL * n * n);
     if (n == 1) return data[0];
 
     if (n == 2) return data[0] * data[3] - data[1] * data[2];
@@ -294,19 +381,20 @@ double SquareMat::operator!() const
 /** @brief Return matrix dimension. */
 int SquareMat::getN() const { return n; }
 
+/** @brief Contiguous row-major buffer of n×n elements (for kernels). */
+double* SquareMat::raw() { return data; }
+
+/** @brief Contiguous row-major buffer (const). */
+const double* SquareMat::raw() const { return data; }
+
 namespace matrix {
 
-/** @brief Pretty-print the matrix row-by-row. */
+/** @brief Pretty-print the matrix row-by-row ("[ a b c ]" lines, each
+ *  value in shortest round-trip form) through writeMatrix().          */
 std::ostream& operator<<(std::ostream& os, const SquareMat& m)
 {
-    for (int i = 0; i < m.getN(); ++i) {
-        os << "[ ";
-        for (int j = 0; j < m.getN(); ++j) {
-            os << m(i, j);
-            if (j + 1 < m.getN()) os << ' ';
-        }
-        os << " ]\n";
-    }
+    SQM_SCOPE(Output, 0, 8ULL * m.getN() * m.getN());
+    writeMatrix(os, m);
     return os;
 }
 
@@ -3,16 +3,33 @@
 #ifndef SQUAREMAT_HPP
 #define SQUAREMAT_HPP
 
+#include <cstddef>
 #include <iostream>
+#include <string>
 
 namespace matrix {
 
+// ---------- מיפוי קובץ לזיכרון ----------
+enum class MapMode { ReadOnly, Private };                 // Private = copy-on-write
+enum class Access { Normal, Sequential, Random, WillNeed };
+
 class SquareMat {
 private:
     double* data;   // מערך חד-ממדי בגודל n×n
     int n;          // גודל המטריצה (n×n)
+    void* mapBase;          // nullptr = אחסון בערימה; אחרת תחילת המיפוי
+    std::size_t mapBytes;
+    bool readOnly;
+    bool numaPlaced;        // mapBase הוא באפר אנונימי של numa::allocate, לא קובץ
+
+    SquareMat(int n, double* data, void* mapBase, std::size_t mapBytes, bool readOnly);
+    void allocate(const double* src, double fill);
+    void release();
+    void requireWritable() const;
 
 public:
+    static constexpr int MAX_N = 46340;   // הגדול ביותר ש-n*n שלו נכנס ב-int
+
     // ---------- בנאים ו־Rule of 3 ----------
     SquareMat(int n, double initVal = 0.0);
     SquareMat(const SquareMat& other);
@@ -29,6 +46,18 @@ public:
     int getN() const;
     double sum() const;
 
+    double* raw();                 // גישה ישירה לבאפר (row-major)
+    const double* raw() const;
+
+    // ---------- אחסון ממופה (mmap של קובץ בפורמט הבינארי) ----------
+    static SquareMat mapFile(const std::string& path, MapMode mode = MapMode::ReadOnly,
+                             Access hint = Access::Normal, bool verify = false);
+    static SquareMat mapRaw(const std::string& path, int n, std::size_t offset,
+                            MapMode mode = MapMode::ReadOnly, Access hint = Access::Normal);
+    bool isMapped() const;
+    bool isReadOnly() const;
+    void advise(Access hint) const;
+
     // ---------- פעולות אריתמטיות ----------
     SquareMat operator+(const SquareMat& rhs) const;
     SquareMat& operator+=(const SquareMat& rhs);
@@ -0,0 +1,742 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "SymEig.hpp"
+#include "Householder.hpp"
+#include "Kernels.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min, std::max, std::sort, std::swap
+#include <cfloat>      // DBL_EPSILON, DBL_MIN
+#include <cmath>       // std::fabs, std::sqrt, std::hypot, std::copysign
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::invalid_argument, std::out_of_range, std::logic_error, std::runtime_error
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Panel width of the tridiagonal reduction. */
+constexpr int NB = 32;
+
+/** @brief Reflectors applied together in the back-transformation. */
+constexpr int NB_APPLY = 64;
+
+/** @brief Sub-problems this small are solved directly by implicit QL. */
+constexpr int LEAF = 32;
+
+constexpr double EPS = DBL_EPSILON;
+
+/** @brief Dot product with eight independent partial sums, so the
+ *  loop vectorizes instead of waiting on one accumulator.              */
+double dot(const double* x, const double* y, int len)
+{
+    double acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    int i = 0;
+    for (; i + 8 <= len; i += 8)
+        for (int l = 0; l < 8; ++l) acc[l] += x[i + l] * y[i + l];
+    double s = ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+    for (; i < len; ++i) s += x[i] * y[i];
+    return s;
+}
+
+/* ====================================================================
+   Householder tridiagonalization  Qᵀ·A·Q = T
+   ================================================================= */
+
+/** @brief Blocked reduction to tridiagonal form (LAPACK dsytrd/dlatrd).
+ *
+ *  @p w is a full symmetric n×n copy of A.  Column c is read as row c
+ *  (A is symmetric), so every access is contiguous.  Inside a panel the
+ *  pending rank-2 updates are kept as NB pairs of vectors (V, W) and
+ *  folded in lazily; after the panel the trailing matrix receives
+ *  A -= V·Wᵀ + W·Vᵀ through two gemm calls.  The symmetric
+ *  matrix-vector product of each step is split across the pool.
+ *  On exit row c of @p w holds v_c from column c+2 on, d/e the
+ *  tridiagonal and tau the reflector scalars.                          */
+void tridiagonalize(double* w, int n, double* d, double* e, double* tau)
+{
+    ThreadPool& pool = ThreadPool::instance();
+    std::unique_ptr<double[]> Vp(new double[static_cast<long>(NB) * n]);
+    std::unique_ptr<double[]> Wp(new double[static_cast<long>(NB) * n]);
+    std::unique_ptr<double[]> y(new double[n]);
+
+    for (int k0 = 0; k0 < n - 1; k0 += NB) {
+        const int kb = std::min(NB, n - 1 - k0);
+        std::fill(Vp.get(), Vp.get() + static_cast<long>(kb) * n, 0.0);
+        std::fill(Wp.get(), Wp.get() + static_cast<long>(kb) * n, 0.0);
+
+        trace::Span panel("tridiag panel", "panel", "col", k0);
+        for (int j = 0; j < kb; ++j) {
+            const int c = k0 + j;
+            double* row = w + static_cast<long>(c) * n;
+
+            // --- fold the panel's pending updates into column c ---
+            for (int t = 0; t < j; ++t) {
+                const double* vt = Vp.get() + static_cast<long>(t) * n;
+                const double* wt = Wp.get() + static_cast<long>(t) * n;
+                const double a = wt[c], b = vt[c];
+                for (int r = c; r < n; ++r) row[r] -= vt[r] * a + wt[r] * b;
+            }
+            d[c] = row[c];
+
+            // --- reflector annihilating A(c+2:n, c) ---
+            double beta, tc;
+            householder::generate(n - c - 1, row + c + 1, 1, beta, tc);
+            e[c] = beta;
+            tau[c] = tc;
+
+            double* v = Vp.get() + static_cast<long>(j) * n;
+            double* wv = Wp.get() + static_cast<long>(j) * n;
+            v[c + 1] = 1.0;
+            std::copy(row + c + 2, row + n, v + c + 2);
+            if (tc == 0.0) continue;
+
+            // --- y = A22·v (rows are independent) ---
+            pool.parallelFor(0, (n - c - 1 + 63) / 64, [&](int blk) {
+                const int r0 = c + 1 + blk * 64;
+                const int r1 = std::min(n, r0 + 64);
+                for (int r = r0; r < r1; ++r)
+                    y[r] = dot(w + static_cast<long>(r) * n + c + 1, v + c + 1, n - c - 1);
+            });
+
+            // --- minus the pending updates: y -= V·(Wᵀv) + W·(Vᵀv) ---
+            for (int t = 0; t < j; ++t) {
+                const double* vt = Vp.get() + static_cast<long>(t) * n;
+                const double* wt = Wp.get() + static_cast<long>(t) * n;
+                const double wtv = dot(wt + c + 1, v + c + 1, n - c - 1);
+                const double vtv = dot(vt + c + 1, v + c + 1, n - c - 1);
+                for (int r = c + 1; r < n; ++r) y[r] -= vt[r] * wtv + wt[r] * vtv;
+            }
+
+            // --- w = τ·y − ½τ²(yᵀv)·v ---
+            double yv = 0.0;
+            for (int r = c + 1; r < n; ++r) { wv[r] = tc * y[r]; yv += wv[r] * v[r]; }
+            const double alpha = -0.5 * tc * yv;
+            for (int r = c + 1; r < n; ++r) wv[r] += alpha * v[r];
+        }
+        panel.end();
+
+        const int s0 = k0 + kb;
+        const int m = n - s0;
+        double* a22 = w + static_cast<long>(s0) * n + s0;
+        kernels::gemm(m, m, kb, -1.0, Vp.get() + s0, n, true, Wp.get() + s0, n, false, 1.0, a22, n);
+        kernels::gemm(m, m, kb, -1.0, Wp.get() + s0, n, true, Vp.get() + s0, n, false, 1.0, a22, n);
+    }
+    d[n - 1] = w[static_cast<long>(n - 1) * n + n - 1];
+}
+
+/** @brief Z ← Q·Z for the Q of tridiagonalize(); Z is n×k row-major.
+ *  Reflectors are applied NB_APPLY at a time in compact WY form, so
+ *  the work is three gemm calls per block – O(n²k) in total.           */
+void backTransform(const double* w, const double* tau, int n, double* Z, int k)
+{
+    const int last = n - 1;                                  // רפלקטורים 0 … n-2
+    for (int c1 = last; c1 > 0; c1 -= NB_APPLY) {
+        const int c0 = std::max(0, c1 - NB_APPLY);
+        const int kb = c1 - c0;
+        const int m = n - c0 - 1;
+
+        std::unique_ptr<double[]> V(new double[static_cast<long>(kb) * m]);
+        std::unique_ptr<double[]> T(new double[static_cast<long>(kb) * kb]);
+        householder::unpackV(kb, m, w + static_cast<long>(c0) * n + c0 + 1, n, V.get());
+        householder::formT(m, kb, V.get(), m, tau + c0, T.get());
+        householder::applyLeft(false, m, k, kb, V.get(), m, T.get(),
+                               Z + static_cast<long>(c0 + 1) * k, k);
+    }
+}
+
+/* ====================================================================
+   Tridiagonal eigensolvers
+   ================================================================= */
+
+/** @brief Sort eigenvalues ascending, permuting the columns of Q along. */
+void sortPairs(int n, double* d, double* Q, int ldq)
+{
+    for (int i = 0; i < n - 1; ++i) {
+        int best = i;
+        for (int j = i + 1; j < n; ++j) if (d[j] < d[best]) best = j;
+        if (best == i) continue;
+        std::swap(d[i], d[best]);
+        for (int r = 0; r < n; ++r)
+            std::swap(Q[static_cast<long>(r) * ldq + i], Q[static_cast<long>(r) * ldq + best]);
+    }
+}
+
+/** @brief Implicit QL with Wilkinson shifts (EISPACK tql2) on a small
+ *  tridiagonal; Q must start as the identity and returns the
+ *  eigenvectors as columns.  With Q = nullptr only the eigenvalues are
+ *  found (tql1) – O(n²) work and no n×n storage, at any size.          */
+void tql(int n, double* d, const double* eIn, double* Q, int ldq)
+{
+    std::unique_ptr<double[]> e(new double[n]);
+    std::copy(eIn, eIn + n - 1, e.get());
+    e[n - 1] = 0.0;
+
+    for (int l = 0; l < n; ++l) {
+        int iter = 0;
+        int m;
+        do {
+            for (m = l; m < n - 1; ++m) {
+                const double dd = std::fabs(d[m]) + std::fabs(d[m + 1]);
+                if (std::fabs(e[m]) <= EPS * dd) break;
+            }
+            if (m == l) break;
+            if (++iter > 60) throw std::runtime_error("tridiagonal QL did not converge");
+
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = std::hypot(g, 1.0);
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            double s = 1.0, c = 1.0, p = 0.0;
+            int i;
+            for (i = m - 1; i >= l; --i) {
+                double f = s * e[i];
+                const double b = c * e[i];
+                e[i + 1] = (r = std::hypot(f, g));
+                if (r == 0.0) {
+                    d[i + 1] -= p;
+                    e[m] = 0.0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2.0 * c * b;
+                d[i + 1] = g + (p = s * r);
+                g = c * r - b;
+                if (Q) for (int k = 0; k < n; ++k) {
+                    double* qk = Q + static_cast<long>(k) * ldq;
+                    f = qk[i + 1];
+                    qk[i + 1] = s * qk[i] + c * f;
+                    qk[i] = c * qk[i] - s * f;
+                }
+            }
+            if (r == 0.0 && i >= l) continue;
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0.0;
+        } while (m != l);
+    }
+    if (Q) sortPairs(n, d, Q, ldq);
+    else std::sort(d, d + n);
+}
+
+/**
+ * Roots of the secular equation 1/ρ + Σ zⱼ²/(dⱼ − λ) = 0 (ρ > 0, d
+ * strictly ascending).  Root i lies in (dᵢ, dᵢ₊₁) – or (d_{K−1}, d_{K−1}+ρ‖z‖²]
+ * for the last – and is stored as org[i] + tau[i] where org is the
+ * nearer pole, so every difference dⱼ − λᵢ = (dⱼ − d_org) − τ keeps full
+ * relative accuracy (needed by the Gu–Eisenstat vectors).
+ */
+void secular(int K, const double* d, const double* z, double rho, int* org, double* tau)
+{
+    double zz = 0.0;
+    for (int j = 0; j < K; ++j) zz += z[j] * z[j];
+
+    ThreadPool::instance().parallelFor(0, (K + 31) / 32, [&](int blk) {
+        for (int i = blk * 32; i < std::min(K, (blk + 1) * 32); ++i) {
+            const bool last = (i == K - 1);
+            int o = i;
+            double lo, hi;
+            if (!last) {
+                const double mid = 0.5 * (d[i + 1] - d[i]);
+                double f = 1.0 / rho;
+                for (int j = 0; j < K; ++j) f += z[j] * z[j] / ((d[j] - d[i]) - mid);
+                if (f >= 0.0) { o = i;     lo = 0.0;  hi = mid; }
+                else          { o = i + 1; lo = -mid; hi = 0.0; }
+            } else {
+                lo = 0.0;
+                hi = rho * zz;
+            }
+
+            double t = 0.5 * (lo + hi);
+            for (int it = 0; it < 200; ++it) {
+                double psi = 0.0, dpsi = 0.0, phi = 0.0, dphi = 0.0;
+                for (int j = 0; j < K; ++j) {
+                    const double dj = (d[j] - d[o]) - t;
+                    const double q = z[j] / dj;
+                    if (j <= i) { psi += z[j] * q; dpsi += q * q; }
+                    else        { phi += z[j] * q; dphi += q * q; }
+                }
+                const double f = 1.0 / rho + psi + phi;
+                if (std::fabs(f) <= 8.0 * EPS * K * (1.0 / rho + std::fabs(psi) + std::fabs(phi)))
+                    break;
+                if (f > 0.0) hi = t; else lo = t;
+
+                // two-pole rational model of f around the bracketing poles
+                const double d1 = (d[i] - d[o]) - t;
+                double eta;
+                bool ok = true;
+                if (!last) {
+                    const double d2 = (d[i + 1] - d[o]) - t;
+                    const double b = d1 * d1 * dpsi, c2 = d2 * d2 * dphi;
+                    const double C = f - b / d1 - c2 / d2;
+                    const double Bq = C * (d1 + d2) + b + c2;
+                    const double Cq = C * d1 * d2 + b * d2 + c2 * d1;
+                    if (C == 0.0) {
+                        eta = Cq / Bq;
+                    } else {
+                        const double disc = Bq * Bq - 4.0 * C * Cq;
+                        if (disc < 0.0) { ok = false; eta = 0.0; }
+                        else {
+                            const double q = 0.5 * (Bq + std::copysign(std::sqrt(disc), Bq));
+                            const double r1 = q / C, r2 = Cq / q;
+                            eta = (r1 > d1 && r1 < d2) ? r1 : r2;
+                        }
+                    }
+                } else {
+                    const double b = d1 * d1 * dpsi;
+                    const double C = f - b / d1;
+                    if (C > 0.0) eta = d1 + b / C;
+                    else { ok = false; eta = 0.0; }
+                }
+
+                double tn = t + eta;
+                if (!ok || !(tn > lo && tn < hi)) tn = 0.5 * (lo + hi);
+                const bool done = std::fabs(tn - t) <= 2.0 * EPS * std::fabs(tn);
+                t = tn;
+                if (done || hi - lo <= 2.0 * EPS * std::max(std::fabs(lo), std::fabs(hi))) break;
+            }
+            org[i] = o;
+            tau[i] = t;
+        }
+    });
+}
+
+struct DC {
+    double* d;
+    const double* e;
+    double* Q;
+    int N;
+
+    void solve(int o, int len);
+    void merge(int o, int len, int m, double rho);
+};
+
+/** @brief Cuppen's divide and conquer on rows/columns [o, o+len).
+ *  The halves are solved one after the other – each merge already
+ *  spreads its secular roots and its gemm over the pool – so only one
+ *  merge workspace (at most 5·len² doubles) is alive at a time and the
+ *  peak extra memory is about 5·n² doubles, at the top level.          */
+void DC::solve(int o, int len)
+{
+    double* q = Q + static_cast<long>(o) * N + o;
+    if (len <= LEAF) {
+        for (int i = 0; i < len; ++i) q[static_cast<long>(i) * N + i] = 1.0;
+        tql(len, d + o, e + o, q, N);
+        return;
+    }
+    const int m = len / 2;
+    const double rho = e[o + m - 1];
+    d[o + m - 1] -= rho;
+    d[o + m] -= rho;
+    solve(o, m);
+    solve(o + m, len - m);
+    merge(o, len, m, rho);
+}
+
+/** @brief Eigen-decomposition of diag(D₁, D₂) + ρ·z·zᵀ and the update of
+ *  the eigenvector block: deflation, secular roots, Gu–Eisenstat
+ *  vectors, then one gemm with the old basis.  Workspace: G, out, S,
+ *  Gk and H – at most 5·len² doubles, freed on return.               */
+void DC::merge(int o, int len, int m, double rho)
+{
+    double* q = Q + static_cast<long>(o) * N + o;
+    const double sgn = (rho < 0.0) ? -1.0 : 1.0;       // ρ<0: פותרים את −(D+ρzzᵀ)
+
+    std::unique_ptr<double[]> z(new double[len]);
+    for (int i = 0; i < m; ++i) z[i] = q[static_cast<long>(m - 1) * N + i];
+    for (int i = m; i < len; ++i) z[i] = q[static_cast<long>(m) * N + i];
+    double zn = 0.0;
+    for (int i = 0; i < len; ++i) zn = std::hypot(zn, z[i]);
+    const double rhoE = sgn * rho * zn * zn;
+
+    // --- sort the poles; gather the basis columns in that order ---
+    std::unique_ptr<int[]> perm(new int[len]);
+    for (int i = 0; i < len; ++i) perm[i] = i;
+    std::sort(perm.get(), perm.get() + len,
+              [&](int a, int b) { return sgn * d[o + a] < sgn * d[o + b]; });
+    std::unique_ptr<double[]> ds(new double[len]), zs(new double[len]);
+    std::unique_ptr<double[]> G(new double[static_cast<long>(len) * len]);
+    for (int i = 0; i < len; ++i) {
+        ds[i] = sgn * d[o + perm[i]];
+        zs[i] = (zn > 0.0) ? z[perm[i]] / zn : 0.0;
+        for (int r = 0; r < len; ++r)
+            G[static_cast<long>(r) * len + i] = q[static_cast<long>(r) * N + perm[i]];
+    }
+
+    // --- deflation ---
+    double dmax = 0.0;
+    for (int i = 0; i < len; ++i) dmax = std::max(dmax, std::fabs(ds[i]));
+    const double tol = 8.0 * EPS * std::max(dmax, rhoE);
+    std::unique_ptr<bool[]> defl(new bool[len]);
+    int prev = -1;
+    for (int j = 0; j < len; ++j) {
+        defl[j] = (rhoE * std::fabs(zs[j]) <= tol);
+        if (defl[j]) continue;
+        if (prev < 0) { prev = j; continue; }
+        const double t = std::hypot(zs[prev], zs[j]);
+        const double c = zs[j] / t, s = zs[prev] / t;
+        if (std::fabs((ds[j] - ds[prev]) * c * s) <= tol) {
+            const double dp = ds[prev], dj = ds[j];
+            ds[prev] = c * c * dp + s * s * dj;
+            ds[j] = s * s * dp + c * c * dj;
+            zs[prev] = 0.0;
+            zs[j] = t;
+            for (int r = 0; r < len; ++r) {
+                double* gr = G.get() + static_cast<long>(r) * len;
+                const double gp = gr[prev], gj = gr[j];
+                gr[prev] = c * gp - s * gj;
+                gr[j] = s * gp + c * gj;
+            }
+            defl[prev] = true;
+        }
+        prev = j;
+    }
+
+    int K = 0;
+    std::unique_ptr<int[]> nd(new int[len]);
+    for (int j = 0; j < len; ++j) if (!defl[j]) nd[K++] = j;
+
+    std::unique_ptr<double[]> lam(new double[len]);
+    std::unique_ptr<double[]> out(new double[static_cast<long>(len) * len]);
+
+    if (K > 0) {
+        std::unique_ptr<double[]> dk(new double[K]), zk(new double[K]), tk(new double[K]);
+        std::unique_ptr<int[]> ok(new int[K]);
+        for (int i = 0; i < K; ++i) { dk[i] = ds[nd[i]]; zk[i] = zs[nd[i]]; }
+        secular(K, dk.get(), zk.get(), rhoE, ok.get(), tk.get());
+
+        auto diff = [&](int j, int i) {                 // λⱼ − dᵢ
+            return (dk[ok[j]] - dk[i]) + tk[j];
+        };
+
+        // --- Gu–Eisenstat: ẑ consistent with the computed roots ---
+        std::unique_ptr<double[]> zh(new double[K]);
+        for (int i = 0; i < K; ++i) {
+            double p = diff(K - 1, i) / rhoE;
+            for (int j = 0; j < i; ++j) p *= diff(j, i) / (dk[j] - dk[i]);
+            for (int j = i; j < K - 1; ++j) p *= diff(j, i) / (dk[j + 1] - dk[i]);
+            zh[i] = std::copysign(std::sqrt(std::fabs(p)), zk[i]);
+        }
+
+        // --- eigenvectors of the rank-one problem (columns of S) ---
+        std::unique_ptr<double[]> S(new double[static_cast<long>(K) * K]);
+        for (int i = 0; i < K; ++i) {
+            double nrm = 0.0;
+            for (int j = 0; j < K; ++j) {
+                const double v = zh[j] / -diff(i, j);
+                S[static_cast<long>(j) * K + i] = v;
+                nrm = std::hypot(nrm, v);
+            }
+            for (int j = 0; j < K; ++j) S[static_cast<long>(j) * K + i] /= nrm;
+            lam[i] = dk[ok[i]] + tk[i];
+        }
+
+        // --- new basis columns: G(:, nd) · S ---
+        std::unique_ptr<double[]> Gk(new double[static_cast<long>(len) * K]);
+        for (int r = 0; r < len; ++r)
+            for (int i = 0; i < K; ++i)
+                Gk[static_cast<long>(r) * K + i] = G[static_cast<long>(r) * len + nd[i]];
+        std::unique_ptr<double[]> H(new double[static_cast<long>(len) * K]);
+        kernels::gemm(len, K, K, 1.0, Gk.get(), K, false, S.get(), K, false, 0.0, H.get(), K);
+        for (int r = 0; r < len; ++r)
+            for (int i = 0; i < K; ++i)
+                out[static_cast<long>(r) * len + i] = H[static_cast<long>(r) * K + i];
+    }
+    int col = K;
+    for (int j = 0; j < len; ++j) {
+        if (!defl[j]) continue;
+        lam[col] = ds[j];
+        for (int r = 0; r < len; ++r)
+            out[static_cast<long>(r) * len + col] = G[static_cast<long>(r) * len + j];
+        ++col;
+    }
+
+    // --- back to the caller's sign, ascending order ---
+    for (int i = 0; i < len; ++i) lam[i] *= sgn;
+    std::unique_ptr<int[]> order(new int[len]);
+    for (int i = 0; i < len; ++i) order[i] = i;
+    std::sort(order.get(), order.get() + len, [&](int a, int b) { return lam[a] < lam[b]; });
+    for (int i = 0; i < len; ++i) {
+        d[o + i] = lam[order[i]];
+        for (int r = 0; r < len; ++r)
+            q[static_cast<long>(r) * N + i] = out[static_cast<long>(r) * len + order[i]];
+    }
+}
+
+/** @brief Number of eigenvalues of the tridiagonal (d,e) below @p x
+ *  (Sturm sequence / LDLᵀ inertia).                                     */
+int sturmCount(int n, const double* d, const double* e, double x, double pivmin)
+{
+    int cnt = 0;
+    double q = d[0] - x;
+    if (std::fabs(q) < pivmin) q = -pivmin;
+    cnt += (q < 0.0);
+    for (int i = 1; i < n; ++i) {
+        q = d[i] - x - e[i - 1] * e[i - 1] / q;
+        if (std::fabs(q) < pivmin) q = -pivmin;
+        cnt += (q < 0.0);
+    }
+    return cnt;
+}
+
+/** @brief Inverse iteration for the eigenvector of (d,e) at λ, kept
+ *  orthogonal to @p prevCount earlier vectors of the same cluster.     */
+void inverseIteration(int n, const double* d, const double* e, double lambda, double tnorm,
+                      double* x, const double* const* prev, int prevCount, unsigned seed)
+{
+    std::unique_ptr<double[]> dl(new double[n]), dm(new double[n]), du(new double[n]),
+                              du2(new double[n]);
+    std::unique_ptr<bool[]> piv(new bool[n]);
+    const double tiny = EPS * std::max(tnorm, DBL_MIN);
+
+    for (int i = 0; i < n; ++i) dm[i] = d[i] - lambda;
+    for (int i = 0; i < n - 1; ++i) { dl[i] = e[i]; du[i] = e[i]; du2[i] = 0.0; }
+
+    for (int i = 0; i < n - 1; ++i) {                        // LU של (T − λI) עם pivoting
+        if (std::fabs(dm[i]) >= std::fabs(dl[i])) {
+            piv[i] = false;
+            if (dm[i] == 0.0) dm[i] = tiny;
+            const double f = dl[i] / dm[i];
+            dl[i] = f;
+            dm[i + 1] -= f * du[i];
+        } else {
+            piv[i] = true;
+            const double f = dm[i] / dl[i];
+            dm[i] = dl[i];
+            dl[i] = f;
+            const double t = du[i];
+            du[i] = dm[i + 1];
+            dm[i + 1] = t - f * dm[i + 1];
+            if (i < n - 2) {
+                du2[i] = du[i + 1];
+                du[i + 1] = -f * du[i + 1];
+            }
+        }
+    }
+    if (dm[n - 1] == 0.0) dm[n - 1] = tiny;
+
+    unsigned s = seed * 2654435761u + 12345u;
+    for (int i = 0; i < n; ++i) {
+        s = s * 1664525u + 1013904223u;
+        x[i] = (s >> 8) / 16777216.0 - 0.5;
+    }
+
+    for (int it = 0; it < 4; ++it) {
+        for (int i = 0; i < n - 1; ++i) {
+            if (!piv[i]) x[i + 1] -= dl[i] * x[i];
+            else {
+                const double t = x[i];
+                x[i] = x[i + 1];
+                x[i + 1] = t - dl[i] * x[i];
+            }
+        }
+        x[n - 1] /= dm[n - 1];
+        if (n > 1) x[n - 2] = (x[n - 2] - du[n - 2] * x[n - 1]) / dm[n - 2];
+        for (int i = n - 3; i >= 0; --i)
+            x[i] = (x[i] - du[i] * x[i + 1] - du2[i] * x[i + 2]) / dm[i];
+
+        for (int p = 0; p < prevCount; ++p) {
+            double dot = 0.0;
+            for (int i = 0; i < n; ++i) dot += x[i] * prev[p][i];
+            for (int i = 0; i < n; ++i) x[i] -= dot * prev[p][i];
+        }
+        double nrm = 0.0;
+        for (int i = 0; i < n; ++i) nrm = std::hypot(nrm, x[i]);
+        for (int i = 0; i < n; ++i) x[i] /= nrm;
+    }
+}
+
+} // namespace
+
+/* ====================================================================
+   Construction
+   ================================================================= */
+
+/** @brief Full spectrum (divide and conquer). */
+SymEig::SymEig(const SquareMat& A, bool wantVectors)
+    : values(nullptr), vectors(nullptr), n(A.getN()), k(0)
+{
+    compute(A, n, Spectrum::Largest, wantVectors);
+}
+
+/** @brief Only the @p topK largest (or smallest) eigenpairs.
+ *  @throw std::invalid_argument unless 0 < topK ≤ n                   */
+SymEig::SymEig(const SquareMat& A, int topK, Spectrum which, bool wantVectors)
+    : values(nullptr), vectors(nullptr), n(A.getN()), k(0)
+{
+    if (topK <= 0 || topK > n) throw std::invalid_argument("topK must be in [1, n]");
+    compute(A, topK, which, wantVectors);
+}
+
+/** @brief Full spectrum of a packed symmetric matrix. */
+SymEig::SymEig(const SymMat& A, bool wantVectors) : SymEig(A.toSquareMat(), wantVectors) {}
+
+/** @brief Top-k of a packed symmetric matrix. */
+SymEig::SymEig(const SymMat& A, int topK, Spectrum which, bool wantVectors)
+    : SymEig(A.toSquareMat(), topK, which, wantVectors) {}
+
+/** @brief Deep-copy constructor. */
+SymEig::SymEig(const SymEig& other)
+    : values(nullptr), vectors(nullptr), n(other.n), k(other.k)
+{
+    std::unique_ptr<double[]> vals(new double[k]);
+    std::copy(other.values, other.values + k, vals.get());
+    if (other.vectors) {
+        vectors = new double[static_cast<long>(k) * n];
+        std::copy(other.vectors, other.vectors + static_cast<long>(k) * n, vectors);
+    }
+    values = vals.release();
+}
+
+/** @brief Copy-assignment operator. */
+SymEig& SymEig::operator=(const SymEig& other)
+{
+    if (this == &other) return *this;
+    SymEig tmp(other);
+    std::swap(values, tmp.values);
+    std::swap(vectors, tmp.vectors);
+    n = other.n;
+    k = other.k;
+    return *this;
+}
+
+/** @brief Destructor – frees values and vectors. */
+SymEig::~SymEig()
+{
+    delete[] values;
+    delete[] vectors;
+}
+
+/** @brief Tridiagonalize, solve the tridiagonal problem for @p wanted
+ *  pairs, and map the vectors back with the Householder Q.              */
+void SymEig::compute(const SquareMat& A, int wanted, Spectrum which, bool wantVectors)
+{
+    const double* a = A.raw();
+    SquareMat W(n);
+    double* w = W.raw();
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j <= i; ++j)
+            w[static_cast<long>(i) * n + j] = w[static_cast<long>(j) * n + i] =
+                a[static_cast<long>(i) * n + j];
+
+    std::unique_ptr<double[]> d(new double[n]), e(new double[n]), tau(new double[n]);
+    e[n - 1] = 0.0;
+    tau[n - 1] = 0.0;
+    if (n > 1) tridiagonalize(w, n, d.get(), e.get(), tau.get());
+    else d[0] = w[0];
+
+    k = wanted;
+    std::unique_ptr<double[]> vals(new double[k]);           // נמסר ל-values רק בסוף
+    std::unique_ptr<double[]> Z;                            // n×k, עמודה לכל וקטור
+
+    if (wanted == n && !wantVectors) {
+        // ---------- full spectrum, values only: QL without Z ----------
+        tql(n, d.get(), e.get(), nullptr, 0);
+        std::copy(d.get(), d.get() + n, vals.get());
+    } else if (wanted == n) {
+        // ---------- full spectrum: divide and conquer ----------
+        Z.reset(new double[static_cast<long>(n) * n]);
+        std::fill(Z.get(), Z.get() + static_cast<long>(n) * n, 0.0);
+        DC dc{d.get(), e.get(), Z.get(), n};
+        dc.solve(0, n);
+        std::copy(d.get(), d.get() + n, vals.get());
+    } else {
+        // ---------- subset: bisection + inverse iteration ----------
+        double gl = d[0], gu = d[0], tnorm = 0.0, emax2 = 0.0;
+        for (int i = 0; i < n; ++i) {
+            const double r = (i > 0 ? std::fabs(e[i - 1]) : 0.0) + (i < n - 1 ? std::fabs(e[i]) : 0.0);
+            gl = std::min(gl, d[i] - r);
+            gu = std::max(gu, d[i] + r);
+            tnorm = std::max(tnorm, std::fabs(d[i]) + r);
+            if (i < n - 1) emax2 = std::max(emax2, e[i] * e[i]);
+        }
+        const double pivmin = DBL_MIN * std::max(1.0, emax2);
+        const int first = (which == Spectrum::Largest) ? n - k : 0;
+
+        ThreadPool::instance().parallelFor(0, k, [&](int t) {
+            const int idx = first + t;
+            double lo = gl - EPS * tnorm - pivmin, hi = gu + EPS * tnorm + pivmin;
+            while (hi - lo > 2.0 * EPS * std::max(std::fabs(lo), std::fabs(hi)) + pivmin) {
+                const double mid = 0.5 * (lo + hi);
+                if (mid <= lo || mid >= hi) break;
+                if (sturmCount(n, d.get(), e.get(), mid, pivmin) > idx) hi = mid;
+                else lo = mid;
+            }
+            vals[t] = 0.5 * (lo + hi);
+        });
+
+        if (wantVectors) {
+            std::unique_ptr<double[]> X(new double[static_cast<long>(k) * n]);
+            const double gap = 1e-3 * std::max(tnorm, DBL_MIN);
+            std::unique_ptr<int[]> clusterStart(new int[k + 1]);
+            int nc = 0;
+            for (int t = 0; t < k; ++t)
+                if (t == 0 || vals[t] - vals[t - 1] > gap) clusterStart[nc++] = t;
+            clusterStart[nc] = k;
+
+            ThreadPool::instance().parallelFor(0, nc, [&](int c) {
+                const int t0 = clusterStart[c], t1 = clusterStart[c + 1];
+                std::unique_ptr<const double*[]> prev(new const double*[t1 - t0]);
+                for (int t = t0; t < t1; ++t) {
+                    double* x = X.get() + static_cast<long>(t) * n;
+                    inverseIteration(n, d.get(), e.get(), vals[t], tnorm, x,
+                                     prev.get(), t - t0, static_cast<unsigned>(t + 1));
+                    prev[t - t0] = x;
+                }
+            });
+            Z.reset(new double[static_cast<long>(n) * k]);
+            for (int t = 0; t < k; ++t)
+                for (int r = 0; r < n; ++r)
+                    Z[static_cast<long>(r) * k + t] = X[static_cast<long>(t) * n + r];
+        }
+    }
+
+    if (wantVectors) {
+        if (n > 1) backTransform(w, tau.get(), n, Z.get(), k);
+        vectors = new double[static_cast<long>(k) * n];
+        for (int t = 0; t < k; ++t)
+            for (int r = 0; r < n; ++r)
+                vectors[static_cast<long>(t) * n + r] = Z[static_cast<long>(r) * k + t];
+    }
+    values = vals.release();
+}
+
+/* ====================================================================
+   Queries
+   ================================================================= */
+
+int SymEig::getN() const { return n; }
+
+/** @brief Number of computed eigenpairs (n, or topK). */
+int SymEig::count() const { return k; }
+
+/** @brief i-th computed eigenvalue (ascending).
+ *  @throw std::out_of_range if @p i is outside [0,count()-1]           */
+double SymEig::eigenvalue(int i) const
+{
+    if (i < 0 || i >= k) throw std::out_of_range("index out of range");
+    return values[i];
+}
+
+/** @brief All computed eigenvalues, ascending. */
+const double* SymEig::eigenvalues() const { return values; }
+
+/** @brief Unit eigenvector of eigenvalue(i) – n contiguous doubles.
+ *  @throw std::logic_error if vectors were not requested              */
+const double* SymEig::eigenvector(int i) const
+{
+    if (i < 0 || i >= k) throw std::out_of_range("index out of range");
+    if (!vectors) throw std::logic_error("eigenvectors were not computed");
+    return vectors + static_cast<long>(i) * n;
+}
+
+/** @brief Eigenvectors as the columns of an n×n matrix
+ *  (columns past count() are zero).                                    */
+SquareMat SymEig::eigenvectors() const
+{
+    if (!vectors) throw std::logic_error("eigenvectors were not computed");
+    SquareMat V(n, 0.0);
+    for (int t = 0; t < k; ++t)
+        for (int r = 0; r < n; ++r) V[r][t] = vectors[static_cast<long>(t) * n + r];
+    return V;
+}
@@ -0,0 +1,56 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef SYMEIG_HPP
+#define SYMEIG_HPP
+
+#include "SquareMat.hpp"
+#include "SymMat.hpp"
+
+namespace matrix {
+
+enum class Spectrum { Largest, Smallest };
+
+/**
+ * Eigen-decomposition of a symmetric matrix, A·x = λ·x.
+ *
+ * A is reduced to tridiagonal form with blocked Householder reflectors;
+ * the full spectrum is then found by divide and conquer (implicit QL,
+ * O(n²), when no vectors are wanted), while a top-k request uses
+ * bisection plus inverse iteration so only the k wanted pairs are
+ * computed.  Eigenvalues are returned in ascending order and
+ * eigenvector(i) belongs to eigenvalue(i).  Only the lower triangle of
+ * A is read.
+ */
+class SymEig {
+private:
+    double* values;    // count() ערכים עצמיים, בסדר עולה
+    double* vectors;   // count() וקטורים באורך n, וקטור לכל שורה
+    int n;
+    int k;
+
+    void compute(const SquareMat& A, int wanted, Spectrum which, bool wantVectors);
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    explicit SymEig(const SquareMat& A, bool wantVectors = true);
+    SymEig(const SquareMat& A, int topK, Spectrum which = Spectrum::Largest,
+           bool wantVectors = true);
+    explicit SymEig(const SymMat& A, bool wantVectors = true);
+    SymEig(const SymMat& A, int topK, Spectrum which = Spectrum::Largest,
+           bool wantVectors = true);
+    SymEig(const SymEig& other);
+    SymEig& operator=(const SymEig& other);
+    ~SymEig();
+
+    // ---------- תוצאות ----------
+    int getN() const;
+    int count() const;
+    double eigenvalue(int i) const;
+    const double* eigenvalues() const;
+    const double* eigenvector(int i) const;
+    SquareMat eigenvectors() const;          // עמודה i = וקטור עצמי i
+};
+
+} // namespace matrix
+
+#endif // SYMEIG_HPP
@@ -0,0 +1,269 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "SymMat.hpp"
+#include "Kernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::invalid_argument, std::out_of_range
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Tile edge used when SYRK/SYMM go through dense gemm tiles. */
+constexpr int NB = 64;
+
+/** @brief Offset of row @p i in packed lower storage. */
+inline long rowStart(int i) { return static_cast<long>(i) * (i + 1) / 2; }
+
+/** @brief Copy the dense tile S(I0..I0+ib, K0..K0+kb) out of packed
+ *  storage into @p tmp (row-major, leading dimension kb).             */
+void unpackTile(const double* packed, int I0, int ib, int K0, int kb, double* tmp)
+{
+    for (int r = 0; r < ib; ++r) {
+        const int i = I0 + r;
+        double* dst = tmp + static_cast<long>(r) * kb;
+        if (K0 + kb - 1 <= i) {                         // כולו מתחת לאלכסון
+            const double* src = packed + rowStart(i) + K0;
+            std::copy(src, src + kb, dst);
+        } else {
+            for (int c = 0; c < kb; ++c) {
+                const int j = K0 + c;
+                dst[c] = (j <= i) ? packed[rowStart(i) + j] : packed[rowStart(j) + i];
+            }
+        }
+    }
+}
+
+} // namespace
+
+/* ====================================================================
+   Rule-of-Three
+   ================================================================= */
+
+/** @brief Construct an @c n×n symmetric matrix filled with @p initVal.
+ *  @throw std::invalid_argument if @p n_ ≤ 0                           */
+SymMat::SymMat(int n_, double initVal) : data(nullptr), n(n_)
+{
+    if (n <= 0) throw std::invalid_argument("n must be positive");
+    data = new double[packedSize()];
+    std::fill(data, data + packedSize(), initVal);
+}
+
+/** @brief Pack the lower triangle of @p A (the upper one is ignored). */
+SymMat::SymMat(const SquareMat& A) : data(nullptr), n(A.getN())
+{
+    data = new double[packedSize()];
+    const double* a = A.raw();
+    for (int i = 0; i < n; ++i)
+        std::copy(a + static_cast<long>(i) * n, a + static_cast<long>(i) * n + i + 1,
+                  data + rowStart(i));
+}
+
+/** @brief Deep-copy constructor (O(n²/2)). */
+SymMat::SymMat(const SymMat& other) : data(nullptr), n(other.n)
+{
+    data = new double[packedSize()];
+    std::copy(other.data, other.data + packedSize(), data);
+}
+
+/** @brief Copy-assignment operator. */
+SymMat& SymMat::operator=(const SymMat& other)
+{
+    if (this == &other) return *this;
+
+    if (n != other.n) {
+        delete[] data;
+        n = other.n;
+        data = new double[packedSize()];
+    }
+    std::copy(other.data, other.data + packedSize(), data);
+    return *this;
+}
+
+/** @brief Destructor – frees the packed buffer. */
+SymMat::~SymMat() { delete[] data; }
+
+/* ====================================================================
+   Element access
+   ================================================================= */
+
+/** @brief Packed offset of (i,j); (j,i) maps to the same slot.
+ *  @throw std::out_of_range if indices are outside [0,n-1]            */
+long SymMat::index(int i, int j) const
+{
+    if (i < 0 || i >= n || j < 0 || j >= n)
+        throw std::out_of_range("index out of range");
+    return (j <= i) ? rowStart(i) + j : rowStart(j) + i;
+}
+
+/** @brief Mutable access – writing (i,j) also changes (j,i). */
+double& SymMat::operator()(int i, int j) { return data[index(i, j)]; }
+
+/** @brief Const access to element (i,j). */
+const double& SymMat::operator()(int i, int j) const { return data[index(i, j)]; }
+
+/** @brief Return matrix dimension. */
+int SymMat::getN() const { return n; }
+
+/** @brief Number of stored doubles, n(n+1)/2. */
+long SymMat::packedSize() const { return static_cast<long>(n) * (n + 1) / 2; }
+
+/** @brief Packed lower-triangular buffer. */
+double* SymMat::raw() { return data; }
+
+/** @brief Packed lower-triangular buffer (const). */
+const double* SymMat::raw() const { return data; }
+
+/** @brief Expand to a dense SquareMat (both triangles filled). */
+SquareMat SymMat::toSquareMat() const
+{
+    SquareMat res(n);
+    unpackTile(data, 0, n, 0, n, res.raw());
+    return res;
+}
+
+/* ====================================================================
+   Arithmetic operators (work on the packed triangle only)
+   ================================================================= */
+
+/** @brief Matrix addition. */
+SymMat SymMat::operator+(const SymMat& rhs) const
+{
+    if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    SymMat res(n);
+    for (long k = 0; k < packedSize(); ++k)
+        res.data[k] = data[k] + rhs.data[k];
+    return res;
+}
+
+/** @brief Matrix subtraction. */
+SymMat SymMat::operator-(const SymMat& rhs) const
+{
+    if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    SymMat res(n);
+    for (long k = 0; k < packedSize(); ++k)
+        res.data[k] = data[k] - rhs.data[k];
+    return res;
+}
+
+/** @brief Multiply every element by scalar @p s. */
+SymMat SymMat::operator*(double s) const
+{
+    SymMat res(n);
+    for (long k = 0; k < packedSize(); ++k)
+        res.data[k] = data[k] * s;
+    return res;
+}
+
+/** @brief SYMM: S·B.  Each NB-row block of the result is built from
+ *  tiles of S unpacked on the fly and multiplied with kernels::gemm,
+ *  so S is never expanded to n² storage.                             */
+SquareMat SymMat::operator*(const SquareMat& rhs) const
+{
+    if (n != rhs.getN()) throw std::invalid_argument("dimension mismatch");
+    SquareMat res(n, 0.0);
+    const int blocks = (n + NB - 1) / NB;
+
+    ThreadPool::instance().parallelFor(0, blocks, [&](int bi) {
+        const int I0 = bi * NB, ib = std::min(NB, n - I0);
+        std::unique_ptr<double[]> tmp(new double[NB * NB]);
+        for (int K0 = 0; K0 < n; K0 += NB) {
+            const int kb = std::min(NB, n - K0);
+            unpackTile(data, I0, ib, K0, kb, tmp.get());
+            kernels::gemm(ib, n, kb, 1.0, tmp.get(), kb, false,
+                          rhs.raw() + static_cast<long>(K0) * n, n, false,
+                          1.0, res.raw() + static_cast<long>(I0) * n, n);
+        }
+    });
+    return res;
+}
+
+/** @brief Product of two symmetric matrices (not symmetric in general). */
+SquareMat SymMat::operator*(const SymMat& rhs) const
+{
+    return *this * rhs.toSquareMat();
+}
+
+namespace matrix {
+
+/** @brief B·S – column blocks of the result are independent. */
+SquareMat operator*(const SquareMat& lhs, const SymMat& rhs)
+{
+    const int n = rhs.getN();
+    if (n != lhs.getN()) throw std::invalid_argument("dimension mismatch");
+    SquareMat res(n, 0.0);
+    const int blocks = (n + NB - 1) / NB;
+
+    ThreadPool::instance().parallelFor(0, blocks, [&](int bj) {
+        const int J0 = bj * NB, jb = std::min(NB, n - J0);
+        std::unique_ptr<double[]> tmp(new double[NB * NB]);
+        for (int K0 = 0; K0 < n; K0 += NB) {
+            const int kb = std::min(NB, n - K0);
+            unpackTile(rhs.raw(), K0, kb, J0, jb, tmp.get());
+            kernels::gemm(n, jb, kb, 1.0, lhs.raw() + K0, n, false,
+                          tmp.get(), jb, false,
+                          1.0, res.raw() + J0, n);
+        }
+    });
+    return res;
+}
+
+/** @brief Scalar on the left: @c s * sym. */
+SymMat operator*(double s, const SymMat& m) { return m * s; }
+
+/** @brief SYRK: A·Aᵀ (or Aᵀ·A with @p transpose) into packed storage.
+ *
+ *  Only the NB×NB tiles on or below the diagonal are computed – each
+ *  with one gemm call – which halves the FLOPs of @c A * ~A and never
+ *  materialises the transpose.                                        */
+SymMat syrk(const SquareMat& A, bool transpose)
+{
+    const int n = A.getN();
+    SymMat res(n);
+    const int blocks = (n + NB - 1) / NB;
+    const int tiles = blocks * (blocks + 1) / 2;
+    const double* a = A.raw();
+
+    ThreadPool::instance().parallelFor(0, tiles, [&](int t) {
+        int bi = 0;
+        while ((bi + 1) * (bi + 2) / 2 <= t) ++bi;
+        const int bj = t - bi * (bi + 1) / 2;
+        const int I0 = bi * NB, ib = std::min(NB, n - I0);
+        const int J0 = bj * NB, jb = std::min(NB, n - J0);
+
+        std::unique_ptr<double[]> tmp(new double[NB * NB]);
+        if (!transpose)
+            kernels::gemm(ib, jb, n, 1.0, a + static_cast<long>(I0) * n, n, false,
+                          a + static_cast<long>(J0) * n, n, true, 0.0, tmp.get(), jb);
+        else
+            kernels::gemm(ib, jb, n, 1.0, a + I0, n, true,
+                          a + J0, n, false, 0.0, tmp.get(), jb);
+
+        double* packed = res.raw();
+        for (int r = 0; r < ib; ++r) {
+            const int i = I0 + r;
+            const int last = std::min(jb, i - J0 + 1);
+            std::copy(tmp.get() + static_cast<long>(r) * jb,
+                      tmp.get() + static_cast<long>(r) * jb + last,
+                      packed + rowStart(i) + J0);
+        }
+    });
+    return res;
+}
+
+/** @brief Pretty-print the full (expanded) matrix row-by-row. */
+std::ostream& operator<<(std::ostream& os, const SymMat& m)
+{
+    for (int i = 0; i < m.getN(); ++i) {
+        os << "[ ";
+        for (int j = 0; j < m.getN(); ++j) {
+            os << m(i, j);
+            if (j + 1 < m.getN()) os << ' ';
+        }
+        os << " ]\n";
+    }
+    return os;
+}
+
+} // namespace matrix
@@ -0,0 +1,59 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef SYMMAT_HPP
+#define SYMMAT_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+
+namespace matrix {
+
+/**
+ * Symmetric n×n matrix in packed storage: only the lower triangle is
+ * kept, row by row, so (i,j) with j ≤ i lives at i(i+1)/2 + j and the
+ * buffer holds n(n+1)/2 doubles.  (i,j) and (j,i) are the same element.
+ */
+class SymMat {
+private:
+    double* data;   // משולש תחתון ארוז, n(n+1)/2 איברים
+    int n;
+
+    long index(int i, int j) const;
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    SymMat(int n, double initVal = 0.0);
+    explicit SymMat(const SquareMat& A);      // לוקח את המשולש התחתון
+    SymMat(const SymMat& other);
+    SymMat& operator=(const SymMat& other);
+    ~SymMat();
+
+    // ---------- גישה לאיברים ----------
+    double& operator()(int i, int j);
+    const double& operator()(int i, int j) const;
+
+    int getN() const;
+    long packedSize() const;
+    double* raw();
+    const double* raw() const;
+
+    SquareMat toSquareMat() const;
+
+    // ---------- פעולות אריתמטיות ----------
+    SymMat operator+(const SymMat& rhs) const;
+    SymMat operator-(const SymMat& rhs) const;
+    SymMat operator*(double s) const;
+
+    SquareMat operator*(const SquareMat& rhs) const;   // SYMM: S·B
+    SquareMat operator*(const SymMat& rhs) const;
+};
+
+// ---------- אופרטורים ופונקציות חיצוניים ----------
+SquareMat operator*(const SquareMat& lhs, const SymMat& rhs);   // B·S
+SymMat operator*(double s, const SymMat& m);
+SymMat syrk(const SquareMat& A, bool transpose = false);        // A·Aᵀ / Aᵀ·A
+std::ostream& operator<<(std::ostream& out, const SymMat& m);
+
+} // namespace matrix
+
+#endif // SYMMAT_HPP
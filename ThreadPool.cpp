@@ -0,0 +1,288 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "ThreadPool.hpp"
+#include <cstdlib>     // std::getenv, std::atoi
+#include <stdexcept>   // std::invalid_argument
+#include <pthread.h>   // pthread_setaffinity_np
+#include <sched.h>     // cpu_set_t
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Pool whose work the current thread is executing – nested
+ *  loops on that pool then run inline instead of deadlocking. */
+thread_local const ThreadPool* insidePool = nullptr;
+
+/** @brief Pool that instance() returns on this thread (nullptr = global). */
+thread_local ThreadPool* threadPool = nullptr;
+
+/** @brief Default pool size: $SQUAREMAT_THREADS or the hardware count. */
+int defaultThreads()
+{
+    if (const char* env = std::getenv("SQUAREMAT_THREADS")) {
+        int t = std::atoi(env);
+        if (t > 0) return t;
+    }
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw ? static_cast<int>(hw) : 1;
+}
+
+} // namespace
+
+/* ====================================================================
+   Construction
+   ================================================================= */
+
+/** @brief Create a pool that runs work on @p threads threads
+ *  (the caller plus @p threads-1 workers).
+ *  @throw std::invalid_argument if @p threads ≤ 0                        */
+ThreadPool::ThreadPool(int threads)
+    : workers(nullptr), nThreads(0), body(nullptr), jobEnd(0), nextIndex(0),
+      active(0), jobWorkers(0), jobBegin(0), staticJob(false), generation(0), stopping(false),
+      pinCpus(nullptr), pinCount(0)
+{
+    if (threads <= 0) throw std::invalid_argument("thread count must be positive");
+    start(threads);
+}
+
+/** @brief Joins every worker. */
+ThreadPool::~ThreadPool()
+{
+    stop();
+    delete[] pinCpus;
+}
+
+/** @brief Process-wide pool used by the matrix kernels, or the pool
+ *  installed with use() on the calling thread.                        */
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool(defaultThreads());
+    return threadPool ? *threadPool : pool;
+}
+
+/** @brief Make instance() return @p pool on the calling thread only
+ *  (nullptr restores the process-wide pool), so kernels called from
+ *  this thread run on a private team of threads.
+ *  @return the previous setting, for the caller to restore            */
+ThreadPool* ThreadPool::use(ThreadPool* pool)
+{
+    ThreadPool* previous = threadPool;
+    threadPool = pool;
+    return previous;
+}
+
+/** @brief Number of threads that take part in a parallel loop. */
+int ThreadPool::size() const { return nThreads; }
+
+/** @brief Replace the workers with a pool of @p threads threads.
+ *  Waits for any running loop to finish first.  A CPU list given to
+ *  pinWorkers() is spread again over the new workers.                */
+void ThreadPool::resize(int threads)
+{
+    if (threads <= 0) throw std::invalid_argument("thread count must be positive");
+    std::lock_guard<std::mutex> submit(submitMtx);
+    if (threads == nThreads) return;
+    stop();
+    start(threads);
+}
+
+void ThreadPool::start(int threads)
+{
+    nThreads = threads;
+    stopping = false;
+    if (threads > 1) {
+        workers = new std::thread[threads - 1];
+        for (int t = 0; t < threads - 1; ++t)
+            workers[t] = std::thread(&ThreadPool::workerLoop, this, t, generation);
+        if (pinCpus)
+            for (int t = 0; t < threads - 1; ++t) pinWorker(t);
+    }
+}
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+        ++generation;
+    }
+    wake.notify_all();
+    for (int t = 0; t < nThreads - 1; ++t) workers[t].join();
+    delete[] workers;
+    workers = nullptr;
+    nThreads = 0;
+}
+
+/* ====================================================================
+   Work distribution
+   ================================================================= */
+
+/** @brief Pull indices from the shared counter until the job is drained.
+ *  In a static job, pool slot @p slot (0 = caller, worker t = t+1) runs
+ *  exactly its own contiguous share of the range instead.             */
+void ThreadPool::runChunks(int slot)
+{
+    if (staticJob) {
+        const long parts = jobWorkers + 1, len = jobEnd - jobBegin;
+        const int lo = jobBegin + static_cast<int>(len * slot / parts);
+        const int hi = jobBegin + static_cast<int>(len * (slot + 1) / parts);
+        for (int i = lo; i < hi; ++i) {
+            try {
+                (*body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!error) error = std::current_exception();
+                return;
+            }
+        }
+        return;
+    }
+    for (;;) {
+        int i;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (nextIndex >= jobEnd || error) return;
+            i = nextIndex++;
+        }
+        try {
+            (*body)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!error) error = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(int id, unsigned long seen)
+{
+    insidePool = this;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            wake.wait(lock, [&] { return generation != seen; });
+            seen = generation;
+            if (stopping) return;
+            if (id >= jobWorkers) continue;
+        }
+        runChunks(id + 1);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (--active == 0) done.notify_one();
+        }
+    }
+}
+
+/** @brief Run @p fn(i) for every i in [begin,end) across the pool.
+ *  Indices are handed out one at a time, so callers should pass
+ *  coarse-grained work items (tiles, row blocks).  The first exception
+ *  thrown by any item is re-thrown here after all threads stop.
+ *  @param maxThreads upper bound on participating threads (0 = all)       */
+void ThreadPool::parallelFor(int begin, int end, const std::function<void(int)>& fn,
+                             int maxThreads)
+{
+    run(begin, end, fn, maxThreads, false);
+}
+
+/** @brief Like parallelFor(), but [begin,end) is cut into one contiguous
+ *  part per participating thread and part j always runs on pool slot j
+ *  (0 = the caller).  Two loops over the same range and thread count
+ *  therefore give every index the same thread – so data first touched
+ *  in one loop is processed on the CPU (and NUMA node) that owns it.
+ *  Load balance is the caller's concern.                                */
+void ThreadPool::parallelForStatic(int begin, int end, const std::function<void(int)>& fn,
+                                   int maxThreads)
+{
+    run(begin, end, fn, maxThreads, true);
+}
+
+void ThreadPool::run(int begin, int end, const std::function<void(int)>& fn, int maxThreads,
+                     bool isStatic)
+{
+    if (begin >= end) return;
+
+    // nested call or pool already busy → run inline
+    std::unique_lock<std::mutex> submit(submitMtx, std::defer_lock);
+    int want = 1;
+    if (insidePool != this && submit.try_lock()) {
+        want = (maxThreads > 0 && maxThreads < nThreads) ? maxThreads : nThreads;
+        if (want > end - begin) want = end - begin;
+    }
+    if (want <= 1) {
+        if (submit.owns_lock()) submit.unlock();          // fn may start its own loop
+        for (int i = begin; i < end; ++i) fn(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        body = &fn;
+        nextIndex = begin;
+        jobBegin = begin;
+        jobEnd = end;
+        staticJob = isStatic;
+        jobWorkers = want - 1;
+        active = want - 1;
+        error = nullptr;
+        ++generation;
+    }
+    wake.notify_all();
+
+    const ThreadPool* outer = insidePool;
+    insidePool = this;
+    runChunks(0);
+    insidePool = outer;
+
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        done.wait(lock, [&] { return active == 0; });
+        body = nullptr;
+        failure = error;
+        error = nullptr;
+    }
+    if (failure) std::rethrow_exception(failure);
+}
+
+/* ====================================================================
+   CPU pinning
+   ================================================================= */
+
+/** @brief CPU assigned to pool slot @p slot: the list is spread evenly,
+ *  so with CPUs ordered by NUMA node neighbouring slots – and therefore
+ *  neighbouring static parts – share a node.                          */
+int ThreadPool::workerCpu(int slot) const
+{
+    if (!pinCpus || slot <= 0 || slot >= nThreads) return -1;
+    return pinCpus[static_cast<long>(slot) * pinCount / nThreads];
+}
+
+bool ThreadPool::pinWorker(int t)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(workerCpu(t + 1), &set);
+    return pthread_setaffinity_np(workers[t].native_handle(), sizeof set, &set) == 0;
+}
+
+/** @brief Pin worker threads to @p cpus (slot j gets cpus[j·count/size]).
+ *  The calling thread is left alone – slot 0 is whichever thread submits
+ *  the loop.  The list is kept and re-applied after resize().
+ *  @return false if the kernel rejected an affinity mask
+ *  @throw std::invalid_argument if @p count ≤ 0 or a CPU id is out of range */
+bool ThreadPool::pinWorkers(const int* cpus, int count)
+{
+    if (count <= 0) throw std::invalid_argument("CPU list is empty");
+    for (int k = 0; k < count; ++k)
+        if (cpus[k] < 0 || cpus[k] >= CPU_SETSIZE) throw std::invalid_argument("CPU id out of range");
+    std::lock_guard<std::mutex> submit(submitMtx);
+    int* list = new int[count];
+    for (int k = 0; k < count; ++k) list[k] = cpus[k];
+    delete[] pinCpus;
+    pinCpus = list;
+    pinCount = count;
+
+    bool ok = true;
+    for (int t = 0; t < nThreads - 1; ++t)
+        if (!pinWorker(t)) ok = false;
+    return ok;
+}
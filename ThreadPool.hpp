@@ -0,0 +1,77 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace matrix {
+
+/**
+ * Fixed-size pool of worker threads shared by all SquareMat kernels.
+ * The calling thread always takes part in the work, so a pool of size 1
+ * simply runs everything inline.
+ */
+class ThreadPool {
+private:
+    std::thread* workers;       // מערך חוטי עבודה (size-1 חוטים)
+    int nThreads;               // כולל החוט הקורא
+
+    std::mutex mtx;
+    std::mutex submitMtx;       // עבודה אחת בכל פעם
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(int)>* body;
+    int jobEnd;
+    int nextIndex;
+    int active;                 // כמה עובדים עדיין בעבודה הנוכחית
+    int jobWorkers;             // כמה עובדים משתתפים בעבודה הנוכחית
+    int jobBegin;
+    bool staticJob;             // חלוקה קבועה: חלק j רץ על משבצת j
+    unsigned long generation;
+    bool stopping;
+    std::exception_ptr error;
+
+    int* pinCpus;               // מעבד לכל משבצת, nullptr = ללא הצמדה
+    int pinCount;
+
+    void workerLoop(int id, unsigned long seen);
+    void runChunks(int slot);
+    void run(int begin, int end, const std::function<void(int)>& fn, int maxThreads, bool isStatic);
+    bool pinWorker(int t);
+    void start(int threads);
+    void stop();
+
+public:
+    // ---------- בנאים ----------
+    explicit ThreadPool(int threads);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    // ---------- מופע גלובלי ----------
+    static ThreadPool& instance();
+    static ThreadPool* use(ThreadPool* pool);     // instance() בחוט הזה בלבד; מחזיר את הקודם
+
+    int size() const;
+    void resize(int threads);
+
+    // ---------- לולאה מקבילית ----------
+    void parallelFor(int begin, int end, const std::function<void(int)>& fn,
+                     int maxThreads = 0);
+    void parallelForStatic(int begin, int end, const std::function<void(int)>& fn,
+                           int maxThreads = 0);   // חלק רציף j תמיד על אותו חוט
+
+    // ---------- הצמדה למעבדים ----------
+    bool pinWorkers(const int* cpus, int count);  // false אם ההצמדה נכשלה
+    int workerCpu(int slot) const;                // -1 = לא מוצמד / החוט הקורא
+};
+
+} // namespace matrix
+
+#endif // THREADPOOL_HPP
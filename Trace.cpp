@@ -0,0 +1,307 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "Trace.hpp"
+#include <algorithm>   // std::max
+#include <cmath>       // std::llround
+#include <cstdio>      // std::rename, std::remove, std::snprintf
+#include <cstdlib>     // std::getenv, std::atexit
+#include <fstream>     // std::ofstream
+#include <iostream>    // std::cerr
+#include <mutex>
+#include <stdexcept>   // std::runtime_error
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>    // syscall, getpid
+
+using namespace matrix::trace;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+/** @brief One complete event.  Fields are relaxed atomics so a reader
+ *  may copy a ring while its owner keeps writing (see readRing).       */
+struct Slot {
+    std::atomic<const char*> name, cat, argName;
+    std::atomic<std::int64_t> arg, ts, dur;     // ב-ticks; ts יחסית ל-epoch
+};
+
+/** @brief Single-producer ring owned by one thread. */
+struct Ring {
+    Slot* slots;
+    std::uint64_t mask;
+    std::atomic<std::uint64_t> head{0};         // נכתב רק ע"י הבעלים
+    std::atomic<std::uint64_t> base{0};         // אירועים לפני start() האחרון
+    std::atomic<bool> alive{true};
+    int tid;
+};
+
+struct Registry {
+    std::mutex mtx;
+    std::vector<Ring*> rings;
+    std::size_t capacity = 1 << 16;
+    std::atomic<std::uint64_t> epochTicks{0};
+    std::int64_t epochNs = 0;                   // steady_clock באותו רגע
+};
+
+std::int64_t steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+bool invariantTsc()
+{
+    std::ifstream f("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(f, line))
+        if (line.rfind("flags", 0) == 0)
+            return line.find(" constant_tsc") != std::string::npos && line.find(" nonstop_tsc") != std::string::npos;
+    return false;
+}
+
+/** @brief Never destroyed, so the exit-time flush and late thread exits
+ *  still find it.                                                     */
+Registry& registry()
+{
+    static Registry* r = new Registry;
+    return *r;
+}
+
+struct Local {
+    Ring* ring = nullptr;
+    ~Local()
+    {
+        if (ring) ring->alive.store(false, std::memory_order_release);
+    }
+};
+
+thread_local Local local;
+
+Ring& localRing()
+{
+    if (local.ring) return *local.ring;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    Ring* ring = new Ring;
+    ring->slots = new Slot[r.capacity];
+    ring->mask = r.capacity - 1;
+    ring->tid = static_cast<int>(::syscall(SYS_gettid));
+    r.rings.push_back(ring);
+    local.ring = ring;
+    return *ring;
+}
+
+struct Event {
+    const char* name;
+    const char* cat;
+    const char* argName;
+    std::int64_t arg, ts, dur;
+};
+
+/** @brief Copy the valid part of @p ring.  Slots the owner may have
+ *  overwritten during the copy are discarded by re-reading head; the
+ *  slot at index @c after may be mid-write, so it counts as lost too.  */
+void readRing(const Ring& ring, std::vector<Event>& out)
+{
+    const std::uint64_t cap = ring.mask + 1;
+    const std::uint64_t head = ring.head.load(std::memory_order_acquire);
+    const std::uint64_t base = ring.base.load(std::memory_order_relaxed);
+    std::uint64_t lo = std::max(base, head > cap ? head - cap : 0);
+    std::vector<Event> tmp;
+    tmp.reserve(head - lo);
+    for (std::uint64_t i = lo; i < head; ++i) {
+        const Slot& s = ring.slots[i & ring.mask];
+        tmp.push_back({s.name.load(std::memory_order_relaxed), s.cat.load(std::memory_order_relaxed),
+                       s.argName.load(std::memory_order_relaxed), s.arg.load(std::memory_order_relaxed),
+                       s.ts.load(std::memory_order_relaxed), s.dur.load(std::memory_order_relaxed)});
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::uint64_t after = ring.head.load(std::memory_order_relaxed);
+    const std::uint64_t safe = after + 1 > cap ? after + 1 - cap : 0;   // מה שעוד לא נדרס
+    for (std::uint64_t i = lo; i < head; ++i)
+        if (i >= safe) out.push_back(tmp[i - lo]);
+}
+
+/** @brief Nanoseconds per tick, calibrated against steady_clock over the
+ *  interval since start() (at least 10 ms).                          */
+double nsPerTick(const Registry& r)
+{
+    if (!detail::useTsc) return 1.0;
+    const std::uint64_t t0 = r.epochTicks.load(std::memory_order_relaxed);
+    std::int64_t ns = steadyNs();
+    while (ns - r.epochNs < 10000000) ns = steadyNs();
+    const std::uint64_t t1 = detail::ticks();
+    return t1 > t0 ? double(ns - r.epochNs) / double(t1 - t0) : 1.0;
+}
+
+void appendMicros(std::string& out, std::int64_t ns)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%lld.%03lld", static_cast<long long>(ns / 1000),
+                  static_cast<long long>(ns % 1000));
+    out += buf;
+}
+
+} // namespace
+
+namespace matrix {
+namespace trace {
+
+namespace detail {
+
+std::atomic<bool> on{false};
+const bool useTsc = invariantTsc();
+
+/** @brief Append one complete event to the calling thread's ring. */
+void record(const char* name, const char* cat, const char* argName, std::int64_t arg, std::uint64_t begin)
+{
+    const std::uint64_t end = ticks();
+    Ring& r = localRing();
+    const std::uint64_t h = r.head.load(std::memory_order_relaxed);
+    Slot& s = r.slots[h & r.mask];
+    s.name.store(name, std::memory_order_relaxed);
+    s.cat.store(cat, std::memory_order_relaxed);
+    s.argName.store(argName, std::memory_order_relaxed);
+    s.arg.store(arg, std::memory_order_relaxed);
+    s.ts.store(static_cast<std::int64_t>(begin - registry().epochTicks.load(std::memory_order_relaxed)),
+               std::memory_order_relaxed);
+    s.dur.store(static_cast<std::int64_t>(end - begin), std::memory_order_relaxed);
+    r.head.store(h + 1, std::memory_order_release);
+}
+
+} // namespace detail
+
+/** @brief Begin recording.  Earlier events are discarded, rings of
+ *  threads that have exited are freed, and @p eventsPerThread (rounded
+ *  up to a power of two) sizes the rings of threads that trace for the
+ *  first time from now on.                                            */
+void start(std::size_t eventsPerThread)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    std::size_t cap = 1;
+    while (cap < std::max<std::size_t>(eventsPerThread, 2)) cap <<= 1;
+    r.capacity = cap;
+
+    std::vector<Ring*> keep;
+    for (Ring* ring : r.rings) {
+        if (ring->alive.load(std::memory_order_acquire)) {
+            ring->base.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+            keep.push_back(ring);
+        } else {
+            delete[] ring->slots;
+            delete ring;
+        }
+    }
+    r.rings.swap(keep);
+    r.epochNs = steadyNs();
+    r.epochTicks.store(detail::ticks(), std::memory_order_relaxed);
+    detail::on.store(true, std::memory_order_release);
+}
+
+/** @brief Stop recording; spans already open still complete. */
+void stop() { detail::on.store(false, std::memory_order_release); }
+
+bool active() { return detail::on.load(std::memory_order_relaxed); }
+
+std::uint64_t dropped()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    std::uint64_t lost = 0;
+    for (const Ring* ring : r.rings) {
+        const std::uint64_t n = ring->head.load(std::memory_order_acquire) - ring->base.load(std::memory_order_relaxed);
+        if (n > ring->mask) lost += n - ring->mask;     // חריץ אחד שמור לאירוע בכתיבה
+    }
+    return lost;
+}
+
+/** @brief Chrome trace event format ("X" complete events plus thread
+ *  name metadata); timestamps in microseconds since start().          */
+std::string toJson()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    const std::string pid = std::to_string(::getpid());
+    const double scale = nsPerTick(r);
+
+    std::string out = "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    out += "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " + pid +
+           ", \"tid\": 0, \"args\": {\"name\": \"SquareMat\"}}";
+    std::vector<Event> events;
+    for (const Ring* ring : r.rings) {
+        const std::string tid = std::to_string(ring->tid);
+        out += ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " + pid + ", \"tid\": " + tid +
+               ", \"args\": {\"name\": \"" + (std::to_string(ring->tid) == pid ? std::string("main")
+                                                                             : "thread " + tid) + "\"}}";
+        events.clear();
+        readRing(*ring, events);
+        for (const Event& e : events) {
+            if (e.ts < 0) continue;                 // נפתח לפני start()
+            out += ",\n{\"name\": \"";
+            out += e.name;
+            out += "\", \"cat\": \"";
+            out += e.cat;
+            out += "\", \"ph\": \"X\", \"ts\": ";
+            appendMicros(out, std::llround(e.ts * scale));
+            out += ", \"dur\": ";
+            appendMicros(out, std::llround(e.dur * scale));
+            out += ", \"pid\": " + pid + ", \"tid\": " + tid;
+            if (e.argName) {
+                out += ", \"args\": {\"";
+                out += e.argName;
+                out += "\": " + std::to_string(e.arg) + "}";
+            }
+            out += '}';
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+/** @brief Write toJson() to @p path via a temporary file and rename().
+ *  @throw std::runtime_error if the file cannot be written            */
+void write(const std::string& path)
+{
+    const std::string text = toJson();
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f << text;
+        if (!f) throw std::runtime_error("cannot write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot rename " + tmp + " to " + path);
+    }
+}
+
+} // namespace trace
+} // namespace matrix
+
+/* --- SQUAREMAT_TRACE=<file>: trace the whole run (defined last, so it
+       is initialized after detail::useTsc) --- */
+namespace {
+
+std::string* autoPath = nullptr;
+
+void flushAtExit()
+{
+    stop();
+    try {
+        write(*autoPath);
+    } catch (const std::exception& e) {
+        std::cerr << "SquareMat trace: " << e.what() << '\n';
+    }
+}
+
+struct AutoTrace {
+    AutoTrace()
+    {
+        const char* env = std::getenv("SQUAREMAT_TRACE");
+        if (!env || !*env) return;
+        autoPath = new std::string(env);
+        start();
+        std::atexit(flushAtExit);
+    }
+} autoTrace;
+
+} // namespace
@@ -0,0 +1,94 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+namespace matrix {
+namespace trace {
+
+/*
+ * Timeline tracer for SquareMat: operator calls, GEMM macro-tiles and
+ * factorization panels, per thread, exported as Chrome trace JSON that
+ * loads in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Off by default: a disabled Span costs one relaxed atomic load.  While
+ * active each thread appends complete ("X") events to its own ring
+ * buffer – no locks, no allocation; when a ring wraps the oldest events
+ * are overwritten and counted in dropped(), and export keeps the newest
+ * capacity − 1 (the next slot may be mid-write).  Timestamps are raw TSC
+ * ticks when the CPU has an invariant TSC (about half the cost of
+ * steady_clock::now() in a VM), converted to time on export.  Setting SQUAREMAT_TRACE=
+ * <file> starts tracing at load time and writes <file> at exit.
+ */
+
+// ---------- הפעלה ----------
+void start(std::size_t eventsPerThread = 1 << 16);   // מעוגל לחזקת 2, מנקה אירועים קודמים
+void stop();
+bool active();
+
+// ---------- ייצוא ----------
+std::string toJson();
+void write(const std::string& path);                  // כתיבה אטומית (קובץ זמני + rename)
+std::uint64_t dropped();                             // אירועים שנדרסו בגלישת הטבעת
+
+namespace detail {
+extern std::atomic<bool> on;
+extern const bool useTsc;                            // TSC קבוע – נבדק פעם אחת בטעינה
+
+inline std::uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (useTsc) return __rdtsc();
+#endif
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void record(const char* name, const char* cat, const char* argName, std::int64_t arg, std::uint64_t begin);
+}
+
+/** RAII span: one event from construction to destruction.  @p name,
+ *  @p cat and @p argName must be string literals (only the pointer is
+ *  stored).                                                            */
+class Span {
+private:
+    const char* name;               // nullptr – המעקב היה כבוי בבנייה
+    const char* cat;
+    const char* argName;
+    std::int64_t arg;
+    std::uint64_t begin;            // detail::ticks()
+
+public:
+    explicit Span(const char* name_, const char* cat_ = "op", const char* argName_ = nullptr,
+                  std::int64_t arg_ = 0)
+        : name(nullptr), cat(cat_), argName(argName_), arg(arg_), begin(0)
+    {
+        if (!detail::on.load(std::memory_order_relaxed)) return;
+        name = name_;
+        begin = detail::ticks();
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+    ~Span() { end(); }
+
+    /** Close the span early (later calls and the destructor do nothing). */
+    void end()
+    {
+        if (name) detail::record(name, cat, argName, arg, begin);
+        name = nullptr;
+    }
+};
+
+} // namespace trace
+} // namespace matrix
+
+#endif // TRACE_HPP
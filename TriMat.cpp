@@ -0,0 +1,361 @@
+// adi.gamzu@msmail.ariel.ac.il
+#include "TriMat.hpp"
+#include "Kernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   // std::copy, std::fill, std::min, std::max
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::invalid_argument, std::out_of_range, std::domain_error
+
+using namespace matrix;
+
+namespace {
+
+/** @brief Tile edge used by the gemm-backed products. */
+constexpr int NB = 64;
+
+/** @brief Column chunk handled by one task in the triangular solve. */
+constexpr int CHUNK = 128;
+
+} // namespace
+
+/* ====================================================================
+   Rule-of-Three
+   ================================================================= */
+
+/** @brief Construct an @c n×n triangle filled with @p initVal
+ *  (the diagonal is 1 for Diag::Unit).
+ *  @throw std::invalid_argument if @p n_ ≤ 0                           */
+TriMat::TriMat(int n_, Uplo uplo_, Diag diag_, double initVal)
+    : data(nullptr), n(n_), uplo(uplo_), diag(diag_)
+{
+    if (n <= 0) throw std::invalid_argument("n must be positive");
+    data = new double[packedSize()];
+    std::fill(data, data + packedSize(), initVal);
+    if (diag == Diag::Unit)
+        for (int i = 0; i < n; ++i) data[rowStart(i) + (uplo == Uplo::Lower ? i : 0)] = 1.0;
+}
+
+/** @brief Take the @p uplo_ triangle of @p A; the rest is ignored. */
+TriMat::TriMat(const SquareMat& A, Uplo uplo_, Diag diag_)
+    : data(nullptr), n(A.getN()), uplo(uplo_), diag(diag_)
+{
+    data = new double[packedSize()];
+    const double* a = A.raw();
+    for (int i = 0; i < n; ++i) {
+        const double* row = a + static_cast<long>(i) * n;
+        if (uplo == Uplo::Lower) std::copy(row, row + i + 1, data + rowStart(i));
+        else                     std::copy(row + i, row + n, data + rowStart(i));
+        if (diag == Diag::Unit) data[rowStart(i) + (uplo == Uplo::Lower ? i : 0)] = 1.0;
+    }
+}
+
+/** @brief Deep-copy constructor. */
+TriMat::TriMat(const TriMat& other)
+    : data(nullptr), n(other.n), uplo(other.uplo), diag(other.diag)
+{
+    data = new double[packedSize()];
+    std::copy(other.data, other.data + packedSize(), data);
+}
+
+/** @brief Copy-assignment operator. */
+TriMat& TriMat::operator=(const TriMat& other)
+{
+    if (this == &other) return *this;
+
+    if (n != other.n) {
+        delete[] data;
+        n = other.n;
+        data = new double[packedSize()];
+    }
+    uplo = other.uplo;
+    diag = other.diag;
+    std::copy(other.data, other.data + packedSize(), data);
+    return *this;
+}
+
+/** @brief Destructor – frees the packed buffer. */
+TriMat::~TriMat() { delete[] data; }
+
+/* ====================================================================
+   Layout helpers
+   ================================================================= */
+
+/** @brief Offset of the first stored element of row @p i. */
+long TriMat::rowStart(int i) const
+{
+    const long li = i;
+    return uplo == Uplo::Lower ? li * (li + 1) / 2 : li * n - li * (li - 1) / 2;
+}
+
+/** @brief True if (i,j) lies in the stored triangle. */
+bool TriMat::inside(int i, int j) const
+{
+    return uplo == Uplo::Lower ? j <= i : j >= i;
+}
+
+/** @brief Dense copy of the tile (I0.., J0..) with implicit zeros/ones. */
+void TriMat::tile(int I0, int ib, int J0, int jb, double* dst) const
+{
+    for (int r = 0; r < ib; ++r) {
+        const int i = I0 + r;
+        double* d = dst + static_cast<long>(r) * jb;
+        for (int c = 0; c < jb; ++c) {
+            const int j = J0 + c;
+            if (!inside(i, j))                          d[c] = 0.0;
+            else if (i == j && diag == Diag::Unit)      d[c] = 1.0;
+            else d[c] = data[rowStart(i) + (uplo == Uplo::Lower ? j : j - i)];
+        }
+    }
+}
+
+/* ====================================================================
+   Element access
+   ================================================================= */
+
+/** @brief Mutable access to an element of the stored triangle.
+ *  @throw std::out_of_range for indices outside [0,n-1], outside the
+ *         triangle, or on the diagonal of a unit triangle              */
+double& TriMat::operator()(int i, int j)
+{
+    if (i < 0 || i >= n || j < 0 || j >= n)
+        throw std::out_of_range("index out of range");
+    if (!inside(i, j) || (i == j && diag == Diag::Unit))
+        throw std::out_of_range("element is not stored");
+    return data[rowStart(i) + (uplo == Uplo::Lower ? j : j - i)];
+}
+
+/** @brief Value of element (i,j) – 0 outside the triangle. */
+double TriMat::operator()(int i, int j) const
+{
+    if (i < 0 || i >= n || j < 0 || j >= n)
+        throw std::out_of_range("index out of range");
+    if (!inside(i, j)) return 0.0;
+    if (i == j && diag == Diag::Unit) return 1.0;
+    return data[rowStart(i) + (uplo == Uplo::Lower ? j : j - i)];
+}
+
+int TriMat::getN() const { return n; }
+Uplo TriMat::getUplo() const { return uplo; }
+Diag TriMat::getDiag() const { return diag; }
+
+/** @brief Number of stored doubles, n(n+1)/2. */
+long TriMat::packedSize() const { return static_cast<long>(n) * (n + 1) / 2; }
+
+/** @brief Expand to a dense SquareMat (zeros outside the triangle). */
+SquareMat TriMat::toSquareMat() const
+{
+    SquareMat res(n);
+    tile(0, n, 0, n, res.raw());
+    return res;
+}
+
+/* ====================================================================
+   Products
+   ================================================================= */
+
+/** @brief y = T·x in n(n+1)/2 multiply-adds. */
+void TriMat::multiply(const double* x, double* y) const
+{
+    const bool unit = (diag == Diag::Unit);
+    ThreadPool::instance().parallelFor(0, (n + 255) / 256, [&](int blk) {
+        const int r1 = std::min(n, (blk + 1) * 256);
+        for (int i = blk * 256; i < r1; ++i) {
+            const double* row = data + rowStart(i);
+            const int j0 = (uplo == Uplo::Lower) ? 0 : i;
+            const int j1 = (uplo == Uplo::Lower) ? i + 1 : n;
+            double s = 0.0;
+            for (int j = j0; j < j1; ++j) s += row[j - j0] * x[j];
+            if (unit) s += x[i] - row[i - j0] * x[i];
+            y[i] = s;
+        }
+    });
+}
+
+/** @brief TRMM: T·B.  Only the tiles of T inside the triangle are
+ *  multiplied (≈ n³ FLOPs instead of 2n³), each through kernels::gemm. */
+SquareMat TriMat::operator*(const SquareMat& rhs) const
+{
+    if (n != rhs.getN()) throw std::invalid_argument("dimension mismatch");
+    SquareMat res(n, 0.0);
+    const int blocks = (n + NB - 1) / NB;
+
+    ThreadPool::instance().parallelFor(0, blocks, [&](int bi) {
+        const int I0 = bi * NB, ib = std::min(NB, n - I0);
+        std::unique_ptr<double[]> tmp(new double[NB * NB]);
+        const int k0 = (uplo == Uplo::Lower) ? 0 : bi;
+        const int k1 = (uplo == Uplo::Lower) ? bi : blocks - 1;
+        for (int bk = k0; bk <= k1; ++bk) {
+            const int K0 = bk * NB, kb = std::min(NB, n - K0);
+            tile(I0, ib, K0, kb, tmp.get());
+            kernels::gemm(ib, n, kb, 1.0, tmp.get(), kb, false,
+                          rhs.raw() + static_cast<long>(K0) * n, n, false,
+                          1.0, res.raw() + static_cast<long>(I0) * n, n);
+        }
+    });
+    return res;
+}
+
+/** @brief Product of two triangles of the same kind (≈ n³/3 FLOPs):
+ *  tile (I,J) of the result only sums over the K between J and I.
+ *  @throw std::invalid_argument on dimension or triangle mismatch     */
+TriMat TriMat::operator*(const TriMat& rhs) const
+{
+    if (n != rhs.n) throw std::invalid_argument("dimension mismatch");
+    if (uplo != rhs.uplo) throw std::invalid_argument("triangle mismatch");
+
+    const Diag d = (diag == Diag::Unit && rhs.diag == Diag::Unit) ? Diag::Unit : Diag::NonUnit;
+    TriMat res(n, uplo, d);
+    const int blocks = (n + NB - 1) / NB;
+    const int tiles = blocks * (blocks + 1) / 2;
+
+    ThreadPool::instance().parallelFor(0, tiles, [&](int t) {
+        int hi = 0;
+        while ((hi + 1) * (hi + 2) / 2 <= t) ++hi;
+        const int lo = t - hi * (hi + 1) / 2;
+        const int bi = (uplo == Uplo::Lower) ? hi : lo;
+        const int bj = (uplo == Uplo::Lower) ? lo : hi;
+        const int I0 = bi * NB, ib = std::min(NB, n - I0);
+        const int J0 = bj * NB, jb = std::min(NB, n - J0);
+
+        std::unique_ptr<double[]> a(new double[NB * NB]);
+        std::unique_ptr<double[]> b(new double[NB * NB]);
+        std::unique_ptr<double[]> c(new double[NB * NB]);
+        std::fill(c.get(), c.get() + ib * jb, 0.0);
+        for (int bk = lo; bk <= hi; ++bk) {
+            const int K0 = bk * NB, kb = std::min(NB, n - K0);
+            tile(I0, ib, K0, kb, a.get());
+            rhs.tile(K0, kb, J0, jb, b.get());
+            kernels::gemm(ib, jb, kb, 1.0, a.get(), kb, false, b.get(), jb, false,
+                          1.0, c.get(), jb);
+        }
+        for (int r = 0; r < ib; ++r)
+            for (int col = 0; col < jb; ++col) {
+                const int i = I0 + r, j = J0 + col;
+                if (res.inside(i, j))
+                    res.data[res.rowStart(i) + (uplo == Uplo::Lower ? j : j - i)] =
+                        c[static_cast<long>(r) * jb + col];
+            }
+    });
+    return res;
+}
+
+/** @brief Binary exponentiation – stays triangular throughout. */
+TriMat TriMat::operator^(int e) const
+{
+    if (e < 0) throw std::invalid_argument("negative exponent");
+    TriMat base(*this);
+    TriMat res(n, uplo, Diag::Unit, 0.0);          // identity
+    while (e) {
+        if (e & 1) res = res * base;
+        base = base * base;
+        e >>= 1;
+    }
+    return res;
+}
+
+/* ====================================================================
+   Transpose / determinant / solve
+   ================================================================= */
+
+/** @brief Transpose – a lower triangle becomes an upper one. */
+TriMat TriMat::operator~() const
+{
+    TriMat res(n, uplo == Uplo::Lower ? Uplo::Upper : Uplo::Lower, diag);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            if (inside(i, j))
+                res.data[res.rowStart(j) + (res.uplo == Uplo::Lower ? i : i - j)] =
+                    data[rowStart(i) + (uplo == Uplo::Lower ? j : j - i)];
+    return res;
+}
+
+/** @brief Determinant = product of the diagonal – O(n). */
+double TriMat::determinant() const
+{
+    if (diag == Diag::Unit) return 1.0;
+    double det = 1.0;
+    for (int i = 0; i < n; ++i) det *= data[rowStart(i) + (uplo == Uplo::Lower ? i : 0)];
+    return det;
+}
+
+/** @brief Same as determinant(). */
+double TriMat::operator!() const { return determinant(); }
+
+/** @throw std::domain_error if a stored diagonal element is zero */
+void TriMat::requireNonsingular() const
+{
+    if (diag == Diag::Unit) return;
+    for (int i = 0; i < n; ++i)
+        if (data[rowStart(i) + (uplo == Uplo::Lower ? i : 0)] == 0.0)
+            throw std::domain_error("matrix is singular");
+}
+
+/** @brief Solve T·x = b by substitution (n² FLOPs), overwriting @p b.
+ *  @throw std::domain_error if the matrix is singular                 */
+void TriMat::solveInPlace(double* b) const
+{
+    requireNonsingular();
+    const bool lower = (uplo == Uplo::Lower);
+    for (int s = 0; s < n; ++s) {
+        const int i = lower ? s : n - 1 - s;
+        const double* row = data + rowStart(i);
+        double v = b[i];
+        if (lower) for (int p = 0; p < i; ++p) v -= row[p] * b[p];
+        else       for (int p = i + 1; p < n; ++p) v -= row[p - i] * b[p];
+        if (diag == Diag::NonUnit) v /= row[lower ? i : 0];
+        b[i] = v;
+    }
+}
+
+/** @brief Solve T·X = B for every column of @p B.
+ *  Column chunks of X are independent and run on the pool.
+ *  @throw std::invalid_argument on dimension mismatch
+ *  @throw std::domain_error if the matrix is singular                 */
+SquareMat TriMat::solve(const SquareMat& B) const
+{
+    if (n != B.getN()) throw std::invalid_argument("dimension mismatch");
+    requireNonsingular();
+    SquareMat X(B);
+    double* x = X.raw();
+    const bool lower = (uplo == Uplo::Lower);
+
+    ThreadPool::instance().parallelFor(0, (n + CHUNK - 1) / CHUNK, [&](int c) {
+        const int j0 = c * CHUNK, w = std::min(CHUNK, n - j0);
+        for (int s = 0; s < n; ++s) {
+            const int i = lower ? s : n - 1 - s;
+            const double* row = data + rowStart(i);
+            double* xi = x + static_cast<long>(i) * n + j0;
+            const int p0 = lower ? 0 : i + 1;
+            const int p1 = lower ? i : n;
+            for (int p = p0; p < p1; ++p) {
+                const double t = row[lower ? p : p - i];
+                if (t == 0.0) continue;
+                const double* xp = x + static_cast<long>(p) * n + j0;
+                for (int j = 0; j < w; ++j) xi[j] -= t * xp[j];
+            }
+            if (diag == Diag::NonUnit) {
+                const double d = row[lower ? i : 0];
+                for (int j = 0; j < w; ++j) xi[j] /= d;
+            }
+        }
+    });
+    return X;
+}
+
+namespace matrix {
+
+/** @brief Pretty-print the full matrix row-by-row (zeros included). */
+std::ostream& operator<<(std::ostream& os, const TriMat& m)
+{
+    for (int i = 0; i < m.getN(); ++i) {
+        os << "[ ";
+        for (int j = 0; j < m.getN(); ++j) {
+            os << m(i, j);
+            if (j + 1 < m.getN()) os << ' ';
+        }
+        os << " ]\n";
+    }
+    return os;
+}
+
+} // namespace matrix
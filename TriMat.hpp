@@ -0,0 +1,70 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef TRIMAT_HPP
+#define TRIMAT_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+
+namespace matrix {
+
+enum class Uplo { Lower, Upper };
+enum class Diag { NonUnit, Unit };
+
+/**
+ * Triangular n×n matrix in packed row-major storage (n(n+1)/2 doubles).
+ * Through the const accessor, elements outside the triangle read as 0 and
+ * a Diag::Unit diagonal reads as 1; the mutable accessor only reaches
+ * stored elements and throws std::out_of_range for the others.
+ */
+class TriMat {
+private:
+    double* data;   // המשולש בלבד, שורה אחרי שורה
+    int n;
+    Uplo uplo;
+    Diag diag;
+
+    long rowStart(int i) const;
+    bool inside(int i, int j) const;
+    void requireNonsingular() const;
+    void tile(int I0, int ib, int J0, int jb, double* dst) const;
+
+public:
+    // ---------- בנאים ו־Rule of 3 ----------
+    TriMat(int n, Uplo uplo = Uplo::Lower, Diag diag = Diag::NonUnit, double initVal = 0.0);
+    TriMat(const SquareMat& A, Uplo uplo, Diag diag = Diag::NonUnit);
+    TriMat(const TriMat& other);
+    TriMat& operator=(const TriMat& other);
+    ~TriMat();
+
+    // ---------- גישה לאיברים ----------
+    double& operator()(int i, int j);
+    double operator()(int i, int j) const;
+
+    int getN() const;
+    Uplo getUplo() const;
+    Diag getDiag() const;
+    long packedSize() const;
+
+    SquareMat toSquareMat() const;
+
+    // ---------- כפל ----------
+    void multiply(const double* x, double* y) const;     // y = T·x
+    SquareMat operator*(const SquareMat& rhs) const;     // TRMM
+    TriMat operator*(const TriMat& rhs) const;
+    TriMat operator^(int e) const;
+
+    // ---------- טרנספוז / דטרמיננטה / פתרון ----------
+    TriMat operator~() const;
+    double operator!() const;
+    double determinant() const;
+
+    void solveInPlace(double* b) const;
+    SquareMat solve(const SquareMat& B) const;
+};
+
+std::ostream& operator<<(std::ostream& out, const TriMat& m);
+
+} // namespace matrix
+
+#endif // TRIMAT_HPP
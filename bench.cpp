@@ -0,0 +1,374 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "Autotune.hpp"
+#include "SquareMat.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace matrix;
+
+/* ====================================================================
+   Allocation counting – every operator new in the process goes through
+   here, so allocs/op covers the temporaries an operator creates.
+   ================================================================= */
+
+namespace {
+std::atomic<long> allocations{0};
+}
+
+void* operator new(std::size_t bytes)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t bytes) { return operator new(bytes); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** @brief Exponent used for the operator^ benchmark. */
+constexpr int POWER = 8;
+
+/** @brief One benchmarked operator: how to run it and its cost model. */
+struct Op {
+    const char* name;
+    int maxN;                                  // גדלים מעבר לזה מדולגים (למשל ! שהוא O(n!))
+    double flops;                              // פעולות נקודה צפה כפולה n² (או n³ ל-*, ^)
+    double bytes;                              // בתים שחייבים לעבור כפולה n²
+    bool cubic;                                // flops מוכפל ב-n³ במקום n²
+    std::function<double(SquareMat&, SquareMat&)> run;
+};
+
+struct Result {
+    std::string op;
+    int n;
+    long iters;                                // קריאות בכל חזרה
+    std::vector<double> samples;               // ns/op לכל חזרה
+    double nsPerOp, gflops, gbps, allocsPerOp;
+    double intensity, roofPct;                 // FLOP/byte ואחוז מהגג (רק עם --roofline)
+};
+
+/** @brief Machine limits for the roofline: min(peak, intensity × bandwidth). */
+struct Machine {
+    double peakGflops = 0;
+    double streamGbps = 0;
+};
+
+/** @brief Matrix multiplications done by operator^(e) (square-and-multiply). */
+int powerProducts(int e)
+{
+    int mults = 0;
+    for (; e; e >>= 1) mults += 1 + (e & 1);
+    return mults;
+}
+
+std::vector<Op> operators()
+{
+    const double pow = powerProducts(POWER);
+    return {
+        {"A+B",   1 << 30, 1, 24, false, [](SquareMat& a, SquareMat& b) { return (a + b)(0, 0); }},
+        {"A-B",   1 << 30, 1, 24, false, [](SquareMat& a, SquareMat& b) { return (a - b)(0, 0); }},
+        {"-A",    1 << 30, 1, 16, false, [](SquareMat& a, SquareMat&) { return (-a)(0, 0); }},
+        {"A*B",   1 << 30, 2, 24, true,  [](SquareMat& a, SquareMat& b) { return (a * b)(0, 0); }},
+        {"A*s",   1 << 30, 1, 16, false, [](SquareMat& a, SquareMat&) { return (a * 1.5)(0, 0); }},
+        {"A/s",   1 << 30, 1, 16, false, [](SquareMat& a, SquareMat&) { return (a / 1.5)(0, 0); }},
+        {"A%B",   1 << 30, 1, 24, false, [](SquareMat& a, SquareMat& b) { return (a % b)(0, 0); }},
+        {"~A",    1 << 30, 0, 16, false, [](SquareMat& a, SquareMat&) { return (~a)(0, 0); }},
+        {"A^8",   1 << 30, 2 * pow, 24, true, [](SquareMat& a, SquareMat&) { return (a ^ POWER)(0, 0); }},
+        {"!A",    9,       0, 8,  false, [](SquareMat& a, SquareMat&) { return !a; }},
+        {"sum",   1 << 30, 1, 8,  false, [](SquareMat& a, SquareMat&) { return a.sum(); }},
+        {"A==B",  1 << 30, 2, 16, false, [](SquareMat& a, SquareMat& b) { return a == b ? 1.0 : 0.0; }},
+        {"++A",   1 << 30, 1, 16, false, [](SquareMat& a, SquareMat&) { return (++a)(0, 0); }},
+        {"A+=B",  1 << 30, 1, 24, false, [](SquareMat& a, SquareMat& b) { return (a += b)(0, 0); }},
+        {"A*=s",  1 << 30, 1, 16, false, [](SquareMat& a, SquareMat&) { return (a *= 1.0000001)(0, 0); }},
+    };
+}
+
+/** @brief Well-scaled test matrix (entries in [-1, 1], so ^ stays finite-ish). */
+SquareMat makeMat(int n, double seed)
+{
+    SquareMat A(n);
+    double* a = A.raw();
+    for (long k = 0; k < static_cast<long>(n) * n; ++k) a[k] = std::sin(seed * (k + 1)) / n;
+    return A;
+}
+
+struct Options {
+    int minN = 2;
+    int maxN = 8192;
+    int reps = 7;
+    double repSeconds = 0.02;                  // זמן יעד לחזרה אחת
+    double budgetSeconds = 2.0;                // זמן יעד לכל (אופרטור, גודל)
+    std::string ops;                           // רשימה מופרדת בפסיקים; ריק = הכל
+    std::string json = "bench.json";
+    autotune::TuneOptions tune;                // tune.n > 0 אחרי --tune
+    bool roofline = false;
+};
+
+volatile double sink;
+
+/**
+ * Time one (operator, size) case.  The iteration count is calibrated
+ * so one repetition lasts about repSeconds; up to reps repetitions are
+ * run within the per-case budget (at least three when a repetition is
+ * short enough, so the compare tool has samples to test).
+ */
+Result measure(const Op& op, int n, const Options& opt)
+{
+    SquareMat A = makeMat(n, 0.37), B = makeMat(n, 0.91);
+    auto time = [&](long iters) {
+        const auto t0 = Clock::now();
+        for (long i = 0; i < iters; ++i) sink = op.run(A, B);
+        return std::chrono::duration<double>(Clock::now() - t0).count();
+    };
+
+    const double once = time(1);               // חימום + כיול
+    const long iters = std::max(1L, static_cast<long>(opt.repSeconds / std::max(once, 1e-9)));
+    const double rep = once * iters;
+    int reps = static_cast<int>(std::clamp(opt.budgetSeconds / std::max(rep, 1e-9), 1.0, double(opt.reps)));
+    if (reps < 3 && 3 * rep <= 4 * opt.budgetSeconds) reps = std::min(3, opt.reps);
+
+    Result r{op.name, n, iters, {}, 0, 0, 0, 0, 0, 0};
+    r.samples.reserve(reps);
+    const long before = allocations.load();
+    for (int k = 0; k < reps; ++k) r.samples.push_back(time(iters) * 1e9 / iters);
+    r.allocsPerOp = double(allocations.load() - before) / (double(iters) * reps);
+
+    std::vector<double> s = r.samples;
+    std::sort(s.begin(), s.end());
+    r.nsPerOp = (s.size() % 2) ? s[s.size() / 2] : 0.5 * (s[s.size() / 2 - 1] + s[s.size() / 2]);
+    const double n2 = double(n) * n;
+    r.gflops = op.flops * n2 * (op.cubic ? n : 1) / r.nsPerOp;
+    r.gbps = op.bytes * n2 / r.nsPerOp;
+    return r;
+}
+
+/* ====================================================================
+   Roofline: machine peak and STREAM bandwidth
+   ================================================================= */
+
+/** @brief 64 independent FMA chains – enough to cover FMA latency on
+ *  every vector width up to AVX-512, and register resident.           */
+double fmaLoop(long iters)
+{
+    double x[64];
+    for (int i = 0; i < 64; ++i) x[i] = 1.0 + i * 1e-3;
+    const double a = 0.999999, b = 1e-6;
+    for (long it = 0; it < iters; ++it)
+        for (int i = 0; i < 64; ++i) x[i] = std::fma(x[i], a, b);
+    double s = 0;
+    for (int i = 0; i < 64; ++i) s += x[i];
+    return s;
+}
+
+/** @brief Peak double-precision GFLOP/s: fmaLoop on every pool thread. */
+double peakGflops()
+{
+    ThreadPool& pool = ThreadPool::instance();
+    const int threads = pool.size();
+    long iters = 1 << 16;
+    for (;;) {
+        const auto t0 = Clock::now();
+        pool.parallelFor(0, threads, [&](int) { sink = fmaLoop(iters); });
+        const double s = std::chrono::duration<double>(Clock::now() - t0).count();
+        if (s > 0.2) return 2.0 * 64 * static_cast<double>(iters) * threads / s * 1e-9;
+        iters *= 2;
+    }
+}
+
+/** @brief STREAM triad a = b + s·c over 3 × 32 MiB arrays, best of five,
+ *  counting 24 bytes per element as STREAM does.                      */
+double streamGbps()
+{
+    constexpr long N = 4L << 20;
+    constexpr int CHUNKS = 64;
+    std::unique_ptr<double[]> a(new double[N]), b(new double[N]), c(new double[N]);
+    ThreadPool& pool = ThreadPool::instance();
+    auto each = [&](const std::function<void(long, long)>& fn) {
+        pool.parallelFor(0, CHUNKS, [&](int k) { fn(N * k / CHUNKS, N * (k + 1) / CHUNKS); });
+    };
+    each([&](long lo, long hi) {                          // first touch על החוט שישתמש בזיכרון
+        for (long i = lo; i < hi; ++i) { a[i] = 0; b[i] = 1; c[i] = 2; }
+    });
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        const auto t0 = Clock::now();
+        each([&](long lo, long hi) {
+            for (long i = lo; i < hi; ++i) a[i] = b[i] + 3.0 * c[i];
+        });
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - t0).count());
+    }
+    sink = a[N / 2];
+    return 24.0 * N / best * 1e-9;
+}
+
+/** @brief Arithmetic intensity and percent of the roofline bound; ops
+ *  without FLOPs are judged against bandwidth alone.                  */
+void placeOnRoofline(Result& r, const Op& op, const Machine& m)
+{
+    const double n = r.n;
+    const double flops = op.flops * n * n * (op.cubic ? n : 1);
+    const double bytes = op.bytes * n * n;
+    r.intensity = bytes > 0 ? flops / bytes : 0;
+    if (flops > 0) r.roofPct = 100 * r.gflops / std::min(m.peakGflops, r.intensity * m.streamGbps);
+    else r.roofPct = 100 * r.gbps / m.streamGbps;
+}
+
+/** @brief Which roof limits @p r: "cpu", "mem", or "cache" when a
+ *  memory-bound case beats STREAM because its operands stay in cache. */
+const char* boundBy(const Result& r, const Machine& m)
+{
+    if (r.intensity * m.streamGbps >= m.peakGflops) return "cpu";
+    return r.roofPct > 100 ? "cache" : "mem";
+}
+
+std::string quoted(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + '"';
+}
+
+void writeJson(const std::string& path, const std::vector<Result>& results, const Machine& m)
+{
+    std::ofstream f(path);
+    f << std::setprecision(10);
+    const kernels::GemmConfig cfg = kernels::gemmConfig();
+    f << "{\n  \"schema\": 1,\n  \"cpu\": " << quoted(autotune::cpuModel())
+      << ",\n  \"threads\": " << ThreadPool::instance().size()
+      << ",\n  \"gemm\": {\"mc\": " << cfg.mc << ", \"kc\": " << cfg.kc << ", \"nc\": " << cfg.nc
+      << ", \"threads\": " << cfg.threads << "}";
+    if (m.peakGflops > 0)
+        f << ",\n  \"machine\": {\"peak_gflops\": " << m.peakGflops << ", \"stream_gbps\": " << m.streamGbps << "}";
+    f << ",\n  \"results\": [\n";
+    for (std::size_t k = 0; k < results.size(); ++k) {
+        const Result& r = results[k];
+        f << "    {\"op\": " << quoted(r.op) << ", \"n\": " << r.n << ", \"iters\": " << r.iters
+          << ", \"ns_per_op\": " << r.nsPerOp << ", \"gflops\": " << r.gflops
+          << ", \"gbps\": " << r.gbps << ", \"allocs_per_op\": " << r.allocsPerOp;
+        if (m.peakGflops > 0) f << ", \"intensity\": " << r.intensity << ", \"roofline_pct\": " << r.roofPct;
+        f << ", \"samples_ns\": [";
+        for (std::size_t i = 0; i < r.samples.size(); ++i) f << (i ? ", " : "") << r.samples[i];
+        f << "]}" << (k + 1 < results.size() ? "," : "") << '\n';
+    }
+    f << "  ]\n}\n";
+    if (!f) std::cerr << "bench: cannot write " << path << '\n';
+}
+
+void usage()
+{
+    std::cerr << "usage: bench_runner [--min-n N] [--max-n N] [--ops A*B,A^8,...] [--reps R]\n"
+                 "                    [--rep-seconds S] [--budget S] [--json FILE] [--roofline]\n"
+                 "       bench_runner --tune N [--tune-seconds S] [--tune-cache FILE]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    opt.tune.n = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "--roofline") { opt.roofline = true; continue; }
+        if (i + 1 >= argc) { usage(); return 2; }
+        const char* v = argv[++i];
+        if (a == "--min-n") opt.minN = std::atoi(v);
+        else if (a == "--max-n") opt.maxN = std::atoi(v);
+        else if (a == "--reps") opt.reps = std::max(1, std::atoi(v));
+        else if (a == "--rep-seconds") opt.repSeconds = std::atof(v);
+        else if (a == "--budget") opt.budgetSeconds = std::atof(v);
+        else if (a == "--ops") opt.ops = v;
+        else if (a == "--json") opt.json = v;
+        else if (a == "--tune") opt.tune.n = std::atoi(v);
+        else if (a == "--tune-seconds") opt.tune.budgetSeconds = std::atof(v);
+        else if (a == "--tune-cache") opt.tune.cachePath = v;
+        else { usage(); return 2; }
+    }
+
+    if (opt.tune.n > 0) {
+        const kernels::GemmConfig before = kernels::gemmConfig();
+        std::cout << "Tuning gemm for " << autotune::cpuModel() << " at n = " << opt.tune.n << " ...\n";
+        autotune::TuneResult r{};
+        try {
+            r = autotune::tune(opt.tune);
+        } catch (const std::exception& e) {
+            std::cerr << "bench: " << e.what() << '\n';
+            return 2;
+        }
+        std::cout << std::fixed << std::setprecision(2)
+                  << "before: MC " << before.mc << " KC " << before.kc << " NC " << before.nc
+                  << " threads " << before.threads << "  " << r.baselineGflops << " GFLOP/s\n"
+                  << "after:  MC " << r.config.mc << " KC " << r.config.kc << " NC " << r.config.nc
+                  << " threads " << r.config.threads << "  " << r.gflops << " GFLOP/s (" << r.tried
+                  << " configurations)\nsaved to "
+                  << (opt.tune.cachePath.empty() ? autotune::defaultCachePath() : opt.tune.cachePath) << '\n';
+        return 0;
+    }
+
+    const kernels::GemmConfig cfg = kernels::gemmConfig();
+    std::cout << "SquareMat benchmark – " << autotune::cpuModel() << ", "
+              << ThreadPool::instance().size() << " thread(s)\n"
+              << "gemm: MC " << cfg.mc << " KC " << cfg.kc << " NC " << cfg.nc << " threads " << cfg.threads << "\n\n";
+    Machine machine;
+    if (opt.roofline) {
+        machine.peakGflops = peakGflops();
+        machine.streamGbps = streamGbps();
+        std::cout << std::fixed << std::setprecision(2) << "peak " << machine.peakGflops << " GFLOP/s, STREAM triad "
+                  << machine.streamGbps << " GB/s, ridge at " << machine.peakGflops / machine.streamGbps
+                  << " FLOP/byte\n\n" << std::defaultfloat;
+    }
+    std::cout << std::left << std::setw(6) << "op" << std::right << std::setw(6) << "n"
+              << std::setw(14) << "iters x reps" << std::setw(16) << "ns/op"
+              << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s"
+              << std::setw(11) << "allocs/op";
+    if (opt.roofline) std::cout << std::setw(10) << "FLOP/B" << std::setw(8) << "%roof" << std::setw(7) << "bound";
+    std::cout << '\n';
+
+    std::vector<Result> results;
+    for (const Op& op : operators()) {
+        if (!opt.ops.empty() && ("," + opt.ops + ",").find(std::string(",") + op.name + ",") == std::string::npos)
+            continue;
+        for (int n = std::max(2, opt.minN); n <= std::min(opt.maxN, op.maxN); n *= 2) {
+            Result r = measure(op, n, opt);
+            if (opt.roofline) placeOnRoofline(r, op, machine);
+            results.push_back(r);
+            std::ostringstream reps;
+            reps << r.iters << " x " << r.samples.size();
+            std::cout << std::left << std::setw(6) << r.op << std::right << std::setw(6) << n
+                      << std::setw(14) << reps.str() << std::fixed << std::setprecision(1)
+                      << std::setw(16) << r.nsPerOp << std::setprecision(2);
+            if (r.gflops > 0) std::cout << std::setw(10) << r.gflops;
+            else std::cout << std::setw(10) << "-";
+            std::cout << std::setw(10) << r.gbps << std::setw(11) << r.allocsPerOp;
+            if (opt.roofline)
+                std::cout << std::setw(10) << r.intensity << std::setw(8) << std::setprecision(1) << r.roofPct
+                          << std::setw(7) << boundBy(r, machine);
+            std::cout << '\n' << std::defaultfloat << std::flush;
+        }
+    }
+    writeJson(opt.json, results, machine);
+    std::cout << "\nwrote " << opt.json << '\n';
+    return 0;
+}
@@ -0,0 +1,324 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * bench_compare BASELINE.json CURRENT.json [options]
+ *
+ * Compares two bench_runner result files case by case (operator, n).
+ * A case regresses when its median slows down by more than the
+ * threshold AND a one-sided Mann–Whitney U test over the per-repetition
+ * samples says the slowdown is significant (p ≤ alpha).  Cases with
+ * fewer than three samples on either side are judged on the threshold
+ * alone.  Exit status: 0 = no regression, 1 = regression, 2 = usage or
+ * input error.
+ */
+
+namespace {
+
+/* ====================================================================
+   Minimal JSON reader (enough for bench_runner output)
+   ================================================================= */
+
+struct Json {
+    enum Kind { Null, Bool, Number, String, Array, Object } kind = Null;
+    double number = 0;
+    std::string text;
+    std::vector<Json> items;
+    std::map<std::string, Json> fields;
+
+    const Json& operator[](const std::string& key) const
+    {
+        static const Json none;
+        auto it = fields.find(key);
+        return it == fields.end() ? none : it->second;
+    }
+};
+
+class Parser {
+private:
+    const std::string& s;
+    std::size_t p = 0;
+
+    [[noreturn]] void fail(const char* what) const
+    {
+        throw std::runtime_error(std::string("JSON: ") + what + " at offset " + std::to_string(p));
+    }
+    void blank() { while (p < s.size() && std::isspace(static_cast<unsigned char>(s[p]))) ++p; }
+    void expect(char c)
+    {
+        blank();
+        if (p >= s.size() || s[p] != c) fail("unexpected character");
+        ++p;
+    }
+    bool literal(const char* word)
+    {
+        const std::size_t len = std::char_traits<char>::length(word);
+        if (s.compare(p, len, word) != 0) return false;
+        p += len;
+        return true;
+    }
+    std::string string()
+    {
+        expect('"');
+        std::string out;
+        while (p < s.size() && s[p] != '"') {
+            if (s[p] == '\\' && p + 1 < s.size()) ++p;
+            out += s[p++];
+        }
+        if (p >= s.size()) fail("unterminated string");
+        ++p;
+        return out;
+    }
+
+public:
+    explicit Parser(const std::string& text) : s(text) {}
+
+    Json value()
+    {
+        blank();
+        if (p >= s.size()) fail("unexpected end");
+        Json v;
+        const char c = s[p];
+        if (c == '{') {
+            v.kind = Json::Object;
+            ++p;
+            blank();
+            if (p < s.size() && s[p] == '}') { ++p; return v; }
+            for (;;) {
+                blank();
+                std::string key = string();
+                expect(':');
+                v.fields[key] = value();
+                blank();
+                if (p < s.size() && s[p] == ',') { ++p; continue; }
+                expect('}');
+                return v;
+            }
+        }
+        if (c == '[') {
+            v.kind = Json::Array;
+            ++p;
+            blank();
+            if (p < s.size() && s[p] == ']') { ++p; return v; }
+            for (;;) {
+                v.items.push_back(value());
+                blank();
+                if (p < s.size() && s[p] == ',') { ++p; continue; }
+                expect(']');
+                return v;
+            }
+        }
+        if (c == '"') {
+            v.kind = Json::String;
+            v.text = string();
+            return v;
+        }
+        if (literal("true")) { v.kind = Json::Bool; v.number = 1; return v; }
+        if (literal("false")) { v.kind = Json::Bool; return v; }
+        if (literal("null")) return v;
+
+        const char* begin = s.c_str() + p;
+        char* end = nullptr;
+        v.kind = Json::Number;
+        v.number = std::strtod(begin, &end);
+        if (end == begin) fail("bad value");
+        p += end - begin;
+        return v;
+    }
+};
+
+/* ====================================================================
+   Results and statistics
+   ================================================================= */
+
+struct Case {
+    double median = 0;
+    std::vector<double> samples;
+};
+
+using Key = std::pair<std::string, int>;          // (אופרטור, n)
+
+std::map<Key, Case> load(const std::string& path)
+{
+    std::ifstream f(path);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    std::stringstream buf;
+    buf << f.rdbuf();
+    const std::string text = buf.str();
+    const Json root = Parser(text).value();
+    if (root["results"].kind != Json::Array) throw std::runtime_error(path + ": no \"results\" array");
+
+    std::map<Key, Case> out;
+    for (const Json& r : root["results"].items) {
+        const Json& ns = r["ns_per_op"];
+        if (ns.kind != Json::Number || !(ns.number > 0))
+            throw std::runtime_error(path + ": " + r["op"].text + " n=" +
+                                     std::to_string(static_cast<int>(r["n"].number)) +
+                                     " has no positive ns_per_op");
+        Case c;
+        c.median = ns.number;
+        for (const Json& s : r["samples_ns"].items) c.samples.push_back(s.number);
+        if (c.samples.empty()) c.samples.push_back(c.median);
+        out[{r["op"].text, static_cast<int>(r["n"].number)}] = c;
+    }
+    return out;
+}
+
+/**
+ * One-sided Mann–Whitney U test: p-value for "current samples tend to
+ * be larger (slower) than baseline samples".  Exact when the samples
+ * are small and tie-free (enumerating the U distribution by dynamic
+ * programming), otherwise the normal approximation with tie correction
+ * and continuity correction.
+ */
+double mannWhitneyP(const std::vector<double>& base, const std::vector<double>& cur)
+{
+    const int n1 = static_cast<int>(cur.size()), n2 = static_cast<int>(base.size());
+    std::vector<std::pair<double, int>> all;              // (ערך, 1 = נוכחי)
+    for (double v : cur) all.push_back({v, 1});
+    for (double v : base) all.push_back({v, 0});
+    std::sort(all.begin(), all.end());
+
+    double rankSum = 0, tieTerm = 0;
+    bool ties = false;
+    for (std::size_t i = 0; i < all.size();) {
+        std::size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) ++j;
+        const double rank = 0.5 * (i + 1 + j);            // דירוג ממוצע לקבוצת שוויון
+        const double t = static_cast<double>(j - i);
+        if (t > 1) { ties = true; tieTerm += t * t * t - t; }
+        for (std::size_t k = i; k < j; ++k)
+            if (all[k].second) rankSum += rank;
+        i = j;
+    }
+    const double u = rankSum - 0.5 * n1 * (n1 + 1);        // U של הדגימות הנוכחיות
+
+    if (!ties && n1 + n2 <= 40) {
+        // count[k] = מספר הסידורים עם U = k;  רקורסיה על האיבר הגדול ביותר
+        const int maxU = n1 * n2;
+        std::vector<std::vector<std::vector<double>>> f(n1 + 1, std::vector<std::vector<double>>(n2 + 1));
+        for (int a = 0; a <= n1; ++a)
+            for (int b = 0; b <= n2; ++b) {
+                f[a][b].assign(a * b + 1, 0.0);
+                if (a == 0 || b == 0) { f[a][b][0] = 1; continue; }
+                for (int k = 0; k <= a * b; ++k) {
+                    double c = 0;
+                    if (k - b >= 0 && k - b <= (a - 1) * b) c += f[a - 1][b][k - b];
+                    if (k <= a * (b - 1)) c += f[a][b - 1][k];
+                    f[a][b][k] = c;
+                }
+            }
+        double tail = 0, total = 0;
+        for (int k = 0; k <= maxU; ++k) {
+            total += f[n1][n2][k];
+            if (k >= u - 1e-9) tail += f[n1][n2][k];
+        }
+        return tail / total;
+    }
+
+    const double N = n1 + n2;
+    const double mean = 0.5 * n1 * n2;
+    const double var = n1 * n2 / 12.0 * ((N + 1) - tieTerm / (N * (N - 1)));
+    if (var <= 0) return u > mean ? 0.0 : 1.0;
+    const double z = (u - mean - 0.5) / std::sqrt(var);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+struct Options {
+    double threshold = 0.05;
+    double alpha = 0.05;
+    std::map<std::string, double> perOp;                  // "A*B" או "A*B:4096"
+    std::string ops;
+};
+
+double thresholdFor(const Options& opt, const Key& k)
+{
+    auto it = opt.perOp.find(k.first + ":" + std::to_string(k.second));
+    if (it != opt.perOp.end()) return it->second;
+    it = opt.perOp.find(k.first);
+    return it != opt.perOp.end() ? it->second : opt.threshold;
+}
+
+void usage()
+{
+    std::cerr << "usage: bench_compare BASELINE.json CURRENT.json [--threshold F] [--alpha P]\n"
+                 "                     [--threshold-for OP[:N]=F ...] [--ops OP,OP,...]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) { usage(); return 2; }
+    Options opt;
+    for (int i = 3; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (i + 1 >= argc) { usage(); return 2; }
+        const std::string v = argv[++i];
+        if (a == "--threshold") opt.threshold = std::atof(v.c_str());
+        else if (a == "--alpha") opt.alpha = std::atof(v.c_str());
+        else if (a == "--ops") opt.ops = v;
+        else if (a == "--threshold-for") {
+            const std::size_t eq = v.rfind('=');
+            if (eq == std::string::npos) { usage(); return 2; }
+            opt.perOp[v.substr(0, eq)] = std::atof(v.c_str() + eq + 1);
+        } else { usage(); return 2; }
+    }
+
+    std::map<Key, Case> base, cur;
+    try {
+        base = load(argv[1]);
+        cur = load(argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << "bench_compare: " << e.what() << '\n';
+        return 2;
+    }
+
+    std::cout << std::left << std::setw(6) << "op" << std::right << std::setw(6) << "n"
+              << std::setw(16) << "base ns/op" << std::setw(16) << "cur ns/op"
+              << std::setw(9) << "change" << std::setw(9) << "p" << "  verdict\n";
+    int regressions = 0, compared = 0;
+    for (const auto& [key, c] : cur) {
+        if (!opt.ops.empty() && ("," + opt.ops + ",").find("," + key.first + ",") == std::string::npos)
+            continue;
+        auto it = base.find(key);
+        if (it == base.end()) continue;
+        const Case& b = it->second;
+        const double change = c.median / b.median - 1;
+        const double limit = thresholdFor(opt, key);
+        const bool enough = b.samples.size() >= 3 && c.samples.size() >= 3;
+        const double p = enough ? mannWhitneyP(b.samples, c.samples) : -1;
+
+        const char* verdict = "ok";
+        if (change > limit && (!enough || p <= opt.alpha)) { verdict = "REGRESSION"; ++regressions; }
+        else if (change > limit) verdict = "noise";
+        else if (change < -limit && (!enough || mannWhitneyP(c.samples, b.samples) <= opt.alpha)) verdict = "faster";
+        ++compared;
+
+        std::cout << std::left << std::setw(6) << key.first << std::right << std::setw(6) << key.second
+                  << std::fixed << std::setprecision(1) << std::setw(16) << b.median << std::setw(16) << c.median
+                  << std::showpos << std::setw(8) << change * 100 << '%' << std::noshowpos
+                  << std::setprecision(3) << std::setw(9);
+        if (enough) std::cout << p;
+        else std::cout << "-";
+        std::cout << "  " << verdict << (enough ? "" : " (few samples)") << '\n' << std::defaultfloat;
+    }
+    for (const auto& [key, b] : base)
+        if (!cur.count(key) && (opt.ops.empty() || ("," + opt.ops + ",").find("," + key.first + ",") != std::string::npos))
+            std::cout << key.first << " n=" << key.second << ": missing from current run\n";
+
+    std::cout << '\n' << compared << " case(s) compared, " << regressions << " regression(s)\n";
+    return regressions ? 1 : 0;
+}
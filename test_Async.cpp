@@ -0,0 +1,86 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Async.hpp"
+#include "LU.hpp"
+#include "test_helpers.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <vector>
+using namespace matrix;
+using test::maxDiff;
+
+namespace {
+
+/** @brief Diagonally dominant, so the LU-based tasks stay well conditioned. */
+SquareMat sample(int n, double shift = 0.0) { return test::sample(n, shift, n); }
+
+} // namespace
+
+TEST_CASE("Async results match the blocking operators") {
+    const SquareMat A = sample(160), B = sample(160, 1.0);
+    Task<SquareMat> prod = multiplyAsync(A, B);
+    Task<SquareMat> power = powAsync(A * (1.0 / 160), 5);
+    Task<double> det = detAsync(sample(3));
+    Task<double> detBig = detAsync(A * (1.0 / 160));
+    Task<SquareMat> sol = solveAsync(A, B);
+
+    CHECK(maxDiff(prod.get(), A * B) < 1e-9);
+    CHECK(maxDiff(power.get(), (A * (1.0 / 160)) ^ 5) < 1e-12);
+    CHECK(det.get() == doctest::Approx(!sample(3)));
+    CHECK(detBig.get() == doctest::Approx(LU(A * (1.0 / 160)).determinant()));
+    CHECK(maxDiff(A * sol.get(), B) < 1e-9);
+    CHECK(prod.progress() == 1.0);
+}
+
+TEST_CASE("Operands are copied at submission") {
+    SquareMat A = sample(120), B = sample(120, 2.0);
+    const SquareMat expected = A * B;
+    Task<SquareMat> t = multiplyAsync(A, B);
+    A = SquareMat(120, 0.0);
+    B(0, 0) = 1e9;
+    CHECK(maxDiff(t.get(), expected) < 1e-9);
+}
+
+TEST_CASE("Progress callbacks rise monotonically to 1") {
+    std::mutex m;
+    std::vector<double> seen;
+    Task<SquareMat> t = powAsync(sample(256) * (1.0 / 256), 6, [&](double f) {
+        std::lock_guard<std::mutex> lock(m);
+        seen.push_back(f);
+    });
+    CHECK(t.waitFor(std::chrono::seconds(60)));
+    CHECK(t.ready());
+    t.get();
+    REQUIRE(seen.size() >= 2);
+    for (std::size_t k = 1; k < seen.size(); ++k) CHECK(seen[k] > seen[k - 1]);
+    CHECK(seen.back() == 1.0);
+}
+
+TEST_CASE("Cancellation stops a running or queued job") {
+    std::atomic<Task<SquareMat>*> self{nullptr};
+    Task<SquareMat> running = powAsync(sample(400) * (1.0 / 400), 8, [&](double) {
+        if (Task<SquareMat>* t = self.load()) t->cancel();
+    });
+    self = &running;
+    Task<double> queued = detAsync(sample(400));
+    queued.cancel();
+
+    CHECK_THROWS_AS(running.get(), OperationCancelled);
+    CHECK(running.progress() < 1.0);
+    CHECK_THROWS_AS(queued.get(), OperationCancelled);
+
+    // the driver keeps serving after a cancelled job
+    CHECK(detAsync(sample(2)).get() == doctest::Approx(!sample(2)));
+}
+
+TEST_CASE("Errors surface at submission or from get()") {
+    CHECK_THROWS_AS(multiplyAsync(SquareMat(3), SquareMat(4)), std::invalid_argument);
+    CHECK_THROWS_AS(solveAsync(SquareMat(3), SquareMat(4)), std::invalid_argument);
+    CHECK_THROWS_AS(powAsync(SquareMat(3), -1), std::invalid_argument);
+
+    Task<SquareMat> singular = solveAsync(SquareMat(80, 1.0), sample(80));
+    CHECK_THROWS_AS(singular.get(), std::domain_error);
+    CHECK(detAsync(SquareMat(80, 1.0)).get() == 0.0);
+}
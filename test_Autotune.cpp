@@ -0,0 +1,153 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Autotune.hpp"
+#include "SquareMat.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+using namespace matrix;
+using kernels::GemmConfig;
+
+namespace {
+
+std::string slurp(const std::string& path)
+{
+    std::ifstream f(path);
+    std::stringstream s;
+    s << f.rdbuf();
+    return s.str();
+}
+
+bool same(const GemmConfig& a, const GemmConfig& b)
+{
+    return a.mc == b.mc && a.kc == b.kc && a.nc == b.nc && a.threads == b.threads;
+}
+
+/** Restores the process-wide configuration after each test. */
+struct Restore {
+    GemmConfig saved = kernels::gemmConfig();
+    ~Restore() { kernels::setGemmConfig(saved); }
+};
+
+} // namespace
+
+TEST_CASE("Cache round-trip for this CPU model") {
+    Restore restore;
+    const std::string path = "test_tune.cache";
+    const GemmConfig tuned{64, 128, 1024, 1};
+    autotune::saveCache(tuned, 12.5, path);
+
+    kernels::setGemmConfig(GemmConfig{96, 256, 4096, 0});
+    CHECK(autotune::loadCache(path));
+    CHECK(same(kernels::gemmConfig(), tuned));
+
+    CHECK_FALSE(autotune::loadCache("no_such_tune.cache"));
+    CHECK_FALSE(autotune::loadCache(""));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Saving replaces this model's entry and keeps other models") {
+    Restore restore;
+    const std::string path = "test_tune_fleet.cache";
+    const std::string model = autotune::cpuModel();
+    {
+        std::ofstream f(path);
+        f << "Other CPU\t4 8 48 192 2048 4 20\n"
+          << model << "\t4 8 32 64 512 1 1\n";
+    }
+    autotune::saveCache(GemmConfig{128, 384, 8192, 0}, 3.5, path);
+    const std::string text = slurp(path);
+    CHECK(text.find("Other CPU\t4 8 48 192 2048 4 20\n") != std::string::npos);
+    CHECK(text.find(model + "\t4 8 32 64") == std::string::npos);
+    CHECK(text.find(model + "\t" + std::to_string(kernels::MR) + " " + std::to_string(kernels::NR) +
+                    " 128 384 8192 0") != std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Entries for another micro-kernel shape or malformed lines are ignored") {
+    Restore restore;
+    const std::string path = "test_tune_shape.cache";
+    {
+        std::ofstream f(path);
+        f << autotune::cpuModel() << '\t' << kernels::MR * 2 << ' ' << kernels::NR << " 64 64 64 0 1\n"
+          << autotune::cpuModel() << "\tgarbage\n";
+    }
+    const GemmConfig before = kernels::gemmConfig();
+    CHECK_FALSE(autotune::loadCache(path));
+    CHECK(same(kernels::gemmConfig(), before));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("The cache is keyed by CPU model and corrupt entries are rejected") {
+    Restore restore;
+    const std::string path = "test_tune_corrupt.cache";
+    const std::string model = autotune::cpuModel();
+    const std::string shape = std::to_string(kernels::MR) + " " + std::to_string(kernels::NR);
+    const GemmConfig before{96, 256, 4096, 0};
+    kernels::setGemmConfig(before);
+    {
+        std::ofstream f(path);
+        f << "Other CPU\t" << shape << " 32 64 512 1 9\n"              // מעבד אחר
+          << model << "X\t" << shape << " 32 64 512 1 9\n"             // קידומת של המודל אינה התאמה
+          << model << "\t" << shape << " 32 64\n"                      // שורה קטועה
+          << model << "\t" << shape << " -32 64 512 1 9\n"             // בלוק שלילי
+          << model << "\t" << shape << " 32 0 512 1 9\n"
+          << model << "\t" << shape << " 32 64 512 -1 9\n";
+    }
+    CHECK_FALSE(autotune::loadCache(path));
+    CHECK(same(kernels::gemmConfig(), before));
+
+    std::ofstream(path, std::ios::app) << model << "\t" << shape << " 48 192 2048 2 7\n";
+    CHECK(autotune::loadCache(path));
+    CHECK(same(kernels::gemmConfig(), GemmConfig{48, 192, 2048, 2}));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Measuring a candidate leaves the active configuration alone") {
+    Restore restore;
+    const GemmConfig active{96, 256, 4096, 0};
+    kernels::setGemmConfig(active);
+    CHECK(autotune::measure(GemmConfig{32, 64, 512, 1}, 96) > 0);
+    CHECK(same(kernels::gemmConfig(), active));
+}
+
+TEST_CASE("A short tuning run installs and caches a correct configuration") {
+    Restore restore;
+    const std::string path = "test_tune_run.cache";
+    autotune::TuneOptions opt;
+    opt.n = 96;
+    opt.budgetSeconds = 1.5;
+    opt.passes = 1;
+    opt.cachePath = path;
+    const autotune::TuneResult r = autotune::tune(opt);
+
+    CHECK(r.tried >= 1);
+    CHECK(same(kernels::gemmConfig(), r.config));
+    CHECK(slurp(path).find(autotune::cpuModel() + "\t") != std::string::npos);
+
+    kernels::setGemmConfig(GemmConfig{96, 256, 4096, 0});
+    CHECK(autotune::loadCache(path));
+    CHECK(same(kernels::gemmConfig(), r.config));
+
+    const int n = 150;
+    SquareMat A(n), B(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            A(i, j) = std::sin(i + 2.0 * j);
+            B(i, j) = std::cos(3.0 * i - j);
+        }
+    const SquareMat C = A * B;
+    double err = 0;
+    for (int i = 0; i < n; i += 7)
+        for (int j = 0; j < n; j += 5) {
+            double s = 0;
+            for (int p = 0; p < n; ++p) s += A(i, p) * B(p, j);
+            err = std::fmax(err, std::fabs(C(i, j) - s));
+        }
+    CHECK(err < 1e-10);
+
+    CHECK_THROWS_AS(autotune::tune(autotune::TuneOptions{8, 1, 1, false, ""}), std::invalid_argument);
+    std::remove(path.c_str());
+}
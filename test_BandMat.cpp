@@ -0,0 +1,88 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "BandMat.hpp"
+#include "LU.hpp"
+using namespace matrix;
+
+namespace {
+
+/** @brief 1-D Laplacian [-1 2 -1] plus a skewed second super-diagonal. */
+BandMat makeBand(int n)
+{
+    BandMat A(n, 1, 2);
+    for (int i = 0; i < n; ++i) {
+        A(i, i) = 2;
+        if (i > 0) A(i, i - 1) = -1;
+        if (i + 1 < n) A(i, i + 1) = -1;
+        if (i + 2 < n) A(i, i + 2) = 0.25 * (i % 3);
+    }
+    return A;
+}
+
+} // namespace
+
+TEST_CASE("BandMat storage and conversion") {
+    BandMat A = makeBand(6);
+    CHECK(A.lower() == 1);
+    CHECK(A.upper() == 2);
+    const BandMat& c = A;
+    CHECK(c(5, 0) == 0);
+    CHECK_THROWS_AS(A(5, 0) = 1, std::out_of_range);
+
+    SquareMat D = A.toSquareMat();
+    CHECK(D(2, 4) == doctest::Approx(0.5));
+    BandMat B(D, 1, 1);                       // חותך את העל-אלכסון השני
+    CHECK(B(0, 1) == -1);
+    const BandMat& cb = B;
+    CHECK(cb(2, 4) == 0);
+
+    BandMat T = ~A;
+    CHECK(T.lower() == 2);
+    CHECK(T(4, 2) == doctest::Approx(0.5));
+}
+
+TEST_CASE("BandMat products, power and determinant") {
+    const int n = 40;
+    BandMat A = makeBand(n);
+    SquareMat Ad = A.toSquareMat();
+    SquareMat Dense(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) Dense(i, j) = (i * 3 + j) % 7;
+
+    SquareMat P = A * Dense, Pref = Ad * Dense;
+    SquareMat Q = (A * ~A).toSquareMat(), Qref = Ad * ~Ad;
+    BandMat A3 = A ^ 3;
+    SquareMat R = A3.toSquareMat(), Rref = Ad ^ 3;
+    CHECK(A3.lower() == 3);
+    CHECK(A3.upper() == 6);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            CHECK(P(i, j) == doctest::Approx(Pref(i, j)));
+            CHECK(Q(i, j) == doctest::Approx(Qref(i, j)));
+            CHECK(R(i, j) == doctest::Approx(Rref(i, j)));
+        }
+
+    CHECK(!A == doctest::Approx(LU(Ad).determinant()));
+    CHECK((A + ~A)(1, 3) == doctest::Approx(0.25));
+}
+
+TEST_CASE("BandMat solve") {
+    const int n = 50;
+    BandMat A = makeBand(n);
+    double x[n], b[n];
+    for (int i = 0; i < n; ++i) x[i] = i % 5 - 2;
+    A.multiply(x, b);
+    A.solveInPlace(b);
+    for (int i = 0; i < n; ++i) CHECK(b[i] == doctest::Approx(x[i]));
+
+    SquareMat I(n, 0.0);
+    for (int i = 0; i < n; ++i) I(i, i) = 1;
+    SquareMat P = A * A.solve(I);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            CHECK(P(i, j) == doctest::Approx(I(i, j)).epsilon(1e-9));
+
+    BandMat Z(3, 1, 1, 0.0);
+    CHECK(!Z == 0);
+    CHECK_THROWS_AS(Z.solveInPlace(x), std::domain_error);
+}
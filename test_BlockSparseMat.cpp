@@ -0,0 +1,69 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "BlockSparseMat.hpp"
+using namespace matrix;
+
+namespace {
+
+/** @brief Dense blocks on the block diagonal and one off-diagonal. */
+SquareMat makeBlocky(int n, int b)
+{
+    SquareMat A(n, 0.0);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            const int I = i / b, J = j / b;
+            if (I == J || J == (I * 3 + 1) % ((n + b - 1) / b))
+                A(i, j) = (i * 5 + j * 3) % 7 - 3;
+        }
+    return A;
+}
+
+template <int B>
+void checkProducts(int n)
+{
+    SquareMat D = makeBlocky(n, B), E = ~makeBlocky(n, B);
+    BlockSparseMat<B> A(D), C(E);
+    CHECK(A.nonZeroBlocks() <= 2L * A.blockRows());
+
+    SquareMat back = A.toSquareMat();
+    SquareMat P = A * E, Pref = D * E;
+    SquareMat Q = (A * C).toSquareMat();
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            CHECK(back(i, j) == D(i, j));
+            CHECK(A(i, j) == D(i, j));
+            CHECK(P(i, j) == Pref(i, j));
+            CHECK(Q(i, j) == Pref(i, j));
+        }
+
+    double* x = new double[n];
+    double* y = new double[n];
+    for (int i = 0; i < n; ++i) x[i] = i % 4 - 1.5;
+    A.multiply(x, y);
+    for (int i = 0; i < n; ++i) {
+        double expect = 0;
+        for (int j = 0; j < n; ++j) expect += D(i, j) * x[j];
+        CHECK(y[i] == doctest::Approx(expect));
+    }
+    delete[] x;
+    delete[] y;
+}
+
+} // namespace
+
+TEST_CASE("BlockSparseMat with 8×8 blocks") {
+    checkProducts<8>(64);
+    checkProducts<8>(75);                     // בלוק אחרון חלקי
+}
+
+TEST_CASE("BlockSparseMat with 16×16 blocks") {
+    checkProducts<16>(96);
+    checkProducts<16>(50);
+
+    BlockSparseMat<16> Z(40);
+    CHECK(Z.nonZeroBlocks() == 0);
+    CHECK(Z(39, 0) == 0);
+    BlockSparseMat<16> copy = Z;
+    copy = BlockSparseMat<16>(makeBlocky(40, 16));
+    CHECK(copy.nonZeroBlocks() > 0);
+}
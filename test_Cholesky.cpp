@@ -0,0 +1,134 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Cholesky.hpp"
+#include "LU.hpp"
+#include "ThreadPool.hpp"
+#include <cmath>
+#include <set>
+#include <thread>
+using namespace matrix;
+
+namespace {
+
+/** @brief A·Aᵀ + n·I – symmetric positive definite. */
+SquareMat makeSPD(int n)
+{
+    SquareMat A(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            A(i, j) = ((i * 13 + j * 7) % 17) / 17.0 - 0.5;
+    SquareMat S = A * ~A;
+    for (int i = 0; i < n; ++i) S(i, i) += n;
+    return S;
+}
+
+SquareMat identity(int n)
+{
+    SquareMat I(n, 0.0);
+    for (int i = 0; i < n; ++i) I(i, i) = 1;
+    return I;
+}
+
+} // namespace
+
+TEST_CASE("LU determinant and solve") {
+    SquareMat C(3);
+    C(0,0)=6; C(0,1)=1; C(0,2)=1;
+    C(1,0)=4; C(1,1)=-2; C(1,2)=5;
+    C(2,0)=2; C(2,1)=8; C(2,2)=7;
+
+    LU lu(C);
+    CHECK_FALSE(lu.isSingular());
+    CHECK(lu.determinant() == doctest::Approx(-306));
+
+    double b[3] = {8, 7, 17};               // C · (1,1,1)
+    lu.solveInPlace(b);
+    for (double x : b) CHECK(x == doctest::Approx(1));
+
+    SquareMat S(2, 1.0);                     // דרגה 1
+    LU sing(S);
+    CHECK(sing.isSingular());
+    CHECK(sing.determinant() == 0);
+    CHECK_THROWS_AS(sing.solve(identity(2)), std::domain_error);
+}
+
+TEST_CASE("LU inverse on a blocked size") {
+    const int n = 150;                        // כמה פאנלים של 64
+    SquareMat A = makeSPD(n);
+    A(0, n - 1) += 3;                         // לא סימטרית
+    SquareMat P = A * LU(A).inverse();
+    SquareMat I = identity(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            CHECK(P(i, j) == doctest::Approx(I(i, j)).epsilon(1e-9));
+}
+
+TEST_CASE("Cholesky factor, determinant and solve") {
+    SquareMat A(2);
+    A(0,0)=4; A(0,1)=2;
+    A(1,0)=2; A(1,1)=3;
+
+    Cholesky c(A);
+    REQUIRE(c.isSPD());
+    CHECK(c.factor()(0,0) == doctest::Approx(2));
+    CHECK(c.factor()(1,0) == doctest::Approx(1));
+    CHECK(c.factor()(0,1) == 0);
+    CHECK(c.determinant() == doctest::Approx(8));
+
+    double b[2] = {6, 5};                     // A · (1,1)
+    c.solveInPlace(b);
+    CHECK(b[0] == doctest::Approx(1));
+    CHECK(b[1] == doctest::Approx(1));
+}
+
+TEST_CASE("Blocked Cholesky matches LU") {
+    const int n = 200;
+    SquareMat A = makeSPD(n);
+    Cholesky c(A);
+    REQUIRE(c.isSPD());
+
+    SquareMat R = c.factor() * ~c.factor() - A;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            CHECK(R(i, j) == doctest::Approx(0).epsilon(1e-9).scale(n));
+
+    LU lu(A);
+    double logDet = 0;
+    for (int i = 0; i < n; ++i) logDet += std::log(std::fabs(lu.factors()(i, i)));
+    CHECK(c.logDeterminant() == doctest::Approx(logDet));
+
+    SquareMat P = A * c.inverse();
+    for (int i = 0; i < n; ++i)
+        CHECK(P(i, i) == doctest::Approx(1).epsilon(1e-9));
+}
+
+TEST_CASE("Non-SPD input falls back to LU") {
+    SquareMat A(2);
+    A(0,0)=1; A(0,1)=2;
+    A(1,0)=2; A(1,1)=1;                       // סימטרית, לא מוגדרת חיובית
+    CHECK_FALSE(Cholesky(A).isSPD());
+    CHECK_THROWS_AS(Cholesky(A).determinant(), std::domain_error);
+    CHECK(spdDeterminant(A) == doctest::Approx(-3));
+
+    SquareMat B(2);
+    B(0,0)=2; B(0,1)=1;
+    B(1,0)=0; B(1,1)=2;                       // לא סימטרית
+    CHECK_FALSE(Cholesky(B).isSPD());
+    SquareMat X = spdSolve(B, identity(2));
+    CHECK(X(0,0) == doctest::Approx(0.5));
+    CHECK(X(0,1) == doctest::Approx(-0.25));
+
+    SquareMat I = spdInverse(makeSPD(5)) * makeSPD(5);
+    CHECK(I(3,3) == doctest::Approx(1));
+}
+
+TEST_CASE("A single-item parallel loop can start a nested loop on the pool") {
+    ThreadPool pool(3);
+    std::set<std::thread::id> ids;
+    pool.parallelFor(0, 1, [&](int) {
+        std::thread::id seen[3];
+        pool.parallelForStatic(0, 3, [&](int i) { seen[i] = std::this_thread::get_id(); });
+        ids.insert(seen, seen + 3);
+    });
+    CHECK(ids.size() == 3);                                  // הלולאה הפנימית לא רצה inline
+}
@@ -0,0 +1,48 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Expm.hpp"
+#include <cmath>
+using namespace matrix;
+
+TEST_CASE("expm of diagonal and nilpotent matrices") {
+    for (double scale : {1e-3, 0.2, 0.9, 2.0, 40.0}) {   // כל דרגות Padé + סקיילינג
+        SquareMat D(3, 0.0);
+        D(0,0) = scale; D(1,1) = -scale; D(2,2) = 0.5 * scale;
+        SquareMat E = expm(D);
+        CHECK(E(0,0) == doctest::Approx(std::exp(scale)));
+        CHECK(E(1,1) == doctest::Approx(std::exp(-scale)));
+        CHECK(E(2,2) == doctest::Approx(std::exp(0.5 * scale)));
+        CHECK(E(0,1) == doctest::Approx(0).scale(1));
+    }
+
+    SquareMat N(3, 0.0);                      // e^N = I + N + N²/2
+    N(0,1) = 3; N(1,2) = 4;
+    SquareMat E = expm(N);
+    CHECK(E(0,0) == doctest::Approx(1));
+    CHECK(E(0,1) == doctest::Approx(3));
+    CHECK(E(0,2) == doctest::Approx(6));
+    CHECK(E(1,2) == doctest::Approx(4));
+    CHECK(E(2,0) == doctest::Approx(0).scale(1));
+}
+
+TEST_CASE("expm of a rotation generator") {
+    const double t = 10.0;
+    SquareMat G(2, 0.0);
+    G(0,1) = -t; G(1,0) = t;
+    SquareMat R = expm(G);
+    CHECK(R(0,0) == doctest::Approx(std::cos(t)));
+    CHECK(R(0,1) == doctest::Approx(-std::sin(t)));
+    CHECK(R(1,0) == doctest::Approx(std::sin(t)));
+    CHECK(R(1,1) == doctest::Approx(std::cos(t)));
+}
+
+TEST_CASE("expm(A) · expm(-A) = I") {
+    const int n = 80;
+    SquareMat A(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) A(i, j) = ((i * 5 + j * 11) % 13 - 6) / 10.0;
+    SquareMat P = expm(A) * expm(-A);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            CHECK(P(i, j) == doctest::Approx(i == j ? 1.0 : 0.0).scale(1).epsilon(1e-8));
+}
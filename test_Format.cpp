@@ -0,0 +1,65 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Format.hpp"
+#include "ThreadPool.hpp"
+#include <sstream>
+#include <string>
+using namespace matrix;
+
+TEST_CASE("operator<< layout and round-trip values") {
+    SquareMat A(2, 0.0);
+    A(0,0) = 3; A(0,1) = -1.5; A(1,0) = 0.1; A(1,1) = 1e-20;
+    std::ostringstream os;
+    os << A;
+    CHECK(os.str() == "[ 3 -1.5 ]\n[ 0.1 1e-20 ]\n");
+
+    SquareMat B(3);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) B(i, j) = 1.0 / (i + 2 * j + 3);
+    std::istringstream in(formatMatrix(B));
+    for (int i = 0; i < 3; ++i) {
+        std::string bracket;
+        in >> bracket;
+        for (int j = 0; j < 3; ++j) {
+            double v;
+            in >> v;
+            CHECK(v == B(i, j));                          // שחזור מדויק
+        }
+        in >> bracket;
+    }
+}
+
+TEST_CASE("Custom precision and separators") {
+    SquareMat A(2, 0.0);
+    A(0,0) = 1.0 / 3; A(0,1) = 2; A(1,0) = -0.25; A(1,1) = 1234.5;
+    FormatOptions csv;
+    csv.precision = 3;
+    csv.open = "";
+    csv.separator = ",";
+    csv.close = "\n";
+    CHECK(formatMatrix(A, csv) == "0.333,2\n-0.25,1.23e+03\n");
+
+    FormatOptions fixed;
+    fixed.precision = 2;
+    fixed.style = std::chars_format::fixed;
+    CHECK(formatMatrix(A, fixed) == "[ 0.33 2.00 ]\n[ -0.25 1234.50 ]\n");
+}
+
+TEST_CASE("Parallel formatting matches serial output") {
+    const int n = 150;
+    SquareMat M(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) M(i, j) = (i - j) * 0.37 + 1.0 / (1 + i * j);
+
+    ThreadPool& pool = ThreadPool::instance();
+    const int before = pool.size();
+    pool.resize(4);
+    FormatOptions serial;
+    serial.parallel = false;
+    const std::string s = formatMatrix(M, serial);
+    CHECK(formatMatrix(M) == s);
+    std::ostringstream os;
+    os << M;
+    CHECK(os.str() == s);
+    pool.resize(before);
+}
@@ -0,0 +1,147 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Graph.hpp"
+#include "ThreadPool.hpp"
+#include "test_helpers.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+using namespace matrix;
+using test::maxDiff;
+
+namespace {
+
+/** @brief Scaled by 1/n so chains of products stay bounded. */
+SquareMat sample(int n, double shift) { return test::sample(n, shift) * (1.0 / n); }
+
+/** Resizes the global pool for one test and restores it afterwards. */
+struct PoolSize {
+    int saved = ThreadPool::instance().size();
+    explicit PoolSize(int threads) { ThreadPool::instance().resize(threads); }
+    ~PoolSize() { ThreadPool::instance().resize(saved); }
+};
+
+} // namespace
+
+TEST_CASE("A DAG evaluates to the sequential result and runs independent nodes together") {
+    PoolSize threads(4);
+    const SquareMat A = sample(120, 0), B = sample(120, 1), C = sample(120, 2), D = sample(120, 3);
+    graph::Graph g;
+    const graph::Value X = g.input(A) * g.input(B);
+    const graph::Value Y = g.input(C) * g.input(D);
+    const graph::Value W = (X + Y) ^ 8;
+
+    const SquareMat expected = ((A * B) + (C * D)) ^ 8;
+    CHECK(maxDiff(g.run(W), expected) < 1e-12);
+    CHECK(g.stats().computed == 4);
+    CHECK(g.stats().widest == 2);                           // X ו-Y יחד
+    CHECK(g.size() == 8);
+
+    CHECK(maxDiff(g.run(W), expected) < 1e-12);             // הרצה חוזרת
+}
+
+TEST_CASE("Shared subexpressions run once and several targets come back in order") {
+    PoolSize threads(2);
+    const SquareMat A = sample(40, 0);
+    std::atomic<int> calls{0};
+    graph::Graph g;
+    const graph::Value a = g.input(A);
+    const graph::Value T = g.apply([&](const std::vector<const SquareMat*>& x) {
+        ++calls;
+        return ~*x[0];
+    }, {a}, "count");
+    const graph::Value P = T * a, Q = a * T, R = P - Q;
+
+    const std::vector<SquareMat> out = g.run({R, T, P});
+    CHECK(calls == 1);
+    REQUIRE(out.size() == 3);
+    CHECK(maxDiff(out[1], ~A) == 0);
+    CHECK(maxDiff(out[2], ~A * A) < 1e-14);
+    CHECK(maxDiff(out[0], ~A * A - A * ~A) < 1e-14);
+    CHECK(g.stats().widest == 2);                           // P ו-Q
+}
+
+TEST_CASE("Intermediate buffers are freed after their last consumer") {
+    const int n = 64;
+    const SquareMat A = sample(n, 0);
+    graph::Graph g;
+    graph::Value v = g.input(A);
+    for (int k = 0; k < 12; ++k) v = v * 1.5;
+
+    const SquareMat out = g.run(v);
+    CHECK(out(3, 5) == doctest::Approx(A(3, 5) * std::pow(1.5, 12)));
+    CHECK(g.stats().computed == 12);
+    CHECK(g.stats().peakBytes == 2 * 8ULL * n * n);         // תוצאה חדשה לצד קודמתה, ואז זו משוחררת
+}
+
+TEST_CASE("Errors propagate to dependent targets") {
+    const SquareMat A = sample(3, 0), B = sample(4, 0);
+    graph::Graph g;
+    const graph::Value bad = g.input(A) * g.input(B);
+    const graph::Value after = bad + bad;
+    const graph::Value fine = g.input(A) ^ 2;
+    CHECK_THROWS_AS(g.run(after), std::invalid_argument);
+    CHECK(maxDiff(g.run(fine), A * A) < 1e-15);
+
+    graph::Graph other;
+    const graph::Value foreign = other.input(A);
+    CHECK_THROWS_AS(g.input(A) + foreign, std::invalid_argument);
+    CHECK_THROWS_AS(g.run(graph::Value()), std::invalid_argument);
+    CHECK_THROWS_AS(g.input(A) ^ -1, std::invalid_argument);
+    CHECK_THROWS_AS(g.apply(graph::Graph::Fn(), {}), std::invalid_argument);
+}
+
+TEST_CASE("Independent nodes run concurrently on a multi-threaded pool") {
+    PoolSize threads(3);
+    const SquareMat A = sample(96, 0);
+    graph::Graph g;
+    const graph::Value a = g.input(A);
+    std::vector<graph::Value> parts;
+    for (int k = 1; k <= 6; ++k) parts.push_back(a ^ k);
+    graph::Value sum = parts[0];
+    for (int k = 1; k < 6; ++k) sum = sum + parts[k];
+
+    SquareMat expected = A;
+    for (int k = 2; k <= 6; ++k) expected += A ^ k;
+    CHECK(maxDiff(g.run(sum), expected) < 1e-12);
+    CHECK(g.stats().widest == 3);                           // 6 מוכנים, 3 חוטים
+}
+
+TEST_CASE("Two independent nodes overlap in time, each with half the pool") {
+    PoolSize threads(4);
+    using Clock = std::chrono::steady_clock;
+    const SquareMat A = sample(8, 0);
+    std::mutex mtx;
+    std::vector<std::set<std::thread::id>> seen(2);
+    std::vector<Clock::time_point> from(2), to(2);
+    auto node = [&](int which) {
+        return [&, which](const std::vector<const SquareMat*>& x) {
+            from[which] = Clock::now();
+            ThreadPool::instance().parallelForStatic(0, 4, [&](int) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                std::lock_guard<std::mutex> lock(mtx);
+                seen[which].insert(std::this_thread::get_id());
+            });
+            to[which] = Clock::now();
+            return *x[0];
+        };
+    };
+    graph::Graph g;
+    const graph::Value a = g.input(A);
+    const graph::Value u = g.apply(node(0), {a}), w = g.apply(node(1), {a});
+    g.run({u, w});
+
+    CHECK(g.stats().widest == 2);
+    CHECK(from[0] < to[1]);                                 // הקטעים חופפים
+    CHECK(from[1] < to[0]);
+    CHECK(seen[0].size() == 2);                             // צוות של 4/2 חוטים לכל צומת
+    CHECK(seen[1].size() == 2);
+    std::set<std::thread::id> all(seen[0]);
+    all.insert(seen[1].begin(), seen[1].end());
+    CHECK(all.size() == 4);
+}
@@ -0,0 +1,103 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Instrument.hpp"
+#include "SquareMat.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+using namespace matrix;
+namespace in = matrix::instrument;
+
+TEST_CASE("Scope counts calls with their FLOP and byte model") {
+    in::reset();
+    {
+        in::Scope s(in::Op::Hadamard, 100, 800);
+    }
+    {
+        in::Scope s(in::Op::Hadamard, 50, 400);
+    }
+    const in::Snapshot snap = in::snapshot();
+    CHECK(snap[in::Op::Hadamard].calls == 2);
+    CHECK(snap[in::Op::Hadamard].flops == 150);
+    CHECK(snap[in::Op::Hadamard].bytes == 1200);
+    CHECK(snap[in::Op::Add].calls == 0);
+}
+
+TEST_CASE("Nested scopes of the same operator count once") {
+    in::reset();
+    {
+        in::Scope outer(in::Op::Multiply, 10, 1);
+        in::Scope inner(in::Op::Multiply, 10, 1);
+        in::Scope other(in::Op::Copy, 0, 5);
+    }
+    const in::Snapshot snap = in::snapshot();
+    CHECK(snap[in::Op::Multiply].calls == 1);
+    CHECK(snap[in::Op::Multiply].flops == 10);
+    CHECK(snap[in::Op::Copy].calls == 1);
+}
+
+TEST_CASE("Allocations, reset and other threads") {
+    in::reset();
+    in::recordAlloc(4096);
+    std::thread t([] {
+        in::recordAlloc(1024);
+        in::record(in::Op::Add, 7, 8, 9);
+    });
+    t.join();
+
+    in::Snapshot snap = in::snapshot();
+    CHECK(snap[in::Op::Allocate].calls == 2);
+    CHECK(snap[in::Op::Allocate].allocBytes == 5120);
+    CHECK(snap[in::Op::Add].nanoseconds == 9);
+
+    in::reset();
+    snap = in::snapshot();
+    CHECK(snap[in::Op::Allocate].calls == 0);
+    CHECK(snap[in::Op::Add].calls == 0);
+}
+
+TEST_CASE("Prometheus and JSON export") {
+    in::reset();
+    in::record(in::Op::Power, 2000, 300, 1500000000);
+    const std::string prom = in::toPrometheus(in::snapshot());
+    CHECK(prom.find("# TYPE squaremat_calls_total counter") != std::string::npos);
+    CHECK(prom.find("squaremat_calls_total{op=\"power\"} 1\n") != std::string::npos);
+    CHECK(prom.find("squaremat_flops_total{op=\"power\"} 2000\n") != std::string::npos);
+    CHECK(prom.find("squaremat_seconds_total{op=\"power\"} 1.500000000\n") != std::string::npos);
+
+    const std::string json = in::toJson(in::snapshot());
+    CHECK(json.find("\"power\": {\"calls\": 1, \"flops\": 2000, \"bytes\": 300") != std::string::npos);
+
+    const std::string path = "test_instrument.prom";
+    in::writePrometheus(path);
+    std::ifstream f(path);
+    std::stringstream text;
+    text << f.rdbuf();
+    CHECK(text.str() == prom);
+    std::remove(path.c_str());
+
+    CHECK_THROWS_AS(in::writeJson("no_such_dir/x.json"), std::runtime_error);
+}
+
+TEST_CASE("SquareMat operators feed the counters when compiled in") {
+    in::reset();
+    const int n = 8;
+    SquareMat A(n, 1.0), B(n, 2.0);
+    SquareMat C = A * B;
+    C = C ^ 3;
+    (void)(A == B);
+    const in::Snapshot snap = in::snapshot();
+
+    if constexpr (in::enabled) {
+        CHECK(snap[in::Op::Multiply].calls >= 1);
+        CHECK(snap[in::Op::Multiply].flops >= 2ULL * n * n * n);
+        CHECK(snap[in::Op::Power].calls == 1);
+        CHECK(snap[in::Op::Power].flops == 4 * 2ULL * n * n * n);   // 3 = 11b: שתי מכפלות + שני ריבועים
+        CHECK(snap[in::Op::Compare].calls == 1);
+        CHECK(snap[in::Op::Allocate].allocBytes >= 3 * 8ULL * n * n);
+    } else {
+        CHECK(snap[in::Op::Multiply].calls == 0);
+        CHECK(snap[in::Op::Allocate].calls == 0);
+    }
+}
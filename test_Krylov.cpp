@@ -0,0 +1,128 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Krylov.hpp"
+#include <cmath>
+#include <vector>
+using namespace matrix;
+
+namespace {
+
+/** @brief 5-point operator on a g×g grid; @p conv > 0 adds an upwind
+ *  convection term, making it non-symmetric.                          */
+SparseMat makeGrid(int g, double conv = 0.0)
+{
+    std::vector<int> r, c;
+    std::vector<double> v;
+    auto add = [&](int i, int j, double x) { r.push_back(i); c.push_back(j); v.push_back(x); };
+    for (int y = 0; y < g; ++y)
+        for (int x = 0; x < g; ++x) {
+            const int i = y * g + x;
+            add(i, i, 4.0 + conv);
+            if (x > 0)     add(i, i - 1, -1.0 - conv);
+            if (x < g - 1) add(i, i + 1, -1.0);
+            if (y > 0)     add(i, i - g, -1.0);
+            if (y < g - 1) add(i, i + g, -1.0);
+        }
+    return SparseMat(g * g, static_cast<long>(v.size()), r.data(), c.data(), v.data());
+}
+
+double relResidual(const LinearOperator& A, const std::vector<double>& b, const std::vector<double>& x)
+{
+    std::vector<double> ax(b.size());
+    A.apply(x.data(), ax.data());
+    double rr = 0, bb = 0;
+    for (size_t i = 0; i < b.size(); ++i) { rr += (b[i] - ax[i]) * (b[i] - ax[i]); bb += b[i] * b[i]; }
+    return std::sqrt(rr / bb);
+}
+
+} // namespace
+
+TEST_CASE("CG on a Poisson problem, with and without preconditioners") {
+    const SparseMat A = makeGrid(30);
+    const int n = A.getN();
+    SparseOperator op(A);
+    std::vector<double> b(n);
+    for (int i = 0; i < n; ++i) b[i] = std::sin(0.1 * i) + 1.0;
+
+    std::vector<double> x(n, 0.0);
+    KrylovResult plain = cg(op, b.data(), x.data());
+    CHECK(plain.converged);
+    CHECK(relResidual(op, b, x) < 1e-9);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    KrylovResult jac = cg(op, b.data(), x.data(), JacobiPreconditioner(A));
+    CHECK(jac.converged);
+    CHECK(relResidual(op, b, x) < 1e-9);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    KrylovResult ilu = cg(op, b.data(), x.data(), ILU0Preconditioner(A));
+    CHECK(ilu.converged);
+    CHECK(ilu.iterations < plain.iterations);
+    CHECK(relResidual(op, b, x) < 1e-9);
+
+    KrylovResult again = cg(op, b.data(), x.data());      // ניחוש התחלתי מדויק
+    CHECK(again.iterations == 0);
+}
+
+TEST_CASE("GMRES and BiCGSTAB on a non-symmetric problem") {
+    const SparseMat A = makeGrid(25, 1.5);
+    const int n = A.getN();
+    SparseOperator op(A);
+    std::vector<double> b(n);
+    for (int i = 0; i < n; ++i) b[i] = (i % 7) - 3.0;
+
+    KrylovOptions opt;
+    opt.restart = 20;
+    opt.maxIter = 2000;
+    for (int variant = 0; variant < 4; ++variant) {
+        std::vector<double> x(n, 0.0);
+        KrylovResult res;
+        ILU0Preconditioner ilu(A);
+        switch (variant) {
+            case 0: res = gmres(op, b.data(), x.data(), opt); break;
+            case 1: res = gmres(op, b.data(), x.data(), ilu, opt); break;
+            case 2: res = bicgstab(op, b.data(), x.data(), opt); break;
+            default: res = bicgstab(op, b.data(), x.data(), JacobiPreconditioner(A), opt); break;
+        }
+        CHECK(res.converged);
+        CHECK(relResidual(op, b, x) < 1e-8);
+    }
+}
+
+TEST_CASE("Dense and matrix-free operators") {
+    const int n = 60;
+    SquareMat D(n, 0.0);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) D(i, j) = (i == j) ? n : 1.0 / (1 + i + 2 * j);
+    DenseOperator dop(D);
+    std::vector<double> b(n, 1.0), x(n, 0.0);
+    CHECK(bicgstab(dop, b.data(), x.data()).converged);
+    CHECK(relResidual(dop, b, x) < 1e-9);
+
+    FunctionOperator tri(n, [n](const double* v, double* y) {   // tridiag(-1, 2, -1)
+        for (int i = 0; i < n; ++i)
+            y[i] = 2 * v[i] - (i > 0 ? v[i - 1] : 0) - (i < n - 1 ? v[i + 1] : 0);
+    });
+    std::fill(x.begin(), x.end(), 0.0);
+    KrylovResult r = cg(tri, b.data(), x.data());
+    CHECK(r.converged);
+    CHECK(r.iterations <= n);
+    CHECK(x[0] == doctest::Approx(n / 2.0));                        // x_i = (i+1)(n−i)/2
+
+    std::vector<double> zero(n, 0.0);
+    std::fill(x.begin(), x.end(), 5.0);
+    CHECK(gmres(tri, zero.data(), x.data()).iterations == 0);
+    CHECK(x[3] == 0);
+}
+
+TEST_CASE("Preconditioner errors") {
+    SquareMat Z(3, 0.0);
+    Z(0, 1) = 1; Z(1, 0) = 1; Z(2, 2) = 1;
+    CHECK_THROWS_AS(JacobiPreconditioner{Z}, std::domain_error);
+    CHECK_THROWS_AS(ILU0Preconditioner{Z}, std::domain_error);
+
+    SparseMat A = makeGrid(4);
+    SparseOperator op(A);
+    double b[16] = {}, x[16] = {};
+    CHECK_THROWS_AS(cg(op, b, x, JacobiPreconditioner(SquareMat(3, 1.0))), std::invalid_argument);
+}
@@ -0,0 +1,123 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Serialize.hpp"
+#include "test_helpers.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+using namespace matrix;
+
+namespace {
+
+SquareMat makeMat(int n)
+{
+    return test::generate(n, [](int i, int j) { return i * 1000 + j + 0.25; });
+}
+
+} // namespace
+
+TEST_CASE("Read-only mapping reads the file in place") {
+    const std::string path = "test_mapped.tmp";
+    const int n = 300;
+    SquareMat A = makeMat(n);
+    saveBinary(A, path);
+
+    SquareMat M = SquareMat::mapFile(path, MapMode::ReadOnly, Access::Sequential, true);
+    CHECK(M.isMapped());
+    CHECK(M.isReadOnly());
+    CHECK(M.getN() == n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) CHECK(M(i, j) == A(i, j));
+    M.advise(Access::Random);
+
+    SquareMat P = M * 2.0 + M;                   // אופרטורים לא משנים עובדים כרגיל
+    CHECK(P(5, 7) == doctest::Approx(3 * A(5, 7)));
+    CHECK_THROWS_AS(M += A, std::logic_error);
+    CHECK_THROWS_AS(M *= 2.0, std::logic_error);
+    CHECK_THROWS_AS(++M, std::logic_error);
+
+    SquareMat C = M;                             // עותק = מטריצה רגילה בערימה
+    CHECK_FALSE(C.isMapped());
+    C += A;
+    CHECK(C(1, 2) == 2 * A(1, 2));
+
+    M = A;                                       // השמה משחררת את המיפוי
+    CHECK_FALSE(M.isMapped());
+    M *= 2.0;
+    CHECK(M(3, 4) == 2 * A(3, 4));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Matrix product-assignment refuses a read-only mapping") {
+    const std::string path = "test_mapped_mul.tmp";
+    const SquareMat A = makeMat(40);
+    saveBinary(A, path);
+    SquareMat M = SquareMat::mapFile(path);
+    CHECK_THROWS_AS(M *= A, std::logic_error);
+    CHECK(M.isMapped());                         // המיפוי לא הוחלף בשקט
+    CHECK(M(2, 3) == A(2, 3));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Private mapping is copy-on-write") {
+    const std::string path = "test_mapped_private.tmp";
+    SquareMat A = makeMat(50);
+    saveBinary(A, path);
+    {
+        SquareMat M = SquareMat::mapFile(path, MapMode::Private);
+        CHECK_FALSE(M.isReadOnly());
+        M(2, 3) = -1;
+        M += A;
+        CHECK(M(2, 3) == -1 + A(2, 3));
+        CHECK(M(0, 0) == 2 * A(0, 0));
+    }
+    SquareMat B = loadBinary(path);              // הקובץ לא השתנה
+    CHECK(B(2, 3) == A(2, 3));
+    CHECK(B(0, 0) == A(0, 0));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Mapping rejects bad files") {
+    CHECK_THROWS_AS(SquareMat::mapFile("no_such_matrix.bin"), std::runtime_error);
+
+    const std::string path = "test_mapped_bad.tmp";
+    saveBinary(makeMat(20), path);
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(64 + 8 * 17);
+        const double junk = 123.0;
+        f.write(reinterpret_cast<const char*>(&junk), sizeof junk);
+    }
+    CHECK_NOTHROW(SquareMat::mapFile(path));               // ללא אימות – נטען
+    CHECK_THROWS_AS(SquareMat::mapFile(path, MapMode::ReadOnly, Access::Normal, true),
+                    std::runtime_error);
+
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f << "short";
+    }
+    CHECK_THROWS_AS(SquareMat::mapFile(path), std::runtime_error);
+
+    std::stringstream buf;
+    saveBinary(makeMat(20), buf);
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        const std::string s = buf.str();
+        f.write(s.data(), static_cast<std::streamsize>(s.size() - 8));   // מטען קטוע
+    }
+    CHECK_THROWS_AS(SquareMat::mapFile(path), std::runtime_error);
+
+    // n שה-n*n שלו גולש מ-int נדחה לפני המיפוי
+    BinaryHeader h = decodeHeader(reinterpret_cast<const unsigned char*>(buf.str().data()));
+    h.n = 65536;
+    h.payloadBytes = h.n * h.n * sizeof(double);
+    unsigned char head[BINARY_HEADER_BYTES];
+    encodeHeader(h, head);
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(head), BINARY_HEADER_BYTES);
+    }
+    CHECK_THROWS_AS(SquareMat::mapFile(path), std::runtime_error);
+    CHECK_THROWS_AS(SquareMat::mapRaw(path, SquareMat::MAX_N + 1, 0), std::invalid_argument);
+    std::remove(path.c_str());
+}
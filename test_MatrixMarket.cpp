@@ -0,0 +1,126 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "MatrixMarket.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+using namespace matrix;
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& text)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f << text;
+}
+
+SquareMat makeMat(int n)
+{
+    return test::generate(n, [](int i, int j) { return (i * 5 + j) % 7 == 0 ? std::sin(i + 0.1 * j) * 1e3 : 0.0; });
+}
+
+} // namespace
+
+TEST_CASE("Matrix Market round trips, dense and sparse") {
+    const std::string path = "test_mtx.tmp";
+    for (int n : {1, 23, 600}) {                 // 600: כמה חלקים מקבילים
+        SquareMat A = makeMat(n);
+        A(0, 0) = 0.1;
+        saveMatrixMarket(A, path);
+        SquareMat B = loadMatrixMarket(path);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) CHECK(B(i, j) == A(i, j));
+
+        for (SparseFormat f : {SparseFormat::CSR, SparseFormat::CSC}) {
+            saveMatrixMarket(SparseMat(A, f), path);
+            SparseMat S = loadMatrixMarketSparse(path, f);
+            CHECK(S.format() == f);
+            CHECK(S.nonZeros() == SparseMat(A).nonZeros());
+            SquareMat D = loadMatrixMarket(path);
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j) {
+                    CHECK(S(i, j) == A(i, j));
+                    CHECK(D(i, j) == A(i, j));
+                }
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Matrix Market reader handles symmetry, patterns and comments") {
+    const std::string path = "test_mtx_sym.tmp";
+    writeFile(path,
+        "%%MatrixMarket matrix coordinate real symmetric\n"
+        "% a comment\n"
+        "\n"
+        "3 3 4\n"
+        "1 1 2.5\n"
+        "2 1 -1\n"
+        "  3 2 +4e-1  \r\n"
+        "3 3 7\n");
+    SquareMat S = loadMatrixMarket(path);
+    CHECK(S(0, 0) == 2.5);
+    CHECK(S(0, 1) == -1);
+    CHECK(S(1, 0) == -1);
+    CHECK(S(1, 2) == 0.4);
+    CHECK(S(2, 2) == 7);
+    CHECK(loadMatrixMarketSparse(path).nonZeros() == 6);
+
+    writeFile(path,
+        "%%MatrixMarket matrix coordinate pattern general\n"
+        "2 2 2\n1 2\n2 1\n");
+    SparseMat P = loadMatrixMarketSparse(path, SparseFormat::CSC);
+    CHECK(P(0, 1) == 1);
+    CHECK(P(1, 0) == 1);
+    CHECK(P(0, 0) == 0);
+
+    writeFile(path,
+        "%%MatrixMarket matrix array integer skew-symmetric\n"
+        "3 3\n1\n2\n3\n");                       // (2,1) (3,1) (3,2)
+    SquareMat K = loadMatrixMarket(path);
+    CHECK(K(1, 0) == 1);
+    CHECK(K(0, 1) == -1);
+    CHECK(K(2, 1) == 3);
+    CHECK(K(1, 2) == -3);
+    CHECK(K(1, 1) == 0);
+
+    writeFile(path,
+        "%%MatrixMarket matrix array real symmetric\n"
+        "2 2\n1\n2\n3\n");
+    SquareMat Y = loadMatrixMarket(path);
+    CHECK(Y(0, 1) == 2);
+    CHECK(Y(1, 0) == 2);
+    CHECK(Y(1, 1) == 3);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Matrix Market reader rejects malformed files") {
+    const std::string path = "test_mtx_bad.tmp";
+    const char* bad[] = {
+        "not a banner\n1 1 0\n",
+        "%%MatrixMarket matrix coordinate complex general\n1 1 0\n",
+        "%%MatrixMarket matrix coordinate real general\n2 3 0\n",
+        "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n",
+        "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n",
+        "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 x\n",
+        "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 1 9\n",
+        "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n",
+        "%%MatrixMarket matrix coordinate real general\n",
+    };
+    for (const char* text : bad) {
+        writeFile(path, text);
+        CHECK_THROWS_AS(loadMatrixMarket(path), std::runtime_error);
+    }
+    CHECK_THROWS_AS(loadMatrixMarket("no_such_file.mtx"), std::runtime_error);
+
+    // גדולה מדי לצפופה – נטענת רק כדלילה
+    writeFile(path, "%%MatrixMarket matrix coordinate real general\n65536 65536 1\n65536 65536 2.5\n");
+    CHECK_THROWS_WITH_AS(loadMatrixMarket(path), doctest::Contains("too large"), std::runtime_error);
+    const SparseMat S = loadMatrixMarketSparse(path);
+    CHECK(S.getN() == 65536);
+    CHECK(S.nonZeros() == 1);
+    CHECK(S(65535, 65535) == 2.5);
+    std::remove(path.c_str());
+}
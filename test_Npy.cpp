@@ -0,0 +1,133 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Npy.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+using namespace matrix;
+
+namespace {
+
+SquareMat makeMat(int n)
+{
+    return test::generate(n, [](int i, int j) { return std::cos(i * 1.1 + j) * (i + 1); });
+}
+
+/** @brief Hand-built .npy bytes for dtype/order combinations we never write. */
+std::string npyBytes(int major, const std::string& descr, bool fortran, int n, const std::string& payload)
+{
+    std::string dict = "{'descr': '" + descr + "', 'fortran_order': " + (fortran ? "True" : "False") +
+                       ", 'shape': (" + std::to_string(n) + ", " + std::to_string(n) + "), }\n";
+    std::string out = "\x93NUMPY";
+    out += static_cast<char>(major);
+    out += '\0';
+    const std::size_t len = dict.size();
+    out += static_cast<char>(len & 0xff);
+    out += static_cast<char>(len >> 8);
+    if (major >= 2) out += std::string(2, '\0');
+    return out + dict + payload;
+}
+
+template <class T>
+std::string bytesOf(const T* v, int count, bool bigEndian)
+{
+    std::string out;
+    for (int k = 0; k < count; ++k) {
+        char b[sizeof(T)];
+        std::memcpy(b, &v[k], sizeof(T));
+        for (std::size_t i = 0; i < sizeof(T); ++i) out += b[bigEndian ? sizeof(T) - 1 - i : i];
+    }
+    return out;
+}
+
+} // namespace
+
+TEST_CASE(".npy round trip and header layout") {
+    SquareMat A = makeMat(37);
+    std::stringstream buf;
+    saveNpy(A, buf);
+    const std::string s = buf.str();
+    CHECK(s.compare(0, 6, "\x93NUMPY") == 0);
+    const std::size_t offset = 10 + (static_cast<unsigned char>(s[8]) | (static_cast<unsigned char>(s[9]) << 8));
+    CHECK(offset % 64 == 0);
+    CHECK(s.size() == offset + 37 * 37 * 8);
+    CHECK(s.find("'descr': '<f8'") != std::string::npos);
+    CHECK(s.find("'shape': (37, 37)") != std::string::npos);
+
+    SquareMat B = loadNpy(buf);
+    for (int i = 0; i < 37; ++i)
+        for (int j = 0; j < 37; ++j) CHECK(B(i, j) == A(i, j));
+}
+
+TEST_CASE(".npy mapping is zero-copy when the layout matches") {
+    const std::string path = "test_npy.tmp";
+    SquareMat A = makeMat(64);
+    saveNpy(A, path);
+    SquareMat M = mapNpy(path);
+    CHECK(M.isMapped());
+    CHECK(M.isReadOnly());
+    CHECK(M(63, 5) == A(63, 5));
+
+    SquareMat P = mapNpy(path, MapMode::Private, Access::Random);
+    P(0, 0) = 42;
+    CHECK(loadNpy(path)(0, 0) == A(0, 0));
+
+    // Fortran order: אי אפשר למפות – נטען ומשוחלף
+    const double v[4] = {1, 2, 3, 4};
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f << npyBytes(1, "<f8", true, 2, bytesOf(v, 4, false));
+    }
+    SquareMat F = mapNpy(path);
+    CHECK_FALSE(F.isMapped());
+    CHECK(F(0, 1) == 3);
+    CHECK(F(1, 0) == 2);
+    std::remove(path.c_str());
+}
+
+TEST_CASE(".npy reader converts dtypes and byte orders") {
+    const float f[4] = {1.5f, -2, 3, 4};
+    const long long i8[4] = {7, -8, 9, 10};
+    const int i4[4] = {1, 2, -3, 4};
+    const double d[4] = {0.25, 1e300, -0.0, 5};
+
+    std::stringstream a(npyBytes(1, "<f4", false, 2, bytesOf(f, 4, false)));
+    SquareMat A = loadNpy(a);
+    CHECK(A(0, 0) == 1.5);
+    CHECK(A(0, 1) == -2);
+
+    std::stringstream b(npyBytes(2, ">i8", false, 2, bytesOf(i8, 4, true)));
+    SquareMat B = loadNpy(b);
+    CHECK(B(0, 1) == -8);
+    CHECK(B(1, 1) == 10);
+
+    std::stringstream c(npyBytes(3, "<i4", true, 2, bytesOf(i4, 4, false)));
+    SquareMat C = loadNpy(c);
+    CHECK(C(0, 1) == -3);
+
+    std::stringstream e(npyBytes(1, ">f8", false, 2, bytesOf(d, 4, true)));
+    SquareMat E = loadNpy(e);
+    CHECK(E(0, 1) == 1e300);
+    CHECK(std::signbit(E(1, 0)));
+}
+
+TEST_CASE(".npy reader rejects what it cannot represent") {
+    const double d[4] = {};
+    std::string s = npyBytes(1, "<f8", false, 2, bytesOf(d, 4, false));
+    s.replace(s.find("(2, 2)"), 6, "(2, 3)");
+    std::stringstream notSquare(s);
+    CHECK_THROWS_AS(loadNpy(notSquare), std::runtime_error);
+
+    std::stringstream complex(npyBytes(1, "<c16", false, 2, bytesOf(d, 4, false)));
+    CHECK_THROWS_AS(loadNpy(complex), std::runtime_error);
+    std::stringstream truncated(npyBytes(1, "<f8", false, 2, bytesOf(d, 3, false)));
+    CHECK_THROWS_AS(loadNpy(truncated), std::runtime_error);
+    std::stringstream huge(npyBytes(1, "<f8", false, 65536, bytesOf(d, 4, false)));   // n*n גולש מ-int
+    CHECK_THROWS_WITH_AS(loadNpy(huge), doctest::Contains("too large"), std::runtime_error);
+    std::stringstream junk("not numpy at all");
+    CHECK_THROWS_AS(loadNpy(junk), std::runtime_error);
+    CHECK_THROWS_AS(loadNpy(std::string("no_such_file.npy")), std::runtime_error);
+}
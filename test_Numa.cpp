@@ -0,0 +1,91 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Numa.hpp"
+#include "SquareMat.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <thread>
+#include <vector>
+using namespace matrix;
+using test::sample;
+
+namespace {
+
+/** Restores the default policy after each test. */
+struct Restore {
+    ~Restore() { numa::setPlacement(numa::Placement::Default); }
+};
+
+} // namespace
+
+TEST_CASE("Topology comes from sysfs and covers every CPU") {
+    CHECK(numa::nodeCount() >= 1);
+    const std::vector<int> cpus = numa::cpuOrder();
+    CHECK(cpus.size() >= 1);
+    for (int c : cpus) CHECK(c >= 0);
+    CHECK(numa::cpusOfNode(100000).empty());
+}
+
+TEST_CASE("A static loop gives each contiguous part to the same pool slot every time") {
+    ThreadPool pool(3);
+    std::vector<std::thread::id> first(12), second(12);
+    pool.parallelForStatic(0, 12, [&](int i) { first[i] = std::this_thread::get_id(); });
+    pool.parallelForStatic(0, 12, [&](int i) { second[i] = std::this_thread::get_id(); });
+    CHECK(first == second);
+    CHECK(first[0] == std::this_thread::get_id());          // חלק 0 – החוט הקורא
+    for (int part = 0; part < 3; ++part)
+        for (int i = part * 4; i < part * 4 + 4; ++i) CHECK(first[i] == first[part * 4]);
+    CHECK(first[0] != first[4]);
+    CHECK(first[4] != first[8]);
+
+    CHECK_THROWS_AS(pool.parallelForStatic(0, 6, [](int i) {
+        if (i == 5) throw std::runtime_error("boom");
+    }), std::runtime_error);
+}
+
+TEST_CASE("Pinning spreads workers over the CPU list and survives resize") {
+    ThreadPool pool(3);
+    const std::vector<int> cpus = numa::cpuOrder();
+    CHECK(numa::pinPool(pool));
+    CHECK(pool.workerCpu(0) == -1);
+    CHECK(pool.workerCpu(1) == cpus[cpus.size() / 3]);
+    pool.resize(2);
+    CHECK(pool.workerCpu(1) == cpus[cpus.size() / 2]);
+    int sum = 0;
+    pool.parallelFor(0, 10, [&](int) { __atomic_add_fetch(&sum, 1, __ATOMIC_RELAXED); });
+    CHECK(sum == 10);
+
+    const int bad = -1;
+    CHECK_THROWS_AS(pool.pinWorkers(&bad, 1), std::invalid_argument);
+    CHECK_THROWS_AS(pool.pinWorkers(cpus.data(), 0), std::invalid_argument);
+}
+
+TEST_CASE("Placed matrices behave like heap matrices") {
+    Restore restore;
+    const SquareMat heapA = sample(96), heapB = sample(96) * 0.5;
+    const SquareMat expected = heapA * heapB;
+
+    for (numa::Placement p : {numa::Placement::FirstTouch, numa::Placement::Interleave}) {
+        numa::setPlacement(p, 1024);
+        CHECK(numa::placement() == p);
+        SquareMat A = heapA, B(96, 2.0);
+        B = heapB;
+        CHECK_FALSE(A.isMapped());
+        CHECK_FALSE(A.isReadOnly());
+        CHECK(numa::nodeOf(A.raw()) >= 0);
+        CHECK(numa::nodeOf(A.raw() + 96 * 95) >= 0);
+
+        const SquareMat C = A * B;
+        double err = 0;
+        for (int i = 0; i < 96; ++i)
+            for (int j = 0; j < 96; ++j) err = std::fmax(err, std::fabs(C(i, j) - expected(i, j)));
+        CHECK(err < 1e-12);
+
+        SquareMat small(4, 1.5);                              // מתחת לסף – ערימה רגילה
+        CHECK(small.sum() == doctest::Approx(24.0));
+        B = small;
+        CHECK(B.getN() == 4);
+        A = SquareMat(97, 3.0);
+        CHECK(A(96, 96) == 3.0);
+    }
+}
@@ -0,0 +1,72 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "OutOfCore.hpp"
+#include "Serialize.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <cstdio>
+using namespace matrix;
+
+namespace {
+
+SquareMat makeMat(int n, double seed)
+{
+    return test::generate(n, [=](int i, int j) { return std::sin(seed * i + 0.3 * j) + (i == j ? 2 : 0); });
+}
+
+void checkClose(const SquareMat& X, const SquareMat& Y)
+{
+    for (int i = 0; i < X.getN(); ++i)
+        for (int j = 0; j < X.getN(); ++j) CHECK(X(i, j) == doctest::Approx(Y(i, j)));
+}
+
+} // namespace
+
+TEST_CASE("Out-of-core multiply matches the in-memory product") {
+    const int n = 157;
+    const std::string pa = "test_ooc_a.tmp", pb = "test_ooc_b.tmp", pc = "test_ooc_c.tmp";
+    SquareMat A = makeMat(n, 0.7), B = makeMat(n, 1.3);
+    saveBinary(A, pa);
+    saveBinary(B, pb);
+    const SquareMat ref = A * B;
+
+    // תקציב זעיר: כמה פאנלים ורצועות חלקיות
+    OutOfCoreOptions opt;
+    opt.stripRows = 20;
+    opt.prefetchDepth = 3;
+    opt.ioThreads = 3;
+    opt.memoryBytes = 3 * 20 * n * 8 + 2 * n * 8 * 45;
+    OutOfCoreStats st = multiplyFiles(pa, pb, pc, opt);
+    CHECK(st.panelRows == 45);
+    CHECK(st.panels == 4);
+    CHECK(st.bytesRead == 8ull * n * n * (1 + 4));           // A פעם אחת, B פעם לכל פאנל
+    CHECK(st.bytesWritten == 8ull * n * n + BINARY_HEADER_BYTES);
+    checkClose(loadBinary(pc), ref);                         // כולל בדיקת checksum
+
+    st = multiplyFiles(pa, pb, pc);                          // הכל בפאנל אחד
+    CHECK(st.panels == 1);
+    checkClose(loadBinary(pc), ref);
+
+    multiplyFiles(pa, pa, pc, opt);                          // A·A מאותו קובץ
+    checkClose(loadBinary(pc), A * A);
+
+    for (const char* p : {pa.c_str(), pb.c_str(), pc.c_str()}) std::remove(p);
+}
+
+TEST_CASE("Out-of-core multiply validates its inputs") {
+    const std::string pa = "test_ooc_v1.tmp", pb = "test_ooc_v2.tmp", pc = "test_ooc_v3.tmp";
+    saveBinary(makeMat(10, 0.1), pa);
+    saveBinary(makeMat(11, 0.2), pb);
+
+    CHECK_THROWS_AS(multiplyFiles(pa, pb, pc), std::invalid_argument);
+    CHECK_THROWS_AS(multiplyFiles(pa, pa, pa), std::invalid_argument);
+    OutOfCoreOptions opt;
+    opt.memoryBytes = 100;
+    CHECK_THROWS_AS(multiplyFiles(pa, pa, pc, opt), std::invalid_argument);
+    opt = OutOfCoreOptions();
+    opt.prefetchDepth = 1;
+    CHECK_THROWS_AS(multiplyFiles(pa, pa, pc, opt), std::invalid_argument);
+    CHECK_THROWS_AS(multiplyFiles("no_such_matrix.bin", pa, pc), std::runtime_error);
+
+    for (const char* p : {pa.c_str(), pb.c_str(), pc.c_str()}) std::remove(p);
+}
@@ -0,0 +1,127 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Perf.hpp"
+#include "SquareMat.hpp"
+#include <string>
+#include <thread>
+using namespace matrix;
+namespace in = matrix::instrument;
+
+namespace {
+
+volatile double sink;
+
+void spin()
+{
+    double x = 0;
+    for (int k = 0; k < 2000000; ++k) x += k * 1e-9;
+    sink = x;
+}
+
+} // namespace
+
+TEST_CASE("Event names") {
+    CHECK(std::string(perf::eventName(perf::Event::Cycles)) == "cycles");
+    CHECK(std::string(perf::eventName(perf::Event::DTLBMisses)) == "dTLB-misses");
+    CHECK(std::string(perf::eventName(perf::Event::TaskClock)) == "task-clock");
+}
+
+TEST_CASE("Region counts the work it encloses") {
+    const bool on = perf::start();
+    CHECK(perf::active() == on);
+    perf::Region r;
+    spin();
+    const perf::Reading d = r.elapsed();
+    for (int e = 0; e < perf::EVENT_COUNT; ++e) {
+        const auto ev = static_cast<perf::Event>(e);
+        if (!perf::available(ev)) CHECK(d[ev] == 0);
+    }
+    if (perf::available(perf::Event::TaskClock)) CHECK(d[perf::Event::TaskClock] > 0);
+    if (perf::available(perf::Event::Instructions)) CHECK(d[perf::Event::Instructions] > 2000000);
+    perf::stop();
+    CHECK_FALSE(perf::active());
+}
+
+TEST_CASE("Scopes attribute counts to operators, outermost only") {
+    const bool on = perf::start();
+    perf::reset();
+    {
+        perf::Scope outer(in::Op::Transpose);
+        perf::Scope inner(in::Op::Transpose);
+        spin();
+    }
+    perf::Profile p = perf::profile();
+    CHECK(p[in::Op::Transpose].calls == (on ? 1u : 0u));
+    if (perf::available(perf::Event::TaskClock)) CHECK(p[in::Op::Transpose].totals[perf::Event::TaskClock] > 0);
+
+    const std::string table = perf::report(p);
+    CHECK(table.find("IPC") != std::string::npos);
+    CHECK((table.find("transpose") != std::string::npos) == on);
+
+    perf::stop();
+    {
+        perf::Scope s(in::Op::Transpose);              // לא פעיל – לא נספר
+    }
+    CHECK(perf::profile()[in::Op::Transpose].calls == p[in::Op::Transpose].calls);
+    perf::reset();
+    CHECK(perf::profile()[in::Op::Transpose].calls == 0);
+}
+
+TEST_CASE("Differences clamp at zero") {
+    perf::Reading a{}, b{};
+    a.value[0] = 5;
+    b.value[0] = 7;                                     // הערכת multiplexing שירדה
+    b.value[1] = 3;
+    a.value[1] = 10;
+    const perf::Reading d = a - b;
+    CHECK(d.value[0] == 0);
+    CHECK(d.value[1] == 7);
+}
+
+TEST_CASE("Scopes overlapping another thread are counted but not attributed") {
+    const bool on = perf::start();
+    perf::reset();
+    {
+        perf::Scope outer(in::Op::Transpose);
+        std::thread t([] {
+            perf::Scope other(in::Op::Negate);
+            spin();
+        });
+        t.join();
+        perf::Scope nested(in::Op::Scale);              // אותו חוט – לא חפיפה
+    }
+    {
+        perf::Scope alone(in::Op::Add);
+        spin();
+    }
+    const perf::Profile p = perf::profile();
+    perf::stop();
+
+    const std::uint64_t one = on ? 1 : 0;
+    CHECK(p[in::Op::Transpose].calls == one);
+    CHECK(p[in::Op::Transpose].overlapped == one);
+    CHECK(p[in::Op::Negate].calls == one);
+    CHECK(p[in::Op::Negate].overlapped == one);
+    CHECK(p[in::Op::Scale].overlapped == 0);
+    CHECK(p[in::Op::Add].overlapped == 0);
+    for (int e = 0; e < perf::EVENT_COUNT; ++e) {
+        CHECK(p[in::Op::Transpose].totals.value[e] == 0);
+        CHECK(p[in::Op::Negate].totals.value[e] == 0);
+    }
+    if (perf::available(perf::Event::TaskClock)) CHECK(p[in::Op::Add].totals[perf::Event::TaskClock] > 0);
+}
+
+TEST_CASE("SquareMat operators are profiled in instrumented builds") {
+    const bool on = perf::start();
+    perf::reset();
+    SquareMat A(64, 1.5);
+    SquareMat B = ~(A * A);
+    (void)!SquareMat(4, 2.0);
+    const perf::Profile p = perf::profile();
+    perf::stop();
+
+    const std::uint64_t expected = (on && in::enabled) ? 1 : 0;
+    CHECK(p[in::Op::Multiply].calls == expected);
+    CHECK(p[in::Op::Transpose].calls == expected);
+    CHECK(p[in::Op::Determinant].calls == expected);      // רקורסיה נספרת פעם אחת
+}
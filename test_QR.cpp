@@ -0,0 +1,102 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "QR.hpp"
+#include "LU.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+using namespace matrix;
+
+namespace {
+
+SquareMat makeMat(int n)
+{
+    return test::generate(n, [](int i, int j) { return ((i * 17 + j * 5) % 13 - 6) / 7.0 + (i == j ? 2 : 0); });
+}
+
+} // namespace
+
+TEST_CASE("QR reproduces A with orthogonal Q") {
+    for (int n : {1, 5, 64, 150}) {                       // פאנל אחד, כמה פאנלים ושארית
+        SquareMat A = makeMat(n);
+        QR f(A);
+        SquareMat R = f.R();
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < i; ++j) CHECK(R(i, j) == 0);
+
+        SquareMat QR_ = f.multiplyQ(R);                   // Q·R = A
+        SquareMat QtA = f.multiplyQ(A, true);             // Qᵀ·A = R
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) {
+                CHECK(QR_(i, j) == doctest::Approx(A(i, j)).scale(1));
+                CHECK(QtA(i, j) == doctest::Approx(R(i, j)).scale(1));
+            }
+
+        SquareMat I(n, 0.0);
+        for (int i = 0; i < n; ++i) I(i, i) = 1;
+        SquareMat Q = f.multiplyQ(I);
+        SquareMat QtQ = ~Q * Q;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                CHECK(QtQ(i, j) == doctest::Approx(i == j ? 1.0 : 0.0).scale(1));
+    }
+}
+
+TEST_CASE("QR determinant and solves") {
+    const int n = 90;
+    SquareMat A = makeMat(n);
+    QR f(A);
+    CHECK(!f.isSingular());
+    CHECK(f.determinant() == doctest::Approx(LU(A).determinant()));
+
+    SquareMat S(3);
+    S(0,0) = 0; S(0,1) = 2; S(0,2) = 1;
+    S(1,0) = 1; S(1,1) = 0; S(1,2) = 0;
+    S(2,0) = 3; S(2,1) = 1; S(2,2) = 4;
+    CHECK(QR(S).determinant() == doctest::Approx(!S));
+
+    double b[n], x[n];
+    for (int i = 0; i < n; ++i) b[i] = x[i] = std::sin(i);
+    f.solveInPlace(x);
+    for (int i = 0; i < n; ++i) {
+        double s = 0;
+        for (int j = 0; j < n; ++j) s += A(i, j) * x[j];
+        CHECK(s == doctest::Approx(b[i]).scale(1));
+    }
+
+    SquareMat X = f.solve(A * A);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) CHECK(X(i, j) == doctest::Approx(A(i, j)).scale(1));
+
+    CHECK_THROWS_AS(f.solve(SquareMat(3)), std::invalid_argument);
+    CHECK_THROWS_AS(QR(SquareMat(4, 0.0)).solveInPlace(x), std::domain_error);
+}
+
+TEST_CASE("QR least squares on a rank-deficient matrix") {
+    SquareMat A(3, 0.0);                                  // עמודה אחרונה = אפס
+    A(0,0) = 1; A(1,1) = 1; A(2,0) = 1;
+    double b[3] = {1, 2, 3}, x[3];
+    const double resid = QR(A).leastSquares(b, x);
+    CHECK(x[0] == doctest::Approx(2));                    // ממוצע של 1 ו-3
+    CHECK(x[1] == doctest::Approx(2));
+    CHECK(x[2] == 0);
+    CHECK(resid == doctest::Approx(std::sqrt(2.0)));
+
+    SquareMat B = makeMat(20);
+    double c[20], y[20];
+    for (int i = 0; i < 20; ++i) c[i] = i;
+    CHECK(QR(B).leastSquares(c, y) == doctest::Approx(0).scale(1));
+}
+
+TEST_CASE("QR copies and assignment between sizes") {
+    const SquareMat A = makeMat(5), B = makeMat(9);
+    QR f(A), g(B);
+    const QR copy(g);
+    f = g;
+    CHECK(f.getN() == 9);
+    const SquareMat X = f.solve(B), Y = copy.solve(B);
+    for (int i = 0; i < 9; ++i)
+        for (int j = 0; j < 9; ++j) {
+            CHECK(X(i, j) == doctest::Approx(i == j ? 1.0 : 0.0).scale(1));
+            CHECK(Y(i, j) == X(i, j));
+        }
+}
@@ -0,0 +1,109 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "SVD.hpp"
+#include "SymEig.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+using namespace matrix;
+
+namespace {
+
+SquareMat makeMat(int n)
+{
+    return test::generate(n, [](int i, int j) { return std::sin(0.3 * i + 1.7 * j) + (i == j ? 1.0 : 0.0); });
+}
+
+/** @brief Rank-r matrix with singular values 2^-t plus a tiny tail. */
+SquareMat makeLowRank(int n, int r)
+{
+    SquareMat A(n, 0.0);
+    for (int t = 0; t < r; ++t) {
+        const double s = std::pow(2.0, -t);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                A(i, j) += s * std::cos((t + 1) * (i + 0.5) * 0.1) * std::sin((t + 2) * (j + 0.3) * 0.07);
+    }
+    return A;
+}
+
+void checkTriplets(const SquareMat& A, const SVD& S, double tol)
+{
+    const int n = A.getN();
+    for (int t = 0; t < S.count(); ++t) {
+        const double* u = S.leftVector(t);
+        const double* v = S.rightVector(t);
+        for (int i = 0; i < n; ++i) {
+            double av = 0.0;
+            for (int j = 0; j < n; ++j) av += A(i, j) * v[j];
+            CHECK(av == doctest::Approx(S.singularValue(t) * u[i]).epsilon(tol).scale(1));
+        }
+        if (t > 0) CHECK(S.singularValue(t - 1) >= S.singularValue(t));
+    }
+}
+
+} // namespace
+
+TEST_CASE("Full SVD reproduces A") {
+    for (int n : {1, 2, 7, 90}) {
+        SquareMat A = makeMat(n);
+        SVD S(A);
+        CHECK(S.count() == n);
+        checkTriplets(A, S, 1e-9);
+
+        SquareMat R = S.reconstruct();
+        SquareMat UtU = ~S.U() * S.U(), VtV = ~S.V() * S.V();
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) {
+                CHECK(R(i, j) == doctest::Approx(A(i, j)).scale(1));
+                CHECK(UtU(i, j) == doctest::Approx(i == j ? 1.0 : 0.0).scale(1));
+                CHECK(VtV(i, j) == doctest::Approx(i == j ? 1.0 : 0.0).scale(1));
+            }
+
+        SymEig E(~A * A, false);                          // σᵢ² = λᵢ(AᵀA)
+        for (int i = 0; i < n; ++i)
+            CHECK(S.singularValue(i) * S.singularValue(i) ==
+                  doctest::Approx(E.eigenvalue(n - 1 - i)).scale(1));
+    }
+}
+
+TEST_CASE("Non-finite input throws without leaking") {
+    SquareMat A = makeMat(6);
+    A(2, 3) = std::nan("");
+    CHECK_THROWS_AS(SVD{A}, std::runtime_error);           // valgrind / ASan: בלי דליפה
+}
+
+TEST_CASE("SVD rank and condition number") {
+    SquareMat A(3, 0.0);
+    A(0,0) = 3; A(1,1) = -4; A(2,2) = 0.5;
+    SVD S(A);
+    CHECK(S.singularValue(0) == doctest::Approx(4));
+    CHECK(S.singularValue(2) == doctest::Approx(0.5));
+    CHECK(S.norm2() == doctest::Approx(4));
+    CHECK(S.conditionNumber() == doctest::Approx(8));
+    CHECK(S.rank() == 3);
+
+    SVD L(makeLowRank(40, 5));
+    CHECK(L.rank(1e-10) == 5);
+    CHECK_THROWS_AS(L.singularValue(40), std::out_of_range);
+}
+
+TEST_CASE("Randomized top-k SVD") {
+    const int n = 200, r = 8;
+    SquareMat A = makeLowRank(n, r);
+    SVD full(A);
+    SVD top(A, 4);
+    CHECK(top.count() == 4);
+    for (int t = 0; t < 4; ++t)
+        CHECK(top.singularValue(t) == doctest::Approx(full.singularValue(t)).epsilon(1e-8));
+    checkTriplets(A, top, 1e-7);
+
+    SVD exact(A, r, 5, 1);                               // דרגה r בדיוק: השחזור מלא
+    SquareMat R = exact.reconstruct();
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) CHECK(R(i, j) == doctest::Approx(A(i, j)).scale(1));
+
+    CHECK_THROWS_AS(top.conditionNumber(), std::logic_error);
+    CHECK_THROWS_AS(SVD(A, 0), std::invalid_argument);
+    SVD copy = top;
+    CHECK(copy.leftVector(2)[7] == top.leftVector(2)[7]);
+}
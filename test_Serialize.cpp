@@ -0,0 +1,99 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Serialize.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+using namespace matrix;
+
+namespace {
+
+SquareMat makeMat(int n)
+{
+    return test::generate(n, [](int i, int j) { return std::sin(i * 0.7 + j) / (1 + i + j); });
+}
+
+} // namespace
+
+TEST_CASE("Binary save/load round-trips bit for bit") {
+    for (int n : {1, 3, 257}) {
+        SquareMat A = makeMat(n);
+        A(0, 0) = -0.0;
+        if (n > 1) A(0, 1) = std::numeric_limits<double>::infinity();
+        std::stringstream buf;
+        saveBinary(A, buf);
+        CHECK(buf.str().size() == BINARY_HEADER_BYTES + sizeof(double) * n * n);
+
+        SquareMat B = loadBinary(buf);
+        CHECK(B.getN() == n);
+        CHECK(std::signbit(B(0, 0)));
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) CHECK(B(i, j) == A(i, j));
+    }
+
+    const std::string path = "test_serialize.tmp";
+    SquareMat A = makeMat(40);
+    saveBinary(A, path);
+    CHECK(loadBinary(path) == A);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Header layout and validation") {
+    SquareMat A = makeMat(4);
+    std::stringstream buf;
+    saveBinary(A, buf);
+    const std::string bytes = buf.str();
+    CHECK(bytes.substr(0, 8) == "SQMATRIX");
+    CHECK(bytes[8] == 1);                                 // version, little endian
+    CHECK(bytes[16] == 4);                                // n
+
+    const BinaryHeader h = decodeHeader(reinterpret_cast<const unsigned char*>(bytes.data()));
+    CHECK(h.n == 4);
+    CHECK(h.payloadBytes == 128);
+    CHECK(h.checksum == checksum(A.raw(), 16));
+
+    auto corrupt = [&](std::size_t pos) {
+        std::string b = bytes;
+        b[pos] ^= 0x10;
+        std::stringstream in(b);
+        return in;
+    };
+    std::stringstream badMagic = corrupt(0), badHeader = corrupt(16), badData = corrupt(70);
+    CHECK_THROWS_AS(loadBinary(badMagic), std::runtime_error);
+    CHECK_THROWS_AS(loadBinary(badHeader), std::runtime_error);
+    CHECK_THROWS_AS(loadBinary(badData), std::runtime_error);
+
+    std::stringstream shortFile(bytes.substr(0, bytes.size() - 8));
+    CHECK_THROWS_AS(loadBinary(shortFile), std::runtime_error);
+    CHECK_THROWS_AS(loadBinary(std::string("/nonexistent/dir/m.bin")), std::runtime_error);
+}
+
+TEST_CASE("A header whose n*n would overflow is rejected before allocating") {
+    std::stringstream small;
+    saveBinary(makeMat(2), small);
+    for (std::uint64_t n : {std::uint64_t(SquareMat::MAX_N) + 1, std::uint64_t(65536)}) {
+        BinaryHeader h = decodeHeader(reinterpret_cast<const unsigned char*>(small.str().data()));
+        h.n = n;
+        h.payloadBytes = n * n * sizeof(double);
+        unsigned char head[BINARY_HEADER_BYTES];
+        encodeHeader(h, head);
+        std::stringstream in(std::string(reinterpret_cast<const char*>(head), BINARY_HEADER_BYTES) +
+                             std::string(64, '\0'));
+        CHECK_THROWS_WITH_AS(loadBinary(in), doctest::Contains("dimension"), std::runtime_error);
+    }
+    CHECK_THROWS_AS(SquareMat(SquareMat::MAX_N + 1), std::length_error);
+}
+
+TEST_CASE("Checksum is chunking-independent") {
+    SquareMat A = makeMat(9);
+    Checksum c;
+    const auto* w = reinterpret_cast<const std::uint64_t*>(A.raw());
+    c.update(w, 5);
+    c.update(w + 5, 1);
+    c.update(w + 6, 75);
+    CHECK(c.finish() == checksum(A.raw(), 81));
+    CHECK(checksum(A.raw(), 80) != checksum(A.raw(), 81));
+}
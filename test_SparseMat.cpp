@@ -0,0 +1,116 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "SparseMat.hpp"
+using namespace matrix;
+
+namespace {
+
+/** @brief Ring graph with a few chords – mostly zeros. */
+SquareMat makeGraph(int n)
+{
+    SquareMat A(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        A(i, (i + 1) % n) = 1;
+        A(i, (i * 7 + 3) % n) += 0.5;
+        if (i % 4 == 0) A(i, i) = -2;
+    }
+    return A;
+}
+
+void checkSame(const SparseMat& S, const SquareMat& D)
+{
+    SquareMat E = S.toSquareMat();
+    for (int i = 0; i < D.getN(); ++i)
+        for (int j = 0; j < D.getN(); ++j)
+            CHECK(E(i, j) == doctest::Approx(D(i, j)));
+}
+
+} // namespace
+
+TEST_CASE("SparseMat construction and formats") {
+    int rows[] = {0, 2, 1, 2, 0};
+    int cols[] = {1, 0, 1, 0, 1};
+    double vals[] = {1, 2, 3, 4, 5};
+    SparseMat A(3, 5, rows, cols, vals);          // (0,1) ו-(2,0) כפולים
+    CHECK(A.nonZeros() == 3);
+    CHECK(A(0, 1) == 6);
+    CHECK(A(2, 0) == 6);
+    CHECK(A(1, 1) == 3);
+    CHECK(A(2, 2) == 0);
+
+    SparseMat C = A.toCSC();
+    CHECK(C.format() == SparseFormat::CSC);
+    CHECK(C(0, 1) == 6);
+    CHECK(C.outerIndex()[1] == 1);                // עמודה 0: רק (2,0)
+    checkSame(C.toCSR(), A.toSquareMat());
+
+    int bad[] = {3};
+    CHECK_THROWS_AS(SparseMat(3, 1, bad, cols, vals), std::out_of_range);
+
+    SquareMat D = makeGraph(20);
+    SparseMat S(D);
+    checkSame(S, D);
+    checkSame(SparseMat(D, SparseFormat::CSC), D);
+    checkSame(~S, ~D);
+    checkSame(~SparseMat(D, SparseFormat::CSC), ~D);
+}
+
+TEST_CASE("Assignment between matrices of different size and format") {
+    SparseMat big(makeGraph(40)), small(makeGraph(7), SparseFormat::CSC);
+    big = small;                                  // n קטן יותר
+    CHECK(big.getN() == 7);
+    CHECK(big.format() == SparseFormat::CSC);
+    CHECK(big.nonZeros() == small.nonZeros());
+    checkSame(big, makeGraph(7));
+
+    SparseMat grow(3);
+    grow = SparseMat(makeGraph(30));              // n גדול יותר
+    checkSame(grow, makeGraph(30));
+    grow = grow;
+    checkSame(grow, makeGraph(30));
+}
+
+TEST_CASE("SpMV in both formats") {
+    const int n = 300;
+    SquareMat D = makeGraph(n);
+    double x[n], y1[n], y2[n];
+    for (int i = 0; i < n; ++i) x[i] = i % 9 - 4;
+
+    SparseMat(D).multiply(x, y1);
+    SparseMat(D, SparseFormat::CSC).multiply(x, y2);
+    for (int i = 0; i < n; ++i) {
+        double expect = 0;
+        for (int j = 0; j < n; ++j) expect += D(i, j) * x[j];
+        CHECK(y1[i] == doctest::Approx(expect));
+        CHECK(y2[i] == doctest::Approx(expect));
+    }
+}
+
+TEST_CASE("SpGEMM, sum and power") {
+    const int n = 60;
+    SquareMat D = makeGraph(n), E = ~makeGraph(n) * 2.0;
+    for (SparseFormat f : {SparseFormat::CSR, SparseFormat::CSC}) {
+        SparseMat A(D, f), B(E, f);
+        checkSame(A * B, D * E);
+        checkSame(A * SparseMat(E), D * E);      // פורמטים מעורבים
+        checkSame(A + B, D + E);
+        checkSame(A * 3.0, D * 3.0);
+        checkSame(A ^ 5, D ^ 5);
+        checkSame(A ^ 0, D ^ 0);
+    }
+}
+
+TEST_CASE("Sparse × dense products") {
+    const int n = 70;
+    SquareMat D = makeGraph(n), M(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) M(i, j) = (i + 2 * j) % 5;
+
+    SquareMat L = SparseMat(D) * M, Lref = D * M;
+    SquareMat R = M * SparseMat(D, SparseFormat::CSC), Rref = M * D;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            CHECK(L(i, j) == doctest::Approx(Lref(i, j)));
+            CHECK(R(i, j) == doctest::Approx(Rref(i, j)));
+        }
+}
@@ -119,3 +119,21 @@ TEST_CASE("Element-wise product %") {
     CHECK(C(1,0) == 21);
     CHECK(C(1,1) == 32);
 }
+
+TEST_CASE("Blocked multiplication matches the naive product") {
+    const int n = 131;                       // לא כפולה של MR/NR/MC
+    SquareMat A(n), B(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            A(i, j) = (i * 7 + j * 3) % 11 - 5;
+            B(i, j) = (i * 5 + j * 2) % 13 - 6;
+        }
+
+    SquareMat C = A * B;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            double expect = 0;
+            for (int k = 0; k < n; ++k) expect += A(i, k) * B(k, j);
+            CHECK(C(i, j) == expect);
+        }
+}
@@ -0,0 +1,121 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "SymEig.hpp"
+#include <cmath>
+using namespace matrix;
+
+namespace {
+
+/** @brief Symmetric test matrix with a spread-out, partly clustered spectrum. */
+SquareMat makeSym(int n)
+{
+    SquareMat A(n, 0.0);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j <= i; ++j)
+            A(i, j) = A(j, i) = ((i * 13 + j * 7) % 11 - 5) / 10.0 + (i == j ? (i % 3) : 0);
+    return A;
+}
+
+/** @brief max |A·v − λ·v| and max |vᵢ·vⱼ − δᵢⱼ| over the computed pairs. */
+void checkPairs(const SquareMat& A, const SymEig& E)
+{
+    const int n = A.getN();
+    for (int t = 0; t < E.count(); ++t) {
+        const double* v = E.eigenvector(t);
+        for (int i = 0; i < n; ++i) {
+            double s = 0.0;
+            for (int j = 0; j < n; ++j) s += A(i, j) * v[j];
+            CHECK(s == doctest::Approx(E.eigenvalue(t) * v[i]).epsilon(1e-8).scale(1));
+        }
+        for (int u = 0; u <= t; ++u) {
+            const double* w = E.eigenvector(u);
+            double dot = 0.0;
+            for (int i = 0; i < n; ++i) dot += v[i] * w[i];
+            CHECK(dot == doctest::Approx(u == t ? 1.0 : 0.0).epsilon(1e-9).scale(1));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("SymEig of small known matrices") {
+    SquareMat A(2, 0.0);
+    A(0,0) = 2; A(0,1) = A(1,0) = 1; A(1,1) = 2;
+    SymEig E(A);
+    CHECK(E.count() == 2);
+    CHECK(E.eigenvalue(0) == doctest::Approx(1));
+    CHECK(E.eigenvalue(1) == doctest::Approx(3));
+    CHECK(std::fabs(E.eigenvector(1)[0]) == doctest::Approx(std::sqrt(0.5)));
+    checkPairs(A, E);
+
+    SquareMat D(4, 0.0);
+    D(0,0) = 3; D(1,1) = -1; D(2,2) = 3; D(3,3) = 0;          // ערך עצמי כפול
+    SymEig F(D);
+    CHECK(F.eigenvalue(0) == doctest::Approx(-1));
+    CHECK(F.eigenvalue(2) == doctest::Approx(3));
+    CHECK(F.eigenvalue(3) == doctest::Approx(3));
+    checkPairs(D, F);
+
+    SymEig one(SquareMat(1, 7.0));
+    CHECK(one.eigenvalue(0) == 7);
+    CHECK(one.eigenvector(0)[0] == doctest::Approx(1));
+
+    CHECK_THROWS_AS(SymEig(A, 3), std::invalid_argument);
+    CHECK_THROWS_AS(E.eigenvalue(2), std::out_of_range);
+    SymEig noVec(A, false);
+    CHECK_THROWS_AS(noVec.eigenvector(0), std::logic_error);
+}
+
+TEST_CASE("Full spectrum through blocking and divide and conquer") {
+    for (int n : {33, 150, 211}) {
+        SquareMat A = makeSym(n);
+        SymEig E(A);
+        CHECK(E.count() == n);
+        double trace = 0.0, sum = 0.0;
+        for (int i = 0; i < n; ++i) {
+            trace += A(i, i);
+            sum += E.eigenvalue(i);
+            if (i > 0) CHECK(E.eigenvalue(i - 1) <= E.eigenvalue(i));
+        }
+        CHECK(sum == doctest::Approx(trace));
+        checkPairs(A, E);
+
+        SquareMat V = E.eigenvectors();                       // A = V·Λ·Vᵀ
+        SquareMat L(n, 0.0);
+        for (int i = 0; i < n; ++i) L(i, i) = E.eigenvalue(i);
+        SquareMat R = V * L * ~V;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) CHECK(R(i, j) == doctest::Approx(A(i, j)).scale(1));
+    }
+}
+
+TEST_CASE("Eigenvalues-only full spectrum matches divide and conquer") {
+    for (int n : {1, 33, 211}) {
+        const SquareMat A = makeSym(n);
+        const SymEig values(A, false), pairs(A);
+        REQUIRE(values.count() == n);
+        for (int i = 0; i < n; ++i) {
+            CHECK(values.eigenvalue(i) == doctest::Approx(pairs.eigenvalue(i)).epsilon(1e-10).scale(1));
+            if (i > 0) CHECK(values.eigenvalue(i - 1) <= values.eigenvalue(i));
+        }
+    }
+}
+
+TEST_CASE("Top-k eigenpairs match the full spectrum") {
+    const int n = 180;
+    SquareMat A = makeSym(n);
+    SymEig full(A, false);
+
+    SymEig top(A, 10, Spectrum::Largest);
+    SymEig low(SymMat(A), 7, Spectrum::Smallest);
+    CHECK(top.count() == 10);
+    for (int t = 0; t < 10; ++t)
+        CHECK(top.eigenvalue(t) == doctest::Approx(full.eigenvalue(n - 10 + t)));
+    for (int t = 0; t < 7; ++t)
+        CHECK(low.eigenvalue(t) == doctest::Approx(full.eigenvalue(t)));
+    checkPairs(A, top);
+    checkPairs(A, low);
+
+    SymEig copy = top;
+    CHECK(copy.eigenvector(3)[5] == top.eigenvector(3)[5]);
+}
@@ -0,0 +1,68 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "SymMat.hpp"
+using namespace matrix;
+
+namespace {
+
+SquareMat makeDense(int n)
+{
+    SquareMat A(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            A(i, j) = (i * 7 + j * 3) % 11 - 5;
+    return A;
+}
+
+} // namespace
+
+TEST_CASE("SymMat packed storage and access") {
+    SymMat S(3, 1.0);
+    CHECK(S.getN() == 3);
+    CHECK(S.packedSize() == 6);
+
+    S(0, 2) = 4;
+    CHECK(S(2, 0) == 4);
+    CHECK_THROWS_AS(S(3, 0), std::out_of_range);
+
+    SquareMat D = S.toSquareMat();
+    CHECK(D(0, 2) == 4);
+    CHECK(D(2, 0) == 4);
+    CHECK(D(1, 1) == 1);
+
+    SymMat T = S + S * 2.0;
+    CHECK(T(2, 0) == 12);
+    CHECK((T - S)(1, 2) == 2);
+}
+
+TEST_CASE("syrk equals A * ~A and ~A * A") {
+    const int n = 150;                        // כמה אריחים של 64
+    SquareMat A = makeDense(n);
+
+    SymMat G = syrk(A);
+    SquareMat ref = A * ~A;
+    SymMat H = syrk(A, true);
+    SquareMat refT = ~A * A;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            CHECK(G(i, j) == ref(i, j));
+            CHECK(H(i, j) == refT(i, j));
+        }
+}
+
+TEST_CASE("Symmetric matrix-matrix multiply") {
+    const int n = 97;
+    SymMat S = syrk(makeDense(n));
+    SquareMat B = ~makeDense(n);
+    SquareMat Sd = S.toSquareMat();
+
+    SquareMat L = S * B, Lref = Sd * B;
+    SquareMat R = B * S, Rref = B * Sd;
+    SquareMat P = S * S, Pref = Sd * Sd;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            CHECK(L(i, j) == Lref(i, j));
+            CHECK(R(i, j) == Rref(i, j));
+            CHECK(P(i, j) == Pref(i, j));
+        }
+}
@@ -0,0 +1,104 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "Trace.hpp"
+#include "LU.hpp"
+#include "SquareMat.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+using namespace matrix;
+
+namespace {
+
+int count(const std::string& text, const std::string& what)
+{
+    int c = 0;
+    for (std::size_t p = text.find(what); p != std::string::npos; p = text.find(what, p + 1)) ++c;
+    return c;
+}
+
+} // namespace
+
+TEST_CASE("Only spans opened while tracing is active are recorded") {
+    { trace::Span s("before"); }
+    trace::start(64);
+    CHECK(trace::active());
+    { trace::Span s("inside", "test", "k", 7); }
+    trace::stop();
+    CHECK_FALSE(trace::active());
+    { trace::Span s("after"); }
+
+    const std::string json = trace::toJson();
+    CHECK(count(json, "\"name\": \"inside\", \"cat\": \"test\", \"ph\": \"X\"") == 1);
+    CHECK(json.find("\"args\": {\"k\": 7}") != std::string::npos);
+    CHECK(json.find("\"before\"") == std::string::npos);
+    CHECK(json.find("\"after\"") == std::string::npos);
+    CHECK(json.find("\"thread_name\"") != std::string::npos);
+}
+
+TEST_CASE("end() closes a span once") {
+    trace::start(64);
+    {
+        trace::Span s("early");
+        s.end();
+        s.end();
+    }
+    trace::stop();
+    CHECK(count(trace::toJson(), "\"early\"") == 1);
+}
+
+TEST_CASE("A full ring keeps the newest events and counts the rest") {
+    trace::start(8);
+    std::thread t([] {
+        for (int k = 0; k < 20; ++k) trace::Span s("wrap", "test", "k", k);
+    });
+    t.join();
+    trace::stop();
+
+    const std::string json = trace::toJson();
+    CHECK(count(json, "\"wrap\"") == 7);        // חריץ אחד שמור לאירוע בכתיבה
+    CHECK(json.find("\"args\": {\"k\": 19}") != std::string::npos);
+    CHECK(json.find("\"args\": {\"k\": 13}") != std::string::npos);
+    CHECK(json.find("\"args\": {\"k\": 12}") == std::string::npos);
+    CHECK(trace::dropped() == 13);
+}
+
+TEST_CASE("Operators, GEMM tiles and factorization panels appear in the trace") {
+    SquareMat A(200);
+    for (int i = 0; i < 200; ++i)
+        for (int j = 0; j < 200; ++j) A(i, j) = (i == j) ? 200.0 : 1.0 / (1 + i + j);
+
+    trace::start();
+    SquareMat C = A * A;
+    LU lu(A);
+    trace::stop();
+
+    const std::string json = trace::toJson();
+    CHECK(json.find("\"name\": \"Multiply\", \"cat\": \"op\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"gemm tile\", \"cat\": \"gemm\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"lu panel\", \"cat\": \"panel\"") != std::string::npos);
+    CHECK(C(0, 0) > 0);
+    CHECK(lu.determinant() != 0);
+}
+
+TEST_CASE("write() produces a complete trace file") {
+    trace::start(16);
+    { trace::Span s("file"); }
+    trace::stop();
+
+    const std::string path = "test_trace.json";
+    trace::write(path);
+    std::ifstream f(path);
+    std::stringstream text;
+    text << f.rdbuf();
+    const std::string json = text.str();
+    std::remove(path.c_str());
+
+    CHECK(json.rfind("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 0) == 0);
+    CHECK(json.substr(json.size() - 3) == "]}\n");
+    CHECK(count(json, "{") == count(json, "}"));
+    CHECK(count(json, "\"file\"") == 1);
+    CHECK_THROWS_AS(trace::write("no_such_dir/t.json"), std::runtime_error);
+}
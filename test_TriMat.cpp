@@ -0,0 +1,107 @@
+//adi.gamzu@msmail.ariel.ac.il
+#include "doctest.h"
+#include "TriMat.hpp"
+#include "LU.hpp"
+using namespace matrix;
+
+namespace {
+
+SquareMat makeDense(int n)
+{
+    SquareMat A(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            A(i, j) = (i * 7 + j * 3) % 11 - 5 + (i == j ? 20 : 0);
+    return A;
+}
+
+} // namespace
+
+TEST_CASE("TriMat storage, access and conversion") {
+    TriMat L(3, Uplo::Lower, Diag::NonUnit, 2.0);
+    const TriMat& cl = L;
+    CHECK(L.packedSize() == 6);
+    CHECK(cl(0, 2) == 0);
+    CHECK(L(2, 0) == 2);
+    CHECK_THROWS_AS(L(0, 2) = 1, std::out_of_range);
+
+    TriMat U(3, Uplo::Upper, Diag::Unit, 5.0);
+    const TriMat& cu = U;
+    CHECK(cu(1, 1) == 1);
+    CHECK(cu(0, 2) == 5);
+    CHECK_THROWS_AS(U(1, 1) = 3, std::out_of_range);
+
+    SquareMat D = U.toSquareMat();
+    CHECK(D(2, 0) == 0);
+    CHECK(D(0, 1) == 5);
+    CHECK(TriMat(D, Uplo::Upper)(0, 1) == 5);
+
+    TriMat T = ~L;
+    CHECK(T.getUplo() == Uplo::Upper);
+    CHECK(T(0, 2) == 2);
+}
+
+TEST_CASE("TriMat determinant and solve") {
+    SquareMat A = makeDense(5);
+    TriMat L(A, Uplo::Lower);
+    double det = 1;
+    for (int i = 0; i < 5; ++i) det *= A(i, i);
+    CHECK(!L == doctest::Approx(det));
+    CHECK(TriMat(A, Uplo::Upper, Diag::Unit).determinant() == 1);
+
+    double x[5] = {1, 2, 3, 4, 5}, b[5];
+    L.multiply(x, b);
+    L.solveInPlace(b);
+    for (int i = 0; i < 5; ++i) CHECK(b[i] == doctest::Approx(x[i]));
+
+    // the factors of LU are triangular: L·U reproduces P·A
+    const int n = 90;
+    SquareMat M = makeDense(n);
+    LU lu(M);
+    TriMat Lf(lu.factors(), Uplo::Lower, Diag::Unit);
+    TriMat Uf(lu.factors(), Uplo::Upper);
+    CHECK((Lf * Uf.toSquareMat()).sum() == doctest::Approx(M.sum()));   // P·A
+
+    SquareMat X = Uf.solve(Lf.solve(Lf * (Uf * M)));
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            CHECK(X(i, j) == doctest::Approx(M(i, j)));
+}
+
+TEST_CASE("TriMat solves reject a zero diagonal") {
+    for (Uplo u : {Uplo::Lower, Uplo::Upper}) {
+        TriMat T(makeDense(6), u);
+        T(3, 3) = 0;
+        double b[6] = {1, 1, 1, 1, 1, 1};
+        CHECK_THROWS_AS(T.solveInPlace(b), std::domain_error);
+        CHECK_THROWS_AS(T.solve(SquareMat(6, 1.0)), std::domain_error);
+        CHECK_NOTHROW(TriMat(makeDense(6), u, Diag::Unit).solve(SquareMat(6, 1.0)));
+    }
+}
+
+TEST_CASE("TriMat products match dense ones") {
+    const int n = 150;
+    for (Uplo u : {Uplo::Lower, Uplo::Upper}) {
+        TriMat A(makeDense(n), u), B(~makeDense(n), u);
+        SquareMat Ad = A.toSquareMat(), Bd = B.toSquareMat();
+        SquareMat Dense = makeDense(n);
+
+        SquareMat P = A * Dense, Pref = Ad * Dense;
+        SquareMat Q = (A * B).toSquareMat(), Qref = Ad * Bd;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) {
+                CHECK(P(i, j) == Pref(i, j));
+                CHECK(Q(i, j) == Qref(i, j));
+            }
+    }
+
+    TriMat S(makeDense(4) / 20.0, Uplo::Lower);
+    SquareMat Sd = S.toSquareMat();
+    SquareMat P3 = (S ^ 3).toSquareMat(), ref = Sd ^ 3;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            CHECK(P3(i, j) == doctest::Approx(ref(i, j)));
+    const TriMat I = S ^ 0;
+    CHECK(I(2, 2) == 1);
+    CHECK(I(2, 1) == 0);
+}
@@ -0,0 +1,40 @@
+//adi.gamzu@msmail.ariel.ac.il
+
+#ifndef TEST_HELPERS_HPP
+#define TEST_HELPERS_HPP
+
+#include "SquareMat.hpp"
+#include <cmath>
+
+// עזרי בדיקה משותפים: מחולל מטריצות וכלי השוואה.
+// כל קובץ בדיקה שומר לעצמו רק את הנוסחה שבאמת שונה אצלו.
+namespace matrix::test {
+
+/** @brief Builds an n×n matrix with entries f(i, j). */
+template <class F>
+SquareMat generate(int n, F f)
+{
+    SquareMat M(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) M(i, j) = f(i, j);
+    return M;
+}
+
+/** @brief Dense, non-symmetric fixture sin(0.3i + 0.7j + shift) plus @p diag on the diagonal. */
+inline SquareMat sample(int n, double shift = 0.0, double diag = 0.0)
+{
+    return generate(n, [&](int i, int j) { return (i == j ? diag : 0.0) + std::sin(0.3 * i + 0.7 * j + shift); });
+}
+
+/** @brief Largest absolute entry-wise difference between two same-sized matrices. */
+inline double maxDiff(const SquareMat& X, const SquareMat& Y)
+{
+    double d = 0;
+    for (int i = 0; i < X.getN(); ++i)
+        for (int j = 0; j < X.getN(); ++j) d = std::fmax(d, std::fabs(X(i, j) - Y(i, j)));
+    return d;
+}
+
+} // namespace matrix::test
+
+#endif // TEST_HELPERS_HPP